@@ -0,0 +1,102 @@
+/****************************************************************************
+ * apps/examples/fatbench/fatbench.h
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_EXAMPLES_FATBENCH_FATBENCH_H
+#define __APPS_EXAMPLES_FATBENCH_FATBENCH_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_NSECTORS
+#  define CONFIG_EXAMPLES_FATBENCH_NSECTORS 8192
+#endif
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_SECTORSIZE
+#  define CONFIG_EXAMPLES_FATBENCH_SECTORSIZE 512
+#endif
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_FILESIZE
+#  define CONFIG_EXAMPLES_FATBENCH_FILESIZE 1048576
+#endif
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_NFILES
+#  define CONFIG_EXAMPLES_FATBENCH_NFILES 256
+#endif
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_MOUNTPT
+#  define CONFIG_EXAMPLES_FATBENCH_MOUNTPT "/mnt/fatbench"
+#endif
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_LOOPDEV
+#  define CONFIG_EXAMPLES_FATBENCH_LOOPDEV "/dev/loop0"
+#endif
+
+#define FATBENCH_RAMDEV "/dev/fatbench"
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Requests seen by the benchmark RAM disk */
+
+struct fatbench_ramstats_s
+{
+  unsigned long nreads;     /* Number of read requests */
+  unsigned long nrdsectors; /* Number of sectors read */
+  unsigned long nwrites;    /* Number of write requests */
+  unsigned long nwrsectors; /* Number of sectors written */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/* fatbench_ramdisk.c *******************************************************/
+
+int  fatbench_ramdisk_register(void);
+void fatbench_ramdisk_unregister(void);
+void fatbench_ramdisk_stats(FAR struct fatbench_ramstats_s *stats,
+                            bool reset);
+
+#endif /* __APPS_EXAMPLES_FATBENCH_FATBENCH_H */
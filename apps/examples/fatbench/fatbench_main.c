@@ -0,0 +1,513 @@
+/****************************************************************************
+ * apps/examples/fatbench/fatbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mount.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/mkfatfs.h>
+
+#include "fatbench.h"
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+#define FATBENCH_FILE   CONFIG_EXAMPLES_FATBENCH_MOUNTPT "/bench.dat"
+#define FATBENCH_DIR    CONFIG_EXAMPLES_FATBENCH_MOUNTPT "/logs"
+#define MAX_XFERSIZE    65536
+#define NXFERSIZES      (sizeof(g_xfersizes) / sizeof(g_xfersizes[0]))
+
+/* The open benchmark opens the most recently created files in a large
+ * directory, as a logger or log viewer would.
+ */
+
+#ifdef CONFIG_FAT_LFN
+#  define FATBENCH_LOGNAME FATBENCH_DIR "/flight_log_%05d.txt"
+#else
+#  define FATBENCH_LOGNAME FATBENCH_DIR "/LOG%05d.TXT"
+#endif
+
+#define NOPENFILES      32
+#define NOPENLOOPS      10
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The sizes of the write() and read() calls in each pass.  The larger sizes
+ * span several clusters on most volumes.
+ */
+
+static const size_t g_xfersizes[] =
+{
+  512, 4096, 16384, MAX_XFERSIZE
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fatbench_msec
+ *
+ * Description:
+ *   Return the number of milliseconds since start (at least one).
+ *
+ ****************************************************************************/
+
+static unsigned long fatbench_msec(FAR const struct timespec *start)
+{
+  struct timespec now;
+  unsigned long msec;
+
+  clock_gettime(CLOCK_REALTIME, &now);
+  msec = (unsigned long)(now.tv_sec - start->tv_sec) * 1000 +
+         (now.tv_nsec - start->tv_nsec) / 1000000;
+
+  return msec > 0 ? msec : 1;
+}
+
+/****************************************************************************
+ * Name: fatbench_persec
+ *
+ * Description:
+ *   Return KB per second for the test file size transferred in 'msec'.
+ *
+ ****************************************************************************/
+
+static unsigned long fatbench_persec(unsigned long msec)
+{
+  return (unsigned long)(CONFIG_EXAMPLES_FATBENCH_FILESIZE / 1024) * 1000 /
+         msec;
+}
+
+/****************************************************************************
+ * Name: fatbench_pass
+ *
+ * Description:
+ *   Write the test file with 'xfersize' write() calls, then read it back
+ *   with 'xfersize' read() calls.
+ *
+ ****************************************************************************/
+
+static int fatbench_pass(FAR uint8_t *buffer, size_t xfersize, bool ramdisk)
+{
+  struct fatbench_ramstats_s wrstats;
+  struct fatbench_ramstats_s rdstats;
+  struct timespec start;
+  unsigned long wrmsec;
+  unsigned long rdmsec;
+  size_t remaining;
+  size_t nbytes;
+  ssize_t ret;
+  int fd;
+
+  /* Write pass */
+
+  fatbench_ramdisk_stats(&wrstats, true);
+  clock_gettime(CLOCK_REALTIME, &start);
+
+  fd = open(FATBENCH_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    {
+      printf("fatbench: open %s failed: %d\n", FATBENCH_FILE, errno);
+      return ERROR;
+    }
+
+  for (remaining = CONFIG_EXAMPLES_FATBENCH_FILESIZE; remaining > 0;
+       remaining -= nbytes)
+    {
+      nbytes = remaining < xfersize ? remaining : xfersize;
+      ret    = write(fd, buffer, nbytes);
+      if (ret != nbytes)
+        {
+          printf("fatbench: write failed: %d\n", errno);
+          close(fd);
+          return ERROR;
+        }
+    }
+
+  close(fd);
+  wrmsec = fatbench_msec(&start);
+  fatbench_ramdisk_stats(&wrstats, true);
+
+  /* Read pass */
+
+  clock_gettime(CLOCK_REALTIME, &start);
+
+  fd = open(FATBENCH_FILE, O_RDONLY);
+  if (fd < 0)
+    {
+      printf("fatbench: open %s failed: %d\n", FATBENCH_FILE, errno);
+      return ERROR;
+    }
+
+  for (remaining = CONFIG_EXAMPLES_FATBENCH_FILESIZE; remaining > 0;
+       remaining -= nbytes)
+    {
+      nbytes = remaining < xfersize ? remaining : xfersize;
+      ret    = read(fd, buffer, nbytes);
+      if (ret != nbytes)
+        {
+          printf("fatbench: read failed: %d\n", errno);
+          close(fd);
+          return ERROR;
+        }
+    }
+
+  close(fd);
+  rdmsec = fatbench_msec(&start);
+  fatbench_ramdisk_stats(&rdstats, true);
+
+  /* Spot check the data that was read last.  The buffer content is never
+   * changed so every transfer should have returned the same bytes.
+   */
+
+  if (buffer[0] != 0 || buffer[nbytes - 1] != (uint8_t)(nbytes - 1))
+    {
+      printf("fatbench: data mismatch\n");
+      return ERROR;
+    }
+
+  printf("  %5lu bytes: write %6lu KB/s  read %6lu KB/s",
+         (unsigned long)xfersize, fatbench_persec(wrmsec),
+         fatbench_persec(rdmsec));
+
+  if (ramdisk)
+    {
+      printf("  requests: write %5lu (%3lu sectors)  read %5lu (%3lu sectors)",
+             wrstats.nwrites,
+             wrstats.nwrites ? wrstats.nwrsectors / wrstats.nwrites : 0,
+             rdstats.nreads,
+             rdstats.nreads ? rdstats.nrdsectors / rdstats.nreads : 0);
+    }
+
+  printf("\n");
+  return unlink(FATBENCH_FILE);
+}
+
+/****************************************************************************
+ * Name: fatbench_openpass
+ *
+ * Description:
+ *   Create CONFIG_EXAMPLES_FATBENCH_NFILES empty files in one directory,
+ *   then repeatedly open and close the last of them.
+ *
+ ****************************************************************************/
+
+static int fatbench_openpass(bool ramdisk)
+{
+  struct fatbench_ramstats_s rdstats;
+  struct timespec start;
+  unsigned long msec;
+  char path[64];
+  int first;
+  int fd;
+  int ret;
+  int i;
+  int j;
+
+  ret = mkdir(FATBENCH_DIR, 0777);
+  if (ret < 0)
+    {
+      printf("fatbench: mkdir %s failed: %d\n", FATBENCH_DIR, errno);
+      return ERROR;
+    }
+
+  for (i = 0; i < CONFIG_EXAMPLES_FATBENCH_NFILES; i++)
+    {
+      snprintf(path, sizeof(path), FATBENCH_LOGNAME, i);
+      fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fd < 0)
+        {
+          printf("fatbench: open %s failed: %d\n", path, errno);
+          return ERROR;
+        }
+
+      close(fd);
+    }
+
+  first = CONFIG_EXAMPLES_FATBENCH_NFILES - NOPENFILES;
+  if (first < 0)
+    {
+      first = 0;
+    }
+
+  fatbench_ramdisk_stats(&rdstats, true);
+  clock_gettime(CLOCK_REALTIME, &start);
+
+  for (j = 0; j < NOPENLOOPS; j++)
+    {
+      for (i = first; i < CONFIG_EXAMPLES_FATBENCH_NFILES; i++)
+        {
+          snprintf(path, sizeof(path), FATBENCH_LOGNAME, i);
+          fd = open(path, O_RDONLY);
+          if (fd < 0)
+            {
+              printf("fatbench: open %s failed: %d\n", path, errno);
+              return ERROR;
+            }
+
+          close(fd);
+        }
+    }
+
+  msec = fatbench_msec(&start);
+  fatbench_ramdisk_stats(&rdstats, true);
+
+  i = (CONFIG_EXAMPLES_FATBENCH_NFILES - first) * NOPENLOOPS;
+  printf("  open: %d files in directory, %lu opens/s",
+         CONFIG_EXAMPLES_FATBENCH_NFILES, (unsigned long)i * 1000 / msec);
+
+  if (ramdisk)
+    {
+      printf("  sectors read per open: %lu", rdstats.nrdsectors / i);
+    }
+
+  printf("\n");
+
+  /* Remove the files and the directory */
+
+  for (i = 0; i < CONFIG_EXAMPLES_FATBENCH_NFILES; i++)
+    {
+      snprintf(path, sizeof(path), FATBENCH_LOGNAME, i);
+      (void)unlink(path);
+    }
+
+  return rmdir(FATBENCH_DIR);
+}
+
+/****************************************************************************
+ * Name: fatbench_loopsetup
+ *
+ * Description:
+ *   Make sure that the loop device backing file is large enough, then
+ *   export it as a block device.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_LOOP
+static int fatbench_loopsetup(FAR const char *filename, FAR uint8_t *buffer)
+{
+  struct stat buf;
+  off_t size = (off_t)CONFIG_EXAMPLES_FATBENCH_NSECTORS *
+               CONFIG_EXAMPLES_FATBENCH_SECTORSIZE;
+  off_t pos;
+  int fd;
+
+  if (stat(filename, &buf) < 0 || buf.st_size < size)
+    {
+      fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fd < 0)
+        {
+          printf("fatbench: Failed to create %s: %d\n", filename, errno);
+          return ERROR;
+        }
+
+      memset(buffer, 0, CONFIG_EXAMPLES_FATBENCH_SECTORSIZE);
+      for (pos = 0; pos < size; pos += CONFIG_EXAMPLES_FATBENCH_SECTORSIZE)
+        {
+          if (write(fd, buffer, CONFIG_EXAMPLES_FATBENCH_SECTORSIZE) !=
+              CONFIG_EXAMPLES_FATBENCH_SECTORSIZE)
+            {
+              printf("fatbench: Failed to write %s: %d\n", filename, errno);
+              close(fd);
+              return ERROR;
+            }
+        }
+
+      close(fd);
+    }
+
+  return losetup(CONFIG_EXAMPLES_FATBENCH_LOOPDEV, filename,
+                 CONFIG_EXAMPLES_FATBENCH_SECTORSIZE, 0, false);
+}
+#endif
+
+/****************************************************************************
+ * Name: fatbench_usage
+ ****************************************************************************/
+
+static void fatbench_usage(void)
+{
+  printf("Usage: fatbench [<blockdev>]\n");
+#ifdef CONFIG_LOOP
+  printf("       fatbench -l <file>\n");
+#endif
+  printf("With no arguments, a RAM disk is used.  Any data on the device "
+         "is destroyed.\n");
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * fatbench_main
+ ****************************************************************************/
+
+int fatbench_main(int argc, char *argv[])
+{
+  struct fat_format_s fmt = FAT_FORMAT_INITIALIZER;
+  FAR const char *devpath = FATBENCH_RAMDEV;
+  FAR uint8_t *buffer;
+  bool ramdisk = false;
+#ifdef CONFIG_LOOP
+  bool loop = false;
+#endif
+  int ret = ERROR;
+  int i;
+
+  buffer = (FAR uint8_t *)malloc(MAX_XFERSIZE);
+  if (!buffer)
+    {
+      printf("fatbench: Failed to allocate the transfer buffer\n");
+      return 1;
+    }
+
+  /* Select the device under test */
+
+  if (argc == 1)
+    {
+      ret = fatbench_ramdisk_register();
+      if (ret < 0)
+        {
+          printf("fatbench: Failed to create the RAM disk: %d\n", ret);
+          goto errout_with_buffer;
+        }
+
+      ramdisk = true;
+    }
+#ifdef CONFIG_LOOP
+  else if (argc == 3 && strcmp(argv[1], "-l") == 0)
+    {
+      ret = fatbench_loopsetup(argv[2], buffer);
+      if (ret < 0)
+        {
+          printf("fatbench: Failed to set up %s: %d\n",
+                 CONFIG_EXAMPLES_FATBENCH_LOOPDEV, ret);
+          goto errout_with_buffer;
+        }
+
+      devpath = CONFIG_EXAMPLES_FATBENCH_LOOPDEV;
+      loop    = true;
+    }
+#endif
+  else if (argc == 2 && argv[1][0] != '-')
+    {
+      devpath = argv[1];
+    }
+  else
+    {
+      fatbench_usage();
+      goto errout_with_buffer;
+    }
+
+  /* Format and mount the device */
+
+  ret = mkfatfs(devpath, &fmt);
+  if (ret < 0)
+    {
+      printf("fatbench: mkfatfs %s failed: %d\n", devpath, errno);
+      goto errout_with_device;
+    }
+
+  ret = mount(devpath, CONFIG_EXAMPLES_FATBENCH_MOUNTPT, "vfat", 0, NULL);
+  if (ret < 0)
+    {
+      printf("fatbench: mount %s failed: %d\n", devpath, errno);
+      goto errout_with_device;
+    }
+
+  /* The write pattern is the same for every transfer */
+
+  for (i = 0; i < MAX_XFERSIZE; i++)
+    {
+      buffer[i] = (uint8_t)i;
+    }
+
+  printf("fatbench: %s, %lu byte file\n", devpath,
+         (unsigned long)CONFIG_EXAMPLES_FATBENCH_FILESIZE);
+
+  for (i = 0; i < NXFERSIZES; i++)
+    {
+      ret = fatbench_pass(buffer, g_xfersizes[i], ramdisk);
+      if (ret < 0)
+        {
+          break;
+        }
+    }
+
+  if (ret >= 0)
+    {
+      ret = fatbench_openpass(ramdisk);
+    }
+
+  (void)umount(CONFIG_EXAMPLES_FATBENCH_MOUNTPT);
+
+errout_with_device:
+  if (ramdisk)
+    {
+      fatbench_ramdisk_unregister();
+    }
+
+#ifdef CONFIG_LOOP
+  if (loop)
+    {
+      (void)loteardown(CONFIG_EXAMPLES_FATBENCH_LOOPDEV);
+    }
+#endif
+
+errout_with_buffer:
+  free(buffer);
+  return ret < 0 ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+/****************************************************************************
+ * apps/examples/fatbench/fatbench_ramdisk.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <nuttx/fs/fs.h>
+
+#include "fatbench.h"
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+#define RAMDISK_SIZE \
+  ((size_t)CONFIG_EXAMPLES_FATBENCH_NSECTORS * CONFIG_EXAMPLES_FATBENCH_SECTORSIZE)
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int     ramdisk_open(FAR struct inode *inode);
+static int     ramdisk_close(FAR struct inode *inode);
+static ssize_t ramdisk_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                            size_t start_sector, unsigned int nsectors);
+static ssize_t ramdisk_write(FAR struct inode *inode,
+                             FAR const unsigned char *buffer,
+                             size_t start_sector, unsigned int nsectors);
+static int     ramdisk_geometry(FAR struct inode *inode,
+                                FAR struct geometry *geometry);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct block_operations g_bops =
+{
+  ramdisk_open,     /* open     */
+  ramdisk_close,    /* close    */
+  ramdisk_read,     /* read     */
+  ramdisk_write,    /* write    */
+  ramdisk_geometry, /* geometry */
+  NULL              /* ioctl    */
+};
+
+static FAR uint8_t *g_ramdisk;
+static struct fatbench_ramstats_s g_ramstats;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int ramdisk_open(FAR struct inode *inode)
+{
+  return OK;
+}
+
+static int ramdisk_close(FAR struct inode *inode)
+{
+  return OK;
+}
+
+static ssize_t ramdisk_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                            size_t start_sector, unsigned int nsectors)
+{
+  if (start_sector + nsectors > CONFIG_EXAMPLES_FATBENCH_NSECTORS)
+    {
+      return -EINVAL;
+    }
+
+  memcpy(buffer,
+         &g_ramdisk[start_sector * CONFIG_EXAMPLES_FATBENCH_SECTORSIZE],
+         nsectors * CONFIG_EXAMPLES_FATBENCH_SECTORSIZE);
+
+  g_ramstats.nreads++;
+  g_ramstats.nrdsectors += nsectors;
+  return nsectors;
+}
+
+static ssize_t ramdisk_write(FAR struct inode *inode,
+                             FAR const unsigned char *buffer,
+                             size_t start_sector, unsigned int nsectors)
+{
+  if (start_sector + nsectors > CONFIG_EXAMPLES_FATBENCH_NSECTORS)
+    {
+      return -EINVAL;
+    }
+
+  memcpy(&g_ramdisk[start_sector * CONFIG_EXAMPLES_FATBENCH_SECTORSIZE],
+         buffer, nsectors * CONFIG_EXAMPLES_FATBENCH_SECTORSIZE);
+
+  g_ramstats.nwrites++;
+  g_ramstats.nwrsectors += nsectors;
+  return nsectors;
+}
+
+static int ramdisk_geometry(FAR struct inode *inode,
+                            FAR struct geometry *geometry)
+{
+  if (!geometry)
+    {
+      return -EINVAL;
+    }
+
+  geometry->geo_available    = true;
+  geometry->geo_mediachanged = false;
+  geometry->geo_writeenabled = true;
+  geometry->geo_nsectors     = CONFIG_EXAMPLES_FATBENCH_NSECTORS;
+  geometry->geo_sectorsize   = CONFIG_EXAMPLES_FATBENCH_SECTORSIZE;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fatbench_ramdisk_register
+ *
+ * Description:
+ *   Allocate the RAM disk and register it as FATBENCH_RAMDEV.  Unlike the
+ *   standard RAM disk, this one counts the requests that it receives so
+ *   that the number of sectors per request can be reported.
+ *
+ ****************************************************************************/
+
+int fatbench_ramdisk_register(void)
+{
+  int ret;
+
+  g_ramdisk = (FAR uint8_t *)malloc(RAMDISK_SIZE);
+  if (!g_ramdisk)
+    {
+      return -ENOMEM;
+    }
+
+  ret = register_blockdriver(FATBENCH_RAMDEV, &g_bops, 0, NULL);
+  if (ret < 0)
+    {
+      free(g_ramdisk);
+      g_ramdisk = NULL;
+      return ret;
+    }
+
+  memset(&g_ramstats, 0, sizeof(struct fatbench_ramstats_s));
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fatbench_ramdisk_unregister
+ ****************************************************************************/
+
+void fatbench_ramdisk_unregister(void)
+{
+  (void)unregister_blockdriver(FATBENCH_RAMDEV);
+  free(g_ramdisk);
+  g_ramdisk = NULL;
+}
+
+/****************************************************************************
+ * Name: fatbench_ramdisk_stats
+ *
+ * Description:
+ *   Return the request counts and optionally reset them.
+ *
+ ****************************************************************************/
+
+void fatbench_ramdisk_stats(FAR struct fatbench_ramstats_s *stats,
+                            bool reset)
+{
+  memcpy(stats, &g_ramstats, sizeof(struct fatbench_ramstats_s));
+  if (reset)
+    {
+      memset(&g_ramstats, 0, sizeof(struct fatbench_ramstats_s));
+    }
+}
@@ -37,10 +37,21 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef CONFIG_EXAMPLES_MM_BENCHMARK
+#  include <stdint.h>
+#  include <time.h>
+#endif
+
+#ifdef CONFIG_EXAMPLES_MM_BENCH_GRAN
+#  include <nuttx/gran.h>
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -52,7 +63,12 @@
 
 /* All other definitions derive from these two */
 
-#define MM_MIN_SHIFT      4  /* 16 bytes */
+#ifdef CONFIG_MM_CALLERPC
+#  define MM_MIN_SHIFT    5  /* 32 bytes */
+#else
+#  define MM_MIN_SHIFT    4  /* 16 bytes */
+#endif
+
 #define MM_MIN_CHUNK     (1 << MM_MIN_SHIFT)
 #define MM_GRAN_MASK     (MM_MIN_CHUNK-1)
 #define MM_ALIGN_UP(a)   (((a) + MM_GRAN_MASK) & ~MM_GRAN_MASK)
@@ -60,10 +76,49 @@
 
 #ifdef CONFIG_SMALL_MEMORY
 # define SIZEOF_MM_ALLOCNODE   4
+#elif defined(CONFIG_MM_CALLERPC)
+# define SIZEOF_MM_ALLOCNODE   16
 #else
 # define SIZEOF_MM_ALLOCNODE   8
 #endif
 
+/* Benchmark configuration */
+
+#ifdef CONFIG_EXAMPLES_MM_BENCHMARK
+#  ifndef CONFIG_EXAMPLES_MM_BENCH_NITER
+#    define CONFIG_EXAMPLES_MM_BENCH_NITER 200000
+#  endif
+
+#  ifndef CONFIG_EXAMPLES_MM_BENCH_NLIVE
+#    define CONFIG_EXAMPLES_MM_BENCH_NLIVE 256
+#  endif
+
+#  define BENCH_MINSIZE  8
+#  define BENCH_MAXSIZE  2048
+
+#  ifdef CONFIG_MM_TLSF
+#    define BENCH_ALLOCATOR "TLSF"
+#  else
+#    define BENCH_ALLOCATOR "first-fit"
+#  endif
+#endif
+
+#ifdef CONFIG_EXAMPLES_MM_BENCH_GRAN
+#  ifndef CONFIG_EXAMPLES_MM_BENCH_GRANPOOL
+#    define CONFIG_EXAMPLES_MM_BENCH_GRANPOOL 1048576
+#  endif
+
+#  ifndef CONFIG_EXAMPLES_MM_BENCH_GRANLOG2
+#    define CONFIG_EXAMPLES_MM_BENCH_GRANLOG2 4
+#  endif
+
+/* Alignment used for the gran_alloc_aligned() pass (a typical DMA
+ * alignment) and for the granule heap itself.
+ */
+
+#  define BENCH_GRANALIGN 9  /* 512 bytes */
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -118,6 +173,15 @@ static const int alignment[NTEST_ALLOCS/2] =
 static void        *allocs[NTEST_ALLOCS];
 static struct       mallinfo alloc_info;
 
+#ifdef CONFIG_EXAMPLES_MM_BENCHMARK
+static void        *bench_allocs[CONFIG_EXAMPLES_MM_BENCH_NLIVE];
+static uint32_t     bench_seed;
+#endif
+
+#ifdef CONFIG_EXAMPLES_MM_BENCH_GRAN
+static size_t       bench_gransizes[CONFIG_EXAMPLES_MM_BENCH_NLIVE];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -262,6 +326,196 @@ static void do_frees(void **mem, const int *size, const int *seq, int n)
     }
 }
 
+#ifdef CONFIG_EXAMPLES_MM_BENCHMARK
+static uint32_t bench_random(void)
+{
+  /* A simple linear congruential generator so that every run (and every
+   * allocator) sees exactly the same sequence of requests.
+   */
+
+  bench_seed = bench_seed * 1103515245 + 12345;
+  return bench_seed >> 8;
+}
+
+static unsigned long bench_elapsed(FAR const struct timespec *start)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_REALTIME, &now);
+  return (unsigned long)(now.tv_sec - start->tv_sec) * 1000 +
+         (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+static void bench_pass(FAR const char *name, int minsize, int maxsize)
+{
+  struct timespec start;
+  unsigned long elapsed;
+  unsigned int nalloc = 0;
+  unsigned int nfree  = 0;
+  unsigned int nfail  = 0;
+  int i;
+  int j;
+
+  bench_seed = 0x1234;
+  clock_gettime(CLOCK_REALTIME, &start);
+
+  for (i = 0; i < CONFIG_EXAMPLES_MM_BENCH_NITER; i++)
+    {
+      j = bench_random() % CONFIG_EXAMPLES_MM_BENCH_NLIVE;
+      if (bench_allocs[j])
+        {
+          free(bench_allocs[j]);
+          bench_allocs[j] = NULL;
+          nfree++;
+        }
+      else
+        {
+          bench_allocs[j] = malloc(minsize + bench_random() % (maxsize - minsize + 1));
+          if (bench_allocs[j])
+            {
+              nalloc++;
+            }
+          else
+            {
+              nfail++;
+            }
+        }
+    }
+
+  elapsed = bench_elapsed(&start);
+  alloc_info = mallinfo();
+
+  printf("  %-10s %8u mallocs %8u frees %4u failed %6lu msec  "
+         "free chunks=%ld largest=%ld\n",
+         name, nalloc, nfree, nfail, elapsed,
+         alloc_info.ordblks, alloc_info.mxordblk);
+
+  for (j = 0; j < CONFIG_EXAMPLES_MM_BENCH_NLIVE; j++)
+    {
+      free(bench_allocs[j]);
+      bench_allocs[j] = NULL;
+    }
+}
+
+static void mm_benchmark(void)
+{
+  printf("Allocator benchmark (%s): %d operations, %d live allocations\n",
+         BENCH_ALLOCATOR, CONFIG_EXAMPLES_MM_BENCH_NITER,
+         CONFIG_EXAMPLES_MM_BENCH_NLIVE);
+
+  bench_pass("small",  BENCH_MINSIZE, 128);
+  bench_pass("mixed",  BENCH_MINSIZE, BENCH_MAXSIZE);
+  bench_pass("large",  BENCH_MAXSIZE / 2, 4 * BENCH_MAXSIZE);
+}
+#endif
+
+#ifdef CONFIG_EXAMPLES_MM_BENCH_GRAN
+static void gran_pass(GRAN_HANDLE handle, FAR const char *name,
+                      uint8_t log2align)
+{
+  struct timespec start;
+  unsigned long elapsed;
+  unsigned int nalloc = 0;
+  unsigned int nfree  = 0;
+  unsigned int nfail  = 0;
+  size_t size;
+  int i;
+  int j;
+
+  bench_seed = 0x1234;
+  clock_gettime(CLOCK_REALTIME, &start);
+
+  for (i = 0; i < CONFIG_EXAMPLES_MM_BENCH_NITER; i++)
+    {
+      j = bench_random() % CONFIG_EXAMPLES_MM_BENCH_NLIVE;
+      if (bench_allocs[j])
+        {
+          gran_free(handle, bench_allocs[j], bench_gransizes[j]);
+          bench_allocs[j] = NULL;
+          nfree++;
+        }
+      else
+        {
+          /* Mostly small requests with some large (DMA buffer) requests */
+
+          if ((bench_random() & 3) != 0)
+            {
+              size = 16 + bench_random() % 497;
+            }
+          else
+            {
+              size = 512 + bench_random() % 15873;
+            }
+
+          if (log2align > 0)
+            {
+              bench_allocs[j] = gran_alloc_aligned(handle, size, log2align);
+            }
+          else
+            {
+              bench_allocs[j] = gran_alloc(handle, size);
+            }
+
+          if (bench_allocs[j])
+            {
+              bench_gransizes[j] = size;
+              nalloc++;
+            }
+          else
+            {
+              nfail++;
+            }
+        }
+    }
+
+  elapsed = bench_elapsed(&start);
+
+  printf("  %-10s %8u allocs  %8u frees %4u failed %6lu msec\n",
+         name, nalloc, nfree, nfail, elapsed);
+
+  for (j = 0; j < CONFIG_EXAMPLES_MM_BENCH_NLIVE; j++)
+    {
+      if (bench_allocs[j])
+        {
+          gran_free(handle, bench_allocs[j], bench_gransizes[j]);
+          bench_allocs[j] = NULL;
+        }
+    }
+}
+
+static void gran_benchmark(void)
+{
+  GRAN_HANDLE handle;
+  FAR void *heap;
+
+  printf("Granule allocator benchmark: %d byte heap, %d byte granules\n",
+         CONFIG_EXAMPLES_MM_BENCH_GRANPOOL,
+         1 << CONFIG_EXAMPLES_MM_BENCH_GRANLOG2);
+
+  heap = memalign(1 << BENCH_GRANALIGN, CONFIG_EXAMPLES_MM_BENCH_GRANPOOL);
+  if (!heap)
+    {
+      printf("  Failed to allocate the granule heap\n");
+      return;
+    }
+
+  handle = gran_initialize(heap, CONFIG_EXAMPLES_MM_BENCH_GRANPOOL,
+                           CONFIG_EXAMPLES_MM_BENCH_GRANLOG2, 0);
+  if (!handle)
+    {
+      printf("  gran_initialize failed\n");
+      free(heap);
+      return;
+    }
+
+  gran_pass(handle, "first-fit", 0);
+  gran_pass(handle, "aligned", BENCH_GRANALIGN);
+
+  gran_release(handle);
+  free(heap);
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -295,6 +549,18 @@ int mm_main(int argc, char *argv[])
 
   do_frees(allocs, alloc_sizes, random1, NTEST_ALLOCS);
 
+#ifdef CONFIG_EXAMPLES_MM_BENCHMARK
+  /* Time the allocator */
+
+  mm_benchmark();
+#endif
+
+#ifdef CONFIG_EXAMPLES_MM_BENCH_GRAN
+  /* Time the granule allocator */
+
+  gran_benchmark();
+#endif
+
   printf("TEST COMPLETE\n");
   return 0;
 }
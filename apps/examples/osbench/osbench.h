@@ -0,0 +1,106 @@
+/****************************************************************************
+ * apps/examples/osbench/osbench.h
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_EXAMPLES_OSBENCH_OSBENCH_H
+#define __APPS_EXAMPLES_OSBENCH_OSBENCH_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <time.h>
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_OSBENCH_WDOG_NITER
+#  define CONFIG_EXAMPLES_OSBENCH_WDOG_NITER 100000
+#endif
+
+#ifndef CONFIG_EXAMPLES_OSBENCH_WAKEUP_NITER
+#  define CONFIG_EXAMPLES_OSBENCH_WAKEUP_NITER 10000
+#endif
+
+#ifndef CONFIG_EXAMPLES_OSBENCH_MUTEX_NITER
+#  define CONFIG_EXAMPLES_OSBENCH_MUTEX_NITER 100000
+#endif
+
+#ifndef CONFIG_EXAMPLES_OSBENCH_MQUEUE_NITER
+#  define CONFIG_EXAMPLES_OSBENCH_MQUEUE_NITER 100000
+#endif
+
+#ifndef CONFIG_EXAMPLES_OSBENCH_WQUEUE_NITER
+#  define CONFIG_EXAMPLES_OSBENCH_WQUEUE_NITER 10000
+#endif
+
+#ifndef CONFIG_EXAMPLES_OSBENCH_SPAWN_NITER
+#  define CONFIG_EXAMPLES_OSBENCH_SPAWN_NITER 1000
+#endif
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/* osbench_main.c ***********************************************************/
+
+void osbench_start(FAR struct timespec *start);
+unsigned long osbench_nsec(FAR const struct timespec *start,
+                           unsigned long niter);
+
+/* Benchmarks ***************************************************************/
+
+#ifdef CONFIG_EXAMPLES_OSBENCH_WDOG
+void osbench_wdog(void);
+#endif
+#ifdef CONFIG_EXAMPLES_OSBENCH_WAKEUP
+void osbench_wakeup(void);
+#endif
+#ifdef CONFIG_EXAMPLES_OSBENCH_MUTEX
+void osbench_mutex(void);
+#endif
+#ifdef CONFIG_EXAMPLES_OSBENCH_MQUEUE
+void osbench_mqueue(void);
+#endif
+#ifdef CONFIG_EXAMPLES_OSBENCH_WQUEUE
+void osbench_wqueue(void);
+#endif
+#ifdef CONFIG_EXAMPLES_OSBENCH_SPAWN
+void osbench_spawn(void);
+#endif
+
+#endif /* __APPS_EXAMPLES_OSBENCH_OSBENCH_H */
@@ -0,0 +1,131 @@
+/****************************************************************************
+ * apps/examples/osbench/osbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdio.h>
+#include <time.h>
+
+#include "osbench.h"
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: osbench_start
+ *
+ * Description:
+ *   Wait for the start of a new clock tick, then return the time.  The
+ *   system clock usually has a resolution of one tick; starting on a tick
+ *   boundary halves the error in the measurement.
+ *
+ ****************************************************************************/
+
+void osbench_start(FAR struct timespec *start)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  do
+    {
+      clock_gettime(CLOCK_REALTIME, start);
+    }
+  while (start->tv_sec == ts.tv_sec && start->tv_nsec == ts.tv_nsec);
+}
+
+/****************************************************************************
+ * Name: osbench_nsec
+ *
+ * Description:
+ *   Return the average time per iteration, in nanoseconds, since start.
+ *
+ ****************************************************************************/
+
+unsigned long osbench_nsec(FAR const struct timespec *start,
+                           unsigned long niter)
+{
+  struct timespec now;
+  unsigned long usec;
+
+  clock_gettime(CLOCK_REALTIME, &now);
+  usec = (unsigned long)(now.tv_sec - start->tv_sec) * 1000000 +
+         (now.tv_nsec - start->tv_nsec) / 1000;
+
+  /* Avoid overflow (and long long arithmetic) for long runs */
+
+  return usec / niter * 1000 + (usec % niter) * 1000 / niter;
+}
+
+/****************************************************************************
+ * osbench_main
+ ****************************************************************************/
+
+int osbench_main(int argc, char *argv[])
+{
+#ifdef CONFIG_EXAMPLES_OSBENCH_WDOG
+  osbench_wdog();
+#endif
+#ifdef CONFIG_EXAMPLES_OSBENCH_WAKEUP
+  osbench_wakeup();
+#endif
+#ifdef CONFIG_EXAMPLES_OSBENCH_MUTEX
+  osbench_mutex();
+#endif
+#ifdef CONFIG_EXAMPLES_OSBENCH_MQUEUE
+  osbench_mqueue();
+#endif
+#ifdef CONFIG_EXAMPLES_OSBENCH_WQUEUE
+  osbench_wqueue();
+#endif
+#ifdef CONFIG_EXAMPLES_OSBENCH_SPAWN
+  osbench_spawn();
+#endif
+
+  printf("osbench: Done\n");
+  return 0;
+}
@@ -0,0 +1,187 @@
+/****************************************************************************
+ * apps/examples/osbench/osbench_mqueue.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <time.h>
+
+#include "osbench.h"
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* 64 byte messages, or as large as the configuration allows */
+
+#if CONFIG_MQ_MAXMSGSIZE < 64
+#  define MQUEUE_MSGSIZE CONFIG_MQ_MAXMSGSIZE
+#else
+#  define MQUEUE_MSGSIZE 64
+#endif
+
+#define MQUEUE_MAXMSG    8
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static char g_msgout[MQUEUE_MSGSIZE];
+static char g_msgin[CONFIG_MQ_MAXMSGSIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static mqd_t mqueue_open(unsigned flags)
+{
+  struct mq_attr attr;
+
+  attr.mq_maxmsg  = MQUEUE_MAXMSG;
+  attr.mq_msgsize = MQUEUE_MSGSIZE;
+  attr.mq_flags   = flags;
+
+  return mq_open("osbench", O_RDWR | O_CREAT | O_NONBLOCK, 0666, &attr);
+}
+
+static void mqueue_close(mqd_t mqdes)
+{
+  mq_close(mqdes);
+  mq_unlink("osbench");
+}
+
+/* Send and receive one message with mq_send() and mq_receive() */
+
+static void mqueue_copy(FAR const char *name, unsigned flags)
+{
+  struct timespec start;
+  mqd_t mqdes;
+  int i;
+
+  mqdes = mqueue_open(flags);
+  if (mqdes == (mqd_t)ERROR)
+    {
+      printf("osbench_mqueue: ERROR mq_open failed\n");
+      return;
+    }
+
+  osbench_start(&start);
+  for (i = 0; i < CONFIG_EXAMPLES_OSBENCH_MQUEUE_NITER; i++)
+    {
+      mq_send(mqdes, g_msgout, MQUEUE_MSGSIZE, 0);
+      mq_receive(mqdes, g_msgin, sizeof(g_msgin), NULL);
+    }
+
+  printf("  %-28s %6lu nsec\n", name,
+         osbench_nsec(&start, CONFIG_EXAMPLES_OSBENCH_MQUEUE_NITER));
+
+  mqueue_close(mqdes);
+}
+
+#ifdef CONFIG_MQ_ZEROCOPY
+/* Pass one message by reference with the zero-copy interfaces.  The
+ * sender still writes the first word of the message so that the
+ * comparison with mq_send() is fair to the caches.
+ */
+
+static void mqueue_loan(void)
+{
+  struct timespec start;
+  FAR void *buf;
+  mqd_t mqdes;
+  int i;
+
+  mqdes = mqueue_open(MQ_ZEROCOPY);
+  if (mqdes == (mqd_t)ERROR)
+    {
+      printf("osbench_mqueue: ERROR mq_open failed\n");
+      return;
+    }
+
+  osbench_start(&start);
+  for (i = 0; i < CONFIG_EXAMPLES_OSBENCH_MQUEUE_NITER; i++)
+    {
+      buf = mq_loan(mqdes);
+      *(FAR int *)buf = i;
+      mq_sendloan(mqdes, buf, MQUEUE_MSGSIZE, 0);
+
+      mq_receiveloan(mqdes, &buf, NULL);
+      mq_return(mqdes, buf);
+    }
+
+  printf("  %-28s %6lu nsec\n", "mq_loan/mq_receiveloan:",
+         osbench_nsec(&start, CONFIG_EXAMPLES_OSBENCH_MQUEUE_NITER));
+
+  mqueue_close(mqdes);
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: osbench_mqueue
+ *
+ * Description:
+ *   Time sending and receiving one message through a message queue:  with
+ *   mq_send() and mq_receive() on an ordinary message queue (messages from
+ *   the global pools, copied in and out) and, if CONFIG_MQ_ZEROCOPY is
+ *   selected, on a MQ_ZEROCOPY message queue (messages from the queue's
+ *   own pool) and with the zero-copy interfaces.
+ *
+ ****************************************************************************/
+
+void osbench_mqueue(void)
+{
+  printf("osbench_mqueue: Send/receive %d byte messages, %d iterations\n",
+         MQUEUE_MSGSIZE, CONFIG_EXAMPLES_OSBENCH_MQUEUE_NITER);
+
+  memset(g_msgout, 0x5a, MQUEUE_MSGSIZE);
+  mqueue_copy("mq_send/mq_receive:", 0);
+#ifdef CONFIG_MQ_ZEROCOPY
+  mqueue_copy("mq_send/mq_receive, pool:", MQ_ZEROCOPY);
+  mqueue_loan();
+#endif
+}
@@ -0,0 +1,182 @@
+/****************************************************************************
+ * apps/examples/osbench/osbench_mutex.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <sched.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+
+#include "osbench.h"
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* The contender task has a higher priority than the benchmark so that it
+ * runs (and blocks on the mutex) as soon as it is released.
+ */
+
+#define MUTEX_MAIN      (SCHED_PRIORITY_DEFAULT + 10)
+#define MUTEX_CONTENDER (SCHED_PRIORITY_DEFAULT + 11)
+
+#define MUTEX_STACKSIZE 2048
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static pthread_mutex_t g_mutex;
+static sem_t g_gosem;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int mutex_contender(int argc, char *argv[])
+{
+  for (;;)
+    {
+      sem_wait(&g_gosem);
+      pthread_mutex_lock(&g_mutex);
+      pthread_mutex_unlock(&g_mutex);
+    }
+
+  return 0;
+}
+
+static void mutex_setprio(pid_t pid, int priority)
+{
+  struct sched_param param;
+
+  param.sched_priority = priority;
+  sched_setparam(pid, &param);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: osbench_mutex
+ *
+ * Description:
+ *   Time a lock/unlock cycle on a mutex and a wait/post cycle on a binary
+ *   semaphore when no other task wants them, then time a mutex lock/unlock
+ *   cycle when a higher priority task blocks on the mutex each time that
+ *   it is locked.  Compare the results with and without
+ *   CONFIG_SEM_FASTPATH.  The contended cycle includes four context
+ *   switches; it shows that the fast path does not slow down the
+ *   contended case.
+ *
+ ****************************************************************************/
+
+void osbench_mutex(void)
+{
+  struct sched_param saved;
+  struct timespec start;
+  sem_t sem;
+  pid_t contender;
+  int i;
+
+  printf("osbench_mutex: Lock/unlock cycle, %d iterations\n",
+         CONFIG_EXAMPLES_OSBENCH_MUTEX_NITER);
+
+  sched_getparam(0, &saved);
+  mutex_setprio(0, MUTEX_MAIN);
+  pthread_mutex_init(&g_mutex, NULL);
+  sem_init(&g_gosem, 0, 0);
+  sem_init(&sem, 0, 1);
+
+  osbench_start(&start);
+  for (i = 0; i < CONFIG_EXAMPLES_OSBENCH_MUTEX_NITER; i++)
+    {
+      pthread_mutex_lock(&g_mutex);
+      pthread_mutex_unlock(&g_mutex);
+    }
+
+  printf("  mutex, uncontended:     %6lu nsec\n",
+         osbench_nsec(&start, CONFIG_EXAMPLES_OSBENCH_MUTEX_NITER));
+
+  osbench_start(&start);
+  for (i = 0; i < CONFIG_EXAMPLES_OSBENCH_MUTEX_NITER; i++)
+    {
+      sem_wait(&sem);
+      sem_post(&sem);
+    }
+
+  printf("  semaphore, uncontended: %6lu nsec\n",
+         osbench_nsec(&start, CONFIG_EXAMPLES_OSBENCH_MUTEX_NITER));
+
+  contender = TASK_CREATE("contender", MUTEX_CONTENDER, MUTEX_STACKSIZE,
+                          mutex_contender, NULL);
+  if (contender < 0)
+    {
+      printf("osbench_mutex: ERROR task_create failed\n");
+      goto errout;
+    }
+
+  /* Each time that the contender is released, it runs immediately and
+   * blocks on the mutex.  Unlocking the mutex then wakes it up; it takes
+   * and releases the mutex and waits to be released again.
+   */
+
+  osbench_start(&start);
+  for (i = 0; i < CONFIG_EXAMPLES_OSBENCH_MUTEX_NITER; i++)
+    {
+      pthread_mutex_lock(&g_mutex);
+      sem_post(&g_gosem);
+      pthread_mutex_unlock(&g_mutex);
+    }
+
+  printf("  mutex, contended:       %6lu nsec\n",
+         osbench_nsec(&start, CONFIG_EXAMPLES_OSBENCH_MUTEX_NITER));
+
+  task_delete(contender);
+
+errout:
+  sem_destroy(&sem);
+  sem_destroy(&g_gosem);
+  pthread_mutex_destroy(&g_mutex);
+  sched_setparam(0, &saved);
+}
@@ -0,0 +1,217 @@
+/****************************************************************************
+ * apps/examples/osbench/osbench_spawn.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <sched.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <time.h>
+
+#include <nuttx/sched.h>
+
+#include "osbench.h"
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* The children have a higher priority than the benchmark so that each one
+ * runs and exits before the call that created it returns.
+ */
+
+#define SPAWN_PRIODELTA   10
+#define SPAWN_STACKSIZE   2048
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int spawn_child(int argc, char *argv[])
+{
+  return 0;
+}
+
+#ifndef CONFIG_DISABLE_PTHREAD
+static FAR void *spawn_thread(FAR void *arg)
+{
+  return NULL;
+}
+#endif
+
+#ifdef CONFIG_SCHED_TCBCACHE
+static void spawn_resetstats(void)
+{
+  int i;
+
+  for (i = 0; i < SCHED_NCACHES; i++)
+    {
+      sched_cachestats(i, NULL, true);
+    }
+}
+
+static void spawn_showstats(void)
+{
+  static const char *names[SCHED_NCACHES] =
+  {
+    "task TCB", "pthread TCB", "group", "stack"
+  };
+
+  struct sched_cachestats_s stats;
+  int i;
+
+  for (i = 0; i < SCHED_NCACHES; i++)
+    {
+      sched_cachestats(i, &stats, true);
+      printf("    %-12s hits %6lu misses %6lu discards %6lu cached %2u\n",
+             names[i], (unsigned long)stats.hits,
+             (unsigned long)stats.misses, (unsigned long)stats.discards,
+             stats.ncached);
+    }
+}
+#else
+#  define spawn_resetstats()
+#  define spawn_showstats()
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: osbench_spawn
+ *
+ * Description:
+ *   Time creating a task or thread that exits immediately, with
+ *   task_create(), pthread_create() and task_spawn().  Compare the results
+ *   with and without CONFIG_SCHED_TCBCACHE.
+ *
+ ****************************************************************************/
+
+void osbench_spawn(void)
+{
+  struct sched_param param;
+  struct timespec start;
+  posix_spawnattr_t sattr;
+#ifndef CONFIG_DISABLE_PTHREAD
+  pthread_attr_t pattr;
+  pthread_t thread;
+#endif
+  pid_t pid;
+  int priority;
+  int i;
+
+  printf("osbench_spawn: Create/exit cycle, %d iterations\n",
+         CONFIG_EXAMPLES_OSBENCH_SPAWN_NITER);
+
+  sched_getparam(0, &param);
+  priority = param.sched_priority + SPAWN_PRIODELTA;
+
+  /* task_create() */
+
+  spawn_resetstats();
+  osbench_start(&start);
+  for (i = 0; i < CONFIG_EXAMPLES_OSBENCH_SPAWN_NITER; i++)
+    {
+      pid = TASK_CREATE("child", priority, SPAWN_STACKSIZE, spawn_child,
+                        NULL);
+      if (pid < 0)
+        {
+          printf("osbench_spawn: ERROR task_create failed\n");
+          return;
+        }
+    }
+
+  printf("  task_create:            %6lu nsec\n",
+         osbench_nsec(&start, CONFIG_EXAMPLES_OSBENCH_SPAWN_NITER));
+  spawn_showstats();
+
+  /* pthread_create() */
+
+#ifndef CONFIG_DISABLE_PTHREAD
+  pthread_attr_init(&pattr);
+  pthread_attr_setstacksize(&pattr, SPAWN_STACKSIZE);
+  param.sched_priority = priority;
+  pthread_attr_setschedparam(&pattr, &param);
+  pthread_attr_setinheritsched(&pattr, PTHREAD_EXPLICIT_SCHED);
+
+  spawn_resetstats();
+  osbench_start(&start);
+  for (i = 0; i < CONFIG_EXAMPLES_OSBENCH_SPAWN_NITER; i++)
+    {
+      if (pthread_create(&thread, &pattr, spawn_thread, NULL) != 0)
+        {
+          printf("osbench_spawn: ERROR pthread_create failed\n");
+          return;
+        }
+
+      pthread_detach(thread);
+    }
+
+  printf("  pthread_create:         %6lu nsec\n",
+         osbench_nsec(&start, CONFIG_EXAMPLES_OSBENCH_SPAWN_NITER));
+  spawn_showstats();
+  pthread_attr_destroy(&pattr);
+#endif
+
+  /* task_spawn() */
+
+  posix_spawnattr_init(&sattr);
+  param.sched_priority = priority;
+  posix_spawnattr_setschedparam(&sattr, &param);
+  task_spawnattr_setstacksize(&sattr, SPAWN_STACKSIZE);
+
+  spawn_resetstats();
+  osbench_start(&start);
+  for (i = 0; i < CONFIG_EXAMPLES_OSBENCH_SPAWN_NITER; i++)
+    {
+      if (task_spawn(&pid, "child", spawn_child, NULL, &sattr,
+                     NULL, NULL) != 0)
+        {
+          printf("osbench_spawn: ERROR task_spawn failed\n");
+          return;
+        }
+    }
+
+  printf("  task_spawn:             %6lu nsec\n",
+         osbench_nsec(&start, CONFIG_EXAMPLES_OSBENCH_SPAWN_NITER));
+  spawn_showstats();
+}
@@ -0,0 +1,207 @@
+/****************************************************************************
+ * apps/examples/osbench/osbench_wakeup.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <time.h>
+
+#include "osbench.h"
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* The benchmark task runs at WAKEUP_MAIN.  The load tasks are ready-to-run
+ * at a lower priority so that they never run.  The waiter task normally
+ * has an even lower priority, so each time that it is woken up it must be
+ * inserted into the ready-to-run list behind all of the load tasks.
+ */
+
+#define WAKEUP_LOW      (SCHED_PRIORITY_DEFAULT - 10)
+#define WAKEUP_LOAD     SCHED_PRIORITY_DEFAULT
+#define WAKEUP_MAIN     (SCHED_PRIORITY_DEFAULT + 10)
+#define WAKEUP_HIGH     (SCHED_PRIORITY_DEFAULT + 11)
+
+#define WAKEUP_STACKSIZE 2048
+#define WAKEUP_MAXLOAD   100
+#define WAKEUP_NPASSES   5
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const int g_nload[WAKEUP_NPASSES] = { 0, 10, 20, 50, WAKEUP_MAXLOAD };
+static pid_t g_loadpid[WAKEUP_MAXLOAD];
+static sem_t g_wakesem;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int wakeup_load(int argc, char *argv[])
+{
+  /* The load tasks are deleted before they ever get to run */
+
+  return 0;
+}
+
+static int wakeup_waiter(int argc, char *argv[])
+{
+  for (;;)
+    {
+      sem_wait(&g_wakesem);
+    }
+
+  return 0;
+}
+
+static void wakeup_setprio(pid_t pid, int priority)
+{
+  struct sched_param param;
+
+  param.sched_priority = priority;
+  sched_setparam(pid, &param);
+}
+
+/* Wake up the waiter, then briefly raise its priority so that it runs and
+ * waits on the semaphore again.
+ */
+
+static inline void wakeup_cycle(pid_t waiter)
+{
+  sem_post(&g_wakesem);
+  wakeup_setprio(waiter, WAKEUP_HIGH);
+  wakeup_setprio(waiter, WAKEUP_LOW);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: osbench_wakeup
+ *
+ * Description:
+ *   Time waking up a task with sem_post() while a growing number of tasks
+ *   of higher priority are ready-to-run.  Each iteration also includes two
+ *   priority changes and two context switches; that overhead is constant.
+ *   Without CONFIG_SCHED_RTRBITMAP, the cost of the wakeup grows with the
+ *   number of ready-to-run tasks.
+ *
+ ****************************************************************************/
+
+void osbench_wakeup(void)
+{
+  struct sched_param saved;
+  struct timespec start;
+  pid_t waiter;
+  int nloaded;
+  int pass;
+  int i;
+
+  printf("osbench_wakeup: sem_post() wakeup cycle, %d iterations\n",
+         CONFIG_EXAMPLES_OSBENCH_WAKEUP_NITER);
+
+  sched_getparam(0, &saved);
+  wakeup_setprio(0, WAKEUP_MAIN);
+  sem_init(&g_wakesem, 0, 0);
+
+  waiter = TASK_CREATE("wakeup", WAKEUP_LOW, WAKEUP_STACKSIZE,
+                       wakeup_waiter, NULL);
+  if (waiter < 0)
+    {
+      printf("osbench_wakeup: ERROR task_create failed\n");
+      goto errout;
+    }
+
+  /* Let the waiter run until it waits on the semaphore */
+
+  wakeup_setprio(waiter, WAKEUP_HIGH);
+  wakeup_setprio(waiter, WAKEUP_LOW);
+
+  nloaded = 0;
+  for (pass = 0; pass < WAKEUP_NPASSES; pass++)
+    {
+      /* Create the ready-to-run load tasks.  The number of tasks is
+       * limited by CONFIG_MAX_TASKS.
+       */
+
+      for (; nloaded < g_nload[pass]; nloaded++)
+        {
+          g_loadpid[nloaded] = TASK_CREATE("load", WAKEUP_LOAD,
+                                           WAKEUP_STACKSIZE, wakeup_load,
+                                           NULL);
+          if (g_loadpid[nloaded] < 0)
+            {
+              break;
+            }
+        }
+
+      if (nloaded < g_nload[pass])
+        {
+          printf("  %3d ready: Skipped, only %d tasks could be created\n",
+                 g_nload[pass], nloaded);
+          break;
+        }
+
+      osbench_start(&start);
+      for (i = 0; i < CONFIG_EXAMPLES_OSBENCH_WAKEUP_NITER; i++)
+        {
+          wakeup_cycle(waiter);
+        }
+
+      printf("  %3d ready: %6lu nsec\n", g_nload[pass],
+             osbench_nsec(&start, CONFIG_EXAMPLES_OSBENCH_WAKEUP_NITER));
+    }
+
+  for (i = 0; i < nloaded; i++)
+    {
+      task_delete(g_loadpid[i]);
+    }
+
+  task_delete(waiter);
+
+errout:
+  sem_destroy(&g_wakesem);
+  sched_setparam(0, &saved);
+}
@@ -0,0 +1,167 @@
+/****************************************************************************
+ * apps/examples/osbench/osbench_wdog.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <wdog.h>
+
+#include "osbench.h"
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* The background watchdogs expire 1 to WDOG_MAXDELAY ticks in the future */
+
+#define WDOG_MAXDELAY   10000
+#define WDOG_MAXACTIVE  1000
+#define WDOG_NPASSES    3
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const int g_nactive[WDOG_NPASSES] = { 10, 100, WDOG_MAXACTIVE };
+static WDOG_ID g_wdogs[WDOG_MAXACTIVE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void wdog_expired(int argc, uint32_t arg)
+{
+}
+
+static int wdog_delay(void)
+{
+  return 1 + rand() % WDOG_MAXDELAY;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: osbench_wdog
+ *
+ * Description:
+ *   Time wd_start() followed by wd_cancel() of one watchdog while many
+ *   other watchdogs are active.  With the watchdog list, the cost grows
+ *   with the number of active watchdogs; with CONFIG_WDOG_WHEEL, it
+ *   should not.
+ *
+ ****************************************************************************/
+
+void osbench_wdog(void)
+{
+  struct timespec start;
+  WDOG_ID wdog;
+  int ncreated;
+  int pass;
+  int i;
+
+  printf("osbench_wdog: wd_start() + wd_cancel(), %d iterations\n",
+         CONFIG_EXAMPLES_OSBENCH_WDOG_NITER);
+
+  wdog = wd_create();
+  if (!wdog)
+    {
+      printf("osbench_wdog: ERROR wd_create failed\n");
+      return;
+    }
+
+  srand(1);
+  ncreated = 0;
+
+  for (pass = 0; pass < WDOG_NPASSES; pass++)
+    {
+      /* Create the background watchdogs.  The number of watchdogs is
+       * limited by CONFIG_PREALLOC_WDOGS.
+       */
+
+      for (; ncreated < g_nactive[pass]; ncreated++)
+        {
+          g_wdogs[ncreated] = wd_create();
+          if (!g_wdogs[ncreated])
+            {
+              break;
+            }
+        }
+
+      if (ncreated < g_nactive[pass])
+        {
+          printf("  %4d active: Skipped, only %d watchdogs available\n",
+                 g_nactive[pass], ncreated + 1);
+          break;
+        }
+
+      for (i = 0; i < ncreated; i++)
+        {
+          wd_start(g_wdogs[i], wdog_delay(), (wdentry_t)wdog_expired, 1, i);
+        }
+
+      /* Now time starting and cancelling one more */
+
+      osbench_start(&start);
+      for (i = 0; i < CONFIG_EXAMPLES_OSBENCH_WDOG_NITER; i++)
+        {
+          wd_start(wdog, wdog_delay(), (wdentry_t)wdog_expired, 1, i);
+          wd_cancel(wdog);
+        }
+
+      printf("  %4d active: %6lu nsec\n", g_nactive[pass],
+             osbench_nsec(&start, CONFIG_EXAMPLES_OSBENCH_WDOG_NITER));
+
+      for (i = 0; i < ncreated; i++)
+        {
+          wd_cancel(g_wdogs[i]);
+        }
+    }
+
+  for (i = 0; i < ncreated; i++)
+    {
+      wd_delete(g_wdogs[i]);
+    }
+
+  wd_delete(wdog);
+}
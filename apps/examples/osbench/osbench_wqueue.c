@@ -0,0 +1,175 @@
+/****************************************************************************
+ * apps/examples/osbench/osbench_wqueue.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdio.h>
+#include <unistd.h>
+#include <semaphore.h>
+#include <time.h>
+
+#include <nuttx/wqueue.h>
+
+#include "osbench.h"
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* The slow work item sleeps for this long (in milliseconds) */
+
+#define WQUEUE_SLOWMSEC 100
+
+/* The number of times that a quick work item is queued behind a slow one */
+
+#define WQUEUE_NSLOW    5
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct work_s g_quickwork;
+static struct work_s g_slowwork;
+static sem_t g_quicksem;
+static sem_t g_slowsem;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void wqueue_quick(FAR void *arg)
+{
+  sem_post(&g_quicksem);
+}
+
+static void wqueue_slow(FAR void *arg)
+{
+  usleep(WQUEUE_SLOWMSEC * 1000);
+  sem_post(&g_slowsem);
+}
+
+static unsigned long wqueue_usec(FAR const struct timespec *start)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_REALTIME, &now);
+  return (unsigned long)(now.tv_sec - start->tv_sec) * 1000000 +
+         (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: osbench_wqueue
+ *
+ * Description:
+ *   Time queuing a work item on the low priority work queue until it has
+ *   been performed, then time the same when the work is queued behind a
+ *   work item that takes WQUEUE_SLOWMSEC milliseconds.  Compare the
+ *   results with different values of CONFIG_SCHED_LPNTHREADS.  With a
+ *   single worker thread, the quick work must wait for the slow work.
+ *
+ ****************************************************************************/
+
+void osbench_wqueue(void)
+{
+  struct timespec start;
+  unsigned long usec;
+  int i;
+
+  printf("osbench_wqueue: Queue/perform cycle, %d iterations\n",
+         CONFIG_EXAMPLES_OSBENCH_WQUEUE_NITER);
+
+  sem_init(&g_quicksem, 0, 0);
+  sem_init(&g_slowsem, 0, 0);
+#ifdef CONFIG_SCHED_WORKSTATS
+  (void)work_getstats(LPWORK, NULL, true);
+#endif
+
+  osbench_start(&start);
+  for (i = 0; i < CONFIG_EXAMPLES_OSBENCH_WQUEUE_NITER; i++)
+    {
+      work_queue(LPWORK, &g_quickwork, wqueue_quick, NULL, 0);
+      sem_wait(&g_quicksem);
+    }
+
+  printf("  idle queue:             %6lu nsec\n",
+         osbench_nsec(&start, CONFIG_EXAMPLES_OSBENCH_WQUEUE_NITER));
+
+  /* Now queue the quick work right behind the slow work each time */
+
+  usec = 0;
+  for (i = 0; i < WQUEUE_NSLOW; i++)
+    {
+      work_queue(LPWORK, &g_slowwork, wqueue_slow, NULL, 0);
+
+      clock_gettime(CLOCK_REALTIME, &start);
+      work_queue(LPWORK, &g_quickwork, wqueue_quick, NULL, 0);
+      sem_wait(&g_quicksem);
+      usec += wqueue_usec(&start);
+
+      sem_wait(&g_slowsem);
+    }
+
+  printf("  behind %3d msec work:   %6lu usec\n",
+         WQUEUE_SLOWMSEC, usec / WQUEUE_NSLOW);
+
+#ifdef CONFIG_SCHED_WORKSTATS
+  {
+    struct work_stats_s stats;
+
+    (void)work_getstats(LPWORK, &stats, false);
+    if (stats.count > 0)
+      {
+        printf("  %lu work items, latency avg/max %lu/%lu ticks, "
+               "execution avg/max %lu/%lu ticks\n",
+               (unsigned long)stats.count,
+               (unsigned long)(stats.totlatency / stats.count),
+               (unsigned long)stats.maxlatency,
+               (unsigned long)(stats.totexec / stats.count),
+               (unsigned long)stats.maxexec);
+      }
+  }
+#endif
+
+  sem_destroy(&g_slowsem);
+  sem_destroy(&g_quicksem);
+}
@@ -0,0 +1,731 @@
+/****************************************************************************
+ * examples/ostest/latency.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <time.h>
+#include <wdog.h>
+#include <errno.h>
+
+#include <nuttx/wqueue.h>
+
+#include "ostest.h"
+
+#ifdef CONFIG_EXAMPLES_OSTEST_LATENCY
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_OSTEST_LATENCY_NSAMPLES
+#  define CONFIG_EXAMPLES_OSTEST_LATENCY_NSAMPLES 1000
+#endif
+
+#define NSAMPLES    CONFIG_EXAMPLES_OSTEST_LATENCY_NSAMPLES
+
+/* The thread on the receiving side of each measurement runs this much
+ * above the priority of the caller.  The caller temporarily raises itself
+ * LAT_SETUP_PRIO above its own priority while it creates the threads so
+ * that none of them runs before all of them exist.
+ */
+
+#define LAT_HIGH_PRIO  10
+#define LAT_SETUP_PRIO 20
+
+#define LAT_STACKSIZE  2048
+
+/* Message queue test */
+
+#define LAT_MQ_REQUEST "lat_request"
+#define LAT_MQ_REPLY   "lat_reply"
+#define LAT_MQ_STOP    0xffffffff
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Samples of the current test in nanoseconds */
+
+static uint32_t g_samples[NSAMPLES];
+static int g_nsamples;
+
+/* Shared state between the two sides of a measurement */
+
+static volatile uint32_t g_start;
+static volatile int g_from;
+static volatile bool g_stop;
+static sem_t g_latsem;
+static int g_basepriority;
+
+#if !defined(CONFIG_DISABLE_MQUEUE)
+static mqd_t g_reqmq;
+static mqd_t g_replymq;
+#endif
+
+#if defined(CONFIG_SCHED_WORKQUEUE) && !defined(CONFIG_NUTTX_KERNEL)
+static struct work_s g_latwork;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lat_now
+ *
+ * Description:
+ *   Return the current time in nanoseconds, modulo 2**32.  Differences of
+ *   two such values are valid for intervals of up to about four seconds.
+ *   The useful resolution is that of CLOCK_REALTIME:  One system tick with
+ *   a periodic timer, one microsecond or better with CONFIG_SCHED_TICKLESS.
+ *
+ ****************************************************************************/
+
+static inline uint32_t lat_now(void)
+{
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint32_t)ts.tv_sec * 1000000000 + (uint32_t)ts.tv_nsec;
+}
+
+/****************************************************************************
+ * Name: lat_record
+ ****************************************************************************/
+
+static inline void lat_record(uint32_t start)
+{
+  uint32_t elapsed = lat_now() - start;
+
+  if (g_nsamples < NSAMPLES)
+    {
+      g_samples[g_nsamples++] = elapsed;
+    }
+}
+
+/****************************************************************************
+ * Name: lat_compare
+ ****************************************************************************/
+
+static int lat_compare(FAR const void *a, FAR const void *b)
+{
+  uint32_t sa = *(FAR const uint32_t *)a;
+  uint32_t sb = *(FAR const uint32_t *)b;
+
+  return sa < sb ? -1 : sa > sb ? 1 : 0;
+}
+
+/****************************************************************************
+ * Name: lat_report
+ *
+ * Description:
+ *   Sort the samples of the test that just completed and print one
+ *   comma-separated result line:
+ *
+ *     latency,<test>,<samples>,<min>,<avg>,<max>,<p99>
+ *
+ *   All times are in nanoseconds.  The average is computed without 64-bit
+ *   arithmetic as the sum of the per-sample quotients plus the quotient of
+ *   the summed remainders.
+ *
+ ****************************************************************************/
+
+static void lat_report(FAR const char *name)
+{
+  uint32_t avg;
+  uint32_t rem;
+  int n = g_nsamples;
+  int i;
+
+  if (n < 1)
+    {
+      printf("latency,%s,0,0,0,0,0\n", name);
+      return;
+    }
+
+  qsort(g_samples, n, sizeof(uint32_t), lat_compare);
+
+  avg = 0;
+  rem = 0;
+  for (i = 0; i < n; i++)
+    {
+      avg += g_samples[i] / n;
+      rem += g_samples[i] % n;
+    }
+
+  avg += rem / n;
+
+  /* The 99th percentile is the smallest sample that is no smaller than
+   * 99% of all samples.
+   */
+
+  i = (99 * n + 99) / 100 - 1;
+
+  printf("latency,%s,%d,%lu,%lu,%lu,%lu\n", name, n,
+         (unsigned long)g_samples[0], (unsigned long)avg,
+         (unsigned long)g_samples[n-1], (unsigned long)g_samples[i]);
+  FFLUSH();
+}
+
+/****************************************************************************
+ * Name: lat_setprio
+ ****************************************************************************/
+
+static void lat_setprio(int priority)
+{
+  struct sched_param param;
+
+  param.sched_priority = priority;
+  (void)sched_setparam(0, &param);
+}
+
+/****************************************************************************
+ * Name: lat_reset
+ ****************************************************************************/
+
+static void lat_reset(void)
+{
+  g_nsamples = 0;
+  g_start    = 0;
+  g_from     = -1;
+  g_stop     = false;
+  sem_init(&g_latsem, 0, 0);
+}
+
+/****************************************************************************
+ * Name: lat_start
+ *
+ * Description:
+ *   Start a thread running LAT_HIGH_PRIO above the base priority.  Unless
+ *   the caller has raised its own priority, the thread runs immediately
+ *   and has blocked by the time that this returns.
+ *
+ ****************************************************************************/
+
+static int lat_start(FAR pthread_t *thread, pthread_startroutine_t entry,
+                     int id)
+{
+  struct sched_param param;
+  pthread_attr_t attr;
+  int ret;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, LAT_STACKSIZE);
+  param.sched_priority = g_basepriority + LAT_HIGH_PRIO;
+  pthread_attr_setschedparam(&attr, &param);
+  pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+
+  ret = pthread_create(thread, &attr, entry, (pthread_addr_t)((intptr_t)id));
+  if (ret != 0)
+    {
+      printf("latency_test: ERROR: pthread_create failed: %d\n", ret);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: lat_ctxsw
+ *
+ * Description:
+ *   Task context switch:  Two threads of equal priority yield to each other.
+ *   Each sample is the time from sched_yield() in one thread until the other
+ *   thread resumes.
+ *
+ ****************************************************************************/
+
+static FAR void *lat_ctxsw_thread(FAR void *arg)
+{
+  int id = (int)((intptr_t)arg);
+  int i;
+
+  for (i = 0; i <= NSAMPLES / 2; i++)
+    {
+      /* Only count the resumption if the other thread did the yield */
+
+      if (g_from >= 0 && g_from != id)
+        {
+          lat_record(g_start);
+        }
+
+      g_from  = id;
+      g_start = lat_now();
+      sched_yield();
+    }
+
+  return NULL;
+}
+
+static void lat_ctxsw(void)
+{
+  pthread_t thread[2];
+  int i;
+
+  lat_reset();
+
+  /* Create both threads before either of them runs */
+
+  lat_setprio(g_basepriority + LAT_SETUP_PRIO);
+  for (i = 0; i < 2; i++)
+    {
+      if (lat_start(&thread[i], lat_ctxsw_thread, i) != 0)
+        {
+          thread[i] = 0;
+        }
+    }
+
+  lat_setprio(g_basepriority);
+
+  for (i = 0; i < 2; i++)
+    {
+      if (thread[i])
+        {
+          pthread_join(thread[i], NULL);
+        }
+    }
+
+  sem_destroy(&g_latsem);
+  lat_report("ctxsw");
+}
+
+/****************************************************************************
+ * Name: lat_sem
+ *
+ * Description:
+ *   Semaphore ping-pong between priorities:  The caller posts a semaphore
+ *   that a higher priority thread waits on.  Each sample is the time from
+ *   sem_post() until sem_wait() returns in the higher priority thread.
+ *
+ ****************************************************************************/
+
+static FAR void *lat_sem_thread(FAR void *arg)
+{
+  for (;;)
+    {
+      while (sem_wait(&g_latsem) < 0);
+      if (g_stop)
+        {
+          break;
+        }
+
+      lat_record(g_start);
+    }
+
+  return NULL;
+}
+
+static void lat_sem(void)
+{
+  pthread_t thread;
+  int i;
+
+  lat_reset();
+  if (lat_start(&thread, lat_sem_thread, 0) == 0)
+    {
+      for (i = 0; i < NSAMPLES; i++)
+        {
+          g_start = lat_now();
+          sem_post(&g_latsem);
+        }
+
+      g_stop = true;
+      sem_post(&g_latsem);
+      pthread_join(thread, NULL);
+    }
+
+  sem_destroy(&g_latsem);
+  lat_report("sem");
+}
+
+/****************************************************************************
+ * Name: lat_mutex
+ *
+ * Description:
+ *   pthread mutex handoff:  A higher priority thread blocks on a mutex held
+ *   by the caller.  Each sample is the time from pthread_mutex_unlock() in
+ *   the caller until pthread_mutex_lock() returns in the waiting thread.
+ *
+ ****************************************************************************/
+
+static pthread_mutex_t g_latmutex;
+
+static FAR void *lat_mutex_thread(FAR void *arg)
+{
+  for (;;)
+    {
+      while (sem_wait(&g_latsem) < 0);
+      if (g_stop)
+        {
+          break;
+        }
+
+      pthread_mutex_lock(&g_latmutex);
+      lat_record(g_start);
+      pthread_mutex_unlock(&g_latmutex);
+    }
+
+  return NULL;
+}
+
+static void lat_mutex(void)
+{
+  pthread_t thread;
+  int i;
+
+  lat_reset();
+  pthread_mutex_init(&g_latmutex, NULL);
+
+  if (lat_start(&thread, lat_mutex_thread, 0) == 0)
+    {
+      for (i = 0; i < NSAMPLES; i++)
+        {
+          /* Hold the mutex, then let the thread run and block on it */
+
+          pthread_mutex_lock(&g_latmutex);
+          sem_post(&g_latsem);
+
+          g_start = lat_now();
+          pthread_mutex_unlock(&g_latmutex);
+        }
+
+      g_stop = true;
+      sem_post(&g_latsem);
+      pthread_join(thread, NULL);
+    }
+
+  pthread_mutex_destroy(&g_latmutex);
+  sem_destroy(&g_latsem);
+  lat_report("mutex");
+}
+
+/****************************************************************************
+ * Name: lat_mqueue
+ *
+ * Description:
+ *   mq_send()/mq_receive() round trip:  The caller sends a message to a
+ *   higher priority thread which replies on a second queue.  Each sample is
+ *   the time from mq_send() until the caller's mq_receive() returns the
+ *   reply.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_MQUEUE
+static FAR void *lat_mqueue_thread(FAR void *arg)
+{
+  uint32_t msg;
+  int prio;
+
+  for (;;)
+    {
+      if (mq_receive(g_reqmq, (FAR char *)&msg, sizeof(uint32_t), &prio) < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          break;
+        }
+
+      if (msg == LAT_MQ_STOP)
+        {
+          break;
+        }
+
+      mq_send(g_replymq, (FAR const char *)&msg, sizeof(uint32_t), 0);
+    }
+
+  return NULL;
+}
+
+static void lat_mqueue(void)
+{
+  struct mq_attr attr;
+  pthread_t thread;
+  uint32_t msg;
+  int prio;
+  int i;
+
+  lat_reset();
+
+  attr.mq_maxmsg  = 1;
+  attr.mq_msgsize = sizeof(uint32_t);
+  attr.mq_flags   = 0;
+
+  g_reqmq   = mq_open(LAT_MQ_REQUEST, O_RDWR|O_CREAT, 0666, &attr);
+  g_replymq = mq_open(LAT_MQ_REPLY, O_RDWR|O_CREAT, 0666, &attr);
+  if (g_reqmq == (mqd_t)-1 || g_replymq == (mqd_t)-1)
+    {
+      printf("latency_test: ERROR: mq_open failed: %d\n", errno);
+    }
+  else if (lat_start(&thread, lat_mqueue_thread, 0) == 0)
+    {
+      for (i = 0; i < NSAMPLES; i++)
+        {
+          msg     = i;
+          g_start = lat_now();
+          mq_send(g_reqmq, (FAR const char *)&msg, sizeof(uint32_t), 0);
+          if (mq_receive(g_replymq, (FAR char *)&msg, sizeof(uint32_t),
+                         &prio) == sizeof(uint32_t))
+            {
+              lat_record(g_start);
+            }
+        }
+
+      msg = LAT_MQ_STOP;
+      mq_send(g_reqmq, (FAR const char *)&msg, sizeof(uint32_t), 0);
+      pthread_join(thread, NULL);
+    }
+
+  if (g_reqmq != (mqd_t)-1)
+    {
+      mq_close(g_reqmq);
+      mq_unlink(LAT_MQ_REQUEST);
+    }
+
+  if (g_replymq != (mqd_t)-1)
+    {
+      mq_close(g_replymq);
+      mq_unlink(LAT_MQ_REPLY);
+    }
+
+  sem_destroy(&g_latsem);
+  lat_report("mqueue");
+}
+#endif
+
+/****************************************************************************
+ * Name: lat_signal
+ *
+ * Description:
+ *   Signal delivery:  The caller signals a higher priority thread that is
+ *   blocked on a semaphore.  Each sample is the time from pthread_kill()
+ *   until the signal handler runs in the receiving thread.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_SIGNALS
+static void lat_sighandler(int signo)
+{
+  lat_record(g_start);
+}
+
+static FAR void *lat_signal_thread(FAR void *arg)
+{
+  struct sigaction act;
+
+  memset(&act, 0, sizeof(struct sigaction));
+  act.sa_handler = lat_sighandler;
+  sigemptyset(&act.sa_mask);
+  (void)sigaction(SIGUSR1, &act, NULL);
+
+  /* The semaphore wait is interrupted by every signal and re-entered until
+   * the caller stops the test.
+   */
+
+  while (!g_stop)
+    {
+      (void)sem_wait(&g_latsem);
+    }
+
+  return NULL;
+}
+
+static void lat_signal(void)
+{
+  pthread_t thread;
+  int i;
+
+  lat_reset();
+  if (lat_start(&thread, lat_signal_thread, 0) == 0)
+    {
+      for (i = 0; i < NSAMPLES; i++)
+        {
+          g_start = lat_now();
+          pthread_kill(thread, SIGUSR1);
+        }
+
+      g_stop = true;
+      sem_post(&g_latsem);
+      pthread_join(thread, NULL);
+    }
+
+  sem_destroy(&g_latsem);
+  lat_report("signal");
+}
+#endif
+
+/****************************************************************************
+ * Name: lat_wdog
+ *
+ * Description:
+ *   wd_start() to callback:  Each sample is the time from starting a one
+ *   tick watchdog until the watchdog function runs.  This includes the
+ *   remainder of the current tick, so with a periodic timer the samples
+ *   are spread over one tick period.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_NUTTX_KERNEL
+static void lat_wdentry(int argc, uint32_t arg1, ...)
+{
+  lat_record(g_start);
+  sem_post(&g_latsem);
+}
+
+static void lat_wdog(void)
+{
+  WDOG_ID wdog;
+  int i;
+
+  lat_reset();
+  wdog = wd_create();
+  if (wdog == NULL)
+    {
+      printf("latency_test: ERROR: wd_create failed\n");
+    }
+  else
+    {
+      for (i = 0; i < NSAMPLES; i++)
+        {
+          g_start = lat_now();
+          wd_start(wdog, 1, lat_wdentry, 1, 0);
+          while (sem_wait(&g_latsem) < 0);
+        }
+
+      wd_delete(wdog);
+    }
+
+  sem_destroy(&g_latsem);
+  lat_report("wdog");
+}
+#endif
+
+/****************************************************************************
+ * Name: lat_work
+ *
+ * Description:
+ *   work_queue() dispatch:  Each sample is the time from queuing work with
+ *   no delay on the high priority work queue until the worker runs.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_SCHED_WORKQUEUE) && !defined(CONFIG_NUTTX_KERNEL)
+static void lat_worker(FAR void *arg)
+{
+  lat_record(g_start);
+  sem_post(&g_latsem);
+}
+
+static void lat_work(void)
+{
+  int i;
+
+  lat_reset();
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      g_start = lat_now();
+      work_queue(HPWORK, &g_latwork, lat_worker, NULL, 0);
+      while (sem_wait(&g_latsem) < 0);
+    }
+
+  sem_destroy(&g_latsem);
+  lat_report("work");
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: latency_test
+ *
+ * Description:
+ *   Measure the latency of a set of basic OS operations and print the
+ *   minimum, average, maximum and 99th percentile of each, one line per
+ *   operation, in a format that is easily extracted from the console log
+ *   (grep '^latency,').
+ *
+ ****************************************************************************/
+
+void latency_test(void)
+{
+  struct sched_param param;
+  struct timespec res;
+
+  (void)sched_getparam(0, &param);
+  g_basepriority = param.sched_priority;
+
+  (void)clock_getres(CLOCK_REALTIME, &res);
+  printf("latency_test: %d samples per test, clock resolution %ld nsec\n",
+         NSAMPLES, (long)res.tv_nsec);
+  printf("latency,test,samples,min_ns,avg_ns,max_ns,p99_ns\n");
+
+  lat_ctxsw();
+  lat_sem();
+  lat_mutex();
+#ifndef CONFIG_DISABLE_MQUEUE
+  lat_mqueue();
+#endif
+#ifndef CONFIG_DISABLE_SIGNALS
+  lat_signal();
+#endif
+#ifndef CONFIG_NUTTX_KERNEL
+  lat_wdog();
+#endif
+#if defined(CONFIG_SCHED_WORKQUEUE) && !defined(CONFIG_NUTTX_KERNEL)
+  lat_work();
+#endif
+}
+
+#endif /* CONFIG_EXAMPLES_OSTEST_LATENCY */
@@ -0,0 +1,371 @@
+/****************************************************************************
+ * examples/ostest/loanmqueue.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <mqueue.h>
+#include <errno.h>
+
+#include "ostest.h"
+
+#ifdef CONFIG_MQ_ZEROCOPY
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TEST_NBUFFERS   4
+#define TEST_MSGSIZE    32
+#define TEST_PRIO       7
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+static mqd_t g_loan_mqfd;
+static volatile bool g_loaned;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Fill in and send one loaned buffer */
+
+static int send_loan(FAR char *buf, int ndx)
+{
+  int len = snprintf(buf, TEST_MSGSIZE, "loaned message %d", ndx) + 1;
+  return mq_sendloan(g_loan_mqfd, buf, len, TEST_PRIO);
+}
+
+/* Receive one loaned buffer and verify its contents */
+
+static int check_loan(int ndx)
+{
+  char expected[TEST_MSGSIZE];
+  FAR void *buf;
+  ssize_t nbytes;
+  int prio;
+  int len;
+
+  len    = snprintf(expected, TEST_MSGSIZE, "loaned message %d", ndx) + 1;
+  nbytes = mq_receiveloan(g_loan_mqfd, &buf, &prio);
+  if (nbytes < 0)
+    {
+      printf("loanmqueue_test: ERROR mq_receiveloan failed, errno=%d\n",
+             errno);
+      return 1;
+    }
+
+  if (nbytes != len || prio != TEST_PRIO || memcmp(buf, expected, len) != 0)
+    {
+      printf("loanmqueue_test: ERROR received \"%.*s\" (%d bytes, prio %d)\n",
+             (int)nbytes, (FAR char *)buf, (int)nbytes, prio);
+      printf("loanmqueue_test:       expected \"%s\" (%d bytes, prio %d)\n",
+             expected, len, TEST_PRIO);
+      (void)mq_return(g_loan_mqfd, buf);
+      return 1;
+    }
+
+  if (mq_return(g_loan_mqfd, buf) < 0)
+    {
+      printf("loanmqueue_test: ERROR mq_return failed, errno=%d\n", errno);
+      return 1;
+    }
+
+  return 0;
+}
+
+/* Borrow a buffer while the pool is exhausted.  mq_loan() blocks until the
+ * main thread returns one.
+ */
+
+static FAR void *loan_thread(FAR void *arg)
+{
+  FAR char *buf = (FAR char *)mq_loan(g_loan_mqfd);
+
+  g_loaned = true;
+  if (!buf)
+    {
+      printf("loan_thread: ERROR mq_loan failed, errno=%d\n", errno);
+      return (FAR void *)1;
+    }
+
+  if (send_loan(buf, TEST_NBUFFERS) < 0)
+    {
+      printf("loan_thread: ERROR mq_sendloan failed, errno=%d\n", errno);
+      return (FAR void *)1;
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+void loanmqueue_test(void)
+{
+  FAR char *bufs[TEST_NBUFFERS];
+  char foreign[TEST_MSGSIZE];
+  struct mq_attr attr;
+  pthread_attr_t pattr;
+  pthread_t loaner;
+  FAR void *result;
+  FAR void *buf;
+  mqd_t nbmqfd;
+  mqd_t othermqfd;
+  int nerrors = 0;
+  int status;
+  int i;
+
+  attr.mq_maxmsg  = TEST_NBUFFERS;
+  attr.mq_msgsize = TEST_MSGSIZE;
+  attr.mq_flags   = MQ_ZEROCOPY;
+
+  g_loan_mqfd = mq_open("loanmq", O_RDWR|O_CREAT, 0666, &attr);
+  othermqfd   = mq_open("loanmq2", O_RDWR|O_CREAT, 0666, &attr);
+  nbmqfd      = mq_open("loanmq", O_RDWR|O_NONBLOCK);
+  if (g_loan_mqfd == (mqd_t)-1 || othermqfd == (mqd_t)-1 ||
+      nbmqfd == (mqd_t)-1)
+    {
+      printf("loanmqueue_test: ERROR mq_open failed, errno=%d\n", errno);
+      return;
+    }
+
+  /* A message sent from a loaned buffer arrives intact */
+
+  printf("loanmqueue_test: Sending and receiving loaned buffers\n");
+  for (i = 0; i < 2 * TEST_NBUFFERS; i++)
+    {
+      bufs[0] = (FAR char *)mq_loan(g_loan_mqfd);
+      if (!bufs[0])
+        {
+          printf("loanmqueue_test: ERROR mq_loan failed, errno=%d\n", errno);
+          nerrors++;
+          break;
+        }
+
+      if (send_loan(bufs[0], i) < 0)
+        {
+          printf("loanmqueue_test: ERROR mq_sendloan failed, errno=%d\n",
+                 errno);
+          nerrors++;
+          break;
+        }
+
+      nerrors += check_loan(i);
+    }
+
+  /* Loaned buffers count against mq_maxmsg:  Once all of them are out,
+   * neither mq_loan() nor mq_send() can get one.
+   */
+
+  printf("loanmqueue_test: Exhausting the pool\n");
+  memset(bufs, 0, sizeof(bufs));
+  for (i = 0; i < TEST_NBUFFERS; i++)
+    {
+      bufs[i] = (FAR char *)mq_loan(g_loan_mqfd);
+      if (!bufs[i])
+        {
+          printf("loanmqueue_test: ERROR mq_loan %d failed, errno=%d\n",
+                 i, errno);
+          nerrors++;
+          goto errout_with_bufs;
+        }
+    }
+
+  buf = mq_loan(nbmqfd);
+  if (buf || errno != EAGAIN)
+    {
+      printf("loanmqueue_test: ERROR mq_loan of an empty pool: %p errno=%d\n",
+             buf, errno);
+      nerrors++;
+      if (buf)
+        {
+          (void)mq_return(g_loan_mqfd, buf);
+        }
+    }
+
+  strcpy(foreign, "copied");
+  if (mq_send(nbmqfd, foreign, 7, TEST_PRIO) == 0 || errno != EAGAIN)
+    {
+      printf("loanmqueue_test: ERROR mq_send to an empty pool: errno=%d\n",
+             errno);
+      nerrors++;
+    }
+
+  /* Buffers that do not belong to the pool of the queue are refused */
+
+  printf("loanmqueue_test: Passing foreign buffers\n");
+  if (mq_return(g_loan_mqfd, foreign) == 0 || errno != EINVAL)
+    {
+      printf("loanmqueue_test: ERROR mq_return of a stack buffer: errno=%d\n",
+             errno);
+      nerrors++;
+    }
+
+  if (mq_sendloan(g_loan_mqfd, foreign, 7, TEST_PRIO) == 0 ||
+      errno != EINVAL)
+    {
+      printf("loanmqueue_test: ERROR mq_sendloan of a stack buffer: errno=%d\n",
+             errno);
+      nerrors++;
+    }
+
+  buf = mq_loan(othermqfd);
+  if (!buf)
+    {
+      printf("loanmqueue_test: ERROR mq_loan failed, errno=%d\n", errno);
+      nerrors++;
+    }
+  else
+    {
+      if (mq_return(g_loan_mqfd, buf) == 0 || errno != EINVAL)
+        {
+          printf("loanmqueue_test: ERROR mq_return to the wrong queue: "
+                 "errno=%d\n", errno);
+          nerrors++;
+        }
+
+      (void)mq_return(othermqfd, buf);
+    }
+
+  /* mq_loan() blocks while the pool is exhausted and mq_return() wakes it */
+
+  printf("loanmqueue_test: Blocking in mq_loan\n");
+  g_loaned = false;
+
+  status = pthread_attr_init(&pattr);
+  if (status == 0)
+    {
+      status = pthread_attr_setstacksize(&pattr, STACKSIZE);
+    }
+
+  if (status == 0)
+    {
+      status = pthread_create(&loaner, &pattr, loan_thread, NULL);
+    }
+
+  if (status != 0)
+    {
+      printf("loanmqueue_test: ERROR pthread_create failed, status=%d\n",
+             status);
+      nerrors++;
+      goto errout_with_bufs;
+    }
+
+  usleep(100*1000);
+  if (g_loaned)
+    {
+      printf("loanmqueue_test: ERROR mq_loan did not block\n");
+      nerrors++;
+    }
+
+  if (mq_return(g_loan_mqfd, bufs[0]) < 0)
+    {
+      printf("loanmqueue_test: ERROR mq_return failed, errno=%d\n", errno);
+      nerrors++;
+    }
+
+  bufs[0] = NULL;
+
+  /* Give the thread a second to wake up rather than hang if it does not */
+
+  for (i = 0; i < 10 && !g_loaned; i++)
+    {
+      usleep(100*1000);
+    }
+
+  if (!g_loaned)
+    {
+      printf("loanmqueue_test: ERROR mq_return did not wake mq_loan\n");
+      nerrors++;
+      pthread_cancel(loaner);
+      pthread_join(loaner, &result);
+    }
+  else
+    {
+      pthread_join(loaner, &result);
+      if (result != NULL)
+        {
+          nerrors++;
+        }
+      else
+        {
+          nerrors += check_loan(TEST_NBUFFERS);
+        }
+    }
+
+  /* The queue is empty again */
+
+  if (mq_receiveloan(nbmqfd, &buf, NULL) >= 0 || errno != EAGAIN)
+    {
+      printf("loanmqueue_test: ERROR mq_receiveloan of an empty queue: "
+             "errno=%d\n", errno);
+      nerrors++;
+    }
+
+errout_with_bufs:
+  for (i = 0; i < TEST_NBUFFERS; i++)
+    {
+      if (bufs[i] && mq_return(g_loan_mqfd, bufs[i]) < 0)
+        {
+          printf("loanmqueue_test: ERROR mq_return %d failed, errno=%d\n",
+                 i, errno);
+          nerrors++;
+        }
+    }
+
+  mq_close(nbmqfd);
+  mq_close(othermqfd);
+  mq_close(g_loan_mqfd);
+  mq_unlink("loanmq2");
+  mq_unlink("loanmq");
+
+  printf("loanmqueue_test: %s, %d errors\n",
+         nerrors ? "FAILED" : "PASSED", nerrors);
+}
+
+#endif /* CONFIG_MQ_ZEROCOPY */
@@ -145,6 +145,12 @@ void mqueue_test(void);
 
 void timedmqueue_test(void);
 
+/* loanmqueue.c *************************************************************/
+
+#ifdef CONFIG_MQ_ZEROCOPY
+void loanmqueue_test(void);
+#endif
+
 /* cancel.c *****************************************************************/
 
 void cancel_test(void);
@@ -173,6 +179,12 @@ void barrier_test(void);
 
 void priority_inheritance(void);
 
+/* latency.c ****************************************************************/
+
+#ifdef CONFIG_EXAMPLES_OSTEST_LATENCY
+void latency_test(void);
+#endif
+
 /* vfork.c ******************************************************************/
 
 #if defined(CONFIG_ARCH_HAVE_VFORK) && defined(CONFIG_SCHED_WAITPID) && \
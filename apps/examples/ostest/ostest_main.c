@@ -411,6 +411,14 @@ static int user_main(int argc, char *argv[])
       check_test_memory_usage();
 #endif
 
+#if defined(CONFIG_MQ_ZEROCOPY) && !defined(CONFIG_DISABLE_PTHREAD)
+      /* Verify the zero-copy message queue interfaces */
+
+      printf("\nuser_main: loaned message queue test\n");
+      loanmqueue_test();
+      check_test_memory_usage();
+#endif
+
 #ifndef CONFIG_DISABLE_SIGNALS
       /* Verify signal handlers */
 
@@ -457,6 +465,14 @@ static int user_main(int argc, char *argv[])
       vfork_test();
 #endif
 
+#ifdef CONFIG_EXAMPLES_OSTEST_LATENCY
+      /* Measure the latency of basic OS operations */
+
+      printf("\nuser_main: latency test\n");
+      latency_test();
+      check_test_memory_usage();
+#endif
+
       /* Compare memory usage at time ostest_main started until
        * user_main exits.  These should not be identical, but should
        * be similar enough that we can detect any serious OS memory
@@ -514,6 +530,16 @@ int ostest_main(int argc, FAR char *argv[])
 {
   int result;
 
+#ifdef CONFIG_EXAMPLES_OSTEST_LATENCY
+  /* 'ostest -b' runs only the latency benchmark */
+
+  if (argc > 1 && strcmp(argv[1], "-b") == 0)
+    {
+      latency_test();
+      return 0;
+    }
+#endif
+
   /* Verify that stdio works first */
 
   stdio_test();
@@ -591,9 +591,26 @@ void nsh_usbtrace(void);
 #ifndef CONFIG_NSH_DISABLE_FREE
   int cmd_free(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
 #endif
+#if defined(CONFIG_MM_STATS) && !defined(CONFIG_NSH_DISABLE_HEAPINFO)
+  int cmd_heapinfo(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
+#endif
+#if defined(CONFIG_IRQ_STATISTICS) && !defined(CONFIG_DISABLE_SIGNALS) && \
+   !defined(CONFIG_NSH_DISABLE_IRQINFO)
+  int cmd_irqinfo(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
+#endif
+#if defined(CONFIG_SCHED_PROFILE) && !defined(CONFIG_NSH_DISABLE_PROF)
+  int cmd_prof(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
+#endif
 #ifndef CONFIG_NSH_DISABLE_PS
   int cmd_ps(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
 #endif
+#if defined(CONFIG_SCHED_CPUACCT) && !defined(CONFIG_DISABLE_SIGNALS) && \
+   !defined(CONFIG_NSH_DISABLE_TOP)
+  int cmd_top(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
+#endif
+#if defined(CONFIG_SCHED_TRACE) && !defined(CONFIG_NSH_DISABLE_TRACE)
+  int cmd_trace(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
+#endif
 #ifndef CONFIG_NSH_DISABLE_XD
   int cmd_xd(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
 #endif
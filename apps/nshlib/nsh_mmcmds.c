@@ -39,7 +39,19 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined(CONFIG_MM_SLAB) || defined(CONFIG_MM_STATS) || \
+    defined(CONFIG_MM_NAMED_HEAPS)
+#  include <nuttx/mm.h>
+#endif
 
 #include "nsh.h"
 #include "nsh_console.h"
@@ -48,6 +60,31 @@
  * Definitions
  ****************************************************************************/
 
+/* Heap dump file format (see also nuttx/tools/mmdump.py).  Every field is a
+ * 32-bit word in the native byte order of the target:
+ *
+ *   Header:  magic, version, flags, MM_MIN_SHIFT, MM_NNODES, heap size,
+ *            bytes used, peak bytes used, number of chunks, time stamp
+ *   Classes: For each of the MM_NNODES size classes: allocated chunks,
+ *            allocated bytes, free chunks, free bytes
+ *   Chunks:  For each chunk in address order: address, size, chunk flags,
+ *            caller address, requested size
+ */
+
+#define HEAPINFO_MAGIC          0x4e584d4d /* "NXMM" */
+#define HEAPINFO_VERSION        1
+
+#define HEAPINFO_FLAG_CALLERPC  (1 << 0)   /* Caller addresses are valid */
+#define HEAPINFO_FLAG_TRUNCATED (1 << 1)   /* Not all chunks were saved */
+
+#define HEAPINFO_CHUNK_ALLOC    (1 << 0)   /* The chunk is allocated */
+
+/* Extra chunk descriptions to allow for the heap changing between sizing
+ * and taking the snapshot (the snapshot buffer itself splits a chunk).
+ */
+
+#define HEAPINFO_SLACK          8
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -68,6 +105,149 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: heapinfo_write
+ ****************************************************************************/
+
+#if defined(CONFIG_MM_STATS) && !defined(CONFIG_NSH_DISABLE_HEAPINFO) && \
+    CONFIG_NFILE_DESCRIPTORS > 0
+static int heapinfo_write(int fd, FAR const uint32_t *words, int nwords)
+{
+  FAR const uint8_t *ptr = (FAR const uint8_t *)words;
+  size_t remaining = nwords * sizeof(uint32_t);
+  ssize_t nwritten;
+
+  while (remaining > 0)
+    {
+      nwritten = write(fd, ptr, remaining);
+      if (nwritten < 0)
+        {
+          if (errno != EINTR)
+            {
+              return ERROR;
+            }
+        }
+      else
+        {
+          ptr       += nwritten;
+          remaining -= nwritten;
+        }
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: heapinfo_dump
+ *
+ * Description:
+ *   Write the heap statistics and a description of every chunk in the user
+ *   heap to a binary file.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_MM_STATS) && !defined(CONFIG_NSH_DISABLE_HEAPINFO) && \
+    CONFIG_NFILE_DESCRIPTORS > 0
+static int heapinfo_dump(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
+                         FAR const char *path)
+{
+  FAR struct mm_chunkinfo_s *chunks;
+  struct mm_stats_s stats;
+  uint32_t words[10];
+  int nalloc;
+  int nchunks;
+  int fd;
+  int ret;
+  int i;
+
+  /* Size the snapshot buffer.  Nothing may be allocated while the heap is
+   * being walked, so the buffer must be allocated first.
+   */
+
+  nalloc = mm_snapshot(&g_mmheap, NULL, 0) + HEAPINFO_SLACK;
+  chunks = (FAR struct mm_chunkinfo_s *)
+    malloc(nalloc * sizeof(struct mm_chunkinfo_s));
+
+  if (!chunks)
+    {
+      nsh_output(vtbl, g_fmtcmdoutofmemory, cmd);
+      return ERROR;
+    }
+
+  nchunks = mm_snapshot(&g_mmheap, chunks, nalloc);
+  (void)mm_stats(&g_mmheap, &stats);
+
+  fd = open(path, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+  if (fd < 0)
+    {
+      nsh_output(vtbl, g_fmtcmdfailed, cmd, "open", NSH_ERRNO);
+      ret = ERROR;
+      goto errout_with_chunks;
+    }
+
+  /* Write the header */
+
+  words[0] = HEAPINFO_MAGIC;
+  words[1] = HEAPINFO_VERSION;
+  words[2] = 0;
+#ifdef CONFIG_MM_CALLERPC
+  words[2] |= HEAPINFO_FLAG_CALLERPC;
+#endif
+  if (nchunks > nalloc)
+    {
+      words[2] |= HEAPINFO_FLAG_TRUNCATED;
+      nchunks   = nalloc;
+    }
+
+  words[3] = MM_MIN_SHIFT;
+  words[4] = MM_NNODES;
+  words[5] = g_mmheap.mm_heapsize;
+  words[6] = stats.curused;
+  words[7] = stats.maxused;
+  words[8] = nchunks;
+  words[9] = (uint32_t)time(NULL);
+
+  ret = heapinfo_write(fd, words, 10);
+
+  /* Write the size class histograms */
+
+  for (i = 0; i < MM_NNODES && ret == OK; i++)
+    {
+      words[0] = stats.nalloc[i];
+      words[1] = stats.allocbytes[i];
+      words[2] = stats.nfree[i];
+      words[3] = stats.freebytes[i];
+
+      ret = heapinfo_write(fd, words, 4);
+    }
+
+  /* Write the chunk descriptions */
+
+  for (i = 0; i < nchunks && ret == OK; i++)
+    {
+      words[0] = chunks[i].addr;
+      words[1] = chunks[i].size;
+      words[2] = chunks[i].allocated ? HEAPINFO_CHUNK_ALLOC : 0;
+      words[3] = chunks[i].callerpc;
+      words[4] = chunks[i].reqsize;
+
+      ret = heapinfo_write(fd, words, 5);
+    }
+
+  if (ret != OK)
+    {
+      nsh_output(vtbl, g_fmtcmdfailed, cmd, "write", NSH_ERRNO);
+    }
+
+  close(fd);
+
+errout_with_chunks:
+  free(chunks);
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -91,6 +271,132 @@ int cmd_free(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
   nsh_output(vtbl, "Mem:   %11d%11d%11d%11d\n",
              mem.arena, mem.uordblks, mem.fordblks, mem.mxordblk);
 
+#ifdef CONFIG_MM_SLAB
+  /* Show the small object cache statistics for each size class that has
+   * been used.
+   */
+
+  {
+    struct mm_slabinfo_s info;
+    int ndx;
+
+    nsh_output(vtbl, "\n   size   cached       hits     misses      frees   released\n");
+    for (ndx = 0; mm_slabinfo(&g_mmheap, ndx, &info) == OK; ndx++)
+      {
+        if (info.nhits || info.nmisses || info.nfrees)
+          {
+            nsh_output(vtbl, "%7d%9u%11lu%11lu%11lu%11lu\n",
+                       (int)info.chunksize, info.ncached,
+                       (unsigned long)info.nhits,
+                       (unsigned long)info.nmisses,
+                       (unsigned long)info.nfrees,
+                       (unsigned long)info.nreleased);
+          }
+      }
+  }
+#endif
+
+#ifdef CONFIG_MM_NAMED_HEAPS
+  /* Show each named heap with the placement statistics */
+
+  {
+    struct mm_heapinfo_s info;
+    int ndx;
+
+    nsh_output(vtbl, "\nheap       props      total       used    largest     allocs  fallbacks   failures\n");
+    for (ndx = 0; mm_heapinfo(ndx, &info) == OK; ndx++)
+      {
+        nsh_output(vtbl, "%-8s   %c%c%c  %11lu%11lu%11lu%11lu%11lu%11lu\n",
+                   info.name,
+                   (info.flags & MM_HEAP_FAST) ? 'F' : '-',
+                   (info.flags & MM_HEAP_DMA)  ? 'D' : '-',
+                   (info.flags & MM_HEAP_BULK) ? 'B' : '-',
+                   (unsigned long)info.heapsize,
+                   (unsigned long)info.used,
+                   (unsigned long)info.largest,
+                   (unsigned long)info.nalloc,
+                   (unsigned long)info.nfallback,
+                   (unsigned long)info.nfail);
+      }
+  }
+#endif
+
   return OK;
 }
 #endif /* !CONFIG_NSH_DISABLE_FREE */
+
+/****************************************************************************
+ * Name: cmd_heapinfo
+ ****************************************************************************/
+
+#if defined(CONFIG_MM_STATS) && !defined(CONFIG_NSH_DISABLE_HEAPINFO)
+int cmd_heapinfo(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
+{
+  struct mm_stats_s stats;
+#if CONFIG_NFILE_DESCRIPTORS > 0
+  FAR char *dumpfile = NULL;
+  int ret = OK;
+#endif
+  int ndx;
+
+  /* Get the optional dump file:  heapinfo [-d <dump-file>] */
+
+  if (argc > 1)
+    {
+#if CONFIG_NFILE_DESCRIPTORS > 0
+      if (argc != 3 || strcmp(argv[1], "-d") != 0)
+#endif
+        {
+          nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+          return ERROR;
+        }
+
+#if CONFIG_NFILE_DESCRIPTORS > 0
+      dumpfile = nsh_getfullpath(vtbl, argv[2]);
+      if (!dumpfile)
+        {
+          return ERROR;
+        }
+#endif
+    }
+
+  /* Show the usage and the histograms of the allocated and free chunks in
+   * each size class.  A size class is shown only if it is not empty.
+   */
+
+  (void)mm_stats(&g_mmheap, &stats);
+
+  nsh_output(vtbl, "             total       used       peak\n");
+  nsh_output(vtbl, "Heap:  %11lu%11lu%11lu\n",
+             (unsigned long)g_mmheap.mm_heapsize,
+             (unsigned long)stats.curused, (unsigned long)stats.maxused);
+
+  nsh_output(vtbl, "\n     size     allocs      bytes      frees      bytes\n");
+  for (ndx = 0; ndx < MM_NNODES; ndx++)
+    {
+      if (stats.nalloc[ndx] || stats.nfree[ndx])
+        {
+          nsh_output(vtbl, "%9lu%11lu%11lu%11lu%11lu\n",
+                     (unsigned long)MM_MIN_CHUNK << ndx,
+                     (unsigned long)stats.nalloc[ndx],
+                     (unsigned long)stats.allocbytes[ndx],
+                     (unsigned long)stats.nfree[ndx],
+                     (unsigned long)stats.freebytes[ndx]);
+        }
+    }
+
+#if CONFIG_NFILE_DESCRIPTORS > 0
+  /* Write the binary heap dump */
+
+  if (dumpfile)
+    {
+      ret = heapinfo_dump(vtbl, argv[0], dumpfile);
+      nsh_freefullpath(dumpfile);
+    }
+
+  return ret;
+#else
+  return OK;
+#endif
+}
+#endif /* CONFIG_MM_STATS && !CONFIG_NSH_DISABLE_HEAPINFO */
@@ -227,6 +227,14 @@ static const struct cmdmap_s g_cmdmap[] =
 # endif
 #endif
 
+#if defined(CONFIG_MM_STATS) && !defined(CONFIG_NSH_DISABLE_HEAPINFO)
+# if CONFIG_NFILE_DESCRIPTORS > 0
+  { "heapinfo", cmd_heapinfo, 1, 3, "[-d <dump-file>]" },
+# else
+  { "heapinfo", cmd_heapinfo, 1, 1, NULL },
+# endif
+#endif
+
 #ifndef CONFIG_NSH_DISABLE_HELP
 # ifdef CONFIG_NSH_HELP_TERSE
   { "help",     cmd_help,     1, 2, "[<cmd>]" },
@@ -251,6 +259,11 @@ static const struct cmdmap_s g_cmdmap[] =
 # endif
 #endif
 
+#if defined(CONFIG_IRQ_STATISTICS) && !defined(CONFIG_DISABLE_SIGNALS) && \
+   !defined(CONFIG_NSH_DISABLE_IRQINFO)
+  { "irqinfo",  cmd_irqinfo,  1, 3, "[-d <sec>]" },
+#endif
+
 #ifndef CONFIG_DISABLE_SIGNALS
 # ifndef CONFIG_NSH_DISABLE_KILL
   { "kill",     cmd_kill,     3, 3, "-<signal> <pid>" },
@@ -351,6 +364,10 @@ static const struct cmdmap_s g_cmdmap[] =
 # endif
 #endif
 
+#if defined(CONFIG_SCHED_PROFILE) && !defined(CONFIG_NSH_DISABLE_PROF)
+  { "prof",     cmd_prof,     2, 2, "start|stop|clear|dump" },
+#endif
+
 #ifndef CONFIG_NSH_DISABLE_PS
   { "ps",       cmd_ps,       1, 1, NULL },
 #endif
@@ -398,6 +415,15 @@ static const struct cmdmap_s g_cmdmap[] =
   { "test",     cmd_test,     3, CONFIG_NSH_MAXARGUMENTS, "<expression>" },
 #endif
 
+#if defined(CONFIG_SCHED_CPUACCT) && !defined(CONFIG_DISABLE_SIGNALS) && \
+   !defined(CONFIG_NSH_DISABLE_TOP)
+  { "top",      cmd_top,      1, 5, "[-n <count>] [-d <sec>]" },
+#endif
+
+#if defined(CONFIG_SCHED_TRACE) && !defined(CONFIG_NSH_DISABLE_TRACE)
+  { "trace",    cmd_trace,    2, 2, "start|stop|clear|dump" },
+#endif
+
 #if !defined(CONFIG_DISABLE_MOUNTPOINT) && CONFIG_NFILE_DESCRIPTORS > 0 && defined(CONFIG_FS_READABLE)
 # ifndef CONFIG_NSH_DISABLE_UMOUNT
   { "umount",   cmd_umount,   2, 2, "<dir-path>" },
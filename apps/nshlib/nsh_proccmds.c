@@ -42,9 +42,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <string.h>
 #include <sched.h>
 #include <errno.h>
 
+#ifdef CONFIG_SCHED_TRACE
+#  include <nuttx/clock.h>
+#  include <nuttx/sched_trace.h>
+#endif
+
+#ifdef CONFIG_SCHED_PROFILE
+#  include <nuttx/clock.h>
+#  include <nuttx/sched_profile.h>
+#endif
+
+#ifdef CONFIG_SCHED_CPUACCT
+#  include <time.h>
+#endif
+
+#if defined(CONFIG_STACK_COLORATION) && !defined(CONFIG_NSH_DISABLE_PS)
+#  include <nuttx/arch.h>
+#endif
+
+#ifdef CONFIG_IRQ_STATISTICS
+#  include <nuttx/irq.h>
+#endif
+
 #include "nsh.h"
 #include "nsh_console.h"
 
@@ -52,6 +75,44 @@
  * Definitions
  ****************************************************************************/
 
+/* The number of trace events read from the kernel at a time by 'trace dump' */
+
+#define TRACE_NREAD 16
+
+/* The number of samples read from the kernel at a time by 'prof dump' */
+
+#define PROF_NREAD  16
+
+/* The commands that 'trace dump' and 'prof dump' are built into */
+
+#if defined(CONFIG_SCHED_TRACE) && !defined(CONFIG_NSH_DISABLE_TRACE)
+#  define HAVE_TRACE 1
+#endif
+
+#if defined(CONFIG_SCHED_PROFILE) && !defined(CONFIG_NSH_DISABLE_PROF)
+#  define HAVE_PROF 1
+#endif
+
+/* The commands that 'top' is built into */
+
+#if defined(CONFIG_SCHED_CPUACCT) && !defined(CONFIG_DISABLE_SIGNALS) && \
+   !defined(CONFIG_NSH_DISABLE_TOP)
+#  define HAVE_TOP 1
+#endif
+
+/* 'top' keeps one slot per PID hash table entry of the OS, so that no two
+ * tasks that exist at the same time can ever share a slot.
+ */
+
+#define TOP_SLOT(pid) ((pid) & (CONFIG_MAX_TASKS-1))
+
+/* The commands that 'irqinfo' is built into */
+
+#if defined(CONFIG_IRQ_STATISTICS) && !defined(CONFIG_DISABLE_SIGNALS) && \
+   !defined(CONFIG_NSH_DISABLE_IRQINFO)
+#  define HAVE_IRQINFO 1
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -62,6 +123,29 @@
 
 typedef int (*exec_t)(void);
 
+/* The CPU usage of one task as seen by 'top' */
+
+#ifdef HAVE_TOP
+struct top_task_s
+{
+  pid_t    pid;                  /* The task ID (the slot is empty if < 0) */
+  uint8_t  prio;                 /* The priority of the task */
+  bool     seen;                 /* The task still existed at the last sample */
+  uint32_t cpusec;               /* Total CPU time: Seconds */
+  uint32_t cpuusec;              /* Total CPU time (usec, modulo 2**32) */
+  uint32_t delta;                /* CPU time used in the last interval (usec) */
+#if CONFIG_TASK_NAME_SIZE > 0
+  char     name[CONFIG_TASK_NAME_SIZE];
+#endif
+};
+
+struct top_s
+{
+  uint32_t irqusec;              /* Total interrupt time (usec, modulo 2**32) */
+  struct top_task_s task[CONFIG_MAX_TASKS];
+};
+#endif
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -127,6 +211,13 @@ static void ps_task(FAR struct tcb_s *tcb, FAR void *arg)
              tcb->flags & TCB_FLAG_CANCEL_PENDING ? 'P' : ' ',
              g_statenames[tcb->task_state]);
 
+#ifdef CONFIG_STACK_COLORATION
+  /* Show the stack size and the most of it that has ever been used */
+
+  nsh_output(vtbl, "%6lu %6lu ", (unsigned long)tcb->adj_stack_size,
+             (unsigned long)up_check_tcbstack(tcb));
+#endif
+
   /* Show task name and arguments */
 
 #if CONFIG_TASK_NAME_SIZE > 0
@@ -169,6 +260,198 @@ static void ps_task(FAR struct tcb_s *tcb, FAR void *arg)
 }
 #endif
 
+/****************************************************************************
+ * Name: trace_task
+ ****************************************************************************/
+
+#if defined(HAVE_TRACE) || defined(HAVE_PROF)
+static void trace_task(FAR struct tcb_s *tcb, FAR void *arg)
+{
+  struct nsh_vtbl_s *vtbl = (struct nsh_vtbl_s*)arg;
+
+  /* Name the tasks that appear in the trace events or profile samples */
+
+#if CONFIG_TASK_NAME_SIZE > 0
+  nsh_output(vtbl, "T %d %d %s\n", tcb->pid, tcb->sched_priority, tcb->name);
+#else
+  nsh_output(vtbl, "T %d %d <noname>\n", tcb->pid, tcb->sched_priority);
+#endif
+}
+#endif
+
+/****************************************************************************
+ * Name: top_usec
+ ****************************************************************************/
+
+#ifdef HAVE_TOP
+static inline uint32_t top_usec(FAR const struct timespec *ts)
+{
+  return (uint32_t)ts->tv_sec * 1000000 + ts->tv_nsec / 1000;
+}
+#endif
+
+/****************************************************************************
+ * Name: top_sample
+ ****************************************************************************/
+
+#ifdef HAVE_TOP
+static void top_sample(FAR struct tcb_s *tcb, FAR void *arg)
+{
+  FAR struct top_s *top = (FAR struct top_s *)arg;
+  FAR struct top_task_s *task = &top->task[TOP_SLOT(tcb->pid)];
+  struct timespec ts;
+  uint32_t usec;
+
+  /* Get the CPU time of the task.  A task that was not there at the
+   * previous sample has used all of its CPU time during the interval.
+   */
+
+  sched_cputime(tcb, &ts);
+  usec = top_usec(&ts);
+
+  if (task->pid != tcb->pid)
+    {
+      task->pid     = tcb->pid;
+      task->cpuusec = 0;
+    }
+
+  task->prio    = tcb->sched_priority;
+  task->seen    = true;
+  task->delta   = usec - task->cpuusec;
+  task->cpusec  = ts.tv_sec;
+  task->cpuusec = usec;
+#if CONFIG_TASK_NAME_SIZE > 0
+  strncpy(task->name, tcb->name, CONFIG_TASK_NAME_SIZE);
+  task->name[CONFIG_TASK_NAME_SIZE-1] = '\0';
+#endif
+}
+#endif
+
+/****************************************************************************
+ * Name: top_update
+ *
+ * Description:
+ *   Take a new sample of the CPU time of every task and return the total
+ *   CPU time (busy, idle and interrupt) since the previous sample.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_TOP
+static uint32_t top_update(FAR struct top_s *top, FAR uint32_t *irqdelta)
+{
+  struct timespec ts;
+  uint32_t total;
+  uint32_t usec;
+  int i;
+
+  for (i = 0; i < CONFIG_MAX_TASKS; i++)
+    {
+      top->task[i].seen = false;
+    }
+
+  sched_foreach(top_sample, top);
+  sched_cputime(NULL, &ts);
+
+  usec         = top_usec(&ts);
+  *irqdelta    = usec - top->irqusec;
+  top->irqusec = usec;
+
+  /* Forget the tasks that have exited */
+
+  total = *irqdelta;
+  for (i = 0; i < CONFIG_MAX_TASKS; i++)
+    {
+      if (top->task[i].seen)
+        {
+          total += top->task[i].delta;
+        }
+      else
+        {
+          top->task[i].pid = -1;
+        }
+    }
+
+  return total;
+}
+#endif
+
+/****************************************************************************
+ * Name: top_permille
+ ****************************************************************************/
+
+#ifdef HAVE_TOP
+static unsigned int top_permille(uint32_t part, uint32_t total)
+{
+  /* Scale the total rather than the part so that nothing overflows */
+
+  total = (total + 999) / 1000;
+  return total > 0 ? (part + total / 2) / total : 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: top_show
+ ****************************************************************************/
+
+#ifdef HAVE_TOP
+static void top_show(FAR struct nsh_vtbl_s *vtbl, FAR struct top_s *top,
+                     uint32_t total, uint32_t irqdelta)
+{
+  FAR struct top_task_s *task;
+  uint8_t order[CONFIG_MAX_TASKS];
+  unsigned int permille;
+  unsigned int idle;
+  int ntasks;
+  int i;
+  int j;
+
+  /* Sort the tasks by the CPU time used in the interval, largest first */
+
+  ntasks = 0;
+  for (i = 0; i < CONFIG_MAX_TASKS; i++)
+    {
+      if (top->task[i].pid >= 0)
+        {
+          for (j = ntasks;
+               j > 0 && top->task[order[j-1]].delta < top->task[i].delta;
+               j--)
+            {
+              order[j] = order[j-1];
+            }
+
+          order[j] = i;
+          ntasks++;
+        }
+    }
+
+  /* The IDLE task is PID 0 */
+
+  idle     = top_permille(top->task[0].delta, total);
+  permille = top_permille(irqdelta, total);
+
+  nsh_output(vtbl, "CPU: %3u.%u%% busy %3u.%u%% irq (%lu msec)\n",
+             (1000 - idle) / 10, (1000 - idle) % 10,
+             permille / 10, permille % 10, (unsigned long)(total / 1000));
+  nsh_output(vtbl, "  PID PRI   CPU%%      TIME NAME\n");
+
+  for (i = 0; i < ntasks; i++)
+    {
+      task     = &top->task[order[i]];
+      permille = top_permille(task->delta, total);
+
+      nsh_output(vtbl, "%5d %3d %3u.%u%% %6lu.%02lu ",
+                 task->pid, task->prio, permille / 10, permille % 10,
+                 (unsigned long)task->cpusec,
+                 (unsigned long)(task->cpuusec % 1000000) / 10000);
+#if CONFIG_TASK_NAME_SIZE > 0
+      nsh_output(vtbl, "%s\n", task->name);
+#else
+      nsh_output(vtbl, "<noname>\n");
+#endif
+    }
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -195,6 +478,68 @@ int cmd_exec(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 }
 #endif
 
+/****************************************************************************
+ * Name: cmd_prof
+ ****************************************************************************/
+
+#ifdef HAVE_PROF
+int cmd_prof(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
+{
+  struct sched_profile_s samples[PROF_NREAD];
+  bool enabled;
+  size_t nread;
+  size_t i;
+
+  if (strcmp(argv[1], "start") == 0)
+    {
+      (void)sched_profile_enable(true);
+    }
+  else if (strcmp(argv[1], "stop") == 0)
+    {
+      (void)sched_profile_enable(false);
+    }
+  else if (strcmp(argv[1], "clear") == 0)
+    {
+      sched_profile_clear();
+    }
+  else if (strcmp(argv[1], "dump") == 0)
+    {
+      /* Don't sample the dump itself.  The dump empties the sample buffer.
+       * The address of sched_profile_sample() lets the host tool relocate
+       * the samples of position-independent (simulation) builds.  The
+       * format is read by nuttx/tools/profdecode.py.
+       */
+
+      enabled = sched_profile_enable(false);
+
+      nsh_output(vtbl, "PROFILE %d %lu %lx\n",
+                 CONFIG_SCHED_PROFILE_INTERVAL * USEC_PER_TICK,
+                 (unsigned long)sched_profile_overruns(),
+                 (unsigned long)(uintptr_t)sched_profile_sample);
+      sched_foreach(trace_task, vtbl);
+
+      while ((nread = sched_profile_read(samples, PROF_NREAD)) > 0)
+        {
+          for (i = 0; i < nread; i++)
+            {
+              nsh_output(vtbl, "S %lx %d\n",
+                         (unsigned long)samples[i].pc, samples[i].pid);
+            }
+        }
+
+      nsh_output(vtbl, "PROFILE END\n");
+      (void)sched_profile_enable(enabled);
+    }
+  else
+    {
+      nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+      return ERROR;
+    }
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: cmd_ps
  ****************************************************************************/
@@ -202,12 +547,133 @@ int cmd_exec(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 #ifndef CONFIG_NSH_DISABLE_PS
 int cmd_ps(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 {
+#ifdef CONFIG_STACK_COLORATION
+  nsh_output(vtbl, "PID   PRI SCHD TYPE   NP STATE     STACK   USED NAME\n");
+#else
   nsh_output(vtbl, "PID   PRI SCHD TYPE   NP STATE    NAME\n");
+#endif
   sched_foreach(ps_task, vtbl);
   return OK;
 }
 #endif
 
+/****************************************************************************
+ * Name: cmd_irqinfo
+ ****************************************************************************/
+
+#ifdef HAVE_IRQINFO
+int cmd_irqinfo(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
+{
+  FAR struct irq_info_s *info;
+  FAR struct irq_info_s *prev;
+  FAR struct irq_info_s *curr;
+  FAR char *endptr;
+  uint32_t count;
+  long delay = 1;
+  int option;
+  int i;
+#ifdef CONFIG_IRQ_THREADED
+  uint32_t nruns;
+  uint32_t avglat;
+#endif
+
+  while ((option = getopt(argc, argv, "d:")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'd':
+            delay = strtol(optarg, &endptr, 0);
+            if (delay < 1 || *endptr != '\0')
+              {
+                nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+                return ERROR;
+              }
+            break;
+
+          default:
+            nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+            return ERROR;
+        }
+    }
+
+  if (optind < argc)
+    {
+      nsh_output(vtbl, g_fmttoomanyargs, argv[0]);
+      return ERROR;
+    }
+
+  /* Sample the statistics of all IRQs twice, 'delay' seconds apart */
+
+  info = (FAR struct irq_info_s *)malloc(2 * NR_IRQS * sizeof(struct irq_info_s));
+  if (!info)
+    {
+      nsh_output(vtbl, g_fmtcmdoutofmemory, argv[0]);
+      return ERROR;
+    }
+
+  for (i = 0; i < NR_IRQS; i++)
+    {
+      (void)irq_info(i, &info[i]);
+    }
+
+  sleep(delay);
+
+  for (i = 0; i < NR_IRQS; i++)
+    {
+      (void)irq_info(i, &info[NR_IRQS + i]);
+    }
+
+  /* Show the IRQs that have been used since boot.  Times are in
+   * microseconds.
+   */
+
+#ifdef CONFIG_IRQ_THREADED
+  nsh_output(vtbl, "IRQ      COUNT  RATE/s   PID PRI     RUNS AVGLAT MAXLAT MAXRUN\n");
+#else
+  nsh_output(vtbl, "IRQ      COUNT  RATE/s\n");
+#endif
+
+  for (i = 0; i < NR_IRQS; i++)
+    {
+      prev  = &info[i];
+      curr  = &info[NR_IRQS + i];
+      count = curr->count - prev->count;
+
+#ifdef CONFIG_IRQ_THREADED
+      if (curr->count == 0 && curr->pid == 0)
+#else
+      if (curr->count == 0)
+#endif
+        {
+          continue;
+        }
+
+      nsh_output(vtbl, "%3d %10lu %7lu", i, (unsigned long)curr->count,
+                 (unsigned long)(count / delay));
+
+#ifdef CONFIG_IRQ_THREADED
+      if (curr->pid > 0)
+        {
+          /* The average latency is that of the runs in the interval */
+
+          nruns  = curr->nruns - prev->nruns;
+          avglat = nruns > 0 ? (curr->latsum - prev->latsum) / nruns : 0;
+
+          nsh_output(vtbl, " %5d %3d %8lu %6lu %6lu %6lu",
+                     curr->pid, curr->priority, (unsigned long)curr->nruns,
+                     (unsigned long)avglat, (unsigned long)curr->latmax,
+                     (unsigned long)curr->runmax);
+        }
+#endif
+
+      nsh_output(vtbl, "\n");
+    }
+
+  free(info);
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: cmd_kill
  ****************************************************************************/
@@ -327,3 +793,146 @@ int cmd_usleep(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 }
 #endif
 #endif
+
+/****************************************************************************
+ * Name: cmd_top
+ ****************************************************************************/
+
+#ifdef HAVE_TOP
+int cmd_top(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
+{
+  FAR struct top_s *top;
+  FAR char *endptr;
+  uint32_t irqdelta;
+  uint32_t total;
+  long count = 1;
+  long delay = 1;
+  int option;
+  int i;
+
+  while ((option = getopt(argc, argv, "n:d:")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'n':
+            count = strtol(optarg, &endptr, 0);
+            if (count < 1 || *endptr != '\0')
+              {
+                nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+                return ERROR;
+              }
+            break;
+
+          case 'd':
+            delay = strtol(optarg, &endptr, 0);
+            if (delay < 1 || *endptr != '\0')
+              {
+                nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+                return ERROR;
+              }
+            break;
+
+          default:
+            nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+            return ERROR;
+        }
+    }
+
+  if (optind < argc)
+    {
+      nsh_output(vtbl, g_fmttoomanyargs, argv[0]);
+      return ERROR;
+    }
+
+  top = (FAR struct top_s *)zalloc(sizeof(struct top_s));
+  if (!top)
+    {
+      nsh_output(vtbl, g_fmtcmdoutofmemory, argv[0]);
+      return ERROR;
+    }
+
+  for (i = 0; i < CONFIG_MAX_TASKS; i++)
+    {
+      top->task[i].pid = -1;
+    }
+
+  /* Take the initial sample, then show the CPU usage over each interval */
+
+  (void)top_update(top, &irqdelta);
+  for (i = 0; i < count; i++)
+    {
+      sleep(delay);
+      total = top_update(top, &irqdelta);
+
+      if (i > 0)
+        {
+          nsh_output(vtbl, "\n");
+        }
+
+      top_show(vtbl, top, total, irqdelta);
+    }
+
+  free(top);
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: cmd_trace
+ ****************************************************************************/
+
+#ifdef HAVE_TRACE
+int cmd_trace(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
+{
+  struct sched_trace_s events[TRACE_NREAD];
+  bool enabled;
+  size_t nread;
+  size_t i;
+
+  if (strcmp(argv[1], "start") == 0)
+    {
+      (void)sched_trace_enable(true);
+    }
+  else if (strcmp(argv[1], "stop") == 0)
+    {
+      (void)sched_trace_enable(false);
+    }
+  else if (strcmp(argv[1], "clear") == 0)
+    {
+      sched_trace_clear();
+    }
+  else if (strcmp(argv[1], "dump") == 0)
+    {
+      /* Don't record the activity of the dump itself.  The dump empties
+       * the trace buffer.  The format is read by nuttx/tools/tracedecode.py.
+       */
+
+      enabled = sched_trace_enable(false);
+
+      nsh_output(vtbl, "TRACE %d %lu\n",
+                 USEC_PER_TICK, (unsigned long)sched_trace_overruns());
+      sched_foreach(trace_task, vtbl);
+
+      while ((nread = sched_trace_read(events, TRACE_NREAD)) > 0)
+        {
+          for (i = 0; i < nread; i++)
+            {
+              nsh_output(vtbl, "E %lu %d %d %d %lx\n",
+                         (unsigned long)events[i].time, events[i].type,
+                         events[i].pid, events[i].priority,
+                         (unsigned long)events[i].arg);
+            }
+        }
+
+      nsh_output(vtbl, "TRACE END\n");
+      (void)sched_trace_enable(enabled);
+    }
+  else
+    {
+      nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+      return ERROR;
+    }
+
+  return OK;
+}
+#endif
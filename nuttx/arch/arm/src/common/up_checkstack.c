@@ -47,8 +47,9 @@
 #include <nuttx/arch.h> 
 
 #include "os_internal.h"
+#include "up_internal.h"
 
-#if defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_STACK)
+#ifdef CONFIG_STACK_COLORATION
 
 /****************************************************************************
  * Private Types
@@ -63,7 +64,30 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: up_check_stack
+ * Name: up_stack_color
+ *
+ * Description:
+ *   Write STACK_COLOR to every word of a new stack.
+ *
+ * Input Parameters:
+ *   stackbase - The lowest address of the stack memory
+ *   nbytes    - The size of the stack in bytes
+ *
+ ****************************************************************************/
+
+void up_stack_color(FAR void *stackbase, size_t nbytes)
+{
+  FAR uint32_t *ptr = (FAR uint32_t *)stackbase;
+  size_t nwords = nbytes >> 2;
+
+  while (nwords-- > 0)
+    {
+      *ptr++ = STACK_COLOR;
+    }
+}
+
+/****************************************************************************
+ * Name: up_check_tcbstack
  *
  * Description:
  *   Determine (approximately) how much stack has been used be searching the
@@ -71,7 +95,7 @@
  *   stack that clobbered some recognizable marker in the stack memory.
  *
  * Input Parameters:
- *   None
+ *   tcb - The TCB of the thread to check
  *
  * Returned value:
  *   The estimated amount of stack space used.
@@ -83,6 +107,13 @@ size_t up_check_tcbstack(FAR struct tcb_s *tcb)
   FAR uint32_t *ptr;
   size_t mark;
 
+  /* The IDLE thread runs on a stack that was never colored */
+
+  if (tcb->stack_alloc_ptr == NULL)
+    {
+      return 0;
+    }
+
   /* The ARM uses a push-down stack:  the stack grows toward lower addresses
    * in memory.  We need to start at the lowest address in the stack memory
    * allocation and search to higher addresses.  The first word we encounter
@@ -90,7 +121,7 @@ size_t up_check_tcbstack(FAR struct tcb_s *tcb)
    */
 
   for (ptr = (FAR uint32_t *)tcb->stack_alloc_ptr, mark = tcb->adj_stack_size/4;
-       *ptr == 0xDEADBEEF && mark > 0;
+       mark > 0 && *ptr == STACK_COLOR;
        ptr++, mark--);
 
   /* If the stack is completely used, then this might mean that the stack
@@ -114,7 +145,7 @@ size_t up_check_tcbstack(FAR struct tcb_s *tcb)
           for (j = 0; j < 64; j++)
             {
               int ch;
-              if (*ptr++ == 0xDEADBEEF)
+              if (*ptr++ == STACK_COLOR)
                 {
                   ch = '.';
                 }
@@ -134,6 +165,15 @@ size_t up_check_tcbstack(FAR struct tcb_s *tcb)
   return mark*4;
 }
 
+/****************************************************************************
+ * Name: up_check_tcbstack_remain, up_check_stack, up_check_stack_remain
+ ****************************************************************************/
+
+size_t up_check_tcbstack_remain(FAR struct tcb_s *tcb)
+{
+  return tcb->adj_stack_size - up_check_tcbstack(tcb);
+}
+
 size_t up_check_stack(void)
 {
   return up_check_tcbstack((FAR struct tcb_s*)g_readytorun.head);
@@ -141,7 +181,7 @@ size_t up_check_stack(void)
 
 size_t up_check_stack_remain(void)
 {
-  return ((FAR struct tcb_s*)g_readytorun.head)->adj_stack_size - up_check_tcbstack((FAR struct tcb_s*)g_readytorun.head);
+  return up_check_tcbstack_remain((FAR struct tcb_s*)g_readytorun.head);
 }
 
-#endif /* CONFIG_DEBUG && CONFIG_DEBUG_STACK */
+#endif /* CONFIG_STACK_COLORATION */
@@ -82,23 +82,6 @@
  * Private Types
  ****************************************************************************/
 
-/****************************************************************************
- * Name: memset32
- *
- * On most larger then 8 bit archs this will need to be word aligned so
- * so maybe some checks should be put in place?
- *
- ****************************************************************************/
-
-#if defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_STACK)
-static void *memset32(void *s, uint32_t  c, size_t n)
-{
-  uint32_t *p = (uint32_t *)s;
-  while (n-- > 0) *p++ = c;
-  return s;
-}
-#endif
-
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -171,7 +154,7 @@ int up_create_stack(FAR struct tcb_s *tcb, size_t stack_size, uint8_t ttype)
 
       if (ttype == TCB_FLAG_TTYPE_KERNEL)
         {
-#if defined(CONFIG_DEBUG) && !defined(CONFIG_DEBUG_STACK)
+#if defined(CONFIG_DEBUG) && !defined(CONFIG_STACK_COLORATION)
           tcb->stack_alloc_ptr = (uint32_t *)kzalloc(stack_size);
 #else
           tcb->stack_alloc_ptr = (uint32_t *)kmalloc(stack_size);
@@ -182,7 +165,7 @@ int up_create_stack(FAR struct tcb_s *tcb, size_t stack_size, uint8_t ttype)
         {
           /* Use the user-space allocator if this is a task or pthread */
 
-#if defined(CONFIG_DEBUG) && !defined(CONFIG_DEBUG_STACK)
+#if defined(CONFIG_DEBUG) && !defined(CONFIG_STACK_COLORATION)
           tcb->stack_alloc_ptr = (uint32_t *)kuzalloc(stack_size);
 #else
           tcb->stack_alloc_ptr = (uint32_t *)kumalloc(stack_size);
@@ -234,14 +217,12 @@ int up_create_stack(FAR struct tcb_s *tcb, size_t stack_size, uint8_t ttype)
       tcb->adj_stack_ptr  = (uint32_t*)top_of_stack;
       tcb->adj_stack_size = size_of_stack;
 
-      /* If stack debug is enabled, then fill the stack with a
+      /* If stack coloration is enabled, then fill the stack with a
        * recognizable value that we can use later to test for high
        * water marks.
        */
 
-#if defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_STACK)
-      memset32(tcb->stack_alloc_ptr, 0xdeadbeef, tcb->adj_stack_size/4);
-#endif
+      up_stack_color(tcb->stack_alloc_ptr, tcb->adj_stack_size);
 
       up_ledon(LED_STACKCREATED);
       return OK;
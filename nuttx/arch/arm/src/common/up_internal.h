@@ -110,6 +110,12 @@
 # define CONFIG_ARCH_INTERRUPTSTACK 0
 #endif
 
+/* The value written to every word of a new stack when stack coloration is
+ * enabled.  up_check_tcbstack() looks for the first word that has changed.
+ */
+
+#define STACK_COLOR 0xdeadbeef
+
 /* Macros to handle saving and restoring interrupt state.  In the current ARM
  * model, the state is always copied to and from the stack and TCB.  In the
  * Cortex-M0/3 model, the state is copied from the stack to the TCB, but only
@@ -406,26 +412,12 @@ void up_usbuninitialize(void);
 void up_rnginitialize(void);
 #endif
 
-/****************************************************************************
- * Name: up_check_stack
- *
- * Description:
- *   Determine (approximately) how much stack has been used be searching the
- *   stack memory for a high water mark.  That is, the deepest level of the
- *   stack that clobbered some recognizable marker in the stack memory.
- *
- * Input Parameters:
- *   None
- *
- * Returned value:
- *   The estimated amount of stack space used.
- *
- ****************************************************************************/
+/* Stack coloration *********************************************************/
 
-#if defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_STACK)
-size_t up_check_stack(void);
-size_t up_check_tcbstack(FAR struct tcb_s);
-size_t up_check_tcbstack_remain(FAR struct tcb_s);
+#ifdef CONFIG_STACK_COLORATION
+void up_stack_color(FAR void *stackbase, size_t nbytes);
+#else
+#  define up_stack_color(b,n)
 #endif
 
 #endif /* __ASSEMBLY__ */
@@ -162,5 +162,11 @@ int up_use_stack(struct tcb_s *tcb, void *stack, size_t stack_size)
   tcb->adj_stack_ptr  = (uint32_t*)top_of_stack;
   tcb->adj_stack_size = size_of_stack;
 
+  /* If stack coloration is enabled, then fill the stack with a
+   * recognizable value that we can use later to test for high
+   * water marks.
+   */
+
+  up_stack_color(tcb->stack_alloc_ptr, tcb->adj_stack_size);
   return OK;
 }
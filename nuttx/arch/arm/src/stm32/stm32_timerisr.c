@@ -43,6 +43,7 @@
 #include <time.h>
 #include <debug.h>
 #include <nuttx/arch.h>
+#include <nuttx/sched_profile.h>
 #include <arch/board/board.h>
 
 #include "nvic.h"
@@ -108,12 +109,33 @@
 
 int up_timerisr(int irq, uint32_t *regs)
 {
+   /* Sample the interrupted code for the profiler */
+
+#ifdef CONFIG_SCHED_PROFILE
+   sched_profile_sample(regs[REG_PC]);
+#endif
+
    /* Process timer interrupt */
 
    sched_process_timer();
    return 0;
 }
 
+/****************************************************************************
+ * Function:  up_profile_enable
+ *
+ * Description:
+ *   The profiler is sampled from every timer interrupt, so nothing needs to
+ *   be started or stopped.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_PROFILE
+void up_profile_enable(bool enable)
+{
+}
+#endif
+
 /****************************************************************************
  * Function:  up_timerinit
  *
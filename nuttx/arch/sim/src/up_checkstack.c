@@ -0,0 +1,127 @@
+/****************************************************************************
+ * arch/sim/src/up_checkstack.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <sched.h>
+
+#include <nuttx/arch.h>
+
+#include "os_internal.h"
+#include "up_internal.h"
+
+#ifdef CONFIG_STACK_COLORATION
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_stack_color
+ *
+ * Description:
+ *   Write STACK_COLOR to every word of a new stack.
+ *
+ ****************************************************************************/
+
+void up_stack_color(void *stackbase, size_t nbytes)
+{
+  uint32_t *ptr = (uint32_t *)stackbase;
+  size_t nwords = nbytes >> 2;
+
+  while (nwords-- > 0)
+    {
+      *ptr++ = STACK_COLOR;
+    }
+}
+
+/****************************************************************************
+ * Name: up_check_tcbstack
+ *
+ * Description:
+ *   Return the high water mark of the stack usage of a thread.  The host
+ *   stack grows toward lower addresses so the search starts at the lowest
+ *   address of the stack memory and stops at the first word that has lost
+ *   its color.
+ *
+ ****************************************************************************/
+
+size_t up_check_tcbstack(FAR struct tcb_s *tcb)
+{
+  FAR uint32_t *ptr;
+  size_t mark;
+
+  /* The IDLE thread runs on the host stack which was never colored */
+
+  if (tcb->stack_alloc_ptr == NULL)
+    {
+      return 0;
+    }
+
+  for (ptr = (FAR uint32_t *)tcb->stack_alloc_ptr,
+       mark = tcb->adj_stack_size >> 2;
+       mark > 0 && *ptr == STACK_COLOR;
+       ptr++, mark--);
+
+  return mark << 2;
+}
+
+/****************************************************************************
+ * Name: up_check_tcbstack_remain, up_check_stack, up_check_stack_remain
+ ****************************************************************************/
+
+size_t up_check_tcbstack_remain(FAR struct tcb_s *tcb)
+{
+  return tcb->adj_stack_size - up_check_tcbstack(tcb);
+}
+
+size_t up_check_stack(void)
+{
+  return up_check_tcbstack((FAR struct tcb_s*)g_readytorun.head);
+}
+
+size_t up_check_stack_remain(void)
+{
+  return up_check_tcbstack_remain((FAR struct tcb_s*)g_readytorun.head);
+}
+
+#endif /* CONFIG_STACK_COLORATION */
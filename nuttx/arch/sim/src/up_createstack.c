@@ -138,6 +138,10 @@ int up_create_stack(FAR struct tcb_s *tcb, size_t stack_size, uint8_t ttype)
       tcb->adj_stack_size  = adj_stack_size;
       tcb->stack_alloc_ptr = stack_alloc_ptr;
       tcb->adj_stack_ptr   = adj_stack_ptr;
+
+      /* Fill the stack with a recognizable value for the high water mark */
+
+      up_stack_color(stack_alloc_ptr, adj_stack_size);
       ret = OK;
     }
 
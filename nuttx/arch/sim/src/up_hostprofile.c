@@ -0,0 +1,121 @@
+/****************************************************************************
+ * arch/sim/src/up_hostprofile.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#define _GNU_SOURCE 1
+
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <sys/time.h>
+
+/****************************************************************************
+ * Private Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+extern void up_profile_sample(uintptr_t pc);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_profile_handler
+ *
+ * Description:
+ *   The SIGPROF handler.  The program counter of the interrupted code is
+ *   taken from the host signal context.
+ *
+ ****************************************************************************/
+
+static void up_profile_handler(int signo, siginfo_t *info, void *context)
+{
+  uintptr_t pc = 0;
+
+#if defined(__linux__) && defined(__x86_64__)
+  pc = ((ucontext_t *)context)->uc_mcontext.gregs[REG_RIP];
+#elif defined(__linux__) && defined(__i386__)
+  pc = ((ucontext_t *)context)->uc_mcontext.gregs[REG_EIP];
+#endif
+
+  up_profile_sample(pc);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_hostprofile
+ *
+ * Description:
+ *   Start (usec > 0) or stop (usec == 0) the host profiling timer.  While
+ *   it runs, up_profile_handler() is called every 'usec' microseconds of
+ *   CPU time used by the simulation.  The time that the simulation spends
+ *   sleeping in the IDLE loop is not counted.
+ *
+ ****************************************************************************/
+
+void up_hostprofile(unsigned int usec)
+{
+  struct itimerval timer;
+  struct sigaction act;
+
+  if (usec > 0)
+    {
+      memset(&act, 0, sizeof(act));
+      act.sa_sigaction = up_profile_handler;
+      act.sa_flags     = SA_SIGINFO | SA_RESTART;
+      sigemptyset(&act.sa_mask);
+      sigaction(SIGPROF, &act, NULL);
+    }
+
+  timer.it_interval.tv_sec  = usec / 1000000;
+  timer.it_interval.tv_usec = usec % 1000000;
+  timer.it_value            = timer.it_interval;
+  setitimer(ITIMER_PROF, &timer, NULL);
+}
@@ -94,11 +94,19 @@ extern void up_x11update(void);
 
 void up_idle(void)
 {
+#ifdef CONFIG_SCHED_TICKLESS
+  /* If the system is idle, then process the "fake" one-shot timer
+   * interrupt if the timer has expired.
+   */
+
+  up_timer_update();
+#else
   /* If the system is idle, then process "fake" timer interrupts.
    * Hopefully, something will wake up.
    */
 
   sched_process_timer();
+#endif
 
   /* Run the network if enabled */
 
@@ -125,11 +133,17 @@ void up_idle(void)
 #endif
 
   /* Wait a bit so that the sched_process_timer() is called close to the
-   * correct rate.
+   * correct rate.  In the tickless mode, sleep until the one-shot timer
+   * expires.
    */
 
-#if defined(CONFIG_SIM_WALLTIME) || defined(CONFIG_SIM_X11FB)
+#if defined(CONFIG_SIM_WALLTIME) || defined(CONFIG_SIM_X11FB) || \
+    defined(CONFIG_SCHED_TICKLESS)
+#ifdef CONFIG_SCHED_TICKLESS
+  up_timer_idle();
+#else
   (void)up_hostusleep(1000000 / CLK_TCK);
+#endif
 
   /* Handle X11-related events */
 
@@ -112,6 +112,11 @@
 #  define SIM_HEAP_SIZE (4*1024*1024)
 #endif
 
+/* Stack Coloration Definitions *********************************************/
+/* The value written to every word of a new stack */
+
+#define STACK_COLOR 0xdeadbeef
+
 /* File System Definitions **************************************************/
 /* These definitions characterize the compressed filesystem image */
 
@@ -137,6 +142,8 @@
 
 #ifndef __ASSEMBLY__
 
+#include <stdint.h>
+
 #ifdef CONFIG_SIM_X11FB
 extern int g_x11initialized;
 #ifdef CONFIG_SIM_TOUCHSCREEN
@@ -167,6 +174,39 @@ extern char *up_deviceimage(void);
 extern size_t up_hostread(void *buffer, size_t len);
 extern size_t up_hostwrite(const void *buffer, size_t len);
 
+/* up_hosttime.c **********************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+extern uint64_t up_hosttime(void);
+#endif
+
+/* up_hostprofile.c *******************************************************/
+
+#ifdef CONFIG_SCHED_PROFILE
+extern void up_hostprofile(unsigned int usec);
+#endif
+
+/* up_profile.c ***********************************************************/
+
+#ifdef CONFIG_SCHED_PROFILE
+extern void up_profile_sample(uintptr_t pc);
+#endif
+
+/* up_tickless.c **********************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+extern void up_timer_update(void);
+extern void up_timer_idle(void);
+#endif
+
+/* up_checkstack.c ********************************************************/
+
+#ifdef CONFIG_STACK_COLORATION
+extern void up_stack_color(void *stackbase, size_t nbytes);
+#else
+#  define up_stack_color(b,n)
+#endif
+
 /* up_netdev.c ************************************************************/
 
 #ifdef CONFIG_NET
@@ -0,0 +1,284 @@
+/****************************************************************************
+ * arch/sim/src/up_tickless.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <syslog.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+
+#include "up_internal.h"
+
+#ifdef CONFIG_SCHED_TICKLESS
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* The IDLE loop must continue to poll the network and to refresh the X11
+ * display even if there is no timed work pending.  Otherwise, nothing
+ * other than the one-shot timer can wake up the simulation and the IDLE
+ * loop may sleep for as long as it likes.
+ */
+
+#if defined(CONFIG_NET) || defined(CONFIG_SIM_X11FB)
+#  define SIM_MAXSLEEP_USEC USEC_PER_TICK
+#else
+#  define SIM_MAXSLEEP_USEC USEC_PER_SEC
+#endif
+
+#ifndef CONFIG_SIM_TICKLESS_STATS_PERIOD
+#  define CONFIG_SIM_TICKLESS_STATS_PERIOD 10
+#endif
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+extern int up_hostusleep(unsigned int usec);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint64_t g_start;      /* Host time when the counter was started */
+static uint64_t g_deadline;   /* Counter value when the timer expires */
+static bool     g_armed;      /* True: The one-shot timer is running */
+
+#ifdef CONFIG_SIM_TICKLESS_STATS
+static uint64_t g_statstart;  /* Counter value at the start of the period */
+static uint64_t g_latesum;    /* Sum of the expiration lateness (usec) */
+static uint32_t g_latemax;    /* Worst case expiration lateness (usec) */
+static uint32_t g_nexpired;   /* Number of timer expirations */
+static uint32_t g_nwakeups;   /* Number of IDLE loop wakeups */
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_timer_now
+ *
+ * Description:
+ *   Return the value of the free-running counter in microseconds.  The
+ *   counter starts at zero on the first call.
+ *
+ ****************************************************************************/
+
+static uint64_t up_timer_now(void)
+{
+  if (g_start == 0)
+    {
+      g_start = up_hosttime();
+    }
+
+  return up_hosttime() - g_start;
+}
+
+/****************************************************************************
+ * Name: up_timer_stats
+ *
+ * Description:
+ *   Report and reset the statistics at the end of each period.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SIM_TICKLESS_STATS
+static void up_timer_stats(uint64_t now)
+{
+  uint64_t period = now - g_statstart;
+  uint32_t rate;
+
+  if (period >= (uint64_t)CONFIG_SIM_TICKLESS_STATS_PERIOD * USEC_PER_SEC)
+    {
+      /* Wakeups per second in units of 1/100 */
+
+      rate = (uint32_t)(((uint64_t)g_nwakeups * 100 * USEC_PER_SEC) / period);
+
+      syslog("tickless: %u.%02u wakeups/sec, %u expirations, "
+             "late avg %u max %u usec\n",
+             rate / 100, rate % 100, g_nexpired,
+             g_nexpired ? (uint32_t)(g_latesum / g_nexpired) : 0,
+             g_latemax);
+
+      g_statstart = now;
+      g_latesum   = 0;
+      g_latemax   = 0;
+      g_nexpired  = 0;
+      g_nwakeups  = 0;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_timer_gettime
+ *
+ * Description:
+ *   Return the time elapsed since the free-running counter was started.
+ *   See include/nuttx/arch.h.
+ *
+ ****************************************************************************/
+
+int up_timer_gettime(FAR struct timespec *ts)
+{
+  uint64_t usec = up_timer_now();
+
+  ts->tv_sec  = (time_t)(usec / USEC_PER_SEC);
+  ts->tv_nsec = (long)(usec % USEC_PER_SEC) * NSEC_PER_USEC;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: up_timer_start
+ *
+ * Description:
+ *   Start the one-shot timer.  The simulation has no asynchronous timer
+ *   interrupt, so this only records the expiration time; the IDLE loop
+ *   sleeps on the host until then (see up_timer_idle()).
+ *
+ ****************************************************************************/
+
+int up_timer_start(FAR const struct timespec *ts)
+{
+  /* Round up to the next microsecond so that the timer never expires
+   * early.
+   */
+
+  g_deadline = up_timer_now() + (uint64_t)ts->tv_sec * USEC_PER_SEC +
+               ((uint32_t)ts->tv_nsec + NSEC_PER_USEC - 1) / NSEC_PER_USEC;
+  g_armed    = true;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: up_timer_cancel
+ *
+ * Description:
+ *   Cancel the one-shot timer.
+ *
+ ****************************************************************************/
+
+int up_timer_cancel(void)
+{
+  g_armed = false;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: up_timer_update
+ *
+ * Description:
+ *   Called from the IDLE loop.  If the one-shot timer has expired, then
+ *   inform the OS.  This plays the part of the timer interrupt handler.
+ *
+ ****************************************************************************/
+
+void up_timer_update(void)
+{
+  uint64_t now = up_timer_now();
+
+  if (g_armed && now >= g_deadline)
+    {
+#ifdef CONFIG_SIM_TICKLESS_STATS
+      uint32_t late = (uint32_t)(now - g_deadline);
+
+      g_latesum += late;
+      if (late > g_latemax)
+        {
+          g_latemax = late;
+        }
+
+      g_nexpired++;
+#endif
+
+      g_armed = false;
+      sched_timer_expiration();
+    }
+
+#ifdef CONFIG_SIM_TICKLESS_STATS
+  up_timer_stats(now);
+#endif
+}
+
+/****************************************************************************
+ * Name: up_timer_idle
+ *
+ * Description:
+ *   Called from the IDLE loop.  Sleep on the host until the one-shot timer
+ *   expires (or for SIM_MAXSLEEP_USEC if the timer is not running).
+ *
+ ****************************************************************************/
+
+void up_timer_idle(void)
+{
+  uint64_t now  = up_timer_now();
+  uint64_t usec = SIM_MAXSLEEP_USEC;
+
+  if (g_armed)
+    {
+      if (g_deadline <= now)
+        {
+          /* Already expired.  Don't sleep */
+
+          return;
+        }
+
+      if (g_deadline - now < usec)
+        {
+          usec = g_deadline - now;
+        }
+    }
+
+  (void)up_hostusleep((unsigned int)usec);
+
+#ifdef CONFIG_SIM_TICKLESS_STATS
+  g_nwakeups++;
+#endif
+}
+
+#endif /* CONFIG_SCHED_TICKLESS */
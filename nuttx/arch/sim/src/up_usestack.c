@@ -104,5 +104,9 @@ int up_use_stack(struct tcb_s *tcb, void *stack, size_t stack_size)
   tcb->adj_stack_size  = adj_stack_size;
   tcb->stack_alloc_ptr = stack;
   tcb->adj_stack_ptr   = adj_stack_ptr;
+
+  /* Fill the stack with a recognizable value for the high water mark */
+
+  up_stack_color(stack, adj_stack_size);
   return OK;
 }
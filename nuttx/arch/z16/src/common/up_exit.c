@@ -89,14 +89,14 @@ static void _up_dumponexit(FAR struct tcb_s *tcb, FAR void *arg)
   lldbg("    priority=%d state=%d\n", tcb->sched_priority, tcb->task_state);
 
 #if CONFIG_NFILE_DESCRIPTORS > 0
-  filelist = tcb->group->tg_filelist;
+  filelist = &tcb->group->tg_filelist;
   for (i = 0; i < CONFIG_NFILE_DESCRIPTORS; i++)
     {
-      struct inode *inode = filelist->fl_files[i].f_inode;
-      if (inode)
+      FAR struct file *filep = files_getfile(filelist, i);
+      if (filep && filep->f_inode)
         {
           lldbg("      fd=%d refcount=%d\n",
-                i, inode->i_crefs);
+                i, filep->f_inode->i_crefs);
         }
     }
 #endif
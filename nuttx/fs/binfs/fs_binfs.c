@@ -115,6 +115,8 @@ const struct mountpt_operations binfs_operations =
 
   NULL,              /* sync */
   binfs_dup,         /* dup */
+  NULL,              /* truncate */
+  NULL,              /* allocate */
 
   binfs_opendir,     /* opendir */
   NULL,              /* closedir */
@@ -62,6 +62,7 @@
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/fat.h>
 #include <nuttx/fs/dirent.h>
+#include <nuttx/fs/ioctl.h>
 
 #include "fs_internal.h"
 #include "fs_fat32.h"
@@ -89,6 +90,9 @@ static int     fat_ioctl(FAR struct file *filep, int cmd, unsigned long arg);
 
 static int     fat_sync(FAR struct file *filep);
 static int     fat_dup(FAR const struct file *oldp, FAR struct file *newp);
+static int     fat_truncate(FAR struct file *filep, off_t length);
+static int     fat_allocate(FAR struct file *filep, int mode, off_t offset,
+                            off_t len);
 
 static int     fat_opendir(struct inode *mountpt, const char *relpath,
                            struct fs_dirent_s *dir);
@@ -132,6 +136,8 @@ const struct mountpt_operations fat_operations =
 
   fat_sync,          /* sync */
   fat_dup,           /* dup */
+  fat_truncate,      /* truncate */
+  fat_allocate,      /* allocate */
 
   fat_opendir,       /* opendir */
   NULL,              /* closedir */
@@ -256,6 +262,12 @@ static int fat_open(FAR struct file *filep, const char *relpath,
             {
               goto errout_with_semaphore;
             }
+
+          /* The directory entry is in the sector cache again, but not
+           * necessarily in the same sector buffer.
+           */
+
+          direntry = &fs->fs_buffer[dirinfo.fd_seq.ds_offset];
         }
 
       /* fall through to finish the file open operations */
@@ -341,6 +353,15 @@ static int fat_open(FAR struct file *filep, const char *relpath,
   ff->ff_sectorsincluster = fs->fs_fatsecperclus;
   ff->ff_size             = DIR_GETFILESIZE(direntry);
 
+  /* The first cluster of the file starts the extent map.  Later clusters
+   * are added as they are reached.
+   */
+
+  if (ff->ff_startcluster != 0)
+    {
+      fat_extentappend(ff, 0, ff->ff_startcluster);
+    }
+
   /* Attach the private date to the struct file instance */
 
   filep->f_priv = ff;
@@ -442,7 +463,10 @@ static ssize_t fat_read(FAR struct file *filep, char *buffer, size_t buflen)
   unsigned int          bytesread;
   unsigned int          readsize;
   unsigned int          nsectors;
+  unsigned int          maxsectors;
+  uint32_t              nclusters;
   size_t                bytesleft;
+  uint32_t              fileclust;
   int32_t               cluster;
   uint8_t               *userbuffer = (uint8_t*)buffer;
   int                   sectorindex;
@@ -524,13 +548,24 @@ static ssize_t fat_read(FAR struct file *filep, char *buffer, size_t buflen)
 
       if (ff->ff_sectorsincluster < 1)
         {
-          /* Find the next cluster in the FAT. */
+          /* Find the next cluster, in the extent map if possible.  The file
+           * position is on a cluster boundary here.
+           */
 
-          cluster = fat_getcluster(fs, ff->ff_currentcluster);
-          if (cluster < 2 || cluster >= fs->fs_nclusters)
+          fileclust = CLUS_FILENDX(fs, filep->f_pos);
+          cluster   = fat_extentfind(ff, fileclust);
+          if (cluster == 0)
             {
-              ret = -EINVAL; /* Not the right error */
-              goto errout_with_semaphore;
+              /* Not mapped.. find the next cluster in the FAT. */
+
+              cluster = fat_getcluster(fs, ff->ff_currentcluster);
+              if (cluster < 2 || cluster >= fs->fs_nclusters)
+                {
+                  ret = -EINVAL; /* Not the right error */
+                  goto errout_with_semaphore;
+                }
+
+              fat_extentappend(ff, fileclust, cluster);
             }
 
           /* Setup to read the first sector from the new cluster */
@@ -554,13 +589,24 @@ fat_read_restart:
            * buffer without using our tiny read buffer.
            *
            * Limit the number of sectors that we read on this time
-           * through the loop to the remaining contiguous sectors
-           * in this cluster
+           * through the loop to the remaining sectors in this cluster
+           * plus the sectors of any physically contiguous clusters that
+           * follow it.
            */
 
           if (nsectors > ff->ff_sectorsincluster)
             {
-              nsectors = ff->ff_sectorsincluster;
+              nclusters = (nsectors - ff->ff_sectorsincluster +
+                           fs->fs_fatsecperclus - 1) / fs->fs_fatsecperclus;
+              nclusters = fat_contiguous(fs, ff, CLUS_FILENDX(fs, filep->f_pos),
+                                         nclusters, false);
+              maxsectors = ff->ff_sectorsincluster +
+                           nclusters * fs->fs_fatsecperclus;
+
+              if (nsectors > maxsectors)
+                {
+                  nsectors = maxsectors;
+                }
             }
 
           /* We are not sure of the state of the file buffer so
@@ -593,9 +639,8 @@ fat_read_restart:
               goto errout_with_semaphore;
             }
 
-          ff->ff_sectorsincluster -= nsectors;
-          ff->ff_currentsector    += nsectors;
-          bytesread                = nsectors * fs->fs_hwsectorsize;
+          fat_advancesectors(fs, ff, nsectors);
+          bytesread = nsectors * fs->fs_hwsectorsize;
         }
       else
         {
@@ -658,10 +703,13 @@ static ssize_t fat_write(FAR struct file *filep, const char *buffer,
   struct inode         *inode;
   struct fat_mountpt_s *fs;
   struct fat_file_s    *ff;
+  uint32_t              fileclust;
   int32_t               cluster;
   unsigned int          byteswritten;
   unsigned int          writesize;
   unsigned int          nsectors;
+  unsigned int          maxsectors;
+  uint32_t              nclusters;
   uint8_t              *userbuffer = (uint8_t*)buffer;
   int                   sectorindex;
   int                   ret;
@@ -726,9 +774,22 @@ static ssize_t fat_write(FAR struct file *filep, const char *buffer,
         {
           /* No.. we have to create a new cluster chain */
 
-          ff->ff_startcluster     = fat_createchain(fs);
-          ff->ff_currentcluster   = ff->ff_startcluster;
+          cluster = fat_createchain(fs);
+          if (cluster < 0)
+            {
+              ret = cluster;
+              goto errout_with_semaphore;
+            }
+          else if (cluster < 2 || cluster >= fs->fs_nclusters)
+            {
+              ret = -ENOSPC;
+              goto errout_with_semaphore;
+            }
+
+          ff->ff_startcluster     = cluster;
+          ff->ff_currentcluster   = cluster;
           ff->ff_sectorsincluster = fs->fs_fatsecperclus;
+          fat_extentappend(ff, 0, cluster);
         }
 
       /* The current sector can then be determined from the currentcluster
@@ -758,23 +819,35 @@ static ssize_t fat_write(FAR struct file *filep, const char *buffer,
 
       if (ff->ff_sectorsincluster < 1)
         {
-          /* Extend the current cluster by one (unless lseek was used to
-           * move the file position back from the end of the file)
+          /* Use the next cluster from the extent map if it is known (i.e.,
+           * lseek was used to move the file position back from the end of
+           * the file).
            */
 
-          cluster = fat_extendchain(fs, ff->ff_currentcluster);
+          fileclust = CLUS_FILENDX(fs, filep->f_pos);
+          cluster   = fat_extentfind(ff, fileclust);
+          if (cluster == 0)
+            {
+              /* Otherwise, extend the current cluster by one (or follow the
+               * existing chain)
+               */
 
-          /* Verify the cluster number */
+              cluster = fat_extendchain(fs, ff->ff_currentcluster);
 
-          if (cluster < 0)
-            {
-              ret = cluster;
-              goto errout_with_semaphore;
-            }
-          else if (cluster < 2 || cluster >= fs->fs_nclusters)
-            {
-              ret = -ENOSPC;
-              goto errout_with_semaphore;
+              /* Verify the cluster number */
+
+              if (cluster < 0)
+                {
+                  ret = cluster;
+                  goto errout_with_semaphore;
+                }
+              else if (cluster < 2 || cluster >= fs->fs_nclusters)
+                {
+                  ret = -ENOSPC;
+                  goto errout_with_semaphore;
+                }
+
+              fat_extentappend(ff, fileclust, cluster);
             }
 
           /* Setup to write the first sector from the new cluster */
@@ -793,13 +866,24 @@ fat_write_restart:
            * buffer without using our tiny read buffer.
            *
            * Limit the number of sectors that we write on this time
-           * through the loop to the remaining contiguous sectors
-           * in this cluster
+           * through the loop to the remaining sectors in this cluster
+           * plus the sectors of any physically contiguous clusters that
+           * follow it (extending the cluster chain as necessary).
            */
 
           if (nsectors > ff->ff_sectorsincluster)
             {
-              nsectors = ff->ff_sectorsincluster;
+              nclusters = (nsectors - ff->ff_sectorsincluster +
+                           fs->fs_fatsecperclus - 1) / fs->fs_fatsecperclus;
+              nclusters = fat_contiguous(fs, ff, CLUS_FILENDX(fs, filep->f_pos),
+                                         nclusters, true);
+              maxsectors = ff->ff_sectorsincluster +
+                           nclusters * fs->fs_fatsecperclus;
+
+              if (nsectors > maxsectors)
+                {
+                  nsectors = maxsectors;
+                }
             }
 
           /* We are not sure of the state of the sector cache so the
@@ -833,10 +917,9 @@ fat_write_restart:
               goto errout_with_semaphore;
             }
 
-          ff->ff_sectorsincluster -= nsectors;
-          ff->ff_currentsector    += nsectors;
-          writesize                = nsectors * fs->fs_hwsectorsize;
-          ff->ff_bflags           |= FFBUFF_MODIFIED;
+          fat_advancesectors(fs, ff, nsectors);
+          writesize      = nsectors * fs->fs_hwsectorsize;
+          ff->ff_bflags |= FFBUFF_MODIFIED;
         }
       else
         {
@@ -945,6 +1028,9 @@ static off_t fat_seek(FAR struct file *filep, off_t offset, int whence)
   struct inode         *inode;
   struct fat_mountpt_s *fs;
   struct fat_file_s    *ff;
+  uint32_t              wantclust;
+  uint32_t              fileclust;
+  int32_t               nextcluster;
   int32_t               cluster;
   off_t                 position;
   unsigned int          clustersize;
@@ -1045,105 +1131,114 @@ static off_t fat_seek(FAR struct file *filep, off_t offset, int whence)
 
   if (cluster)
     {
-      /* If the file has a cluster chain, follow it to the
-       * requested position.
+      /* If the file has a cluster chain, find the cluster containing the
+       * requested position.  The extent map usually holds it; otherwise
+       * the chain is followed from the end of the map.
        */
 
       clustersize = fs->fs_fatsecperclus * fs->fs_hwsectorsize;
-      for (;;)
-        {
-          /* Skip over clusters prior to the one containing
-           * the requested position.
-           */
+      fileclust   = CLUS_FILENDX(fs, position);
 
-          ff->ff_currentcluster = cluster;
-          if (position < clustersize)
-            {
-              break;
-            }
+      /* A position on a cluster boundary is treated as the end of the
+       * preceding cluster.  Then no new cluster is allocated until data is
+       * actually written there.
+       */
 
-          /* Extend the cluster chain if write in enabled.  NOTE:
-           * this is not consistent with the lseek description:
-           * "The  lseek() function allows the file offset to be
-           * set beyond the end of the file (but this does not
-           * change the size of the file).  If data is later written
-           * at  this  point, subsequent reads of the data in the
-           * gap (a "hole") return null bytes ('\0') until data
-           * is actually written into the gap."
-           */
+      if (fileclust > 0 && (position % clustersize) == 0)
+        {
+          fileclust--;
+        }
 
-          if ((ff->ff_oflags & O_WROK) != 0)
-            {
-              /* Extend the cluster chain (fat_extendchain
-               * will follow the existing chain or add new
-               * clusters as needed.
-               */
+      wantclust = fileclust;
 
-              cluster = fat_extendchain(fs, cluster);
-            }
-          else
-            {
-              /* Otherwise we can only follong the existing chain */
+      cluster = fat_extentlookup(fs, ff, &fileclust);
+      if (cluster < 0)
+        {
+          ret = cluster;
+          goto errout_with_semaphore;
+        }
 
-              cluster = fat_getcluster(fs, cluster);
-            }
+      /* Extend the cluster chain if write in enabled.  NOTE:
+       * this is not consistent with the lseek description:
+       * "The  lseek() function allows the file offset to be
+       * set beyond the end of the file (but this does not
+       * change the size of the file).  If data is later written
+       * at  this  point, subsequent reads of the data in the
+       * gap (a "hole") return null bytes ('\0') until data
+       * is actually written into the gap."
+       */
 
-          if (cluster < 0)
+      while (fileclust < wantclust && (ff->ff_oflags & O_WROK) != 0)
+        {
+          nextcluster = fat_extendchain(fs, cluster);
+          if (nextcluster < 0)
             {
               /* An error occurred getting the cluster */
 
-              ret = cluster;
+              ret = nextcluster;
               goto errout_with_semaphore;
             }
 
-          /* Zero means that there is no further clusters available
-           * in the chain.
-           */
+          /* Zero means that there are no free clusters available */
 
-          if (cluster == 0)
+          if (nextcluster == 0)
             {
-              /* At the position to the current locaiton and
-               * break out.
-               */
-
-              position = clustersize;
               break;
             }
 
-          if (cluster >= fs->fs_nclusters)
+          if (nextcluster >= fs->fs_nclusters)
             {
               ret = -ENOSPC;
               goto errout_with_semaphore;
             }
 
-          /* Otherwise, update the position and continue looking */
-
-          filep->f_pos += clustersize;
-          position     -= clustersize;
+          cluster = nextcluster;
+          fileclust++;
+          fat_extentappend(ff, fileclust, cluster);
         }
 
-      /* We get here after we have found the sector containing
-       * the requested position.
-       *
-       * Save the new file position
-       */
+      ff->ff_currentcluster = cluster;
 
-      filep->f_pos += position;
+      if (fileclust < wantclust)
+        {
+          /* The cluster chain could not be extended to the requested
+           * position.  Stop at the end of the last cluster.
+           */
 
-      /* Then get the current sector from the cluster and the offset
-       * into the cluster from the position
-       */
+          position = (off_t)(fileclust + 1) * clustersize;
+        }
 
-      (void)fat_currentsector(fs, ff, filep->f_pos);
+      /* Save the new file position */
 
-      /* Load the sector corresponding to the position */
+      filep->f_pos = position;
 
-      if ((position & SEC_NDXMASK(fs)) != 0)
+      if (position == (off_t)(fileclust + 1) * clustersize)
         {
-          ret = fat_ffcacheread(fs, ff, ff->ff_currentsector);
-          if (ret < 0)
+          /* The position is at the very end of the cluster.  The next read
+           * or write will move on to the following cluster.
+           */
+
+          ff->ff_currentsector    = fat_cluster2sector(fs, cluster) +
+                                    fs->fs_fatsecperclus;
+          ff->ff_sectorsincluster = 0;
+        }
+      else
+        {
+          /* Get the current sector from the cluster and the offset into
+           * the cluster from the position
+           */
+
+          (void)fat_currentsector(fs, ff, filep->f_pos);
+
+          /* Load the sector corresponding to the position */
+
+          if ((position & SEC_NDXMASK(fs)) != 0)
             {
-              goto errout_with_semaphore;
+              ret = fat_ffcacheread(fs, ff, ff->ff_currentsector);
+              if (ret < 0)
+                {
+                  goto errout_with_semaphore;
+                }
             }
         }
     }
@@ -1195,6 +1290,37 @@ static int fat_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
       return ret;
     }
 
+  /* Return sector cache statistics for the volume */
+
+  if (cmd == FIOC_CACHESTATS)
+    {
+      FAR struct fat_cachestats_s *stats =
+        (FAR struct fat_cachestats_s *)((uintptr_t)arg);
+      int i;
+
+      if (!stats)
+        {
+          fat_semgive(fs);
+          return -EINVAL;
+        }
+
+      memcpy(stats, &fs->fs_cachestats, sizeof(struct fat_cachestats_s));
+
+      /* The dirty state of the current sector is held in fs_dirty */
+
+      stats->cs_ndirty = fs->fs_dirty ? 1 : 0;
+      for (i = 0; i < CONFIG_FAT_NCACHESECTORS; i++)
+        {
+          if (i != fs->fs_cacheline && fs->fs_cache[i].cl_dirty)
+            {
+              stats->cs_ndirty++;
+            }
+        }
+
+      fat_semgive(fs);
+      return OK;
+    }
+
   /* ioctl calls are just passed through to the contained block driver */
 
   fat_semgive(fs);
@@ -1388,6 +1514,11 @@ static int fat_dup(FAR const struct file *oldp, FAR struct file *newp)
   newff->ff_startcluster     = oldff->ff_startcluster;     /* Start cluster of file on media */
   newff->ff_currentsector    = oldff->ff_currentsector;    /* Current sector */
   newff->ff_cachesector      = 0;                          /* Sector in file buffer */
+#if CONFIG_FAT_NEXTENTS > 0
+  newff->ff_nextents         = oldff->ff_nextents;         /* Cluster extent map */
+  memcpy(newff->ff_extents, oldff->ff_extents,
+         oldff->ff_nextents * sizeof(struct fat_extent_s));
+#endif
 
   /* Attach the private date to the struct file instance */
 
@@ -1417,6 +1548,239 @@ errout_with_semaphore:
   return ret;
 }
 
+/****************************************************************************
+ * Name: fat_growfile
+ *
+ * Description: Make sure that clusters are allocated for the first 'length'
+ *   bytes of the file.  If 'setsize' is true and the file is shorter than
+ *   'length', the new part of the file is zeroed and the file size is
+ *   changed.  Otherwise, the new clusters are only reserved beyond the end
+ *   of the file and they are not initialized:  Reads stop at the end of the
+ *   file and writes that extend the file will use the reserved clusters.
+ *
+ *   The caller should hold the mountpoint semaphore and should have written
+ *   back the file buffer.
+ *
+ ****************************************************************************/
+
+static int fat_growfile(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                        off_t length, bool setsize)
+{
+  unsigned int clustersize;
+  uint32_t     nclusters;
+  int          ret;
+
+  clustersize = fs->fs_fatsecperclus * fs->fs_hwsectorsize;
+  nclusters   = length / clustersize;
+  if ((length % clustersize) != 0)
+    {
+      nclusters++;
+    }
+
+  ret = fat_preallocate(fs, ff, nclusters);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (setsize && length > ff->ff_size)
+    {
+      ret = fat_zerofill(fs, ff, ff->ff_size, length);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      ff->ff_size = length;
+    }
+
+  ff->ff_bflags |= FFBUFF_MODIFIED;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_truncate
+ *
+ * Description: Set the size of the file.  When the file is shortened, all of
+ *   the clusters beyond the new end of the file are released, including any
+ *   space reserved with fallocate(FALLOC_FL_KEEP_SIZE).  When it is
+ *   extended, the new clusters are allocated contiguously where possible
+ *   and zeroed.
+ *
+ ****************************************************************************/
+
+static int fat_truncate(FAR struct file *filep, off_t length)
+{
+  struct inode         *inode;
+  struct fat_mountpt_s *fs;
+  struct fat_file_s    *ff;
+  unsigned int          clustersize;
+  uint32_t              nclusters;
+  int                   ret;
+
+  /* Sanity checks */
+
+  DEBUGASSERT(filep->f_priv != NULL && filep->f_inode != NULL);
+
+  /* Recover our private data from the struct file instance */
+
+  ff    = filep->f_priv;
+  inode = filep->f_inode;
+  fs    = inode->i_private;
+
+  DEBUGASSERT(fs != NULL);
+
+  /* Make sure that the mount is still healthy */
+
+  fat_semtake(fs);
+  ret = fat_checkmount(fs);
+  if (ret != OK)
+    {
+      goto errout_with_semaphore;
+    }
+
+  /* Check if the file was opened for write access */
+
+  if ((ff->ff_oflags & O_WROK) == 0)
+    {
+      ret = -EACCES;
+      goto errout_with_semaphore;
+    }
+
+  /* Write back and discard the file buffer; the sector that it holds may
+   * be released.
+   */
+
+  ret = fat_ffcacheinvalidate(fs, ff);
+  if (ret < 0)
+    {
+      goto errout_with_semaphore;
+    }
+
+  if (length > ff->ff_size)
+    {
+      ret = fat_growfile(fs, ff, length, true);
+    }
+  else
+    {
+      clustersize = fs->fs_fatsecperclus * fs->fs_hwsectorsize;
+      nclusters   = length / clustersize;
+      if ((length % clustersize) != 0)
+        {
+          nclusters++;
+        }
+
+      ret = fat_truncatechain(fs, ff, nclusters);
+      if (ret >= 0)
+        {
+          ff->ff_size    = length;
+          ff->ff_bflags |= FFBUFF_MODIFIED;
+        }
+    }
+
+  fat_semgive(fs);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* The FAT file system cannot represent a hole, so a file position beyond
+   * the new end of the file is moved back to it.  A position within the
+   * file still refers to clusters that were kept.
+   */
+
+  if (filep->f_pos > length)
+    {
+      ret = fat_seek(filep, length, SEEK_SET);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  /* Commit the new size and cluster chain to the media */
+
+  return fat_sync(filep);
+
+errout_with_semaphore:
+  fat_semgive(fs);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: fat_allocate
+ *
+ * Description: Reserve clusters for bytes 'offset' through
+ *   'offset' + 'len' - 1 of the file, allocating them contiguously where
+ *   possible.  Sequential writes into the reserved space then stay
+ *   contiguous and do not have to update the FAT.  Unless
+ *   FALLOC_FL_KEEP_SIZE is specified, the file is extended to cover the
+ *   range (which requires zeroing the new part of the file).
+ *
+ ****************************************************************************/
+
+static int fat_allocate(FAR struct file *filep, int mode, off_t offset,
+                        off_t len)
+{
+  struct inode         *inode;
+  struct fat_mountpt_s *fs;
+  struct fat_file_s    *ff;
+  int                   ret;
+
+  /* Sanity checks */
+
+  DEBUGASSERT(filep->f_priv != NULL && filep->f_inode != NULL);
+
+  /* Recover our private data from the struct file instance */
+
+  ff    = filep->f_priv;
+  inode = filep->f_inode;
+  fs    = inode->i_private;
+
+  DEBUGASSERT(fs != NULL);
+
+  /* Make sure that the mount is still healthy */
+
+  fat_semtake(fs);
+  ret = fat_checkmount(fs);
+  if (ret != OK)
+    {
+      goto errout_with_semaphore;
+    }
+
+  /* Check if the file was opened for write access */
+
+  if ((ff->ff_oflags & O_WROK) == 0)
+    {
+      ret = -EACCES;
+      goto errout_with_semaphore;
+    }
+
+  /* Flush unwritten data in the file buffer */
+
+  ret = fat_ffcacheflush(fs, ff);
+  if (ret < 0)
+    {
+      goto errout_with_semaphore;
+    }
+
+  ret = fat_growfile(fs, ff, offset + len,
+                     (mode & FALLOC_FL_KEEP_SIZE) == 0);
+  fat_semgive(fs);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Commit the reservation to the media */
+
+  return fat_sync(filep);
+
+errout_with_semaphore:
+  fat_semgive(fs);
+  return ret;
+}
+
 /****************************************************************************
  * Name: fat_opendir
  *
@@ -1835,14 +2199,20 @@ static int fat_unbind(void *handle, FAR struct inode **blkdriver)
             }
         }
 
-      /* Release the mountpoint private data */
+      /* Write back anything still dirty in the sector cache, then release
+       * the mountpoint private data.
+       */
 
-      if (fs->fs_buffer)
-        {
-          fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
-        }
+      (void)fat_fscacheflush(fs);
+      fat_fscacheuninitialize(fs);
+#ifdef CONFIG_FAT_FREEMAP
+      fat_freemapuninitialize(fs);
+#endif
 
+      fat_semgive(fs);
+      sem_destroy(&fs->fs_sem);
       kfree(fs);
+      return OK;
     }
 
   fat_semgive(fs);
@@ -2055,11 +2425,11 @@ static int fat_mkdir(struct inode *mountpt, const char *relpath, mode_t mode)
       goto errout_with_semaphore;
     }
 
-  /* Flush any existing, dirty data in fs_buffer (because we need 
-   * it to create the directory entries.
+  /* Get a sector cache buffer for the first sector of the new directory.
+   * There is no need to read the sector; its contents are replaced.
    */
 
-  ret = fat_fscacheflush(fs);
+  ret = fat_fscachenew(fs, dirsector);
   if (ret < 0)
     {
       goto errout_with_semaphore;
@@ -2071,7 +2441,6 @@ static int fat_mkdir(struct inode *mountpt, const char *relpath, mode_t mode)
 
   /* Now erase the contents of fs_buffer */
 
-  fs->fs_currentsector = dirsector;
   memset(direntry, 0, fs->fs_hwsectorsize);
 
   /* Now clear all sectors in the new directory cluster (except for the first) */
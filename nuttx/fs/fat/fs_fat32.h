@@ -50,11 +50,76 @@
 
 #include <nuttx/kmalloc.h>
 #include <nuttx/fs/dirent.h>
+#include <nuttx/fs/fat.h>
+
+#if defined(CONFIG_FAT_FREEMAP) && defined(CONFIG_SCHED_WORKQUEUE)
+#  include <nuttx/wqueue.h>
+#endif
 
 /****************************************************************************
  * Definitions
  ****************************************************************************/
 
+/* Configuration ************************************************************/
+/* CONFIG_FAT_NCACHESECTORS - The number of FAT and directory sectors held
+ *   in the per-mountpoint sector cache.
+ */
+
+#ifndef CONFIG_FAT_NCACHESECTORS
+#  define CONFIG_FAT_NCACHESECTORS 4
+#endif
+
+#if CONFIG_FAT_NCACHESECTORS < 1
+#  error "CONFIG_FAT_NCACHESECTORS must be at least 1"
+#elif CONFIG_FAT_NCACHESECTORS > 255
+#  error "CONFIG_FAT_NCACHESECTORS must be no larger than 255"
+#endif
+
+/* CONFIG_FAT_NEXTENTS - The number of contiguous cluster runs remembered
+ *   for each open file.  Zero disables the extent map.
+ */
+
+#ifndef CONFIG_FAT_NEXTENTS
+#  define CONFIG_FAT_NEXTENTS 8
+#endif
+
+#if CONFIG_FAT_NEXTENTS > 255
+#  error "CONFIG_FAT_NEXTENTS must be no larger than 255"
+#endif
+
+/* CONFIG_FAT_FREEMAP - Keep an in-memory bitmap of the free clusters on
+ *   each mounted volume.
+ * CONFIG_FAT_FREEMAP_BATCH - The number of FAT sectors examined in each
+ *   step of building the bitmap.
+ * CONFIG_FAT_FREEMAP_MINRUN - When a file cannot be extended into the
+ *   cluster that follows it, prefer a free run of at least this many
+ *   clusters.
+ */
+
+#ifdef CONFIG_FAT_FREEMAP
+#  ifndef CONFIG_FAT_FREEMAP_BATCH
+#    define CONFIG_FAT_FREEMAP_BATCH 16
+#  endif
+#  ifndef CONFIG_FAT_FREEMAP_MINRUN
+#    define CONFIG_FAT_FREEMAP_MINRUN 8
+#  endif
+#endif
+
+/* CONFIG_FAT_NDIRCACHE - The number of directory entry locations remembered
+ *   for each mounted volume.  Must be a power of two.  Zero disables the
+ *   directory lookup cache.
+ */
+
+#ifndef CONFIG_FAT_NDIRCACHE
+#  define CONFIG_FAT_NDIRCACHE 0
+#endif
+
+#if (CONFIG_FAT_NDIRCACHE & (CONFIG_FAT_NDIRCACHE - 1)) != 0
+#  error "CONFIG_FAT_NDIRCACHE must be a power of two"
+#elif CONFIG_FAT_NDIRCACHE > 1024
+#  error "CONFIG_FAT_NDIRCACHE must be no larger than 1024"
+#endif
+
 /****************************************************************************
  * These offsets describes the master boot record.
  *
@@ -221,6 +286,7 @@
 #define SEC_NSECTORS(f,n)   ((n) / (f)->fs_hwsectorsize)
 
 #define CLUS_NDXMASK(f)     ((f)->fs_fatsecperclus - 1)
+#define CLUS_FILENDX(f,p)   (SEC_NSECTORS(f,p) / (f)->fs_fatsecperclus)
 
 /****************************************************************************
  * The FAT "long" file name (LFN) directory entry */
@@ -681,10 +747,11 @@
  * Name: fat_io_alloc and fat_io_free
  *
  * Description:
- *   The FAT file system allocates two I/O buffers for data transfer, each
- *   are the size of one device sector.  One of the buffers is allocated
- *   once for each FAT volume that is mounted; the other buffers are
- *   allocated each time a FAT file is opened.
+ *   The FAT file system allocates two kinds of I/O buffers for data
+ *   transfer, each a multiple of the size of one device sector.  The
+ *   sector cache (CONFIG_FAT_NCACHESECTORS sectors) is allocated once for
+ *   each FAT volume that is mounted; the other buffers are allocated each
+ *   time a FAT file is opened.
  *
  *   Some hardware, however, may require special DMA-capable memory in
  *   order to perform the the transfers.  If CONFIG_FAT_DMAMEMORY is defined
@@ -708,9 +775,48 @@
  * Public Types
  ****************************************************************************/
 
+/* This structure describes one line of the mountpoint sector cache.  The
+ * cache holds FAT and directory sectors.  When a sector that is not in the
+ * cache is needed, the least recently used line is written back (if dirty)
+ * and replaced.
+ */
+
+struct fat_cacheline_s
+{
+  off_t    cl_sector;              /* The sector held in this line (-1: none) */
+  uint32_t cl_lastuse;             /* Value of fs_cacheclock when last used */
+  bool     cl_dirty;               /* true: cl_buffer must be written back */
+  uint8_t *cl_buffer;              /* Sector buffer (part of fs_cachemem) */
+};
+
+/* This structure describes one entry of the mountpoint directory lookup
+ * cache.  It remembers where the directory entries for a name were last
+ * found:  The name and its parent directory are hashed to select the entry,
+ * and dc_cluster, dc_sector, and dc_offset give the position of the first
+ * directory entry of the name (the first long file name entry, if any).
+ * The name is always compared again at that position, so an entry is only
+ * a hint.
+ */
+
+#if CONFIG_FAT_NDIRCACHE > 0
+struct fat_dircache_s
+{
+  uint32_t dc_hash;                /* Hash of the name and the directory */
+  uint32_t dc_dircluster;          /* First cluster of the directory (0: FAT12/16 root) */
+  uint32_t dc_cluster;             /* Cluster containing the first entry */
+  off_t    dc_sector;              /* Sector containing the first entry (0: unused) */
+  uint16_t dc_offset;              /* Sector offset to the first entry */
+};
+#endif
+
 /* This structure represents the overall mountpoint state.  An instance of this
  * structure is retained as inode private data on each mountpoint that is
  * mounted with a fat32 filesystem.
+ *
+ * fs_currentsector, fs_dirty, and fs_buffer always describe the sector cache
+ * line that was most recently selected by fat_fscacheread() (or
+ * fat_fscachenew()).  Directory and FAT logic operates on that line exactly
+ * as it would on a single sector buffer.
  */
 
 struct fat_file_s;
@@ -726,7 +832,7 @@ struct fat_mountpt_s
   off_t    fs_rootbase;            /* MBR: Cluster no. of 1st cluster of root dir */
   off_t    fs_database;            /* Logical block of start data sectors */
   off_t    fs_fsinfo;              /* MBR: Sector number of FSINFO sector */
-  off_t    fs_currentsector;       /* The sector number buffered in fs_buffer */
+  off_t    fs_currentsector;       /* The sector number buffered in fs_buffer (-1: none) */
   uint32_t fs_nclusters;           /* Maximum number of data clusters */
   uint32_t fs_nfatsects;           /* MBR: Count of sectors occupied by one fat */
   uint32_t fs_fattotsec;           /* MBR: Total count of sectors on the volume */
@@ -740,10 +846,61 @@ struct fat_mountpt_s
   uint8_t  fs_type;                /* FSTYPE_FAT12, FSTYPE_FAT16, or FSTYPE_FAT32 */
   uint8_t  fs_fatnumfats;          /* MBR: Number of FATs (probably 2) */
   uint8_t  fs_fatsecperclus;       /* MBR: Sectors per allocation unit: 2**n, n=0..7 */
-  uint8_t *fs_buffer;              /* This is an allocated buffer to hold one sector
-                                    * from the device */
+  uint8_t  fs_cacheline;           /* Index of the cache line in fs_buffer */
+  uint32_t fs_cacheclock;          /* Incremented on each sector cache access */
+  uint8_t *fs_buffer;              /* The sector buffer of the current cache line */
+  uint8_t *fs_cachemem;            /* Allocated memory for all cache line buffers */
+  struct fat_cacheline_s fs_cache[CONFIG_FAT_NCACHESECTORS];
+  struct fat_cachestats_s fs_cachestats; /* Sector cache statistics */
+#ifdef CONFIG_FAT_FREEMAP
+  struct fat_freemap_s *fs_freemap; /* Free cluster bitmap (NULL: none) */
+#endif
+#if CONFIG_FAT_NDIRCACHE > 0
+  struct fat_dircache_s fs_dircache[CONFIG_FAT_NDIRCACHE];
+#endif
 };
 
+/* This structure holds the free cluster bitmap of a volume.  The bitmap is
+ * built by scanning the FAT a few sectors at a time after the volume is
+ * mounted; clusters below fm_next have been scanned and their bits are
+ * kept up to date as clusters are allocated and freed.
+ */
+
+#ifdef CONFIG_FAT_FREEMAP
+struct fat_freemap_s
+{
+#ifdef CONFIG_SCHED_WORKQUEUE
+  struct work_s fm_work;           /* Used to build the bitmap in the background */
+  struct fat_mountpt_s *fm_fs;     /* The volume (NULL: volume was unmounted) */
+  bool     fm_active;              /* true: fm_work is queued or running */
+#endif
+  uint32_t fm_next;                /* Clusters below this have been scanned */
+  uint32_t fm_nfree;               /* Number of free clusters below fm_next */
+  uint8_t *fm_buffer;              /* Sector buffer used while scanning */
+  uint32_t fm_bitmap[1];           /* One bit per cluster, set if the cluster is free */
+};
+
+#  define FAT_FREEMAPREADY(f) \
+  ((f)->fs_freemap && (f)->fs_freemap->fm_next >= (f)->fs_nclusters)
+#else
+#  define FAT_FREEMAPREADY(f) (false)
+#endif
+
+/* This structure describes one run of physically contiguous clusters in a
+ * file.  Each open file keeps a map of the runs that make up the front of
+ * its cluster chain so that file positions can be converted to sectors
+ * without following the chain through the FAT.
+ */
+
+#if CONFIG_FAT_NEXTENTS > 0
+struct fat_extent_s
+{
+  uint32_t fe_fileclust;           /* Index of the first cluster of the run in the file */
+  uint32_t fe_cluster;             /* First cluster of the run on the media */
+  uint32_t fe_nclusters;           /* Number of clusters in the run */
+};
+#endif
+
 /* This structure represents on open file under the mountpoint.  An instance
  * of this structure is retained as struct file specific information on each
  * opened file.
@@ -763,6 +920,10 @@ struct fat_file_s
   off_t    ff_currentsector;       /* Current sector being operated on */
   off_t    ff_cachesector;         /* Current sector in the file buffer */
   uint8_t *ff_buffer;              /* File buffer (for partial sector accesses) */
+#if CONFIG_FAT_NEXTENTS > 0
+  uint8_t  ff_nextents;            /* Number of valid entries in ff_extents[] */
+  struct fat_extent_s ff_extents[CONFIG_FAT_NEXTENTS]; /* Map of the cluster chain */
+#endif
 };
 
 /* This structure holds the sequency of directory entries used by one
@@ -917,12 +1078,59 @@ EXTERN int    fat_remove(struct fat_mountpt_s *fs, const char *relpath, bool dir
 
 /* Mountpoint and file buffer cache (for partial sector accesses) */
 
+EXTERN int    fat_fscacheinitialize(struct fat_mountpt_s *fs);
+EXTERN void   fat_fscacheuninitialize(struct fat_mountpt_s *fs);
 EXTERN int    fat_fscacheflush(struct fat_mountpt_s *fs);
 EXTERN int    fat_fscacheread(struct fat_mountpt_s *fs, off_t sector);
+EXTERN int    fat_fscachenew(struct fat_mountpt_s *fs, off_t sector);
+EXTERN uint8_t *fat_fscachepeek(struct fat_mountpt_s *fs, off_t sector);
 EXTERN int    fat_ffcacheflush(struct fat_mountpt_s *fs, struct fat_file_s *ff);
 EXTERN int    fat_ffcacheread(struct fat_mountpt_s *fs, struct fat_file_s *ff, off_t sector);
 EXTERN int    fat_ffcacheinvalidate(struct fat_mountpt_s *fs, struct fat_file_s *ff);
 
+/* File cluster extent map */
+
+#if CONFIG_FAT_NEXTENTS > 0
+EXTERN uint32_t fat_extentfind(struct fat_file_s *ff, uint32_t fileclust);
+EXTERN void   fat_extentappend(struct fat_file_s *ff, uint32_t fileclust,
+                               uint32_t cluster);
+EXTERN void   fat_extenttruncate(struct fat_file_s *ff, uint32_t nclusters);
+#else
+#  define fat_extentfind(ff,n)     ((void)(ff), (void)(n), 0)
+#  define fat_extentappend(ff,n,c) ((void)(ff), (void)(n), (void)(c))
+#  define fat_extenttruncate(ff,n) ((void)(ff), (void)(n))
+#endif
+EXTERN int32_t fat_extentlookup(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                               uint32_t *pfileclust);
+EXTERN uint32_t fat_contiguous(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                               uint32_t fileclust, uint32_t maxclusters,
+                               bool extend);
+EXTERN void   fat_advancesectors(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                                 unsigned int nsectors);
+
+/* File space preallocation and truncation */
+
+EXTERN int    fat_preallocate(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                              uint32_t nclusters);
+EXTERN int    fat_truncatechain(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                                uint32_t nclusters);
+EXTERN int    fat_zerofill(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                           off_t start, off_t end);
+
+/* Free cluster bitmap */
+
+#ifdef CONFIG_FAT_FREEMAP
+EXTERN int    fat_freemapinitialize(struct fat_mountpt_s *fs);
+EXTERN void   fat_freemapuninitialize(struct fat_mountpt_s *fs);
+EXTERN int    fat_freemapbuild(struct fat_mountpt_s *fs, uint32_t nsectors);
+EXTERN void   fat_freemapupdate(struct fat_mountpt_s *fs, uint32_t cluster,
+                                bool isfree);
+EXTERN uint32_t fat_freemapalloc(struct fat_mountpt_s *fs, uint32_t startcluster);
+EXTERN uint32_t fat_freemapallocrun(struct fat_mountpt_s *fs,
+                                    uint32_t startcluster,
+                                    uint32_t nclusters);
+#endif
+
 /* FSINFO sector support */
 
 EXTERN int    fat_updatefsinfo(struct fat_mountpt_s *fs);
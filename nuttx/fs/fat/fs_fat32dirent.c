@@ -153,6 +153,21 @@ static int fat_putlfname(struct fat_mountpt_s *fs, struct fat_dirinfo_s *dirinfo
 static int fat_putsfdirentry(struct fat_mountpt_s *fs,
                              struct fat_dirinfo_s *dirinfo,
                              uint8_t attributes, uint32_t fattime);
+#if CONFIG_FAT_NDIRCACHE > 0
+static uint32_t fat_dircachehash(struct fat_dirinfo_s *dirinfo);
+static void fat_dircachefirst(struct fat_dirinfo_s *dirinfo, off_t *cluster,
+                              off_t *sector, uint16_t *offset);
+static void fat_dircacheadd(struct fat_mountpt_s *fs,
+                            struct fat_dirinfo_s *dirinfo, uint32_t hash);
+static void fat_dircacheremove(struct fat_mountpt_s *fs, off_t sector,
+                               uint16_t offset);
+static void fat_dircacheremovedir(struct fat_mountpt_s *fs,
+                                  uint32_t dircluster);
+#endif
+static int fat_findentry(struct fat_mountpt_s *fs,
+                         struct fat_dirinfo_s *dirinfo);
+static int fat_lookupentry(struct fat_mountpt_s *fs,
+                           struct fat_dirinfo_s *dirinfo);
 
 /****************************************************************************
  * Private Variables
@@ -2235,6 +2250,289 @@ static int fat_putsfdirentry(struct fat_mountpt_s *fs,
   return OK;
 }
 
+/****************************************************************************
+ * Name: fat_dircachehash
+ *
+ * Desciption: Return the directory lookup cache hash of the path segment
+ *   name in dirinfo and the directory being searched (FNV-1a).
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_NDIRCACHE > 0
+static uint32_t fat_dircachehash(struct fat_dirinfo_s *dirinfo)
+{
+  const uint8_t *name;
+  uint32_t dircluster;
+  uint32_t hash;
+  int      len;
+  int      i;
+
+  /* Select the name that will be compared in the directory entries */
+
+#ifdef CONFIG_FAT_LFN
+  if (dirinfo->fd_lfname[0] != '\0')
+    {
+      name = dirinfo->fd_lfname;
+      len  = strlen((const char *)name);
+    }
+  else
+#endif
+    {
+      name = dirinfo->fd_name;
+      len  = DIR_MAXFNAME;
+    }
+
+  /* Hash the directory cluster and then the name.  Names that collide are
+   * told apart when the directory entries are compared.
+   */
+
+  dircluster = (uint32_t)dirinfo->dir.fd_startcluster;
+  hash       = 2166136261u;
+
+  for (i = 0; i < 4; i++)
+    {
+      hash ^= dircluster & 0xff;
+      hash *= 16777619u;
+      dircluster >>= 8;
+    }
+
+  for (i = 0; i < len; i++)
+    {
+      hash ^= name[i];
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_dircachefirst
+ *
+ * Desciption: Get the position of the first directory entry of the
+ *   sequence in dirinfo (the last long file name entry, if any, otherwise
+ *   the short file name entry).  The dirinfo must describe an entry that
+ *   was just found or allocated.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_NDIRCACHE > 0
+static void fat_dircachefirst(struct fat_dirinfo_s *dirinfo, off_t *cluster,
+                              off_t *sector, uint16_t *offset)
+{
+#ifdef CONFIG_FAT_LFN
+  *cluster = dirinfo->fd_seq.ds_lfncluster;
+  *sector  = dirinfo->fd_seq.ds_lfnsector;
+  *offset  = dirinfo->fd_seq.ds_lfnoffset;
+#else
+  *cluster = dirinfo->dir.fd_currcluster;
+  *sector  = dirinfo->fd_seq.ds_sector;
+  *offset  = dirinfo->fd_seq.ds_offset;
+#endif
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_dircacheadd
+ *
+ * Desciption: Remember the position of the directory entries in dirinfo,
+ *   replacing whatever the hash slot held before.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_NDIRCACHE > 0
+static void fat_dircacheadd(struct fat_mountpt_s *fs,
+                            struct fat_dirinfo_s *dirinfo, uint32_t hash)
+{
+  struct fat_dircache_s *entry;
+  off_t cluster;
+
+  entry = &fs->fs_dircache[hash & (CONFIG_FAT_NDIRCACHE - 1)];
+  fat_dircachefirst(dirinfo, &cluster, &entry->dc_sector, &entry->dc_offset);
+
+  entry->dc_hash       = hash;
+  entry->dc_dircluster = (uint32_t)dirinfo->dir.fd_startcluster;
+  entry->dc_cluster    = (uint32_t)cluster;
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_dircacheremove
+ *
+ * Desciption: Forget any name whose first directory entry is at the
+ *   specified position.  Called when the directory entries are freed.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_NDIRCACHE > 0
+static void fat_dircacheremove(struct fat_mountpt_s *fs, off_t sector,
+                               uint16_t offset)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_FAT_NDIRCACHE; i++)
+    {
+      if (fs->fs_dircache[i].dc_sector == sector &&
+          fs->fs_dircache[i].dc_offset == offset)
+        {
+          fs->fs_dircache[i].dc_sector = 0;
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_dircacheremovedir
+ *
+ * Desciption: Forget all names in a directory that is being removed.  Its
+ *   clusters may be reused for file data, so positions within it must not
+ *   be searched again, even if a new directory later starts at the same
+ *   cluster.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_NDIRCACHE > 0
+static void fat_dircacheremovedir(struct fat_mountpt_s *fs,
+                                  uint32_t dircluster)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_FAT_NDIRCACHE; i++)
+    {
+      if (fs->fs_dircache[i].dc_dircluster == dircluster)
+        {
+          fs->fs_dircache[i].dc_sector = 0;
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_findentry
+ *
+ * Desciption: Search the directory in dirinfo for the path segment name in
+ *   dirinfo, starting at the current directory position.
+ *
+ * NOTE: As a side effect, this function returns with the sector containing
+ *   the short file name directory entry in the cache.
+ *
+ ****************************************************************************/
+
+static int fat_findentry(struct fat_mountpt_s *fs,
+                         struct fat_dirinfo_s *dirinfo)
+{
+  /* Is this a path segment a long or a short file.  Was a long file
+   * name parsed?
+   */
+
+#ifdef CONFIG_FAT_LFN
+  if (dirinfo->fd_lfname[0] != '\0')
+    {
+      /* Yes.. Search for the sequence of long file name directory
+       * entries. NOTE: As a side effect, this function returns with
+       * the sector containing the short file name directory entry
+       * in the cache.
+       */
+
+      return fat_findlfnentry(fs, dirinfo);
+    }
+  else
+#endif
+    {
+      /* No.. Search for the single short file name directory entry */
+
+      return fat_findsfnentry(fs, dirinfo);
+    }
+}
+
+/****************************************************************************
+ * Name: fat_lookupentry
+ *
+ * Desciption: Search the directory in dirinfo for the path segment name in
+ *   dirinfo.  The directory position must be at the beginning of the
+ *   directory.
+ *
+ *   If the directory lookup cache remembers where the name was last seen,
+ *   the search is started there first.  The name is still compared with
+ *   the directory entries, so a stale cache entry only costs the extra
+ *   search.  Otherwise, the whole directory is searched and the position
+ *   of the name is remembered.
+ *
+ ****************************************************************************/
+
+static int fat_lookupentry(struct fat_mountpt_s *fs,
+                           struct fat_dirinfo_s *dirinfo)
+{
+#if CONFIG_FAT_NDIRCACHE > 0
+  struct fat_dircache_s *entry;
+  struct fs_fatdir_s     start;
+  uint32_t hash;
+  off_t    cluster;
+  off_t    sector;
+  uint16_t offset;
+  int      ret;
+
+  hash  = fat_dircachehash(dirinfo);
+  entry = &fs->fs_dircache[hash & (CONFIG_FAT_NDIRCACHE - 1)];
+
+  if (entry->dc_sector != 0 && entry->dc_hash == hash &&
+      entry->dc_dircluster == (uint32_t)dirinfo->dir.fd_startcluster)
+    {
+      /* Resume the search at the remembered position.  fd_index is the
+       * index of the entry within the current cluster (or within the
+       * fixed FAT12/16 root directory).
+       */
+
+      start = dirinfo->dir;
+
+      dirinfo->dir.fd_currcluster = entry->dc_cluster;
+      dirinfo->dir.fd_currsector  = entry->dc_sector;
+      dirinfo->dir.fd_index       = entry->dc_offset / DIR_SIZE +
+        (entry->dc_sector - (entry->dc_cluster == 0 ? fs->fs_rootbase :
+         fat_cluster2sector(fs, entry->dc_cluster))) * DIRSEC_NDIRS(fs);
+
+      ret = fat_findentry(fs, dirinfo);
+      if (ret == OK)
+        {
+          fat_dircachefirst(dirinfo, &cluster, &sector, &offset);
+          if (sector == entry->dc_sector && offset == entry->dc_offset)
+            {
+              /* Found where expected.  The search started part way
+               * through the directory, but the rest of the file system
+               * expects the sequence to describe the whole directory.
+               */
+
+#ifdef CONFIG_FAT_LFN
+              dirinfo->fd_seq.ds_startsector = start.fd_currsector;
+#endif
+              fs->fs_cachestats.cs_dirhits++;
+              return OK;
+            }
+        }
+      else if (ret != -ENOENT)
+        {
+          return ret;
+        }
+
+      /* The cache entry was stale.  Search again from the beginning */
+
+      dirinfo->dir = start;
+    }
+
+  fs->fs_cachestats.cs_dirmisses++;
+
+  ret = fat_findentry(fs, dirinfo);
+  if (ret == OK)
+    {
+      fat_dircacheadd(fs, dirinfo, hash);
+    }
+
+  return ret;
+#else
+  return fat_findentry(fs, dirinfo);
+#endif
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -2324,28 +2622,12 @@ int fat_finddirentry(struct fat_mountpt_s *fs, struct fat_dirinfo_s *dirinfo,
           return ret;
         }
 
-      /* Is this a path segment a long or a short file.  Was a long file
-       * name parsed?
+      /* Search the directory for the path segment.  NOTE: As a side
+       * effect, this function returns with the sector containing the
+       * short file name directory entry in the cache.
        */
 
-#ifdef CONFIG_FAT_LFN
-      if (dirinfo->fd_lfname[0] != '\0')
-        {
-          /* Yes.. Search for the sequence of long file name directory
-           * entries. NOTE: As a side effect, this function returns with
-           * the sector containing the short file name directory entry
-           * in the cache.
-           */
-
-          ret = fat_findlfnentry(fs, dirinfo);
-        }
-      else
-#endif
-        {
-          /* No.. Search for the single short file name directory entry */
-
-          ret = fat_findsfnentry(fs, dirinfo);
-        }
+      ret = fat_lookupentry(fs, dirinfo);
 
       /* Did we find the directory entries? */
 
@@ -2483,7 +2765,17 @@ int fat_allocatedirentry(struct fat_mountpt_s *fs, struct fat_dirinfo_s *dirinfo
        * (we can't handle other return values)
        */
 
-      if (ret == OK || ret != -ENOSPC)
+      if (ret == OK)
+        {
+#if CONFIG_FAT_NDIRCACHE > 0
+          /* Remember where the new name will be written */
+
+          fat_dircacheadd(fs, dirinfo, fat_dircachehash(dirinfo));
+#endif
+          return OK;
+        }
+
+      if (ret != -ENOSPC)
         {
           return ret;
         }
@@ -2513,31 +2805,34 @@ int fat_allocatedirentry(struct fat_mountpt_s *fs, struct fat_dirinfo_s *dirinfo
           return cluster;
         }
 
-     /* Flush out any cached data in fs_buffer.. we are going to use
-      * it to initialize the new directory cluster.
-      */
+      /* Clear all sectors comprising the new directory cluster.  The first
+       * sector is cleared in the sector cache (where the search will find
+       * it); the remaining sectors are written directly.
+       */
+
+      sector = fat_cluster2sector(fs, cluster);
+      if (sector < 0)
+        {
+          return sector;
+        }
 
-      ret = fat_fscacheflush(fs);
+      ret = fat_fscachenew(fs, sector);
       if (ret < 0)
         {
           return ret;
         }
 
-      /* Clear all sectors comprising the new directory cluster */
-
-      fs->fs_currentsector = fat_cluster2sector(fs, cluster);
       memset(fs->fs_buffer, 0, fs->fs_hwsectorsize);
+      fs->fs_dirty = true;
 
-      sector = fs->fs_currentsector;
-      for (i = fs->fs_fatsecperclus; i; i--)
+      for (i = fs->fs_fatsecperclus - 1; i; i--)
         {
+          sector++;
           ret = fat_hwwrite(fs, fs->fs_buffer, sector, 1);
           if (ret < 0)
             {
               return ret;
             }
-
-          sector++;
         }
 
       /* Start the search again */
@@ -2565,6 +2860,12 @@ int fat_freedirentry(struct fat_mountpt_s *fs, struct fat_dirseq_s *seq)
   off_t    startsector;
   int      ret;
 
+#if CONFIG_FAT_NDIRCACHE > 0
+  /* The name no longer exists at this position */
+
+  fat_dircacheremove(fs, seq->ds_lfnsector, seq->ds_lfnoffset);
+#endif
+
   /* Set it to the cluster containing the "last" LFN entry (that appears
    * first on the media).
    */
@@ -2629,6 +2930,12 @@ int fat_freedirentry(struct fat_mountpt_s *fs, struct fat_dirseq_s *seq)
   uint8_t *direntry;
   int      ret;
 
+#if CONFIG_FAT_NDIRCACHE > 0
+  /* The name no longer exists at this position */
+
+  fat_dircacheremove(fs, seq->ds_sector, seq->ds_offset);
+#endif
+
   /* Free the single short file name entry.
    *
    * Make sure that the sector containing the directory entry is in the
@@ -2930,14 +3237,27 @@ int fat_remove(struct fat_mountpt_s *fs, const char *relpath, bool directory)
               return -ENOTEMPTY;
             }
 
-          /* Get the next directory entry */
+          /* Get the next directory entry.  -ENOSPC means that the end of
+           * the directory cluster chain was reached without finding an
+           * end-of-directory marker; the directory is empty.
+           */
 
           ret = fat_nextdirentry(fs, &dirinfo.dir);
-          if (ret < 0)
+          if (ret == -ENOSPC)
+            {
+              break;
+            }
+          else if (ret < 0)
             {
               return ret;
             }
         }
+
+#if CONFIG_FAT_NDIRCACHE > 0
+      /* Forget any names that were found in the directory */
+
+      fat_dircacheremovedir(fs, dircluster);
+#endif
     }
   else
     {
@@ -0,0 +1,587 @@
+/****************************************************************************
+ * fs/fat/fs_fat32freemap.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <arch/irq.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/fat.h>
+
+#include "fs_internal.h"
+#include "fs_fat32.h"
+
+#ifdef CONFIG_FAT_FREEMAP
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+#define FREEMAP_ISFREE(m,c)   (((m)->fm_bitmap[(c) >> 5] & ((uint32_t)1 << ((c) & 31))) != 0)
+#define FREEMAP_SETFREE(m,c)  ((m)->fm_bitmap[(c) >> 5] |= ((uint32_t)1 << ((c) & 31)))
+#define FREEMAP_SETUSED(m,c)  ((m)->fm_bitmap[(c) >> 5] &= ~((uint32_t)1 << ((c) & 31)))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fat_freemaprun
+ *
+ * Desciption: Search clusters first through last-1 for a run of at least
+ *   'minrun' free clusters.  Whole words of the bitmap are skipped or
+ *   accepted at once where possible.
+ *
+ * Returned value:
+ *   The first cluster of the run or zero if there is no such run.
+ *
+ ****************************************************************************/
+
+static uint32_t fat_freemaprun(struct fat_freemap_s *fm, uint32_t first,
+                               uint32_t last, uint32_t minrun)
+{
+  uint32_t runstart = 0;
+  uint32_t runlen   = 0;
+  uint32_t cluster  = first;
+  uint32_t word;
+
+  while (cluster < last)
+    {
+      word = fm->fm_bitmap[cluster >> 5];
+
+      if ((cluster & 31) == 0 && cluster + 32 <= last)
+        {
+          if (word == 0)
+            {
+              /* 32 clusters in use */
+
+              runlen   = 0;
+              cluster += 32;
+              continue;
+            }
+          else if (word == 0xffffffff)
+            {
+              /* 32 free clusters */
+
+              if (runlen == 0)
+                {
+                  runstart = cluster;
+                }
+
+              runlen  += 32;
+              cluster += 32;
+
+              if (runlen >= minrun)
+                {
+                  return runstart;
+                }
+
+              continue;
+            }
+        }
+
+      if ((word & ((uint32_t)1 << (cluster & 31))) != 0)
+        {
+          if (runlen == 0)
+            {
+              runstart = cluster;
+            }
+
+          if (++runlen >= minrun)
+            {
+              return runstart;
+            }
+        }
+      else
+        {
+          runlen = 0;
+        }
+
+      cluster++;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: fat_freemapworker
+ *
+ * Desciption: Build a part of the free cluster bitmap on the low priority
+ *   work queue, then queue the next part.  The worker never waits for the
+ *   mountpoint semaphore:  If the volume is busy, it simply tries again
+ *   later.  Interrupts are disabled while the semaphore is taken so that
+ *   the volume cannot be unmounted between checking fm_fs and taking the
+ *   semaphore.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKQUEUE
+static void fat_freemapworker(FAR void *arg)
+{
+  struct fat_freemap_s *fm = (struct fat_freemap_s *)arg;
+  struct fat_mountpt_s *fs;
+  irqstate_t flags;
+  int ret;
+
+  flags = irqsave();
+  fs = fm->fm_fs;
+  if (!fs)
+    {
+      /* The volume was unmounted while this work was about to run.  The
+       * bitmap now belongs to the worker.
+       */
+
+      irqrestore(flags);
+      kfree(fm);
+      return;
+    }
+
+  if (sem_trywait(&fs->fs_sem) != OK)
+    {
+      /* The volume is in use; try again on the next tick */
+
+      (void)work_queue(LPWORK, &fm->fm_work, fat_freemapworker, fm, 1);
+      irqrestore(flags);
+      return;
+    }
+
+  irqrestore(flags);
+
+  /* Scan the next few FAT sectors */
+
+  ret = fat_freemapbuild(fs, CONFIG_FAT_FREEMAP_BATCH);
+  if (ret < 0)
+    {
+      /* The FAT could not be read.  Give up on the bitmap; allocations
+       * will fall back to searching the FAT.
+       */
+
+      fdbg("Free cluster bitmap disabled: %d\n", ret);
+      fm->fm_active = false;
+      fat_freemapuninitialize(fs);
+    }
+  else if (FAT_FREEMAPREADY(fs) || !fs->fs_mounted)
+    {
+      fm->fm_active = false;
+    }
+  else
+    {
+      (void)work_queue(LPWORK, &fm->fm_work, fat_freemapworker, fm, 0);
+    }
+
+  fat_semgive(fs);
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fat_freemapinitialize
+ *
+ * Desciption: Allocate the free cluster bitmap for a newly mounted volume
+ *   and start building it.  Until the bitmap is complete, allocations
+ *   search the FAT as before.
+ *
+ *   The caller should hold the mountpoint semaphore
+ *
+ ****************************************************************************/
+
+int fat_freemapinitialize(struct fat_mountpt_s *fs)
+{
+  struct fat_freemap_s *fm;
+  uint32_t nwords = (fs->fs_nclusters + 31) >> 5;
+
+  fm = (struct fat_freemap_s *)
+    kzalloc(sizeof(struct fat_freemap_s) + (nwords - 1) * sizeof(uint32_t));
+
+  if (!fm)
+    {
+      fdbg("No memory for the free cluster bitmap\n");
+      return -ENOMEM;
+    }
+
+  fm->fm_buffer = (uint8_t*)fat_io_alloc(fs->fs_hwsectorsize);
+  if (!fm->fm_buffer)
+    {
+      kfree(fm);
+      return -ENOMEM;
+    }
+
+  /* Clusters 0 and 1 are reserved */
+
+  fm->fm_next    = 2;
+  fs->fs_freemap = fm;
+
+#ifdef CONFIG_SCHED_WORKQUEUE
+  /* Let the low priority work queue build the bitmap in the background */
+
+  fm->fm_fs     = fs;
+  fm->fm_active = true;
+
+  if (work_queue(LPWORK, &fm->fm_work, fat_freemapworker, fm, 0) < 0)
+    {
+      fm->fm_active = false;
+    }
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_freemapuninitialize
+ *
+ * Desciption: Release the free cluster bitmap.  If the background worker
+ *   has been dequeued but has not yet run, the bitmap is handed over to the
+ *   worker to be freed.
+ *
+ *   The caller should hold the mountpoint semaphore
+ *
+ ****************************************************************************/
+
+void fat_freemapuninitialize(struct fat_mountpt_s *fs)
+{
+  struct fat_freemap_s *fm = fs->fs_freemap;
+#ifdef CONFIG_SCHED_WORKQUEUE
+  irqstate_t flags;
+#endif
+
+  if (!fm)
+    {
+      return;
+    }
+
+  fs->fs_freemap = NULL;
+  if (fm->fm_buffer)
+    {
+      fat_io_free(fm->fm_buffer, fs->fs_hwsectorsize);
+      fm->fm_buffer = NULL;
+    }
+
+#ifdef CONFIG_SCHED_WORKQUEUE
+  flags = irqsave();
+  if (fm->fm_active && work_available(&fm->fm_work))
+    {
+      /* The worker is about to run and will free the bitmap */
+
+      fm->fm_fs = NULL;
+      irqrestore(flags);
+      return;
+    }
+
+  (void)work_cancel(LPWORK, &fm->fm_work);
+  irqrestore(flags);
+#endif
+
+  kfree(fm);
+}
+
+/****************************************************************************
+ * Name: fat_freemapbuild
+ *
+ * Desciption: Scan up to 'nsectors' more sectors of the FAT into the free
+ *   cluster bitmap.  FAT sectors that are in the sector cache are used from
+ *   the cache; others are read into a private buffer so that scanning does
+ *   not displace the cached FAT and directory sectors.  When the scan
+ *   completes, the FSINFO free cluster count is corrected.
+ *
+ *   The caller should hold the mountpoint semaphore
+ *
+ ****************************************************************************/
+
+int fat_freemapbuild(struct fat_mountpt_s *fs, uint32_t nsectors)
+{
+  struct fat_freemap_s *fm = fs->fs_freemap;
+  uint8_t *buffer;
+  uint32_t nentries;
+  uint32_t ndx;
+  uint32_t value;
+  off_t    sector;
+  off_t    next;
+  int      ret;
+
+  if (!fm || fm->fm_next >= fs->fs_nclusters)
+    {
+      return OK;
+    }
+
+  if (fs->fs_type == FSTYPE_FAT12)
+    {
+      /* FAT12 entries may straddle sectors, but FAT12 volumes are small.
+       * Just look up each cluster in turn.
+       */
+
+      nentries = (2 * fs->fs_hwsectorsize) / 3;
+      for (ndx = nsectors * nentries;
+           ndx > 0 && fm->fm_next < fs->fs_nclusters;
+           ndx--, fm->fm_next++)
+        {
+          next = fat_getcluster(fs, fm->fm_next);
+          if (next < 0)
+            {
+              return (int)next;
+            }
+          else if (next == 0)
+            {
+              FREEMAP_SETFREE(fm, fm->fm_next);
+              fm->fm_nfree++;
+            }
+        }
+    }
+  else
+    {
+      nentries = fs->fs_hwsectorsize / (fs->fs_type == FSTYPE_FAT16 ? 2 : 4);
+
+      for (; nsectors > 0 && fm->fm_next < fs->fs_nclusters; nsectors--)
+        {
+          sector = fs->fs_fatbase + fm->fm_next / nentries;
+          buffer = fat_fscachepeek(fs, sector);
+          if (!buffer)
+            {
+              ret = fat_hwread(fs, fm->fm_buffer, sector, 1);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+
+              buffer = fm->fm_buffer;
+            }
+
+          for (ndx = fm->fm_next % nentries;
+               ndx < nentries && fm->fm_next < fs->fs_nclusters;
+               ndx++, fm->fm_next++)
+            {
+              if (fs->fs_type == FSTYPE_FAT16)
+                {
+                  value = FAT_GETFAT16(buffer, ndx << 1);
+                }
+              else
+                {
+                  value = FAT_GETFAT32(buffer, ndx << 2) & 0x0fffffff;
+                }
+
+              if (value == 0)
+                {
+                  FREEMAP_SETFREE(fm, fm->fm_next);
+                  fm->fm_nfree++;
+                }
+            }
+        }
+    }
+
+  if (fm->fm_next >= fs->fs_nclusters)
+    {
+      /* The bitmap is complete.  The scan buffer is no longer needed and
+       * the free cluster count is now known exactly.
+       */
+
+      if (fm->fm_buffer)
+        {
+          fat_io_free(fm->fm_buffer, fs->fs_hwsectorsize);
+          fm->fm_buffer = NULL;
+        }
+
+      if (fs->fs_fsifreecount != fm->fm_nfree)
+        {
+          fs->fs_fsifreecount = fm->fm_nfree;
+          fs->fs_fsidirty     = (fs->fs_type == FSTYPE_FAT32);
+        }
+
+      fvdbg("Free cluster bitmap complete: %d free\n", fm->fm_nfree);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_freemapupdate
+ *
+ * Desciption: Record that 'cluster' was allocated or freed.  Clusters that
+ *   have not been scanned yet are ignored; their state will be picked up
+ *   from the FAT when they are scanned.
+ *
+ ****************************************************************************/
+
+void fat_freemapupdate(struct fat_mountpt_s *fs, uint32_t cluster,
+                       bool isfree)
+{
+  struct fat_freemap_s *fm = fs->fs_freemap;
+
+  if (!fm || cluster < 2 || cluster >= fm->fm_next)
+    {
+      return;
+    }
+
+  if (isfree && !FREEMAP_ISFREE(fm, cluster))
+    {
+      FREEMAP_SETFREE(fm, cluster);
+      fm->fm_nfree++;
+    }
+  else if (!isfree && FREEMAP_ISFREE(fm, cluster))
+    {
+      FREEMAP_SETUSED(fm, cluster);
+      fm->fm_nfree--;
+    }
+}
+
+/****************************************************************************
+ * Name: fat_freemapalloc
+ *
+ * Desciption: Choose a free cluster to follow 'startcluster' using the
+ *   completed free cluster bitmap.  The cluster immediately after
+ *   'startcluster' is used if it is free so that files stay contiguous.
+ *   Otherwise, the start of the next run of at least
+ *   CONFIG_FAT_FREEMAP_MINRUN free clusters is preferred over isolated free
+ *   clusters.  The cluster is not marked as allocated.
+ *
+ * Returned value:
+ *   The cluster number or zero if there are no free clusters.
+ *
+ ****************************************************************************/
+
+uint32_t fat_freemapalloc(struct fat_mountpt_s *fs, uint32_t startcluster)
+{
+  struct fat_freemap_s *fm = fs->fs_freemap;
+  uint32_t first = startcluster + 1;
+  uint32_t cluster;
+
+  if (first < 2 || first >= fs->fs_nclusters)
+    {
+      first = 2;
+    }
+
+  if (FREEMAP_ISFREE(fm, first))
+    {
+      return first;
+    }
+
+  /* Search forward (wrapping) for a long enough run, then for any free
+   * cluster at all.
+   */
+
+  cluster = fat_freemaprun(fm, first, fs->fs_nclusters,
+                           CONFIG_FAT_FREEMAP_MINRUN);
+  if (!cluster)
+    {
+      cluster = fat_freemaprun(fm, 2, first, CONFIG_FAT_FREEMAP_MINRUN);
+    }
+
+  if (!cluster)
+    {
+      cluster = fat_freemaprun(fm, first, fs->fs_nclusters, 1);
+    }
+
+  if (!cluster)
+    {
+      cluster = fat_freemaprun(fm, 2, first, 1);
+    }
+
+  return cluster;
+}
+
+/****************************************************************************
+ * Name: fat_freemapallocrun
+ *
+ * Desciption: Find 'nclusters' contiguous free clusters to follow
+ *   'startcluster' using the completed free cluster bitmap.  The clusters
+ *   immediately after 'startcluster' are used if they are all free;
+ *   otherwise the first long enough run on the volume is used.  The
+ *   clusters are not marked as allocated.
+ *
+ * Returned value:
+ *   The first cluster of the run or zero if there is no such run.
+ *
+ ****************************************************************************/
+
+uint32_t fat_freemapallocrun(struct fat_mountpt_s *fs, uint32_t startcluster,
+                             uint32_t nclusters)
+{
+  struct fat_freemap_s *fm = fs->fs_freemap;
+  uint32_t first = startcluster + 1;
+  uint32_t cluster;
+
+  if (first < 2 || first >= fs->fs_nclusters)
+    {
+      first = 2;
+    }
+
+  if (nclusters > fs->fs_nclusters - 2)
+    {
+      return 0;
+    }
+
+  /* Search forward from 'first' (so the run will start at 'first' if that
+   * is possible), then wrap around and search the whole volume.
+   */
+
+  cluster = fat_freemaprun(fm, first, fs->fs_nclusters, nclusters);
+  if (!cluster)
+    {
+      cluster = fat_freemaprun(fm, 2, fs->fs_nclusters, nclusters);
+    }
+
+  return cluster;
+}
+
+#endif /* CONFIG_FAT_FREEMAP */
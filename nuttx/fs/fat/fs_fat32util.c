@@ -284,6 +284,239 @@ static int fat_checkbootrecord(struct fat_mountpt_s *fs)
   return OK;
 }
 
+/****************************************************************************
+ * Name: fat_blkwrite
+ *
+ * Desciption: Write sectors to the block driver.  Unlike fat_hwwrite(),
+ *   this does not discard cached copies of the sectors.
+ *
+ ****************************************************************************/
+
+static int fat_blkwrite(struct fat_mountpt_s *fs, uint8_t *buffer,
+                        off_t sector, unsigned int nsectors)
+{
+  int ret = -ENODEV;
+  if (fs && fs->fs_blkdriver )
+    {
+      struct inode *inode = fs->fs_blkdriver;
+      if (inode && inode->u.i_bops && inode->u.i_bops->write)
+        {
+          ssize_t nSectorsWritten =
+              inode->u.i_bops->write(inode, buffer, sector, nsectors);
+
+          if (nSectorsWritten == nsectors)
+            {
+              ret = OK;
+            }
+          else if (nSectorsWritten < 0)
+            {
+              ret = nSectorsWritten;
+            }
+        }
+    }
+  return ret;
+}
+
+/****************************************************************************
+ * Name: fat_isfatsector
+ *
+ * Desciption: Return true if the sector lies in the first FAT.  Changes to
+ *   such sectors must also be made in each redundant FAT copy.
+ *
+ ****************************************************************************/
+
+static inline bool fat_isfatsector(struct fat_mountpt_s *fs, off_t sector)
+{
+  return sector >= fs->fs_fatbase &&
+         sector <  fs->fs_fatbase + fs->fs_nfatsects;
+}
+
+/****************************************************************************
+ * Name: fat_cachesave
+ *
+ * Desciption: The directory and FAT logic marks the current sector as
+ *   modified by setting fs_dirty.  Save that state in the current cache
+ *   line before another line is selected.
+ *
+ ****************************************************************************/
+
+static inline void fat_cachesave(struct fat_mountpt_s *fs)
+{
+  fs->fs_cache[fs->fs_cacheline].cl_dirty = fs->fs_dirty;
+}
+
+/****************************************************************************
+ * Name: fat_cacheselect
+ *
+ * Desciption: Make the cache line at 'ndx' the current sector buffer and
+ *   mark it as the most recently used line.
+ *
+ ****************************************************************************/
+
+static void fat_cacheselect(struct fat_mountpt_s *fs, int ndx)
+{
+  struct fat_cacheline_s *line = &fs->fs_cache[ndx];
+
+  line->cl_lastuse     = ++fs->fs_cacheclock;
+  fs->fs_cacheline     = ndx;
+  fs->fs_currentsector = line->cl_sector;
+  fs->fs_dirty         = line->cl_dirty;
+  fs->fs_buffer        = line->cl_buffer;
+}
+
+/****************************************************************************
+ * Name: fat_cachefind
+ *
+ * Desciption: Return the index of the cache line holding 'sector' or -1 if
+ *   the sector is not in the cache.
+ *
+ ****************************************************************************/
+
+static int fat_cachefind(struct fat_mountpt_s *fs, off_t sector)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_FAT_NCACHESECTORS; i++)
+    {
+      if (fs->fs_cache[i].cl_sector == sector)
+        {
+          return i;
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: fat_cachewrite
+ *
+ * Desciption: Write back one dirty cache line.  Sectors in the FAT region
+ *   are also written to each redundant FAT copy.
+ *
+ ****************************************************************************/
+
+static int fat_cachewrite(struct fat_mountpt_s *fs,
+                          struct fat_cacheline_s *line)
+{
+  off_t sector;
+  int ret;
+  int i;
+
+  ret = fat_blkwrite(fs, line->cl_buffer, line->cl_sector, 1);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  fs->fs_cachestats.cs_writes++;
+
+  if (fat_isfatsector(fs, line->cl_sector))
+    {
+      sector = line->cl_sector;
+      for (i = fs->fs_fatnumfats; i >= 2; i--)
+        {
+          sector += fs->fs_nfatsects;
+          ret = fat_blkwrite(fs, line->cl_buffer, sector, 1);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          fs->fs_cachestats.cs_mirrorwrites++;
+        }
+    }
+
+  line->cl_dirty = false;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_cachereplace
+ *
+ * Desciption: Select the cache line to hold a new sector:  An unused line
+ *   if there is one, otherwise the least recently used line.  The contents
+ *   of the line are written back if dirty.  On success, the index of the
+ *   line is returned; the line is unassigned and must be assigned by the
+ *   caller.
+ *
+ ****************************************************************************/
+
+static int fat_cachereplace(struct fat_mountpt_s *fs)
+{
+  struct fat_cacheline_s *line;
+  uint32_t oldest = 0;
+  uint32_t age;
+  int ndx = 0;
+  int ret;
+  int i;
+
+  for (i = 0; i < CONFIG_FAT_NCACHESECTORS; i++)
+    {
+      line = &fs->fs_cache[i];
+      if (line->cl_sector < 0)
+        {
+          return i;
+        }
+
+      /* The age is computed so that it is correct even if the clock wraps */
+
+      age = fs->fs_cacheclock - line->cl_lastuse;
+      if (age >= oldest)
+        {
+          oldest = age;
+          ndx    = i;
+        }
+    }
+
+  line = &fs->fs_cache[ndx];
+  if (line->cl_dirty)
+    {
+      ret = fat_cachewrite(fs, line);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  line->cl_sector = -1;
+  return ndx;
+}
+
+/****************************************************************************
+ * Name: fat_cachediscard
+ *
+ * Desciption: Discard any cached copies of sectors that are about to be
+ *   overwritten on the media by fat_hwwrite().
+ *
+ ****************************************************************************/
+
+static void fat_cachediscard(struct fat_mountpt_s *fs, off_t sector,
+                             unsigned int nsectors)
+{
+  struct fat_cacheline_s *line;
+  int i;
+
+  if (fs->fs_cachemem)
+    {
+      for (i = 0; i < CONFIG_FAT_NCACHESECTORS; i++)
+        {
+          line = &fs->fs_cache[i];
+          if (line->cl_sector >= sector &&
+              line->cl_sector <  sector + nsectors)
+            {
+              line->cl_sector = -1;
+              line->cl_dirty  = false;
+
+              if (i == fs->fs_cacheline)
+                {
+                  fs->fs_currentsector = -1;
+                  fs->fs_dirty         = false;
+                }
+            }
+        }
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -541,12 +774,13 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
   fs->fs_hwsectorsize = geo.geo_sectorsize;
   fs->fs_hwnsectors   = geo.geo_nsectors;
 
-  /* Allocate a buffer to hold one hardware sector */
+  /* Allocate the sector cache.  fs_buffer will refer to the first (empty)
+   * cache line.
+   */
 
-  fs->fs_buffer = (uint8_t*)fat_io_alloc(fs->fs_hwsectorsize);
-  if (!fs->fs_buffer)
+  ret = fat_fscacheinitialize(fs);
+  if (ret < 0)
     {
-      ret = -ENOMEM;
       goto errout;
     }
 
@@ -666,11 +900,18 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
   fdbg("\tFSI free count       %d\n", fs->fs_fsifreecount);
   fdbg("\t    next free        %d\n", fs->fs_fsinextfree);
 
+#ifdef CONFIG_FAT_FREEMAP
+  /* Start building the free cluster bitmap.  The volume is usable without
+   * the bitmap, so a failure here is not fatal.
+   */
+
+  (void)fat_freemapinitialize(fs);
+#endif
+
   return OK;
 
  errout_with_buffer:
-  fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
-  fs->fs_buffer = 0;
+  fat_fscacheuninitialize(fs);
 
  errout:
   fs->fs_mounted = false;
@@ -754,33 +995,18 @@ int fat_hwread(struct fat_mountpt_s *fs, uint8_t *buffer,  off_t sector,
 /****************************************************************************
  * Name: fat_hwwrite
  *
- * Desciption: Write the sector buffer to the specified sector
+ * Desciption: Write the sector buffer to the specified sector, discarding
+ *   any copies of the sector held in the sector cache.
  *
  ****************************************************************************/
 
 int fat_hwwrite(struct fat_mountpt_s *fs, uint8_t *buffer, off_t sector,
                 unsigned int nsectors)
 {
-  int ret = -ENODEV;
-  if (fs && fs->fs_blkdriver )
-    {
-      struct inode *inode = fs->fs_blkdriver;
-      if (inode && inode->u.i_bops && inode->u.i_bops->write)
-        {
-          ssize_t nSectorsWritten =
-              inode->u.i_bops->write(inode, buffer, sector, nsectors);
+  /* Any copy of these sectors in the sector cache is now stale */
 
-          if (nSectorsWritten == nsectors)
-            {
-              ret = OK;
-            }
-          else if (nSectorsWritten < 0)
-            {
-              ret = nSectorsWritten;
-            }
-        }
-    }
-  return ret;
+  fat_cachediscard(fs, sector, nsectors);
+  return fat_blkwrite(fs, buffer, sector, nsectors);
 }
 
 /****************************************************************************
@@ -1084,6 +1310,12 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno, off_t nextclust
               return -EINVAL;
         }
 
+#ifdef CONFIG_FAT_FREEMAP
+      /* Keep the free cluster bitmap in step with the FAT */
+
+      fat_freemapupdate(fs, clusterno, nextcluster == 0);
+#endif
+
       /* Mark the modified sector as "dirty" and return success */
 
       fs->fs_dirty = true;
@@ -1205,61 +1437,84 @@ int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
       startcluster = cluster;
     }
 
-  /* Loop until (1) we discover that there are not free clusters
-   * (return 0), an errors occurs (return -errno), or (3) we find
-   * the next cluster (return the new cluster number).
-   */
+#ifdef CONFIG_FAT_FREEMAP
+  if (FAT_FREEMAPREADY(fs))
+    {
+      /* The free cluster bitmap is complete; search it instead of the FAT */
 
-  newcluster = startcluster;
-  for (;;)
+      newcluster = fat_freemapalloc(fs, startcluster);
+      if (newcluster == 0)
+        {
+          return 0;
+        }
+    }
+  else
+#endif
     {
-      /* Examine the next cluster in the FAT */
+#if defined(CONFIG_FAT_FREEMAP) && !defined(CONFIG_SCHED_WORKQUEUE)
+      /* There is no background worker to build the free cluster bitmap, so
+       * advance it a little each time that a cluster is allocated.
+       */
+
+      (void)fat_freemapbuild(fs, CONFIG_FAT_FREEMAP_BATCH);
+#endif
+
+      /* Loop until (1) we discover that there are not free clusters
+       * (return 0), an errors occurs (return -errno), or (3) we find
+       * the next cluster (return the new cluster number).
+       */
 
-      newcluster++;
-      if (newcluster >= fs->fs_nclusters)
+      newcluster = startcluster;
+      for (;;)
         {
-          /* If we hit the end of the available clusters, then
-           * wrap back to the beginning because we might have
-           * started at a non-optimal place.  But don't continue
-           * past the start cluster.
-           */
+          /* Examine the next cluster in the FAT */
 
-          newcluster = 2;
-          if (newcluster > startcluster)
+          newcluster++;
+          if (newcluster >= fs->fs_nclusters)
             {
-              /* We are back past the starting cluster, then there
-               * is no free cluster.
+              /* If we hit the end of the available clusters, then
+               * wrap back to the beginning because we might have
+               * started at a non-optimal place.  But don't continue
+               * past the start cluster.
                */
 
-              return 0;
+              newcluster = 2;
+              if (newcluster > startcluster)
+                {
+                  /* We are back past the starting cluster, then there
+                   * is no free cluster.
+                   */
+
+                  return 0;
+                }
             }
-        }
 
-      /* We have a candidate cluster.  Check if the cluster number is
-       * mapped to a group of sectors.
-       */
+          /* We have a candidate cluster.  Check if the cluster number is
+           * mapped to a group of sectors.
+           */
 
-      startsector = fat_getcluster(fs, newcluster);
-      if (startsector == 0)
-        {
-          /* Found have found a free cluster break out */
+          startsector = fat_getcluster(fs, newcluster);
+          if (startsector == 0)
+            {
+              /* Found have found a free cluster break out */
 
-          break;
-        }
-      else if (startsector < 0)
-        {
-          /* Some error occurred, return the error number */
+              break;
+            }
+          else if (startsector < 0)
+            {
+              /* Some error occurred, return the error number */
 
-          return startsector;
-        }
+              return startsector;
+            }
 
-      /* We wrap all the back to the starting cluster?  If so, then
-       * there are no free clusters.
-       */
+          /* We wrap all the back to the starting cluster?  If so, then
+           * there are no free clusters.
+           */
 
-      if (newcluster == startcluster)
-        {
-          return 0;
+          if (newcluster == startcluster)
+            {
+              return 0;
+            }
         }
     }
 
@@ -1462,114 +1717,288 @@ int  fat_dirtruncate(struct fat_mountpt_s *fs, struct fat_dirinfo_s *dirinfo)
 }
 
 /****************************************************************************
- * Name: fat_fscacheflush
+ * Name: fat_fscacheinitialize
  *
- * Desciption: Flush any dirty sector if fs_buffer as necessary
+ * Desciption: Allocate the sector cache for the mountpoint.  The cache
+ *   starts out empty.
  *
  ****************************************************************************/
 
-int fat_fscacheflush(struct fat_mountpt_s *fs)
+int fat_fscacheinitialize(struct fat_mountpt_s *fs)
 {
-  int ret;
+  struct fat_cacheline_s *line;
+  int i;
 
-  /* Check if the fs_buffer is dirty.  In this case, we will write back the
-   * contents of fs_buffer.
-   */
+  fs->fs_cachemem = (uint8_t*)
+    fat_io_alloc(CONFIG_FAT_NCACHESECTORS * fs->fs_hwsectorsize);
 
-  if (fs->fs_dirty)
+  if (!fs->fs_cachemem)
     {
-      /* Write the dirty sector */
-
-      ret = fat_hwwrite(fs, fs->fs_buffer, fs->fs_currentsector, 1);
-      if (ret < 0)
-        {
-          return ret;
-        }
+      return -ENOMEM;
+    }
 
-      /* Does the sector lie in the FAT region? */
+  for (i = 0; i < CONFIG_FAT_NCACHESECTORS; i++)
+    {
+      line             = &fs->fs_cache[i];
+      line->cl_sector  = -1;
+      line->cl_lastuse = 0;
+      line->cl_dirty   = false;
+      line->cl_buffer  = &fs->fs_cachemem[i * fs->fs_hwsectorsize];
+    }
 
-      if (fs->fs_currentsector >= fs->fs_fatbase &&
-          fs->fs_currentsector < fs->fs_fatbase + fs->fs_nfatsects)
-        {
-          /* Yes, then make the change in the FAT copy as well */
-          int i;
+  memset(&fs->fs_cachestats, 0, sizeof(struct fat_cachestats_s));
+  fs->fs_cachestats.cs_nsectors = CONFIG_FAT_NCACHESECTORS;
 
-          for (i = fs->fs_fatnumfats; i >= 2; i--)
-            {
-              fs->fs_currentsector += fs->fs_nfatsects;
-              ret = fat_hwwrite(fs, fs->fs_buffer, fs->fs_currentsector, 1);
-              if (ret < 0)
-                {
-                  return ret;
-                }
-            }
-        }
+#if CONFIG_FAT_NDIRCACHE > 0
+  /* The directory lookup cache also starts out empty */
 
-      /* No longer dirty */
+  memset(fs->fs_dircache, 0, sizeof(fs->fs_dircache));
+#endif
 
-      fs->fs_dirty = false;
-    }
+  fs->fs_cacheclock = 0;
+  fat_cacheselect(fs, 0);
   return OK;
 }
 
 /****************************************************************************
- * Name: fat_fscacheread
+ * Name: fat_fscacheuninitialize
  *
- * Desciption: Read the specified sector into the sector cache, flushing any
- *   existing dirty sectors as necessary.
+ * Desciption: Free the sector cache.  Any dirty sectors are lost; the
+ *   caller should first call fat_fscacheflush() if they matter.
  *
  ****************************************************************************/
 
-int fat_fscacheread(struct fat_mountpt_s *fs, off_t sector)
+void fat_fscacheuninitialize(struct fat_mountpt_s *fs)
 {
-  int ret;
-
-  /* fs->fs_currentsector holds the current sector that is buffered in
-   * fs->fs_buffer. If the requested sector is the same as this sector, then
-   * we do nothing. Otherwise, we will have to read the new sector.
-   */
-
-    if (fs->fs_currentsector != sector)
-      {
-        /* We will need to read the new sector.  First, flush the cached
-         * sector if it is dirty.
-         */
-
-        ret = fat_fscacheflush(fs);
-        if (ret < 0)
-          {
-              return ret;
-          }
-
-        /* Then read the specified sector into the cache */
-
-        ret = fat_hwread(fs, fs->fs_buffer, sector, 1);
-        if (ret < 0)
-          {
-            return ret;
-          }
-
-        /* Update the cached sector number */
-
-        fs->fs_currentsector = sector;
+  if (fs->fs_cachemem)
+    {
+      fat_io_free(fs->fs_cachemem,
+                  CONFIG_FAT_NCACHESECTORS * fs->fs_hwsectorsize);
     }
 
-    return OK;
+  fs->fs_cachemem      = NULL;
+  fs->fs_buffer        = NULL;
+  fs->fs_currentsector = -1;
+  fs->fs_dirty         = false;
 }
 
 /****************************************************************************
- * Name: fat_ffcacheflush
+ * Name: fat_fscacheflush
  *
- * Desciption: Flush any dirty sectors as necessary
+ * Desciption: Write back all dirty sectors in the sector cache.  Sectors
+ *   are written in ascending order and the redundant FAT copies are
+ *   written only after all of the primary sectors, one FAT copy at a time.
+ *   The sectors remain valid in the cache.
  *
  ****************************************************************************/
 
-int fat_ffcacheflush(struct fat_mountpt_s *fs, struct fat_file_s *ff)
+int fat_fscacheflush(struct fat_mountpt_s *fs)
 {
+  struct fat_cacheline_s *line;
+  uint8_t dirty[CONFIG_FAT_NCACHESECTORS];
+  off_t sector;
+  int ndirty;
   int ret;
+  int i;
+  int j;
 
-  /* Check if the ff_buffer is dirty.  In this case, we will write back the
-   * contents of ff_buffer.
+  /* Collect the dirty cache lines, sorted by sector number */
+
+  fat_cachesave(fs);
+
+  for (i = 0, ndirty = 0; i < CONFIG_FAT_NCACHESECTORS; i++)
+    {
+      line = &fs->fs_cache[i];
+      if (line->cl_dirty && line->cl_sector >= 0)
+        {
+          for (j = ndirty;
+               j > 0 && fs->fs_cache[dirty[j-1]].cl_sector > line->cl_sector;
+               j--)
+            {
+              dirty[j] = dirty[j-1];
+            }
+
+          dirty[j] = i;
+          ndirty++;
+        }
+    }
+
+  if (ndirty == 0)
+    {
+      return OK;
+    }
+
+  /* Write the dirty sectors */
+
+  for (i = 0; i < ndirty; i++)
+    {
+      line = &fs->fs_cache[dirty[i]];
+      ret  = fat_blkwrite(fs, line->cl_buffer, line->cl_sector, 1);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      fs->fs_cachestats.cs_writes++;
+    }
+
+  /* Then make the same changes in each FAT copy */
+
+  for (j = 1; j < fs->fs_fatnumfats; j++)
+    {
+      for (i = 0; i < ndirty; i++)
+        {
+          line = &fs->fs_cache[dirty[i]];
+          if (fat_isfatsector(fs, line->cl_sector))
+            {
+              sector = line->cl_sector + j * fs->fs_nfatsects;
+              ret    = fat_blkwrite(fs, line->cl_buffer, sector, 1);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+
+              fs->fs_cachestats.cs_mirrorwrites++;
+            }
+        }
+    }
+
+  /* No longer dirty */
+
+  for (i = 0; i < ndirty; i++)
+    {
+      fs->fs_cache[dirty[i]].cl_dirty = false;
+    }
+
+  fs->fs_dirty = false;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_fscacheread
+ *
+ * Desciption: Make the specified sector the current sector in fs_buffer,
+ *   reading it into the sector cache if it is not already there.  If the
+ *   sector must be read, the least recently used sector is replaced,
+ *   writing it back first if it is dirty.
+ *
+ ****************************************************************************/
+
+int fat_fscacheread(struct fat_mountpt_s *fs, off_t sector)
+{
+  int ndx;
+  int ret;
+
+  /* fs->fs_currentsector holds the current sector that is buffered in
+   * fs->fs_buffer. If the requested sector is the same as this sector, then
+   * we do nothing.
+   */
+
+  if (fs->fs_currentsector == sector)
+    {
+      fs->fs_cachestats.cs_hits++;
+      return OK;
+    }
+
+  /* Otherwise, check if the sector is elsewhere in the cache */
+
+  fat_cachesave(fs);
+
+  ndx = fat_cachefind(fs, sector);
+  if (ndx >= 0)
+    {
+      fs->fs_cachestats.cs_hits++;
+      fat_cacheselect(fs, ndx);
+      return OK;
+    }
+
+  /* We will need to read the new sector.  First, get a cache line for it
+   * (possibly flushing the sector that it now holds).
+   */
+
+  ndx = fat_cachereplace(fs);
+  if (ndx < 0)
+    {
+      return ndx;
+    }
+
+  /* Then read the specified sector into the cache.  On a failure, the
+   * line is left unassigned.
+   */
+
+  fs->fs_cachestats.cs_misses++;
+  ret = fat_hwread(fs, fs->fs_cache[ndx].cl_buffer, sector, 1);
+  if (ret == OK)
+    {
+      fs->fs_cache[ndx].cl_sector = sector;
+    }
+
+  fs->fs_cache[ndx].cl_dirty = false;
+  fat_cacheselect(fs, ndx);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: fat_fscachenew
+ *
+ * Desciption: Make the specified sector the current sector in fs_buffer
+ *   without reading it from the media.  This is used when the entire
+ *   content of the sector is about to be replaced; the caller must fill
+ *   fs_buffer and mark it dirty.
+ *
+ ****************************************************************************/
+
+int fat_fscachenew(struct fat_mountpt_s *fs, off_t sector)
+{
+  int ndx;
+
+  fat_cachesave(fs);
+
+  ndx = fat_cachefind(fs, sector);
+  if (ndx < 0)
+    {
+      ndx = fat_cachereplace(fs);
+      if (ndx < 0)
+        {
+          return ndx;
+        }
+
+      fs->fs_cache[ndx].cl_sector = sector;
+      fs->fs_cache[ndx].cl_dirty  = false;
+    }
+
+  fat_cacheselect(fs, ndx);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_fscachepeek
+ *
+ * Desciption: Return the cached content of 'sector' or NULL if the sector
+ *   is not in the sector cache.  The current sector and the replacement
+ *   order of the cache are not changed.
+ *
+ ****************************************************************************/
+
+uint8_t *fat_fscachepeek(struct fat_mountpt_s *fs, off_t sector)
+{
+  int ndx = fat_cachefind(fs, sector);
+  return ndx < 0 ? NULL : fs->fs_cache[ndx].cl_buffer;
+}
+
+/****************************************************************************
+ * Name: fat_ffcacheflush
+ *
+ * Desciption: Flush any dirty sectors as necessary
+ *
+ ****************************************************************************/
+
+int fat_ffcacheflush(struct fat_mountpt_s *fs, struct fat_file_s *ff)
+{
+  int ret;
+
+  /* Check if the ff_buffer is dirty.  In this case, we will write back the
+   * contents of ff_buffer.
    */
 
   if (ff->ff_cachesector &&
@@ -1681,7 +2110,7 @@ int fat_updatefsinfo(struct fat_mountpt_s *fs)
 {
   int ret;
 
-  /* Flush the fs_buffer if it is dirty */
+  /* Flush all dirty sectors in the sector cache */
 
   ret = fat_fscacheflush(fs);
   if (ret == OK)
@@ -1696,6 +2125,12 @@ int fat_updatefsinfo(struct fat_mountpt_s *fs)
         {
           /* Create an image of the FSINFO sector in the fs_buffer */
 
+          ret = fat_fscachenew(fs, fs->fs_fsinfo);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
           memset(fs->fs_buffer, 0, fs->fs_hwsectorsize);
           FSI_PUTLEADSIG(fs->fs_buffer, 0x41615252);
           FSI_PUTSTRUCTSIG(fs->fs_buffer, 0x61417272);
@@ -1705,9 +2140,8 @@ int fat_updatefsinfo(struct fat_mountpt_s *fs)
 
           /* Then flush this to disk */
 
-          fs->fs_currentsector = fs->fs_fsinfo;
-          fs->fs_dirty         = true;
-          ret                  = fat_fscacheflush(fs);
+          fs->fs_dirty = true;
+          ret          = fat_fscacheflush(fs);
 
           /* No longer dirty */
 
@@ -1729,6 +2163,16 @@ int fat_nfreeclusters(struct fat_mountpt_s *fs, off_t *pfreeclusters)
 {
   uint32_t nfreeclusters;
 
+#ifdef CONFIG_FAT_FREEMAP
+  /* The free cluster bitmap holds an exact count once it is complete */
+
+  if (FAT_FREEMAPREADY(fs))
+    {
+      *pfreeclusters = fs->fs_freemap->fm_nfree;
+      return OK;
+    }
+#endif
+
   /* If number of the first free cluster is valid, then just return that value. */
 
   if (fs->fs_fsifreecount <= fs->fs_nclusters - 2)
@@ -1737,6 +2181,27 @@ int fat_nfreeclusters(struct fat_mountpt_s *fs, off_t *pfreeclusters)
       return OK;
     }
 
+#ifdef CONFIG_FAT_FREEMAP
+  /* Otherwise, finish building the bitmap now.  Only the part of the FAT
+   * that has not yet been scanned needs to be read.
+   */
+
+  if (fs->fs_freemap)
+    {
+      int ret = fat_freemapbuild(fs, fs->fs_nfatsects);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      if (FAT_FREEMAPREADY(fs))
+        {
+          *pfreeclusters = fs->fs_freemap->fm_nfree;
+          return OK;
+        }
+    }
+#endif
+
   /* Otherwise, we will have to count the number of free clusters */
 
   nfreeclusters = 0;
@@ -1781,12 +2246,11 @@ int fat_nfreeclusters(struct fat_mountpt_s *fs, off_t *pfreeclusters)
                   return ret;
                 }
 
-              /* Reset the offset to the next FAT entry.
-               * Increment the sector number to read next time around.
+              /* Reset the offset to the first FAT entry in the new sector.
+               * (fatsector was already incremented above.)
                */
 
               offset = 0;
-              fatsector++;
             }
 
           /* FAT16 and FAT32 differ only on the size of each cluster start
@@ -1867,3 +2331,629 @@ int fat_currentsector(struct fat_mountpt_s *fs, struct fat_file_s *ff,
 }
 
 
+
+/****************************************************************************
+ * Name: fat_extentfind
+ *
+ * Desciption: Return the media cluster that holds the 'fileclust' cluster of
+ *   the file if it is described by the file's extent map.  Zero is returned
+ *   if the cluster is not in the map.  The FAT is not accessed.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_NEXTENTS > 0
+uint32_t fat_extentfind(struct fat_file_s *ff, uint32_t fileclust)
+{
+  struct fat_extent_s *extent;
+  int low  = 0;
+  int high = ff->ff_nextents;
+  int mid;
+
+  /* The extents are sorted by file cluster index; do a binary search */
+
+  while (low < high)
+    {
+      mid    = (low + high) >> 1;
+      extent = &ff->ff_extents[mid];
+
+      if (fileclust < extent->fe_fileclust)
+        {
+          high = mid;
+        }
+      else if (fileclust >= extent->fe_fileclust + extent->fe_nclusters)
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          return extent->fe_cluster + (fileclust - extent->fe_fileclust);
+        }
+    }
+
+  return 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_extentappend
+ *
+ * Desciption: Record that the 'fileclust' cluster of the file is held in
+ *   media cluster 'cluster'.  The map only grows at its end:  The cluster is
+ *   ignored unless it immediately follows the last mapped cluster.  If it is
+ *   also physically contiguous with that cluster, the last run is extended;
+ *   otherwise a new run is started (if there is room for one).
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_NEXTENTS > 0
+void fat_extentappend(struct fat_file_s *ff, uint32_t fileclust,
+                      uint32_t cluster)
+{
+  struct fat_extent_s *extent;
+  uint32_t nextclust = 0;
+
+  if (ff->ff_nextents > 0)
+    {
+      extent    = &ff->ff_extents[ff->ff_nextents - 1];
+      nextclust = extent->fe_fileclust + extent->fe_nclusters;
+
+      if (fileclust == nextclust &&
+          cluster == extent->fe_cluster + extent->fe_nclusters)
+        {
+          extent->fe_nclusters++;
+          return;
+        }
+    }
+
+  if (fileclust == nextclust && ff->ff_nextents < CONFIG_FAT_NEXTENTS)
+    {
+      extent               = &ff->ff_extents[ff->ff_nextents];
+      extent->fe_fileclust = fileclust;
+      extent->fe_cluster   = cluster;
+      extent->fe_nclusters = 1;
+      ff->ff_nextents++;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_extenttruncate
+ *
+ * Desciption: Forget the clusters of the file from cluster 'nclusters' on.
+ *   This is called when the end of the cluster chain has been released.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_NEXTENTS > 0
+void fat_extenttruncate(struct fat_file_s *ff, uint32_t nclusters)
+{
+  struct fat_extent_s *extent;
+
+  while (ff->ff_nextents > 0)
+    {
+      extent = &ff->ff_extents[ff->ff_nextents - 1];
+      if (extent->fe_fileclust < nclusters)
+        {
+          if (extent->fe_fileclust + extent->fe_nclusters > nclusters)
+            {
+              extent->fe_nclusters = nclusters - extent->fe_fileclust;
+            }
+
+          break;
+        }
+
+      ff->ff_nextents--;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_extentlookup
+ *
+ * Desciption: Find the media cluster that holds the '*pfileclust' cluster of
+ *   the file.  The extent map is used if it describes the cluster; otherwise
+ *   the cluster chain is followed from the end of the map (recording the
+ *   clusters that are found along the way).
+ *
+ * Returned value:
+ *   The requested cluster.  If the cluster chain is shorter than requested,
+ *   the last cluster in the chain is returned and '*pfileclust' is updated
+ *   to its index.  Zero is returned if the file has no cluster chain and a
+ *   negated errno value is returned on a failure.
+ *
+ ****************************************************************************/
+
+int32_t fat_extentlookup(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                         uint32_t *pfileclust)
+{
+  uint32_t fileclust = *pfileclust;
+  uint32_t ndx       = 0;
+  int32_t  cluster   = ff->ff_startcluster;
+  int32_t  next;
+
+  if (cluster == 0)
+    {
+      return 0;
+    }
+
+#if CONFIG_FAT_NEXTENTS > 0
+  next = fat_extentfind(ff, fileclust);
+  if (next != 0)
+    {
+      return next;
+    }
+
+  /* Not mapped.  Start the search from the last mapped cluster */
+
+  if (ff->ff_nextents > 0)
+    {
+      struct fat_extent_s *extent = &ff->ff_extents[ff->ff_nextents - 1];
+
+      ndx     = extent->fe_fileclust + extent->fe_nclusters - 1;
+      cluster = extent->fe_cluster + extent->fe_nclusters - 1;
+    }
+  else
+    {
+      fat_extentappend(ff, 0, cluster);
+    }
+#endif
+
+  /* Follow the cluster chain through the FAT */
+
+  while (ndx < fileclust)
+    {
+      next = fat_getcluster(fs, cluster);
+      if (next < 0)
+        {
+          return next;
+        }
+      else if (next < 2 || next >= fs->fs_nclusters)
+        {
+          /* End of the cluster chain */
+
+          break;
+        }
+
+      cluster = next;
+      ndx++;
+      fat_extentappend(ff, ndx, cluster);
+    }
+
+  *pfileclust = ndx;
+  return cluster;
+}
+
+/****************************************************************************
+ * Name: fat_contiguous
+ *
+ * Desciption: Count how many of the clusters that follow the current
+ *   cluster of the file (ff_currentcluster, which is cluster 'fileclust' of
+ *   the file) are physically contiguous with it, up to 'maxclusters'.  This
+ *   lets a transfer that spans clusters be passed to the block driver as a
+ *   single request.  Clusters are taken from the extent map if possible;
+ *   others are found in the FAT and added to the map.  If 'extend' is true,
+ *   clusters are added to the end of the chain as necessary.
+ *
+ *   Any problem with the chain just ends the count; it will be reported
+ *   when the transfer reaches that cluster.
+ *
+ ****************************************************************************/
+
+uint32_t fat_contiguous(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                        uint32_t fileclust, uint32_t maxclusters, bool extend)
+{
+  uint32_t cluster = ff->ff_currentcluster;
+  uint32_t ncontig;
+  int32_t  next;
+
+  for (ncontig = 0; ncontig < maxclusters; ncontig++)
+    {
+      next = fat_extentfind(ff, fileclust + ncontig + 1);
+      if (next == 0)
+        {
+          if (extend)
+            {
+              next = fat_extendchain(fs, cluster);
+            }
+          else
+            {
+              next = fat_getcluster(fs, cluster);
+            }
+
+          if (next < 2 || next >= fs->fs_nclusters)
+            {
+              break;
+            }
+
+          fat_extentappend(ff, fileclust + ncontig + 1, next);
+        }
+
+      if (next != cluster + 1)
+        {
+          break;
+        }
+
+      cluster = next;
+    }
+
+  return ncontig;
+}
+
+/****************************************************************************
+ * Name: fat_advancesectors
+ *
+ * Desciption: Advance the current position of the file by 'nsectors' after
+ *   a direct transfer.  The transfer may have continued into clusters that
+ *   are physically contiguous with the current cluster (see
+ *   fat_contiguous()).
+ *
+ ****************************************************************************/
+
+void fat_advancesectors(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                        unsigned int nsectors)
+{
+  unsigned int beyond;
+  uint32_t     nclusters;
+
+  if (nsectors > ff->ff_sectorsincluster)
+    {
+      beyond    = nsectors - ff->ff_sectorsincluster;
+      nclusters = (beyond + fs->fs_fatsecperclus - 1) / fs->fs_fatsecperclus;
+
+      ff->ff_currentcluster  += nclusters;
+      ff->ff_sectorsincluster = nclusters * fs->fs_fatsecperclus - beyond;
+    }
+  else
+    {
+      ff->ff_sectorsincluster -= nsectors;
+    }
+
+  ff->ff_currentsector += nsectors;
+}
+
+/****************************************************************************
+ * Name: fat_preallocate
+ *
+ * Desciption: Make sure that the cluster chain of the file holds at least
+ *   'nclusters' clusters.  If the free cluster bitmap is available, the
+ *   missing clusters are allocated as one contiguous run and linked in a
+ *   single pass over the FAT.  Otherwise they are added one at a time with
+ *   fat_extendchain(), which still keeps them together if the space after
+ *   the file is free.  The new clusters are added to the extent map.
+ *
+ ****************************************************************************/
+
+int fat_preallocate(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                    uint32_t nclusters)
+{
+  uint32_t fileclust;
+  uint32_t nclustersnow = 0;
+  int32_t  lastcluster  = 0;
+  int32_t  cluster;
+  off_t    nfreeclusters;
+  int      ret;
+
+  /* Find the end of the existing cluster chain (if any) */
+
+  if (ff->ff_startcluster != 0 && nclusters > 0)
+    {
+      fileclust   = nclusters - 1;
+      lastcluster = fat_extentlookup(fs, ff, &fileclust);
+      if (lastcluster < 0)
+        {
+          return lastcluster;
+        }
+
+      nclustersnow = fileclust + 1;
+    }
+
+  if (nclustersnow >= nclusters)
+    {
+      return OK;
+    }
+
+  /* Fail now, rather than part way through, if there is not enough space */
+
+  ret = fat_nfreeclusters(fs, &nfreeclusters);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (nfreeclusters < nclusters - nclustersnow)
+    {
+      return -ENOSPC;
+    }
+
+#ifdef CONFIG_FAT_FREEMAP
+  if (FAT_FREEMAPREADY(fs))
+    {
+      uint32_t ncontig = nclusters - nclustersnow;
+      uint32_t first;
+      uint32_t i;
+
+      first = fat_freemapallocrun(fs, lastcluster, ncontig);
+      if (first != 0)
+        {
+          /* Build the new part of the chain, then attach it to the file */
+
+          for (i = 0; i < ncontig; i++)
+            {
+              ret = fat_putcluster(fs, first + i,
+                                   i + 1 < ncontig ? first + i + 1 : 0x0fffffff);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+
+              fat_extentappend(ff, nclustersnow + i, first + i);
+            }
+
+          if (lastcluster != 0)
+            {
+              ret = fat_putcluster(fs, lastcluster, first);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+            }
+          else
+            {
+              ff->ff_startcluster   = first;
+              ff->ff_currentcluster = first;
+            }
+
+          /* And update the FSINFO for the next time we have to search */
+
+          fs->fs_fsinextfree = first + ncontig - 1;
+          if (fs->fs_fsifreecount != 0xffffffff)
+            {
+              fs->fs_fsifreecount -= ncontig;
+              fs->fs_fsidirty = 1;
+            }
+
+          return OK;
+        }
+    }
+#endif
+
+  /* Add the clusters one at a time */
+
+  while (nclustersnow < nclusters)
+    {
+      cluster = fat_extendchain(fs, lastcluster);
+      if (cluster < 0)
+        {
+          return cluster;
+        }
+      else if (cluster < 2 || cluster >= fs->fs_nclusters)
+        {
+          return -ENOSPC;
+        }
+
+      if (lastcluster == 0)
+        {
+          ff->ff_startcluster   = cluster;
+          ff->ff_currentcluster = cluster;
+        }
+
+      fat_extentappend(ff, nclustersnow, cluster);
+      lastcluster = cluster;
+      nclustersnow++;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_truncatechain
+ *
+ * Desciption: Release the clusters of the file beyond the first
+ *   'nclusters' clusters.  If 'nclusters' is zero, the whole cluster chain
+ *   is released and the file is left without a start cluster.
+ *
+ ****************************************************************************/
+
+int fat_truncatechain(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                      uint32_t nclusters)
+{
+  uint32_t fileclust;
+  int32_t  cluster;
+  int32_t  nextcluster;
+  int      ret;
+
+  if (ff->ff_startcluster == 0)
+    {
+      return OK;
+    }
+
+  if (nclusters == 0)
+    {
+      ret = fat_removechain(fs, ff->ff_startcluster);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      ff->ff_startcluster   = 0;
+      ff->ff_currentcluster = 0;
+      ff->ff_currentsector  = 0;
+      fat_extenttruncate(ff, 0);
+      return OK;
+    }
+
+  /* Find the last cluster to keep */
+
+  fileclust = nclusters - 1;
+  cluster   = fat_extentlookup(fs, ff, &fileclust);
+  if (cluster < 0)
+    {
+      return cluster;
+    }
+
+  nextcluster = fat_getcluster(fs, cluster);
+  if (nextcluster < 0)
+    {
+      return nextcluster;
+    }
+
+  if (nextcluster >= 2 && nextcluster < fs->fs_nclusters)
+    {
+      /* End the chain at the last cluster, then release the rest */
+
+      ret = fat_putcluster(fs, cluster, 0x0fffffff);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      ret = fat_removechain(fs, nextcluster);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  fat_extenttruncate(ff, nclusters);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_zerofill
+ *
+ * Desciption: Write zeroes to bytes 'start' through 'end' - 1 of the file.
+ *   The clusters must already be allocated.  The data that precedes 'start'
+ *   in its sector is preserved.  Whole sectors are written up to a cluster
+ *   at a time from a zeroed buffer if one can be allocated; otherwise they
+ *   are written one at a time from the file buffer.  The file buffer is
+ *   left invalid.
+ *
+ ****************************************************************************/
+
+int fat_zerofill(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                 off_t start, off_t end)
+{
+  uint8_t     *zbuffer;
+  unsigned int zsectors;
+  unsigned int nsectors;
+  unsigned int sectorndx;
+  unsigned int bytendx;
+  uint32_t     fileclust;
+  uint32_t     wantclust;
+  int32_t      cluster;
+  int32_t      nextcluster;
+  int          ret;
+
+  if (start >= end)
+    {
+      return OK;
+    }
+
+  /* Find the cluster that holds the first byte */
+
+  fileclust = CLUS_FILENDX(fs, start);
+  wantclust = fileclust;
+  cluster   = fat_extentlookup(fs, ff, &fileclust);
+  if (cluster < 0)
+    {
+      return cluster;
+    }
+  else if (cluster == 0 || fileclust != wantclust)
+    {
+      return -EINVAL;
+    }
+
+  /* Zero the rest of a partial first sector through the file buffer */
+
+  bytendx = start & SEC_NDXMASK(fs);
+  if (bytendx != 0)
+    {
+      sectorndx = SEC_NSECTORS(fs, start) & CLUS_NDXMASK(fs);
+      ret = fat_ffcacheread(fs, ff, fat_cluster2sector(fs, cluster) + sectorndx);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      memset(&ff->ff_buffer[bytendx], 0, fs->fs_hwsectorsize - bytendx);
+      ff->ff_bflags |= FFBUFF_DIRTY;
+      start         += fs->fs_hwsectorsize - bytendx;
+    }
+
+  /* Write back the file buffer.  Its memory may then be used for zeroes. */
+
+  ret = fat_ffcacheinvalidate(fs, ff);
+  if (ret < 0 || start >= end)
+    {
+      return ret;
+    }
+
+  zsectors = fs->fs_fatsecperclus;
+  zbuffer  = (uint8_t*)fat_io_alloc(zsectors * fs->fs_hwsectorsize);
+  if (!zbuffer)
+    {
+      zsectors = 1;
+      zbuffer  = ff->ff_buffer;
+    }
+
+  memset(zbuffer, 0, zsectors * fs->fs_hwsectorsize);
+
+  while (start < end)
+    {
+      /* Move on to the next cluster of the file if necessary */
+
+      if (CLUS_FILENDX(fs, start) != fileclust)
+        {
+          fileclust++;
+          nextcluster = fat_extentfind(ff, fileclust);
+          if (nextcluster == 0)
+            {
+              nextcluster = fat_getcluster(fs, cluster);
+              if (nextcluster < 0)
+                {
+                  ret = nextcluster;
+                  break;
+                }
+              else if (nextcluster < 2 || nextcluster >= fs->fs_nclusters)
+                {
+                  ret = -EINVAL;
+                  break;
+                }
+
+              fat_extentappend(ff, fileclust, nextcluster);
+            }
+
+          cluster = nextcluster;
+        }
+
+      /* Zero the rest of this cluster (or as much of it as is needed) */
+
+      sectorndx = SEC_NSECTORS(fs, start) & CLUS_NDXMASK(fs);
+      nsectors  = fs->fs_fatsecperclus - sectorndx;
+      if (nsectors > zsectors)
+        {
+          nsectors = zsectors;
+        }
+
+      if (nsectors > SEC_NSECTORS(fs, end - start + fs->fs_hwsectorsize - 1))
+        {
+          nsectors = SEC_NSECTORS(fs, end - start + fs->fs_hwsectorsize - 1);
+        }
+
+      ret = fat_hwwrite(fs, zbuffer, fat_cluster2sector(fs, cluster) + sectorndx,
+                        nsectors);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      start += (off_t)nsectors * fs->fs_hwsectorsize;
+    }
+
+  if (zbuffer != ff->ff_buffer)
+    {
+      fat_io_free(zbuffer, zsectors * fs->fs_hwsectorsize);
+    }
+
+  return ret;
+}
@@ -0,0 +1,149 @@
+/****************************************************************************
+ * fs/fs_fallocate.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/sched.h>
+
+#include "fs_internal.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fallocate
+ *
+ * Description:
+ *   Reserve storage for bytes 'offset' through 'offset' + 'len' - 1 of the
+ *   file referred to by 'fd' so that later writes to that range cannot fail
+ *   for lack of space.  The file is extended if necessary and the new part
+ *   of the file reads as zeroes.  If FALLOC_FL_KEEP_SIZE is included in
+ *   'mode', the space is reserved beyond the end of the file and the file
+ *   size is not changed; the file system may then skip initializing the
+ *   reserved space.
+ *
+ *   This is the linux interface; posix_fallocate() is built on it.
+ *
+ ****************************************************************************/
+
+int fallocate(int fd, int mode, off_t offset, off_t len)
+{
+  FAR struct filelist *list;
+  FAR struct file     *this_file;
+  struct inode        *inode;
+  int                  ret;
+
+  /* Get the thread-specific file list */
+
+  list = sched_getfiles();
+  if (!list)
+    {
+      ret = EMFILE;
+      goto errout;
+    }
+
+  /* Did we get a valid file descriptor? */
+
+  if ((unsigned int)fd >= CONFIG_NFILE_DESCRIPTORS)
+    {
+      ret = EBADF;
+      goto errout;
+    }
+
+  /* Was this file opened for write access? */
+
+  this_file = files_getfile(list, fd);
+  if (!this_file || (this_file->f_oflags & O_WROK) == 0)
+    {
+      ret = EBADF;
+      goto errout;
+    }
+
+  if (offset < 0 || len <= 0 || (mode & ~FALLOC_FL_KEEP_SIZE) != 0)
+    {
+      ret = EINVAL;
+      goto errout;
+    }
+
+  /* The end of the range must be representable as a file size (off_t is
+   * int32_t).  offset and len are both non-negative here, so this cannot
+   * overflow.
+   */
+
+  if (len > INT32_MAX - offset)
+    {
+      ret = EFBIG;
+      goto errout;
+    }
+
+  /* Is this inode a registered mountpoint that supports preallocation? */
+
+  inode = this_file->f_inode;
+  if (!inode || !INODE_IS_MOUNTPT(inode))
+    {
+      ret = ENODEV;
+      goto errout;
+    }
+
+  if (!inode->u.i_mops || !inode->u.i_mops->allocate)
+    {
+      ret = EOPNOTSUPP;
+      goto errout;
+    }
+
+  /* Yes, then tell the mountpoint to reserve the space */
+
+  ret = inode->u.i_mops->allocate(this_file, mode, offset, len);
+  if (ret >= 0)
+    {
+      return OK;
+    }
+
+  ret = -ret;
+
+errout:
+  set_errno(ret);
+  return ERROR;
+}
@@ -80,8 +80,8 @@ static inline int file_vfcntl(int fildes, int cmd, va_list ap)
 
   /* Was this file opened ? */
 
-  this_file = &list->fl_files[fildes];
-  if (!this_file->f_inode)
+  this_file = files_getfile(list, fildes);
+  if (!this_file || !this_file->f_inode)
     {
       err = EBADF;
       goto errout;
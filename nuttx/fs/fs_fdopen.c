@@ -66,6 +66,7 @@
 static inline int fs_checkfd(FAR struct tcb_s *tcb, int fd, int oflags)
 {
   FAR struct filelist *flist;
+  FAR struct file     *filep;
   FAR struct inode    *inode;
 
   DEBUGASSERT(tcb && tcb->group);
@@ -80,7 +81,8 @@ static inline int fs_checkfd(FAR struct tcb_s *tcb, int fd, int oflags)
    * been closed.
    */
   
-  inode = flist->fl_files[fd].f_inode;
+  filep = files_getfile(flist, fd);
+  inode = filep ? filep->f_inode : NULL;
   if (!inode)
     {
       /* No inode -- descriptor does not correspond to an open file */
@@ -0,0 +1,377 @@
+/****************************************************************************
+ * fs/fs_fdtable.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/fs/fdtable.h>
+#include <nuttx/kmalloc.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define FDTABLE_FULL 0xffffffff
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fdtable_ffz
+ *
+ * Description:
+ *   Return the number of the lowest zero bit in a word that is not full.
+ *
+ ****************************************************************************/
+
+static inline int fdtable_ffz(uint32_t word)
+{
+#ifdef __GNUC__
+  return __builtin_ctzl((unsigned long)~word);
+#else
+  int bit = 0;
+
+  word = ~word;
+  if ((word & 0x0000ffff) == 0)
+    {
+      bit  += 16;
+      word >>= 16;
+    }
+
+  if ((word & 0x000000ff) == 0)
+    {
+      bit  += 8;
+      word >>= 8;
+    }
+
+  if ((word & 0x0000000f) == 0)
+    {
+      bit  += 4;
+      word >>= 4;
+    }
+
+  if ((word & 0x00000003) == 0)
+    {
+      bit  += 2;
+      word >>= 2;
+    }
+
+  if ((word & 0x00000001) == 0)
+    {
+      bit++;
+    }
+
+  return bit;
+#endif
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fdtable_initialize
+ *
+ * Description:
+ *   Initialize an empty table of 'size' descriptors of 'esize' bytes each.
+ *   'inuse' is the bitmap (FDTABLE_NWORDS(size) words) and 'storage' is
+ *   either the array of descriptors or, if CONFIG_FDTABLE_DYNAMIC, the
+ *   array of FDTABLE_NBLOCKS(size) block pointers.
+ *
+ ****************************************************************************/
+
+void fdtable_initialize(FAR struct fdtable_s *table, int size, size_t esize,
+                        FAR uint32_t *inuse, FAR void *storage)
+{
+  int nwords = FDTABLE_NWORDS(size);
+
+  DEBUGASSERT(table && size > 0 && size <= FDTABLE_MAXSIZE && inuse &&
+              storage);
+
+  table->ft_size  = size;
+  table->ft_esize = esize;
+  table->ft_inuse = inuse;
+
+  /* Mark the bits beyond the last descriptor and the summary bits beyond
+   * the last word as in use so that they are never selected.
+   */
+
+  memset(inuse, 0, nwords * sizeof(uint32_t));
+  if ((size & 31) != 0)
+    {
+      inuse[nwords - 1] = ~(((uint32_t)1 << (size & 31)) - 1);
+    }
+
+  table->ft_full = nwords < 32 ? ~(((uint32_t)1 << nwords) - 1) : 0;
+
+#ifdef CONFIG_FDTABLE_DYNAMIC
+  table->ft_blocks = (FAR void **)storage;
+  memset(storage, 0, FDTABLE_NBLOCKS(size) * sizeof(FAR void *));
+#else
+  table->ft_base = (FAR uint8_t *)storage;
+  memset(storage, 0, size * esize);
+#endif
+}
+
+/****************************************************************************
+ * Name: fdtable_release
+ *
+ * Description:
+ *   Free the descriptor blocks of a table.  The descriptors must already
+ *   have been closed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FDTABLE_DYNAMIC
+void fdtable_release(FAR struct fdtable_s *table)
+{
+  int nblocks = FDTABLE_NBLOCKS(table->ft_size);
+  int i;
+
+  for (i = 0; i < nblocks; i++)
+    {
+      if (table->ft_blocks[i])
+        {
+          kfree(table->ft_blocks[i]);
+          table->ft_blocks[i] = NULL;
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: fdtable_allocate
+ *
+ * Description:
+ *   Mark the lowest free descriptor greater than or equal to 'minndx' as in
+ *   use.  Returns the index of the descriptor or a negated errno value:
+ *   -EMFILE if there is no free descriptor or -ENOMEM if the memory for it
+ *   could not be allocated.
+ *
+ ****************************************************************************/
+
+int fdtable_allocate(FAR struct fdtable_s *table, int minndx)
+{
+  uint32_t word;
+  uint32_t full;
+  int wndx;
+  int ndx;
+
+  DEBUGASSERT(table && minndx >= 0);
+
+  if (minndx >= table->ft_size)
+    {
+      return -EMFILE;
+    }
+
+  /* Look first in the word that holds 'minndx', ignoring the descriptors
+   * below 'minndx'.
+   */
+
+  wndx = minndx >> 5;
+  word = table->ft_inuse[wndx] | (((uint32_t)1 << (minndx & 31)) - 1);
+  if (word == FDTABLE_FULL)
+    {
+      /* Then in the first word after that which is not full */
+
+      full = table->ft_full | (((uint32_t)2 << wndx) - 1);
+      if (full == FDTABLE_FULL)
+        {
+          return -EMFILE;
+        }
+
+      wndx = fdtable_ffz(full);
+      word = table->ft_inuse[wndx];
+    }
+
+  ndx = (wndx << 5) + fdtable_ffz(word);
+  if (!fdtable_reserve(table, ndx))
+    {
+      return -ENOMEM;
+    }
+
+  return ndx;
+}
+
+/****************************************************************************
+ * Name: fdtable_reserve
+ *
+ * Description:
+ *   Mark one specific descriptor as in use (it may already be in use) and
+ *   return its structure.  Returns NULL if the index is out of range or if
+ *   the memory for the descriptor could not be allocated.
+ *
+ ****************************************************************************/
+
+FAR void *fdtable_reserve(FAR struct fdtable_s *table, int ndx)
+{
+  FAR void *desc;
+  int wndx;
+
+#ifdef CONFIG_FDTABLE_DYNAMIC
+  if ((unsigned int)ndx < table->ft_size)
+    {
+      /* Allocate the block that holds this descriptor if this is the first
+       * descriptor used in it.  The last block only needs to hold the
+       * descriptors up to ft_size.
+       */
+
+      int blk = ndx / CONFIG_FDTABLE_BLOCKSIZE;
+      if (!table->ft_blocks[blk])
+        {
+          int nelem = table->ft_size - blk * CONFIG_FDTABLE_BLOCKSIZE;
+          if (nelem > CONFIG_FDTABLE_BLOCKSIZE)
+            {
+              nelem = CONFIG_FDTABLE_BLOCKSIZE;
+            }
+
+          table->ft_blocks[blk] = kzalloc(nelem * table->ft_esize);
+        }
+    }
+#endif
+
+  desc = fdtable_get(table, ndx);
+  if (desc)
+    {
+      wndx = ndx >> 5;
+      table->ft_inuse[wndx] |= (uint32_t)1 << (ndx & 31);
+      if (table->ft_inuse[wndx] == FDTABLE_FULL)
+        {
+          table->ft_full |= (uint32_t)1 << wndx;
+        }
+    }
+
+  return desc;
+}
+
+/****************************************************************************
+ * Name: fdtable_free
+ *
+ * Description:
+ *   Mark a descriptor as free.
+ *
+ ****************************************************************************/
+
+void fdtable_free(FAR struct fdtable_s *table, int ndx)
+{
+  int wndx = ndx >> 5;
+
+  DEBUGASSERT(table && (unsigned int)ndx < table->ft_size);
+
+  table->ft_inuse[wndx] &= ~((uint32_t)1 << (ndx & 31));
+  table->ft_full        &= ~((uint32_t)1 << wndx);
+}
+
+/****************************************************************************
+ * Name: fdtable_get
+ *
+ * Description:
+ *   Return the structure of a descriptor, whether in use or not.  Returns
+ *   NULL if the index is out of range or if no memory has been allocated
+ *   for the descriptor (which then cannot be in use).
+ *
+ ****************************************************************************/
+
+FAR void *fdtable_get(FAR struct fdtable_s *table, int ndx)
+{
+  if ((unsigned int)ndx >= table->ft_size)
+    {
+      return NULL;
+    }
+
+#ifdef CONFIG_FDTABLE_DYNAMIC
+  {
+    FAR uint8_t *block = (FAR uint8_t *)
+      table->ft_blocks[ndx / CONFIG_FDTABLE_BLOCKSIZE];
+
+    if (!block)
+      {
+        return NULL;
+      }
+
+    return block + (ndx % CONFIG_FDTABLE_BLOCKSIZE) * table->ft_esize;
+  }
+#else
+  return table->ft_base + ndx * table->ft_esize;
+#endif
+}
+
+/****************************************************************************
+ * Name: fdtable_index
+ *
+ * Description:
+ *   Return the index of a descriptor structure or -1 if it does not belong
+ *   to the table.
+ *
+ ****************************************************************************/
+
+int fdtable_index(FAR struct fdtable_s *table, FAR const void *desc)
+{
+  FAR const uint8_t *ptr = (FAR const uint8_t *)desc;
+  FAR const uint8_t *base;
+#ifdef CONFIG_FDTABLE_DYNAMIC
+  int nblocks = FDTABLE_NBLOCKS(table->ft_size);
+  int i;
+
+  for (i = 0; i < nblocks; i++)
+    {
+      base = (FAR const uint8_t *)table->ft_blocks[i];
+      if (base && ptr >= base &&
+          ptr < base + CONFIG_FDTABLE_BLOCKSIZE * table->ft_esize)
+        {
+          return i * CONFIG_FDTABLE_BLOCKSIZE +
+                 (ptr - base) / table->ft_esize;
+        }
+    }
+#else
+  base = table->ft_base;
+  if (ptr >= base && ptr < base + table->ft_size * table->ft_esize)
+    {
+      return (ptr - base) / table->ft_esize;
+    }
+#endif
+
+  return -1;
+}
@@ -52,9 +52,7 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
-#define DUP_ISOPEN(fd, list) \
-  ((unsigned int)fd < CONFIG_NFILE_DESCRIPTORS && \
-   list->fl_files[fd].f_inode != NULL)
+#define DUP_ISOPEN(filep) ((filep) != NULL && (filep)->f_inode != NULL)
 
 /****************************************************************************
  * Private Functions
@@ -79,6 +77,7 @@
 int file_dup(int fildes, int minfd)
 {
   FAR struct filelist *list;
+  FAR struct file *filep;
   int fildes2;
 
   /* Get the thread-specific file list */
@@ -92,7 +91,8 @@ int file_dup(int fildes, int minfd)
 
   /* Verify that fildes is a valid, open file descriptor */
 
-  if (!DUP_ISOPEN(fildes, list))
+  filep = files_getfile(list, fildes);
+  if (!DUP_ISOPEN(filep))
     {
       set_errno(EBADF);
       return ERROR;
@@ -100,18 +100,16 @@ int file_dup(int fildes, int minfd)
 
   /* Increment the reference count on the contained inode */
 
-  inode_addref(list->fl_files[fildes].f_inode);
+  inode_addref(filep->f_inode);
 
   /* Then allocate a new file descriptor for the inode */
 
-  fildes2 = files_allocate(list->fl_files[fildes].f_inode,
-                           list->fl_files[fildes].f_oflags,
-                           list->fl_files[fildes].f_pos,
+  fildes2 = files_allocate(filep->f_inode, filep->f_oflags, filep->f_pos,
                            minfd);
   if (fildes2 < 0)
     {
       set_errno(EMFILE);
-      inode_release(list->fl_files[fildes].f_inode);
+      inode_release(filep->f_inode);
       return ERROR;
     }
 
@@ -51,9 +51,7 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
-#define DUP_ISOPEN(fd, list) \
-  ((unsigned int)fd < CONFIG_NFILE_DESCRIPTORS && \
-   list->fl_files[fd].f_inode != NULL)
+#define DUP_ISOPEN(filep) ((filep) != NULL && (filep)->f_inode != NULL)
 
 /****************************************************************************
  * Private Functions
@@ -81,6 +79,9 @@ int dup2(int fildes1, int fildes2)
 #endif
 {
   FAR struct filelist *list;
+  FAR struct file *filep1;
+  FAR struct file *filep2;
+  int ret;
 
   /* Get the thread-specific file list */
 
@@ -93,7 +94,8 @@ int dup2(int fildes1, int fildes2)
 
   /* Verify that fildes is a valid, open file descriptor */
 
-  if (!DUP_ISOPEN(fildes1, list))
+  filep1 = files_getfile(list, fildes1);
+  if (!DUP_ISOPEN(filep1))
     {
       set_errno(EBADF);
       return ERROR;
@@ -114,7 +116,24 @@ int dup2(int fildes1, int fildes2)
       return ERROR;
     }
 
-  return files_dup(&list->fl_files[fildes1], &list->fl_files[fildes2]);
+  /* Reserve fildes2 (it may already be open) so that it cannot be taken
+   * by another thread before the file is duplicated into it.
+   */
+
+  filep2 = files_reserve(list, fildes2);
+  if (!filep2)
+    {
+      set_errno(EMFILE);
+      return ERROR;
+    }
+
+  ret = files_dup(filep1, filep2);
+  if (ret < 0)
+    {
+      files_unreserve(list, fildes2);
+    }
+
+  return ret;
 }
 
 #endif /* CONFIG_NFILE_DESCRIPTORS > 0 */
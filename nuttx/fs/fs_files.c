@@ -168,6 +168,16 @@ void files_initlist(FAR struct filelist *list)
   /* Initialize the list access mutex */
 
   (void)sem_init(&list->fl_sem, 0, 1);
+
+  /* And the (empty) table of file descriptors */
+
+#ifdef CONFIG_FDTABLE_DYNAMIC
+  fdtable_initialize(&list->fl_table, CONFIG_NFILE_DESCRIPTORS,
+                     sizeof(struct file), list->fl_inuse, list->fl_blocks);
+#else
+  fdtable_initialize(&list->fl_table, CONFIG_NFILE_DESCRIPTORS,
+                     sizeof(struct file), list->fl_inuse, list->fl_files);
+#endif
 }
 
 /****************************************************************************
@@ -191,14 +201,65 @@ void files_releaselist(FAR struct filelist *list)
 
   for (i = 0; i < CONFIG_NFILE_DESCRIPTORS; i++)
     {
-      (void)_files_close(&list->fl_files[i]);
+      FAR struct file *filep = files_getfile(list, i);
+      if (filep)
+        {
+          (void)_files_close(filep);
+        }
     }
 
+  /* Free the memory used for the file descriptors */
+
+  fdtable_release(&list->fl_table);
+
   /* Destroy the semaphore */
 
   (void)sem_destroy(&list->fl_sem);
 }
 
+/****************************************************************************
+ * Name: files_reserve
+ *
+ * Description:
+ *   Reserve a specific file descriptor in a list so that it will not be
+ *   allocated by open() or dup() and return its file structure.  This is
+ *   done before a file is duplicated into the descriptor with files_dup().
+ *
+ ****************************************************************************/
+
+FAR struct file *files_reserve(FAR struct filelist *list, int fd)
+{
+  FAR struct file *filep;
+
+  _files_semtake(list);
+  filep = (FAR struct file *)fdtable_reserve(&list->fl_table, fd);
+  _files_semgive(list);
+  return filep;
+}
+
+/****************************************************************************
+ * Name: files_unreserve
+ *
+ * Description:
+ *   Release a descriptor reserved with files_reserve() if no file could be
+ *   duplicated into it.
+ *
+ ****************************************************************************/
+
+void files_unreserve(FAR struct filelist *list, int fd)
+{
+  FAR struct file *filep;
+
+  _files_semtake(list);
+  filep = files_getfile(list, fd);
+  if (filep && !filep->f_inode)
+    {
+      fdtable_free(&list->fl_table, fd);
+    }
+
+  _files_semgive(list);
+}
+
 /****************************************************************************
  * Name: files_dup
  *
@@ -314,23 +375,25 @@ errout:
 int files_allocate(FAR struct inode *inode, int oflags, off_t pos, int minfd)
 {
   FAR struct filelist *list;
+  FAR struct file *filep;
   int i;
 
   list = sched_getfiles();
   if (list)
     {
+      /* Take the lowest free descriptor from the table */
+
       _files_semtake(list);
-      for (i = minfd; i < CONFIG_NFILE_DESCRIPTORS; i++)
+      i = fdtable_allocate(&list->fl_table, minfd);
+      if (i >= 0)
         {
-          if (!list->fl_files[i].f_inode)
-            {
-               list->fl_files[i].f_oflags = oflags;
-               list->fl_files[i].f_pos    = pos;
-               list->fl_files[i].f_inode  = inode;
-               list->fl_files[i].f_priv   = NULL;
-               _files_semgive(list);
-               return i;
-            }
+          filep           = files_getfile(list, i);
+          filep->f_oflags = oflags;
+          filep->f_pos    = pos;
+          filep->f_inode  = inode;
+          filep->f_priv   = NULL;
+          _files_semgive(list);
+          return i;
         }
 
       _files_semgive(list);
@@ -353,6 +416,7 @@ int files_allocate(FAR struct inode *inode, int oflags, off_t pos, int minfd)
 int files_close(int filedes)
 {
   FAR struct filelist *list;
+  FAR struct file     *filep;
   int                  ret;
 
   /* Get the thread-specific file list */
@@ -365,15 +429,17 @@ int files_close(int filedes)
 
   /* If the file was properly opened, there should be an inode assigned */
 
-  if (filedes < 0 || filedes >= CONFIG_NFILE_DESCRIPTORS || !list->fl_files[filedes].f_inode)
+  filep = files_getfile(list, filedes);
+  if (!filep || !filep->f_inode)
    {
      return -EBADF;
    }
 
-  /* Perform the protected close operation */
+  /* Perform the protected close operation and free the descriptor */
 
   _files_semtake(list);
-  ret = _files_close(&list->fl_files[filedes]);
+  ret = _files_close(filep);
+  fdtable_free(&list->fl_table, filedes);
   _files_semgive(list);
   return ret;
 }
@@ -390,16 +456,19 @@ int files_close(int filedes)
 void files_release(int filedes)
 {
   FAR struct filelist *list;
+  FAR struct file *filep;
 
   list = sched_getfiles();
   if (list)
     {
-      if (filedes >=0 && filedes < CONFIG_NFILE_DESCRIPTORS)
+      filep = files_getfile(list, filedes);
+      if (filep)
         {
           _files_semtake(list);
-          list->fl_files[filedes].f_oflags  = 0;
-          list->fl_files[filedes].f_pos     = 0;
-          list->fl_files[filedes].f_inode = NULL;
+          filep->f_oflags = 0;
+          filep->f_pos    = 0;
+          filep->f_inode  = NULL;
+          fdtable_free(&list->fl_table, filedes);
           _files_semgive(list);
         }
     }
@@ -101,8 +101,8 @@ int fsync(int fd)
 
   /* Was this file opened for write access? */
 
-  this_file = &list->fl_files[fd];
-  if ((this_file->f_oflags & O_WROK) == 0)
+  this_file = files_getfile(list, fd);
+  if (!this_file || (this_file->f_oflags & O_WROK) == 0)
     {
       ret = EBADF;
       goto errout;
@@ -125,8 +125,8 @@ int ioctl(int fd, int req, unsigned long arg)
 
   /* Is a driver registered? Does it support the ioctl method? */
 
-  this_file = &list->fl_files[fd];
-  inode     = this_file->f_inode;
+  this_file = files_getfile(list, fd);
+  inode     = this_file ? this_file->f_inode : NULL;
 
   if (inode && inode->u.i_ops && inode->u.i_ops->ioctl)
     {
@@ -115,8 +115,8 @@ off_t lseek(int fd, off_t offset, int whence)
 
   /* Is a driver registered? */
 
-  filep = &list->fl_files[fd];
-  inode =  filep->f_inode;
+  filep = files_getfile(list, fd);
+  inode = filep ? filep->f_inode : NULL;
 
   if (inode && inode->u.i_ops)
     {
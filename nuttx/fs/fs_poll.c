@@ -131,8 +131,8 @@ static int poll_fdsetup(int fd, FAR struct pollfd *fds, bool setup)
    * If not, return -ENOSYS
    */
 
-  this_file = &list->fl_files[fd];
-  inode     = this_file->f_inode;
+  this_file = files_getfile(list, fd);
+  inode     = this_file ? this_file->f_inode : NULL;
 
   if (inode && inode->u.i_ops && inode->u.i_ops->poll)
     {
@@ -72,12 +72,12 @@ static inline ssize_t file_read(int fd, FAR void *buf, size_t nbytes)
 
   else if ((unsigned int)fd < CONFIG_NFILE_DESCRIPTORS)
     {
-      FAR struct file *this_file = &list->fl_files[fd];
-      FAR struct inode *inode    = this_file->f_inode;
+      FAR struct file *this_file = files_getfile(list, fd);
+      FAR struct inode *inode    = this_file ? this_file->f_inode : NULL;
 
       /* Yes.. Was this file opened for read access? */
 
-      if ((this_file->f_oflags & O_RDOK) == 0)
+      if (!this_file || (this_file->f_oflags & O_RDOK) == 0)
         {
           /* No.. File is not read-able */
 
@@ -74,8 +74,8 @@ static inline ssize_t file_write(int fd, FAR const void *buf, size_t nbytes)
 
   /* Was this file opened for write access? */
 
-  this_file = &list->fl_files[fd];
-  if ((this_file->f_oflags & O_WROK) == 0)
+  this_file = files_getfile(list, fd);
+  if (!this_file || (this_file->f_oflags & O_WROK) == 0)
     {
       err = EBADF;
       goto errout;
@@ -170,6 +170,8 @@ const struct mountpt_operations nfs_operations =
 
   NULL,                         /* sync */
   nfs_dup,                      /* dup */
+  NULL,                         /* truncate */
+  NULL,                         /* allocate */
 
   nfs_opendir,                  /* opendir */
   NULL,                         /* closedir */
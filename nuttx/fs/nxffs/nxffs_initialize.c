@@ -85,6 +85,8 @@ const struct mountpt_operations nxffs_operations =
 
   NULL,              /* sync -- No buffered data */
   nxffs_dup,         /* dup */
+  NULL,              /* truncate */
+  NULL,              /* allocate */
 
   nxffs_opendir,     /* opendir */
   NULL,              /* closedir */
@@ -123,6 +123,8 @@ const struct mountpt_operations romfs_operations =
 
   NULL,            /* sync */
   romfs_dup,       /* dup */
+  NULL,            /* truncate */
+  NULL,            /* allocate */
 
   romfs_opendir,   /* opendir */
   NULL,            /* closedir */
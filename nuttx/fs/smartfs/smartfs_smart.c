@@ -135,6 +135,8 @@ const struct mountpt_operations smartfs_operations =
 
   smartfs_sync,          /* sync */
   smartfs_dup,           /* dup */
+  NULL,                  /* truncate */
+  NULL,                  /* allocate */
 
   smartfs_opendir,       /* opendir */
   NULL,                  /* closedir */
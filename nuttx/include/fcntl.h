@@ -128,6 +128,10 @@
 #define DN_RENAME   4  /* A file was renamed */
 #define DN_ATTRIB   5  /* Attributes of a file were changed */
 
+/* Mode flags for fallocate() (linux) */
+
+#define FALLOC_FL_KEEP_SIZE 1 /* Reserve space but do not change the file size */
+
 /********************************************************************************
  * Public Type Definitions
  ********************************************************************************/
@@ -164,6 +168,11 @@ extern "C" {
 EXTERN int creat(const char *path, mode_t mode);
 EXTERN int open(const char *path, int oflag, ...);
 EXTERN int fcntl(int fd, int cmd, ...);
+EXTERN int posix_fallocate(int fd, off_t offset, off_t len);
+
+/* Non-standard (linux) file space preallocation */
+
+EXTERN int fallocate(int fd, int mode, off_t offset, off_t len);
 
 #undef EXTERN
 #if defined(__cplusplus)
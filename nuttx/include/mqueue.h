@@ -40,6 +40,8 @@
  * Included Files
  ********************************************************************************/
 
+#include <nuttx/config.h>
+
 #include <sys/types.h>
 #include <signal.h>
 #include "queue.h"
@@ -54,6 +56,15 @@
 
 #define MQ_NONBLOCK O_NONBLOCK
 
+/* Non-standard mq_flags attribute used only when a message queue is created
+ * with mq_open():  Give the queue its own pool of messages and support the
+ * zero-copy interfaces.
+ */
+
+#ifdef CONFIG_MQ_ZEROCOPY
+#  define MQ_ZEROCOPY (1 << 15)
+#endif
+
 /********************************************************************************
  * Global Type Declarations
  ********************************************************************************/
@@ -101,6 +112,15 @@ EXTERN int     mq_setattr(mqd_t mqdes, const struct mq_attr *mq_stat,
                   struct mq_attr *oldstat);
 EXTERN int     mq_getattr(mqd_t mqdes, struct mq_attr *mq_stat);
 
+/* Non-standard zero-copy interfaces for queues created with MQ_ZEROCOPY */
+
+#ifdef CONFIG_MQ_ZEROCOPY
+EXTERN FAR void *mq_loan(mqd_t mqdes);
+EXTERN int     mq_sendloan(mqd_t mqdes, FAR void *buf, size_t msglen, int prio);
+EXTERN ssize_t mq_receiveloan(mqd_t mqdes, FAR void **buf, int *prio);
+EXTERN int     mq_return(mqd_t mqdes, FAR void *buf);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
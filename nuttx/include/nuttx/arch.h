@@ -46,6 +46,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <sched.h>
+#include <time.h>
 
 #include <arch/arch.h>
 
@@ -290,6 +291,38 @@ FAR void *up_stack_frame(FAR struct tcb_s *tcb, size_t frame_size);
 void up_release_stack(FAR struct tcb_s *dtcb, uint8_t ttype);
 #endif
 
+/****************************************************************************
+ * Name: up_check_tcbstack and friends
+ *
+ * Description:
+ *   Determine (approximately) how much stack a thread has used by searching
+ *   its stack memory for the deepest word that no longer holds the color
+ *   written by up_create_stack() or up_use_stack().  Because the color is
+ *   never restored, this is the high water mark of stack usage since the
+ *   thread was created.
+ *
+ *   up_check_tcbstack      - Stack used by the thread with this TCB
+ *   up_check_tcbstack_remain - Stack never used by that thread
+ *   up_check_stack         - up_check_tcbstack() for the running thread
+ *   up_check_stack_remain  - up_check_tcbstack_remain() for the running
+ *                            thread
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread to check
+ *
+ * Returned Value:
+ *   The number of bytes of stack used or remaining.  Zero is returned for
+ *   threads whose stack was not colored (the IDLE thread, for example).
+ *
+ ****************************************************************************/
+
+#if !defined(CONFIG_CUSTOM_STACK) && defined(CONFIG_STACK_COLORATION)
+size_t up_check_tcbstack(FAR struct tcb_s *tcb);
+size_t up_check_tcbstack_remain(FAR struct tcb_s *tcb);
+size_t up_check_stack(void);
+size_t up_check_stack_remain(void);
+#endif
+
 /****************************************************************************
  * Name: up_unblock_task
  *
@@ -955,6 +988,97 @@ void up_udelay(useconds_t microseconds);
 void up_cxxinitialize(void);
 #endif
 
+/****************************************************************************
+ * Name: up_timer_gettime
+ *
+ * Description:
+ *   If CONFIG_SCHED_TICKLESS is selected, then the platform must provide a
+ *   free-running counter.  This function returns the time elapsed since
+ *   the counter was started (i.e., since power-up).  All system time is
+ *   derived from this counter; it must be usable from the very beginning
+ *   of OS initialization and must never go backward.
+ *
+ * Input Parameters:
+ *   ts - Location to return the elapsed time.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+int up_timer_gettime(FAR struct timespec *ts);
+#endif
+
+/****************************************************************************
+ * Name: up_timer_start
+ *
+ * Description:
+ *   If CONFIG_SCHED_TICKLESS is selected, then the platform must provide a
+ *   one-shot timer.  This function starts (or re-starts) the one-shot timer
+ *   so that it expires after the provided interval.  Any previously started
+ *   interval is discarded.  When the timer expires, the platform must call
+ *   sched_timer_expiration().  The timer must never expire early.  An
+ *   interval of zero means that the timer should expire as soon as
+ *   possible.
+ *
+ * Input Parameters:
+ *   ts - The time interval until the timer expires, relative to the time
+ *        of the call.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+int up_timer_start(FAR const struct timespec *ts);
+#endif
+
+/****************************************************************************
+ * Name: up_timer_cancel
+ *
+ * Description:
+ *   Cancel the one-shot timer started by up_timer_start().  There is no
+ *   timed work pending and the platform may remain idle indefinitely.
+ *   This is not an error if the timer was not started.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+int up_timer_cancel(void);
+#endif
+
+/****************************************************************************
+ * Name: up_profile_enable
+ *
+ * Description:
+ *   Called by sched_profile_enable() when sampling is started or stopped
+ *   (CONFIG_SCHED_PROFILE).  While sampling is enabled, the platform must
+ *   call sched_profile_sample() once per system timer tick with the program
+ *   counter of the interrupted code (see include/nuttx/sched_profile.h).
+ *   Platforms that do that from the timer interrupt handler at all times
+ *   need do nothing here; others may use this to start and stop a
+ *   separate sampling source.
+ *
+ * Input Parameters:
+ *   enable - True: sampling is being started; false: it is being stopped
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_PROFILE
+void up_profile_enable(bool enable);
+#endif
+
 /****************************************************************************
  * These are standard interfaces that are exported by the OS
  * for use by the architecture specific logic
@@ -972,7 +1096,26 @@ void up_cxxinitialize(void);
  *
  ****************************************************************************/
 
+#ifndef CONFIG_SCHED_TICKLESS
 void sched_process_timer(void);
+#endif
+
+/****************************************************************************
+ * Name: sched_timer_expiration
+ *
+ * Description:
+ *   If CONFIG_SCHED_TICKLESS is selected, then this function replaces
+ *   sched_process_timer().  The platform-specific logic must call this
+ *   function when the one-shot timer started by up_timer_start() expires.
+ *   The OS will account for the elapsed time, process any expired
+ *   watchdogs and round-robin timeslices, and then re-start the one-shot
+ *   timer for the next expiration (if there is one).
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+void sched_timer_expiration(void);
+#endif
 
 /****************************************************************************
  * Name: irq_dispatch
@@ -131,10 +131,12 @@
 /* Direct access to the system timer/counter is supported only if (1) the
  * system timer counter is available (i.e., we are not configured to use
  * a hardware periodic timer), and (2) the execution environment has direct
- * access to kernel global data
+ * access to kernel global data.  In the tickless mode, there is no
+ * periodically incremented counter; the system timer is computed on
+ * demand from the platform's free-running counter by clock_systimer().
  */
 
-#if __HAVE_KERNEL_GLOBALS
+#if __HAVE_KERNEL_GLOBALS && !defined(CONFIG_SCHED_TICKLESS)
 #  ifdef CONFIG_SYSTEM_TIME64
 
 extern volatile uint64_t g_system_timer;
@@ -199,7 +201,7 @@ EXTERN void clock_synchronize(void);
  *   Return the current value of the 32-bit system timer counter.  Indirect
  *   access to the system timer counter is required through this function if
  *   the execution environment does not have direct access to kernel global
- *   data
+ *   data or if the tickless mode is selected
  *
  * Parameters:
  *   None
@@ -211,7 +213,7 @@ EXTERN void clock_synchronize(void);
  *
  ****************************************************************************/
 
-#if !__HAVE_KERNEL_GLOBALS
+#if !__HAVE_KERNEL_GLOBALS || defined(CONFIG_SCHED_TICKLESS)
 #  ifdef CONFIG_SYSTEM_TIME64
 #    define clock_systimer()  (uint32_t)(clock_systimer64() & 0x00000000ffffffff)
 #  else
@@ -238,7 +240,8 @@ EXTERN uint32_t clock_systimer(void);
  *
  ****************************************************************************/
 
-#if !__HAVE_KERNEL_GLOBALS && defined(CONFIG_SYSTEM_TIME64)
+#if (!__HAVE_KERNEL_GLOBALS || defined(CONFIG_SCHED_TICKLESS)) && \
+    defined(CONFIG_SYSTEM_TIME64)
 EXTERN uint64_t clock_systimer64(void);
 #endif
 
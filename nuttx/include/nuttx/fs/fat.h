@@ -65,6 +65,23 @@
 
 typedef uint8_t fat_attrib_t;
 
+/* Mountpoint sector cache and directory lookup cache statistics returned by
+ * the FIOC_CACHESTATS ioctl command.  The counts accumulate from the time
+ * that the volume is mounted.
+ */
+
+struct fat_cachestats_s
+{
+  uint32_t cs_hits;                /* Accesses satisfied by a cached sector */
+  uint32_t cs_misses;              /* Accesses that required a sector read */
+  uint32_t cs_writes;              /* Dirty sectors written back */
+  uint32_t cs_mirrorwrites;        /* Sectors written to the redundant FAT copies */
+  uint16_t cs_nsectors;            /* Number of sectors in the cache */
+  uint16_t cs_ndirty;              /* Number of cached sectors now dirty */
+  uint32_t cs_dirhits;             /* Names found at their cached directory position */
+  uint32_t cs_dirmisses;           /* Names that required a directory search */
+};
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -91,10 +108,11 @@ EXTERN int fat_setattrib(const char *path, fat_attrib_t setbits, fat_attrib_t cl
  * Name: fat_dma_alloc and fat_dma_free
  *
  * Description:
- *   The FAT file system allocates two I/O buffers for data transfer, each
- *   are the size of one device sector.  One of the buffers is allocated
- *   once for each FAT volume that is mounted; the other buffers are
- *   allocated each time a FAT file is opened.
+ *   The FAT file system allocates two kinds of I/O buffers for data
+ *   transfer, each a multiple of the size of one device sector.  The
+ *   sector cache (CONFIG_FAT_NCACHESECTORS sectors) is allocated once for
+ *   each FAT volume that is mounted; the other buffers are allocated each
+ *   time a FAT file is opened.
  *
  *   Some hardware, however, may require special DMA-capable memory in
  *   order to perform the the transfers.  If CONFIG_FAT_DMAMEMORY is defined
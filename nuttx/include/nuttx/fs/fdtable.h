@@ -0,0 +1,219 @@
+/****************************************************************************
+ * include/nuttx/fs/fdtable.h
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_FS_FDTABLE_H
+#define __INCLUDE_NUTTX_FS_FDTABLE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <nuttx/compiler.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* Descriptor tables.  The file descriptors (struct filelist) and the socket
+ * descriptors (struct socketlist) of each task group are managed with one
+ * of these.  A bitmap holds one bit for each descriptor that is in use and
+ * a summary word holds one bit for each full word of the bitmap, so that
+ * the lowest free descriptor is found with two bit searches no matter how
+ * many descriptors are configured.  That limits a table to 32*32
+ * descriptors.
+ *
+ * If CONFIG_FDTABLE_DYNAMIC is selected, the descriptor structures are not
+ * held in the table but allocated in blocks of CONFIG_FDTABLE_BLOCKSIZE
+ * when the first descriptor in the block is used.  Then a task group pays
+ * only for the descriptors that it actually uses (rounded up to the block
+ * size) plus a pointer per block and a bit per descriptor.  Blocks never
+ * move once allocated and are only freed with the table, so a descriptor
+ * structure may be used without holding the table lock as before.
+ */
+
+#define FDTABLE_MAXSIZE     (32*32)
+#define FDTABLE_NWORDS(n)   (((n) + 31) >> 5)
+
+#ifdef CONFIG_FDTABLE_DYNAMIC
+#  ifndef CONFIG_FDTABLE_BLOCKSIZE
+#    define CONFIG_FDTABLE_BLOCKSIZE 8
+#  endif
+#  define FDTABLE_NBLOCKS(n) \
+     (((n) + CONFIG_FDTABLE_BLOCKSIZE - 1) / CONFIG_FDTABLE_BLOCKSIZE)
+#endif
+
+#if CONFIG_NFILE_DESCRIPTORS > FDTABLE_MAXSIZE
+#  error CONFIG_NFILE_DESCRIPTORS is too large
+#endif
+
+#if defined(CONFIG_NSOCKET_DESCRIPTORS) && \
+    CONFIG_NSOCKET_DESCRIPTORS > FDTABLE_MAXSIZE
+#  error CONFIG_NSOCKET_DESCRIPTORS is too large
+#endif
+
+/****************************************************************************
+ * Type Definitions
+ ****************************************************************************/
+
+/* The table does not know the type of the descriptors.  The storage for the
+ * bitmap and the descriptors (or the block pointers) is provided by the
+ * containing structure, sized for the number of descriptors, and attached
+ * with fdtable_initialize().
+ */
+
+struct fdtable_s
+{
+  uint16_t      ft_size;     /* Number of descriptors */
+  uint16_t      ft_esize;    /* Size of one descriptor structure */
+  uint32_t      ft_full;     /* Bit n set: Word n of ft_inuse[] is full */
+  FAR uint32_t *ft_inuse;    /* Bit n set: Descriptor n is in use */
+#ifdef CONFIG_FDTABLE_DYNAMIC
+  FAR void    **ft_blocks;   /* Blocks of descriptors (NULL if not used) */
+#else
+  FAR uint8_t  *ft_base;     /* The array of descriptors */
+#endif
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C" {
+#else
+#define EXTERN extern
+#endif
+
+/* fs_fdtable.c *************************************************************/
+/****************************************************************************
+ * Name: fdtable_initialize
+ *
+ * Description:
+ *   Initialize an empty table of 'size' descriptors of 'esize' bytes each.
+ *   'inuse' is the bitmap (FDTABLE_NWORDS(size) words) and 'storage' is
+ *   either the array of descriptors or, if CONFIG_FDTABLE_DYNAMIC, the
+ *   array of FDTABLE_NBLOCKS(size) block pointers.
+ *
+ ****************************************************************************/
+
+void fdtable_initialize(FAR struct fdtable_s *table, int size, size_t esize,
+                        FAR uint32_t *inuse, FAR void *storage);
+
+/****************************************************************************
+ * Name: fdtable_release
+ *
+ * Description:
+ *   Free the descriptor blocks of a table.  The descriptors must already
+ *   have been closed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FDTABLE_DYNAMIC
+void fdtable_release(FAR struct fdtable_s *table);
+#else
+#  define fdtable_release(t)
+#endif
+
+/****************************************************************************
+ * Name: fdtable_allocate
+ *
+ * Description:
+ *   Mark the lowest free descriptor greater than or equal to 'minndx' as in
+ *   use.  Returns the index of the descriptor or a negated errno value:
+ *   -EMFILE if there is no free descriptor or -ENOMEM if the memory for it
+ *   could not be allocated.  The descriptor structure is zeroed if its
+ *   block was just allocated; otherwise it is left as it was freed.
+ *
+ ****************************************************************************/
+
+int fdtable_allocate(FAR struct fdtable_s *table, int minndx);
+
+/****************************************************************************
+ * Name: fdtable_reserve
+ *
+ * Description:
+ *   Mark one specific descriptor as in use (it may already be in use) and
+ *   return its structure.  Returns NULL if the index is out of range or if
+ *   the memory for the descriptor could not be allocated.
+ *
+ ****************************************************************************/
+
+FAR void *fdtable_reserve(FAR struct fdtable_s *table, int ndx);
+
+/****************************************************************************
+ * Name: fdtable_free
+ *
+ * Description:
+ *   Mark a descriptor as free.
+ *
+ ****************************************************************************/
+
+void fdtable_free(FAR struct fdtable_s *table, int ndx);
+
+/****************************************************************************
+ * Name: fdtable_get
+ *
+ * Description:
+ *   Return the structure of a descriptor, whether in use or not.  Returns
+ *   NULL if the index is out of range or if no memory has been allocated
+ *   for the descriptor (which then cannot be in use).
+ *
+ ****************************************************************************/
+
+FAR void *fdtable_get(FAR struct fdtable_s *table, int ndx);
+
+/****************************************************************************
+ * Name: fdtable_index
+ *
+ * Description:
+ *   Return the index of a descriptor structure or -1 if it does not belong
+ *   to the table.
+ *
+ ****************************************************************************/
+
+int fdtable_index(FAR struct fdtable_s *table, FAR const void *desc);
+
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* __INCLUDE_NUTTX_FS_FDTABLE_H */
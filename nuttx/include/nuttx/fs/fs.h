@@ -48,6 +48,8 @@
 #include <stdbool.h>
 #include <semaphore.h>
 
+#include <nuttx/fs/fdtable.h>
+
 /****************************************************************************
  * Definitions
  ****************************************************************************/
@@ -162,6 +164,8 @@ struct mountpt_operations
 
   int     (*sync)(FAR struct file *filp);
   int     (*dup)(FAR const struct file *oldp, FAR struct file *newp);
+  int     (*truncate)(FAR struct file *filp, off_t length);
+  int     (*allocate)(FAR struct file *filp, int mode, off_t offset, off_t len);
 
   /* Directory operations */
 
@@ -186,7 +190,7 @@ struct mountpt_operations
   int     (*stat)(FAR struct inode *mountpt, FAR const char *relpath, FAR struct stat *buf);
 
   /* NOTE:  More operations will be needed here to support:  disk usage stats
-   * file stat(), file attributes, file truncation, etc.
+   * file stat(), file attributes, etc.
    */
 };
 #endif /* CONFIG_DISABLE_MOUNTPOUNT */
@@ -234,13 +238,21 @@ struct file
   void             *f_priv;   /* Per file driver private data */
 };
 
-/* This defines a list of files indexed by the file descriptor */
+/* This defines a list of files indexed by the file descriptor.  Use
+ * files_getfile() to get the file structure of a descriptor.
+ */
 
 #if CONFIG_NFILE_DESCRIPTORS > 0
 struct filelist
 {
   sem_t   fl_sem;             /* Manage access to the file list */
+  struct fdtable_s fl_table;  /* Allocation of file descriptors */
+  uint32_t fl_inuse[FDTABLE_NWORDS(CONFIG_NFILE_DESCRIPTORS)];
+#ifdef CONFIG_FDTABLE_DYNAMIC
+  FAR void *fl_blocks[FDTABLE_NBLOCKS(CONFIG_NFILE_DESCRIPTORS)];
+#else
   struct file fl_files[CONFIG_NFILE_DESCRIPTORS];
+#endif
 };
 #endif
 
@@ -472,6 +484,39 @@ void files_initlist(FAR struct filelist *list);
 void files_releaselist(FAR struct filelist *list);
 #endif
 
+/****************************************************************************
+ * Name: files_getfile
+ *
+ * Description:
+ *   Return the file structure of a file descriptor in the list, whether it
+ *   is open or not.  Returns NULL if the descriptor is out of range or, if
+ *   CONFIG_FDTABLE_DYNAMIC, if no memory was ever allocated for it (in
+ *   which case it is not open either).
+ *
+ ****************************************************************************/
+
+#if CONFIG_NFILE_DESCRIPTORS > 0
+#  define files_getfile(list,fd) \
+     ((FAR struct file *)fdtable_get(&(list)->fl_table, fd))
+#endif
+
+/****************************************************************************
+ * Name: files_reserve, files_unreserve
+ *
+ * Description:
+ *   Reserve a specific file descriptor in a list so that it will not be
+ *   allocated by open() or dup() and return its file structure (NULL if it
+ *   is out of range or if no memory is available).  This is done before a
+ *   file is duplicated into the descriptor with files_dup().  If that fails,
+ *   the descriptor must be released again with files_unreserve().
+ *
+ ****************************************************************************/
+
+#if CONFIG_NFILE_DESCRIPTORS > 0
+FAR struct file *files_reserve(FAR struct filelist *list, int fd);
+void files_unreserve(FAR struct filelist *list, int fd);
+#endif
+
 /****************************************************************************
  * Name: files_dup
  *
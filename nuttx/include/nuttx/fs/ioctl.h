@@ -122,6 +122,14 @@
 * OUT: Bytes writable to this fd
 */
 
+#define FIOC_CACHESTATS _FIOC(0x0006)     /* IN:  Pointer to a write-able instance
+                                           *      of struct fat_cachestats_s
+                                           *      (see nuttx/fs/fat.h)
+                                           * OUT: Sector cache statistics for
+                                           *      the volume containing the
+                                           *      file
+                                           */
+
 /* NuttX file system ioctl definitions **************************************/
 
 #define _DIOCVALID(c)   (_IOC_TYPE(c)==_DIOCBASE)
@@ -116,10 +116,6 @@ extern "C" {
  *   The actual memory allocates will be 64 byte (wasting 17 bytes) and
  *   will be aligned at least to (1 << log2align).
  *
- *   NOTE: The current implementation also restricts the maximum allocation
- *   size to 32 granules.  That restriction could be eliminated with some
- *   additional coding effort.
- *
  * Input Parameters:
  *   heapstart - Start of the granule allocation heap
  *   heapsize  - Size of heap in bytes
@@ -146,16 +142,33 @@ EXTERN GRAN_HANDLE gran_initialize(FAR void *heapstart, size_t heapsize,
                                    uint8_t log2gran, uint8_t log2align);
 #endif
 
+/****************************************************************************
+ * Name: gran_release
+ *
+ * Description:
+ *   Uninitialize a granule allocator instance and release the resources
+ *   that it holds.  The memory that it managed is not affected.
+ *
+ * Input Parameters:
+ *   handle - The handle previously returned by gran_initialize
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_GRAN_SINGLE
+EXTERN void gran_release(void);
+#else
+EXTERN void gran_release(GRAN_HANDLE handle);
+#endif
+
 /****************************************************************************
  * Name: gran_alloc
  *
  * Description:
  *   Allocate memory from the granule heap.
  *
- *   NOTE: The current implementation also restricts the maximum allocation
- *   size to 32 granules.  That restriction could be eliminated with some
- *   additional coding effort.
- *
  * Input Parameters:
  *   handle - The handle previously returned by gran_initialize
  *   size   - The size of the memory region to allocate.
@@ -172,6 +185,38 @@ EXTERN FAR void *gran_alloc(size_t size);
 EXTERN FAR void *gran_alloc(GRAN_HANDLE handle, size_t size);
 #endif
 
+/****************************************************************************
+ * Name: gran_alloc_aligned
+ *
+ * Description:
+ *   Allocate memory from the granule heap with the start address aligned
+ *   to (1 << log2align) bytes.  This is intended for DMA buffers with
+ *   alignment requirements larger than the granule size.  The allocation
+ *   is taken from the smallest free region that can hold it (best fit) so
+ *   that larger regions remain available.  Unlike gran_alloc(), the time
+ *   required is proportional to the size of the granule heap.
+ *
+ *   The granule boundaries must be compatible with the alignment:  The
+ *   heap start must be aligned to the smaller of the granule size and the
+ *   requested alignment.
+ *
+ * Input Parameters:
+ *   handle    - The handle previously returned by gran_initialize
+ *   size      - The size of the memory region to allocate.
+ *   log2align - Log base 2 of the required alignment.
+ *
+ * Returned Value:
+ *   On success, a non-NULL pointer to the allocated memory is returned.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_GRAN_SINGLE
+EXTERN FAR void *gran_alloc_aligned(size_t size, uint8_t log2align);
+#else
+EXTERN FAR void *gran_alloc_aligned(GRAN_HANDLE handle, size_t size,
+                                    uint8_t log2align);
+#endif
+
 /****************************************************************************
  * Name: gran_free
  *
@@ -41,6 +41,8 @@
  ****************************************************************************/
 
 #ifndef __ASSEMBLY__
+# include <sys/types.h>
+# include <stdint.h>
 # include <assert.h>
 #endif
 
@@ -55,6 +57,15 @@
 # define irq_detach(isr) irq_attach(isr, NULL)
 #endif
 
+/* Return values from the top half of a threaded interrupt handler (see
+ * irq_attach_thread()).
+ */
+
+#ifdef CONFIG_IRQ_THREADED
+#  define IRQ_HANDLED       0  /* Handled completely in the top half */
+#  define IRQ_WAKE_THREAD   1  /* Run the bottom half */
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -65,6 +76,34 @@
 typedef int (*xcpt_t)(int irq, FAR void *context);
 #endif
 
+/* This is the bottom half of a threaded interrupt handler */
+
+#if defined(CONFIG_IRQ_THREADED) && !defined(__ASSEMBLY__)
+typedef void (*irqthread_t)(int irq, FAR void *arg);
+#endif
+
+/* Statistics for one IRQ as returned by irq_info().  Times are in
+ * microseconds with the resolution of the free-running timer in the
+ * tickless mode or of the system timer tick otherwise.  The counts and the
+ * latency total wrap around; rates and averages are computed from the
+ * differences between two samples.
+ */
+
+#if defined(CONFIG_IRQ_STATISTICS) && !defined(__ASSEMBLY__)
+struct irq_info_s
+{
+  uint32_t count;            /* Number of interrupts */
+#ifdef CONFIG_IRQ_THREADED
+  pid_t    pid;              /* Bottom half thread (0 if not threaded) */
+  uint8_t  priority;         /* Priority of the bottom half thread */
+  uint32_t nruns;            /* Number of runs of the bottom half */
+  uint32_t latsum;           /* Total wake-up latency of the bottom half */
+  uint32_t latmax;           /* Maximum wake-up latency */
+  uint32_t runmax;           /* Longest run of the bottom half */
+#endif
+};
+#endif
+
 /* Now include architecture-specific types */
 
 #include <arch/irq.h>
@@ -97,6 +136,56 @@ extern "C"
 
 int irq_attach(int irq, xcpt_t isr);
 
+/****************************************************************************
+ * Name: irq_attach_thread
+ *
+ * Description:
+ *   Attach a threaded interrupt handler to IRQ number 'irq'.  The handler
+ *   has two parts:
+ *
+ *   isr     - The top half.  It runs in interrupt context and should only
+ *             do what cannot wait (typically read and clear the interrupt
+ *             status) and return IRQ_WAKE_THREAD if the bottom half must
+ *             run or IRQ_HANDLED if not.  If NULL, then the IRQ is disabled
+ *             in the interrupt controller and the bottom half is woken; the
+ *             IRQ is enabled again after the bottom half has run.  A NULL
+ *             top half is not supported if CONFIG_ARCH_NOINTC or
+ *             CONFIG_ARCH_VECNOTIRQ is defined.
+ *   handler - The bottom half.  It runs in a kernel thread of its own at
+ *             'priority' with a stack of 'stacksize' bytes (or
+ *             CONFIG_IRQ_THREAD_STACKSIZE if zero).  It is passed 'arg'.
+ *
+ *   Interrupts that occur while the bottom half is pending are coalesced
+ *   into one run.  The thread is started immediately if the OS is running
+ *   or by os_bringup() for handlers attached during initialization.
+ *   irq_detach() stops the thread.
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value on failure:  -EINVAL if an
+ *   argument is invalid, -EBUSY if the IRQ already has a threaded handler
+ *   or -ENOMEM if all CONFIG_IRQ_NTHREADS handlers are in use or the
+ *   thread cannot be created.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IRQ_THREADED
+int irq_attach_thread(int irq, xcpt_t isr, irqthread_t handler,
+                      FAR void *arg, int priority, int stacksize);
+#endif
+
+/****************************************************************************
+ * Name: irq_info
+ *
+ * Description:
+ *   Return the statistics of IRQ number 'irq'.  Returns OK or -EINVAL if
+ *   the IRQ number is not valid.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IRQ_STATISTICS
+int irq_info(int irq, FAR struct irq_info_s *info);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -165,6 +165,18 @@ bool kmm_heapmember(FAR void *mem);
 #endif
 #endif
 
+/* Allocation with a placement hint (see mm_hintalloc() in nuttx/mm.h).  In
+ * the flat build, these use the same registry of named heaps as user code.
+ * In the kernel build, they use a separate registry of heaps in the kernel
+ * and so require the kernel heap.
+ */
+
+#if defined(CONFIG_MM_NAMED_HEAPS) && \
+   (!defined(CONFIG_NUTTX_KERNEL) || defined(CONFIG_MM_KERNEL_HEAP))
+# define kmalloc_hint(h,s)      mm_hintalloc(h,s)
+# define kzalloc_hint(h,s)      mm_hintzalloc(h,s)
+#endif
+
 /* Functions defined in sched/sched_kfree.c **********************************/
 
 /* Handles memory freed from an interrupt handler.  In that context, kfree()
@@ -43,6 +43,8 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <semaphore.h>
 
 /****************************************************************************
@@ -65,6 +67,15 @@
 #  define CONFIG_MM_SMALL 1
 #endif
 
+/* Caller tagging adds two words to each chunk header.  It is not supported
+ * with the small (16-bit) chunk header and requires GCC's
+ * __builtin_return_address().
+ */
+
+#if defined(CONFIG_MM_CALLERPC) && (defined(CONFIG_MM_SMALL) || !defined(__GNUC__))
+#  undef CONFIG_MM_CALLERPC
+#endif
+
 /* Chunk Header Definitions *************************************************/
 /* These definitions define the characteristics of allocator
  *
@@ -86,6 +97,9 @@
 #ifdef CONFIG_MM_SMALL
 #  define MM_MIN_SHIFT    4  /* 16 bytes */
 #  define MM_MAX_SHIFT   15  /* 32 Kb */
+#elif defined(CONFIG_MM_CALLERPC)
+#  define MM_MIN_SHIFT    5  /* 32 bytes */
+#  define MM_MAX_SHIFT   22  /*  4 Mb */
 #else
 #  define MM_MIN_SHIFT    4  /* 16 bytes */
 #  define MM_MAX_SHIFT   22  /*  4 Mb */
@@ -113,6 +127,148 @@
 #define MM_IS_ALLOCATED(n) \
   ((int)((struct mm_allocnode_s*)(n)->preceding) < 0))
 
+/* Two-Level Segregated Fit (TLSF) definitions.  If CONFIG_MM_TLSF is
+ * selected, then free chunks are kept in a two dimensional array of
+ * segregated lists instead of the size-ordered mm_nodelist[].  The first
+ * level index is the power-of-two range of the chunk size; the second level
+ * splits each range into MM_TLSF_SLCOUNT linear sub-ranges.  Chunks smaller
+ * than MM_TLSF_SMALL all share first level index zero and are binned
+ * linearly in units of MM_MIN_CHUNK.
+ *
+ * Non-empty lists are tracked with bitmaps so that a free chunk of
+ * sufficient size can be found with two find-first-set operations rather
+ * than a list search.
+ */
+
+#ifdef CONFIG_MM_TLSF
+#  ifndef CONFIG_MM_TLSF_SLSHIFT
+#    define CONFIG_MM_TLSF_SLSHIFT 3
+#  endif
+
+#  if CONFIG_MM_TLSF_SLSHIFT < 1 || CONFIG_MM_TLSF_SLSHIFT > 5
+#    error "CONFIG_MM_TLSF_SLSHIFT must be in the range 1-5"
+#  endif
+
+#  define MM_TLSF_SLSHIFT  CONFIG_MM_TLSF_SLSHIFT
+#  define MM_TLSF_SLCOUNT  (1 << MM_TLSF_SLSHIFT)
+#  define MM_TLSF_FLSHIFT  (MM_MIN_SHIFT + MM_TLSF_SLSHIFT)
+#  define MM_TLSF_SMALL    (1 << MM_TLSF_FLSHIFT)
+#  define MM_TLSF_FLCOUNT  (MM_MAX_SHIFT - MM_TLSF_FLSHIFT + 2)
+
+#  if MM_TLSF_FLSHIFT > MM_MAX_SHIFT
+#    error "CONFIG_MM_TLSF_SLSHIFT is too large for this memory model"
+#  endif
+#endif
+
+/* Small object cache definitions.  If CONFIG_MM_SLAB is selected, then each
+ * heap keeps a cache of recently freed chunks for each chunk size up to
+ * MM_SLAB_MAXCHUNK.  Small allocations are satisfied from these caches
+ * without taking the heap semaphore or searching the free lists.  Cached
+ * chunks remain marked as allocated as far as the heap is concerned.
+ */
+
+#ifdef CONFIG_MM_SLAB
+#  ifndef CONFIG_MM_SLAB_MAXSIZE
+#    define CONFIG_MM_SLAB_MAXSIZE 128
+#  endif
+
+#  ifndef CONFIG_MM_SLAB_BATCH
+#    define CONFIG_MM_SLAB_BATCH 8
+#  endif
+
+#  ifndef CONFIG_MM_SLAB_NCACHED
+#    define CONFIG_MM_SLAB_NCACHED 32
+#  endif
+
+#  define MM_SLAB_MAXCHUNK MM_ALIGN_UP(CONFIG_MM_SLAB_MAXSIZE + SIZEOF_MM_ALLOCNODE)
+#  define MM_SLAB_NCLASSES (MM_SLAB_MAXCHUNK >> MM_MIN_SHIFT)
+#  define MM_SLAB_NDX(s)   (((s) >> MM_MIN_SHIFT) - 1)
+#endif
+
+/* Heap statistics.  If CONFIG_MM_STATS is selected, then each heap keeps a
+ * count of the bytes held in allocated chunks (including chunk headers)
+ * and the peak value of that count.  The caller must hold the mm
+ * semaphore.
+ */
+
+#ifdef CONFIG_MM_STATS
+#  define MM_ADDUSED(h,n) \
+     do \
+       { \
+         (h)->mm_curused += (n); \
+         if ((h)->mm_curused > (h)->mm_maxused) \
+           { \
+             (h)->mm_maxused = (h)->mm_curused; \
+           } \
+       } \
+     while (0)
+#  define MM_SUBUSED(h,n) do { (h)->mm_curused -= (n); } while (0)
+#else
+#  define MM_ADDUSED(h,n)
+#  define MM_SUBUSED(h,n)
+#endif
+
+/* Caller tagging.  If CONFIG_MM_CALLERPC is selected, then each allocated
+ * chunk records the return address of the allocation call and the size
+ * that was requested.  MM_TAGNODE sets the tag of a chunk; MM_TAGCALLER
+ * tags the chunk of an allocation with the return address of the calling
+ * function and must be used only in the public allocation interfaces.
+ */
+
+#ifdef CONFIG_MM_CALLERPC
+#  define MM_TAGNODE(n,pc,s) \
+     do \
+       { \
+         (n)->callerpc = (uintptr_t)(pc); \
+         (n)->reqsize  = (s); \
+       } \
+     while (0)
+#  define MM_TAGCALLER(m,s) \
+     do \
+       { \
+         if (m) \
+           { \
+             MM_TAGNODE((FAR struct mm_allocnode_s *) \
+                        ((FAR char *)(m) - SIZEOF_MM_ALLOCNODE), \
+                        __builtin_return_address(0), (s)); \
+           } \
+       } \
+     while (0)
+#else
+#  define MM_TAGNODE(n,pc,s)
+#  define MM_TAGCALLER(m,s)
+#endif
+
+/* Named heaps.  If CONFIG_MM_NAMED_HEAPS is selected, then heaps created
+ * with mm_initialize() may be registered under a name together with flags
+ * that describe the memory.  mm_hintalloc() and friends then take the same
+ * flags as a placement hint and allocate from the first registered heap
+ * (in order of registration) that has all of the requested properties.
+ *
+ *   MM_HEAP_FAST   - Fast memory such as tightly coupled or core-coupled
+ *                    SRAM
+ *   MM_HEAP_DMA    - Memory that DMA controllers can access
+ *   MM_HEAP_BULK   - Large, possibly slower memory such as external SDRAM
+ *
+ * If no such heap can satisfy the request, the allocation falls back to the
+ * default heap (the user heap or, in the kernel build, the kernel heap)
+ * unless MM_HINT_STRICT is included in the hint.  Use MM_HINT_STRICT when
+ * a property is required (DMA) rather than preferred (FAST).
+ */
+
+#ifdef CONFIG_MM_NAMED_HEAPS
+#  ifndef CONFIG_MM_NAMED_NHEAPS
+#    define CONFIG_MM_NAMED_NHEAPS 4
+#  endif
+
+#  define MM_HEAP_FAST    0x01
+#  define MM_HEAP_DMA     0x02
+#  define MM_HEAP_BULK    0x04
+#  define MM_HEAP_PROPS   0x07   /* All of the above */
+
+#  define MM_HINT_STRICT  0x80
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -136,12 +292,18 @@ struct mm_allocnode_s
 {
   mmsize_t size;           /* Size of this chunk */
   mmsize_t preceding;      /* Size of the preceding chunk */
+#ifdef CONFIG_MM_CALLERPC
+  uintptr_t callerpc;      /* Return address of the allocation call */
+  mmsize_t reqsize;        /* Size requested by the caller */
+#endif
 };
 
 /* What is the size of the allocnode? */
 
 #ifdef CONFIG_MM_SMALL
 # define SIZEOF_MM_ALLOCNODE   4
+#elif defined(CONFIG_MM_CALLERPC)
+# define SIZEOF_MM_ALLOCNODE   16
 #else
 # define SIZEOF_MM_ALLOCNODE   8
 #endif
@@ -155,6 +317,10 @@ struct mm_freenode_s
 {
   mmsize_t size;                   /* Size of this chunk */
   mmsize_t preceding;              /* Size of the preceding chunk */
+#ifdef CONFIG_MM_CALLERPC
+  uintptr_t callerpc;              /* Unused in free chunks */
+  mmsize_t reqsize;
+#endif
   FAR struct mm_freenode_s *flink; /* Supports a doubly linked list */
   FAR struct mm_freenode_s *blink;
 };
@@ -167,6 +333,8 @@ struct mm_freenode_s
 #  else
 #     define SIZEOF_MM_FREENODE 12
 #  endif
+#elif defined(CONFIG_MM_CALLERPC)
+# define SIZEOF_MM_FREENODE     24
 #else
 # define SIZEOF_MM_FREENODE     16
 #endif
@@ -174,6 +342,63 @@ struct mm_freenode_s
 #define CHECK_FREENODE_SIZE \
   DEBUGASSERT(sizeof(struct mm_freenode_s) == SIZEOF_MM_FREENODE)
 
+/* This describes the cache of free chunks of one size class.  Cached chunks
+ * are linked through the flink field of struct mm_freenode_s.
+ */
+
+#ifdef CONFIG_MM_SLAB
+struct mm_slab_s
+{
+  FAR struct mm_freenode_s *ms_head; /* List of cached chunks */
+  uint16_t ms_ncached;               /* Number of chunks in the list */
+  uint32_t ms_nhits;                 /* Allocations taken from the cache */
+  uint32_t ms_nmisses;               /* Allocations that found it empty */
+  uint32_t ms_nfrees;                /* Frees kept in the cache */
+  uint32_t ms_nreleased;             /* Frees returned to the heap */
+};
+
+/* This is the information about one size class returned by mm_slabinfo() */
+
+struct mm_slabinfo_s
+{
+  size_t   chunksize;                /* Chunk size (including the header) */
+  unsigned ncached;                  /* Number of chunks held in the cache */
+  uint32_t nhits;                    /* Allocations taken from the cache */
+  uint32_t nmisses;                  /* Allocations that found it empty */
+  uint32_t nfrees;                   /* Frees kept in the cache */
+  uint32_t nreleased;                /* Frees returned to the heap */
+};
+#endif
+
+/* This is the heap usage information returned by mm_stats().  Chunks are
+ * counted in the same power-of-two size classes that are used for the
+ * mm_nodelist[] free lists:  Class n holds chunks of at least
+ * (MM_MIN_CHUNK << n) bytes; the last class also holds all larger chunks.
+ */
+
+#ifdef CONFIG_MM_STATS
+struct mm_stats_s
+{
+  size_t   curused;                  /* Bytes in allocated chunks */
+  size_t   maxused;                  /* Peak value of curused */
+  uint32_t nalloc[MM_NNODES];        /* Number of allocated chunks */
+  size_t   allocbytes[MM_NNODES];    /* Bytes in allocated chunks */
+  uint32_t nfree[MM_NNODES];         /* Number of free chunks */
+  size_t   freebytes[MM_NNODES];     /* Bytes in free chunks */
+};
+
+/* This describes one chunk in the heap snapshot returned by mm_snapshot() */
+
+struct mm_chunkinfo_s
+{
+  uintptr_t addr;                    /* Address of the chunk header */
+  size_t    size;                    /* Chunk size (including the header) */
+  uintptr_t callerpc;                /* Caller tag (zero if none) */
+  size_t    reqsize;                 /* Requested size (zero if none) */
+  bool      allocated;               /* True if the chunk is allocated */
+};
+#endif
+
 /* This describes one heap (possibly with multiple regions) */
 
 struct mm_heap_s
@@ -199,14 +424,55 @@ struct mm_heap_s
   int mm_nregions;
 #endif
 
+#ifdef CONFIG_MM_TLSF
+  /* Free nodes are maintained in segregated, doubly linked lists, one for
+   * each (first level, second level) size class.  Bit n of mm_flbitmap is
+   * set if any list of first level class n is non-empty; bit m of
+   * mm_slbitmap[n] is set if list mm_freelist[n][m] is non-empty.
+   */
+
+  uint32_t mm_flbitmap;
+  uint32_t mm_slbitmap[MM_TLSF_FLCOUNT];
+  FAR struct mm_freenode_s *mm_freelist[MM_TLSF_FLCOUNT][MM_TLSF_SLCOUNT];
+#else
   /* All free nodes are maintained in a doubly linked list.  This
    * array provides some hooks into the list at various points to
    * speed searches for free nodes.
    */
 
   struct mm_freenode_s mm_nodelist[MM_NNODES];
+#endif
+
+#ifdef CONFIG_MM_SLAB
+  /* Caches of free chunks for each small chunk size */
+
+  struct mm_slab_s mm_slab[MM_SLAB_NCLASSES];
+#endif
+
+#ifdef CONFIG_MM_STATS
+  /* Bytes held in allocated chunks and the peak of that value */
+
+  size_t mm_curused;
+  size_t mm_maxused;
+#endif
 };
 
+/* This is the information about one named heap returned by mm_heapinfo() */
+
+#ifdef CONFIG_MM_NAMED_HEAPS
+struct mm_heapinfo_s
+{
+  FAR const char *name;              /* Name given to mm_register() */
+  uint8_t  flags;                    /* MM_HEAP_* properties */
+  size_t   heapsize;                 /* Total size of all regions */
+  size_t   used;                     /* Bytes in allocated chunks */
+  size_t   largest;                  /* Largest free chunk */
+  uint32_t nalloc;                   /* Hinted allocations placed here */
+  uint32_t nfallback;                /* ... of which only as a fallback */
+  uint32_t nfail;                    /* Hinted allocations that failed here */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -227,6 +493,14 @@ EXTERN struct mm_heap_s g_mmheap;
 
 #endif
 
+#if defined(CONFIG_NUTTX_KERNEL) && defined(CONFIG_MM_KERNEL_HEAP) && \
+    defined(__KERNEL__)
+/* This is the kernel heap */
+
+EXTERN struct mm_heap_s g_kmmheap;
+
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -275,6 +549,7 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size);
 #ifdef CONFIG_MM_MULTIHEAP
 void mm_free(FAR struct mm_heap_s *heap, FAR void *mem);
 #endif
+void mm_freechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node);
 
 /* Functions contained in mm_realloc.c **************************************/
 
@@ -313,18 +588,94 @@ int  mm_mallinfo(FAR struct mm_heap_s *heap, FAR struct mallinfo *info);
 void mm_shrinkchunk(FAR struct mm_heap_s *heap,
                     FAR struct mm_allocnode_s *node, size_t size);
 
-/* Functions contained in mm_addfreechunk.c *********************************/
+/* Functions contained in mm_addfreechunk.c or mm_tlsf.c *******************/
 
 void mm_addfreechunk(FAR struct mm_heap_s *heap,
                      FAR struct mm_freenode_s *node);
 
+/* Functions contained in mm_remfreechunk.c or mm_tlsf.c *******************/
+
+void mm_remfreechunk(FAR struct mm_heap_s *heap,
+                     FAR struct mm_freenode_s *node);
+
 /* Functions contained in mm_size2ndx.c.c ***********************************/
 
+#ifndef CONFIG_MM_TLSF
 int mm_size2ndx(size_t size);
+#endif
+
+/* Functions contained in mm_tlsf.c *****************************************/
+
+#ifdef CONFIG_MM_TLSF
+void mm_tlsf_initialize(FAR struct mm_heap_s *heap);
+FAR struct mm_freenode_s *mm_tlsf_findchunk(FAR struct mm_heap_s *heap,
+                                            size_t size);
+#endif
+
+/* Functions contained in mm_slab.c *****************************************/
+
+#ifdef CONFIG_MM_SLAB
+void mm_slab_initialize(FAR struct mm_heap_s *heap);
+FAR struct mm_freenode_s *mm_slab_alloc(FAR struct mm_heap_s *heap,
+                                        size_t size);
+void mm_slab_add(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node);
+bool mm_slab_free(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node);
+bool mm_slab_flush(FAR struct mm_heap_s *heap);
+int  mm_slabinfo(FAR struct mm_heap_s *heap, int ndx,
+                 FAR struct mm_slabinfo_s *info);
+#endif
+
+/* Functions contained in mm_stats.c ****************************************/
+
+#ifdef CONFIG_MM_STATS
+int  mm_stats(FAR struct mm_heap_s *heap, FAR struct mm_stats_s *stats);
+int  mm_snapshot(FAR struct mm_heap_s *heap,
+                 FAR struct mm_chunkinfo_s *chunks, int nchunks);
+#endif
+
+/* Functions contained in mm_named.c ****************************************/
+
+#ifdef CONFIG_MM_NAMED_HEAPS
+int  mm_register(FAR struct mm_heap_s *heap, FAR const char *name,
+                 uint8_t flags);
+FAR struct mm_heap_s *mm_findheap(FAR const char *name);
+FAR struct mm_heap_s *mm_heapowner(FAR void *mem);
+FAR void *mm_hintalloc(uint8_t hint, size_t size);
+FAR void *mm_hintzalloc(uint8_t hint, size_t size);
+FAR void *mm_hintmemalign(uint8_t hint, size_t alignment, size_t size);
+int  mm_heapinfo(int ndx, FAR struct mm_heapinfo_s *info);
+#endif
 
 #undef EXTERN
 #ifdef __cplusplus
 }
 #endif
 
+/* C++ placement tag.  With this, objects can be placed in a named heap with
+ * the usual new and delete operators:
+ *
+ *   FAR int16_t *buffer = new (mm_placement(MM_HEAP_FAST)) int16_t[256];
+ *   ...
+ *   delete[] buffer;
+ *
+ * The operators are provided by libxx/libxx_newhint.cxx.  As with the other
+ * NuttX new operators, they return NULL on allocation failures.
+ */
+
+#if defined(__cplusplus) && defined(CONFIG_MM_NAMED_HEAPS)
+struct mm_placement
+{
+  uint8_t hint;
+  explicit mm_placement(uint8_t h) : hint(h) { }
+};
+
+#ifdef CONFIG_CXX_NEWLONG
+void *operator new(unsigned long nbytes, const mm_placement &where);
+void *operator new[](unsigned long nbytes, const mm_placement &where);
+#else
+void *operator new(unsigned int nbytes, const mm_placement &where);
+void *operator new[](unsigned int nbytes, const mm_placement &where);
+#endif
+#endif
+
 #endif /* __INCLUDE_NUTTX_MM_H */
@@ -80,6 +80,10 @@ struct msgq_s
   pid_t        ntpid;         /* Notification: Receiving Task's PID */
   int          ntsigno;       /* Notification: Signal number */
   union sigval ntvalue;       /* Notification: Signal value */
+#endif
+#ifdef CONFIG_MQ_ZEROCOPY
+  FAR void    *msgpool;       /* The queue's own messages (NULL if none) */
+  sq_queue_t   msgfree;       /* Free messages in msgpool */
 #endif
   char         name[1];       /* Start of the queue name */
 };
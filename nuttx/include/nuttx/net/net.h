@@ -48,6 +48,7 @@
 #include <stdarg.h>
 #include <semaphore.h>
 
+#include <nuttx/fs/fdtable.h>
 #include <nuttx/net/uip/uip.h>
 
 /****************************************************************************
@@ -100,13 +101,22 @@ struct socket
   FAR void     *s_conn;      /* Connection: struct uip_conn or uip_udp_conn */
 };
 
-/* This defines a list of sockets indexed by the socket descriptor */
+/* This defines a list of sockets indexed by the socket descriptor (less
+ * __SOCKFD_OFFSET).  Use net_getsocket() to get the socket structure for
+ * an index.
+ */
 
 #if CONFIG_NSOCKET_DESCRIPTORS > 0
 struct socketlist
 {
   sem_t   sl_sem;            /* Manage access to the socket list */
+  struct fdtable_s sl_table; /* Allocation of socket descriptors */
+  uint32_t sl_inuse[FDTABLE_NWORDS(CONFIG_NSOCKET_DESCRIPTORS)];
+#ifdef CONFIG_FDTABLE_DYNAMIC
+  FAR void *sl_blocks[FDTABLE_NBLOCKS(CONFIG_NSOCKET_DESCRIPTORS)];
+#else
   struct socket sl_sockets[CONFIG_NSOCKET_DESCRIPTORS];
+#endif
 };
 #endif
 
@@ -147,6 +157,19 @@ void weak_function net_initialize(void);
 void net_initlist(FAR struct socketlist *list);
 void net_releaselist(FAR struct socketlist *list);
 
+/* Return the socket structure at an index of the list (NULL if the index is
+ * out of range or, with CONFIG_FDTABLE_DYNAMIC, if no memory was ever
+ * allocated for it).  net_reserve() marks a specific index as in use before
+ * a socket is cloned into it with net_clone() and net_unreserve() releases
+ * it again if that fails.
+ */
+
+#define net_getsocket(list,ndx) \
+  ((FAR struct socket *)fdtable_get(&(list)->sl_table, ndx))
+
+FAR struct socket *net_reserve(FAR struct socketlist *list, int ndx);
+void net_unreserve(FAR struct socketlist *list, int ndx);
+
 /* Given a socket descriptor, return the underly NuttX-specific socket
  * structure.
  */
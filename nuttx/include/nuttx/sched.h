@@ -44,6 +44,7 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <queue.h>
 #include <signal.h>
 #include <semaphore.h>
@@ -139,6 +140,16 @@
 #  define CHILD_FLAG_TTYPE_KERNEL  (2 << CHILD_FLAG_TTYPE_SHIFT) /* Kernel thread */
 #define CHILD_FLAG_EXITED          (1 << 0) /* Bit 2: The child thread has exit'ed */
 
+/* Identifies the caches of recycled task memory (see sched_cachestats()) */
+
+#ifdef CONFIG_SCHED_TCBCACHE
+#  define SCHED_CACHE_TASK         0        /* struct task_tcb_s */
+#  define SCHED_CACHE_PTHREAD      1        /* struct pthread_tcb_s */
+#  define SCHED_CACHE_GROUP        2        /* struct task_group_s */
+#  define SCHED_CACHE_STACK        3        /* Task and pthread stacks */
+#  define SCHED_NCACHES            4
+#endif
+
 /********************************************************************************
  * Public Type Definitions
  ********************************************************************************/
@@ -464,6 +475,13 @@ struct tcb_s
 #endif
   FAR struct wdog_s *waitdog;            /* All timed waits used this wdog      */
 
+#ifdef CONFIG_SCHED_CPUACCT
+  uint32_t cputicks;                     /* CPU time used by the thread (ticks) */
+#ifdef CONFIG_SCHED_TICKLESS
+  uint32_t cpuusec;                      /* Plus the fraction of a tick (usec)  */
+#endif
+#endif
+
   /* Stack-Related Fields *******************************************************/
 
 #ifndef CONFIG_CUSTOM_STACK
@@ -590,6 +608,19 @@ struct pthread_tcb_s
 
 typedef void (*sched_foreach_t)(FAR struct tcb_s *tcb, FAR void *arg);
 
+/* struct sched_cachestats_s ****************************************************/
+/* Statistics of one cache of recycled task memory */
+
+#ifdef CONFIG_SCHED_TCBCACHE
+struct sched_cachestats_s
+{
+  uint32_t hits;                         /* Allocations taken from the cache    */
+  uint32_t misses;                       /* Allocations taken from the heap     */
+  uint32_t discards;                     /* Released to the heap, cache full    */
+  uint16_t ncached;                      /* Number of entries now in the cache  */
+};
+#endif
+
 #endif /* __ASSEMBLY__ */
 
 /********************************************************************************
@@ -624,6 +655,27 @@ FAR struct tcb_s *sched_self(void);
 
 void sched_foreach(sched_foreach_t handler, FAR void *arg);
 
+/* sched_cputime() returns the CPU time that has been consumed by a task or
+ * thread, including the time that it has been running since the last context
+ * switch.  If tcb is NULL, the time spent in interrupt handlers is returned
+ * instead.  The CPU time of the IDLE task is the time that the CPU has been
+ * idle.
+ */
+
+#ifdef CONFIG_SCHED_CPUACCT
+void sched_cputime(FAR struct tcb_s *tcb, FAR struct timespec *ts);
+#endif
+
+/* sched_cachestats() returns the statistics of one of the caches of recycled
+ * task memory (SCHED_CACHE_*).  If stats is NULL, nothing is returned.  If
+ * reset is true, the counts are cleared (after being returned).
+ */
+
+#ifdef CONFIG_SCHED_TCBCACHE
+void sched_cachestats(int cache, FAR struct sched_cachestats_s *stats,
+                      bool reset);
+#endif
+
 /* File system helpers **********************************************************/
 /* These functions all extract lists from the group structure assocated with the
  * currently executing task.
@@ -0,0 +1,182 @@
+/****************************************************************************
+ * include/nuttx/sched_profile.h
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_SCHED_PROFILE_H
+#define __INCLUDE_NUTTX_SCHED_PROFILE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* Configuration ************************************************************/
+/* CONFIG_SCHED_PROFILE - Sample the interrupted program counter from the
+ *   system timer interrupt into a buffer in RAM.  Requires support from
+ *   the architecture (CONFIG_ARCH_HAVE_PROFILE).
+ * CONFIG_SCHED_PROFILE_NSAMPLES - The size of the sample buffer.  When the
+ *   buffer is full, new samples are dropped until it is read.
+ * CONFIG_SCHED_PROFILE_INTERVAL - Take one sample every this many system
+ *   timer ticks.
+ */
+
+#ifndef CONFIG_SCHED_PROFILE_NSAMPLES
+#  define CONFIG_SCHED_PROFILE_NSAMPLES 1024
+#endif
+
+#ifndef CONFIG_SCHED_PROFILE_INTERVAL
+#  define CONFIG_SCHED_PROFILE_INTERVAL 1
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+#ifndef __ASSEMBLY__
+
+/* One sample in the profile buffer */
+
+struct sched_profile_s
+{
+  uintptr_t pc;         /* The program counter of the interrupted code */
+  int16_t   pid;        /* ID of the task that was running */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+#ifdef CONFIG_SCHED_PROFILE
+
+/****************************************************************************
+ * Name: sched_profile_sample
+ *
+ * Description:
+ *   Called by the architecture-specific logic on every system timer tick
+ *   (from the timer interrupt handler) with the program counter of the
+ *   code that was interrupted.  A sample is recorded every
+ *   CONFIG_SCHED_PROFILE_INTERVAL ticks while profiling is enabled.
+ *
+ *   This must not be called by application logic.
+ *
+ * Input Parameters:
+ *   pc - The interrupted program counter
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_profile_sample(uintptr_t pc);
+
+/****************************************************************************
+ * Name: sched_profile_enable
+ *
+ * Description:
+ *   Start or stop sampling.  Sampling is disabled at power-up.
+ *
+ * Input Parameters:
+ *   enable - True: start sampling; false: stop sampling
+ *
+ * Returned Value:
+ *   The previous state:  True if sampling was enabled.
+ *
+ ****************************************************************************/
+
+bool sched_profile_enable(bool enable);
+
+/****************************************************************************
+ * Name: sched_profile_clear
+ *
+ * Description:
+ *   Discard all samples in the buffer and reset the overrun count.
+ *
+ ****************************************************************************/
+
+void sched_profile_clear(void);
+
+/****************************************************************************
+ * Name: sched_profile_read
+ *
+ * Description:
+ *   Remove up to nsamples of the oldest samples from the buffer.
+ *
+ * Input Parameters:
+ *   buffer   - The location to return the samples
+ *   nsamples - The maximum number of samples to return
+ *
+ * Returned Value:
+ *   The number of samples returned.  Zero means that the buffer is empty.
+ *
+ ****************************************************************************/
+
+size_t sched_profile_read(FAR struct sched_profile_s *buffer,
+                          size_t nsamples);
+
+/****************************************************************************
+ * Name: sched_profile_overruns
+ *
+ * Description:
+ *   Return the number of samples that were dropped because the buffer was
+ *   full.
+ *
+ ****************************************************************************/
+
+uint32_t sched_profile_overruns(void);
+
+#endif /* CONFIG_SCHED_PROFILE */
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ASSEMBLY__ */
+#endif /* __INCLUDE_NUTTX_SCHED_PROFILE_H */
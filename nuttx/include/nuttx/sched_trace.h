@@ -0,0 +1,222 @@
+/****************************************************************************
+ * include/nuttx/sched_trace.h
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_SCHED_TRACE_H
+#define __INCLUDE_NUTTX_SCHED_TRACE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* Configuration ************************************************************/
+/* CONFIG_SCHED_TRACE - Record scheduler events in a ring buffer in RAM.
+ * CONFIG_SCHED_TRACE_NEVENTS - The size of the ring buffer in events.  When
+ *   the buffer is full, the oldest events are overwritten.
+ * CONFIG_SCHED_TRACE_IRQ - Also record interrupt entry and exit.
+ */
+
+#ifndef CONFIG_SCHED_TRACE_NEVENTS
+#  define CONFIG_SCHED_TRACE_NEVENTS 512
+#endif
+
+/* Trace event types.  The pid and priority of each event are those of the
+ * task that the event applies to; the meaning of the argument depends on
+ * the event type:
+ *
+ *   SCHED_TRACE_START    - A task was started.  arg is unused.
+ *   SCHED_TRACE_STOP     - A task was stopped.  arg is the high water mark
+ *                          of its stack usage in bytes if
+ *                          CONFIG_STACK_COLORATION is enabled, else zero.
+ *   SCHED_TRACE_SWITCH   - The task started running.  arg is the ID of the
+ *                          task that was running before it.
+ *   SCHED_TRACE_IRQENTER - An interrupt was entered while the task was
+ *                          running.  arg is the IRQ number.
+ *   SCHED_TRACE_IRQLEAVE - The interrupt handler returned.  arg is the IRQ
+ *                          number.
+ *   SCHED_TRACE_SEMBLOCK - The task blocked on a semaphore.  arg is the
+ *                          address of the semaphore.
+ *   SCHED_TRACE_SEMWAKE  - The task was awakened from a semaphore wait.  arg
+ *                          is the address of the semaphore.
+ *   SCHED_TRACE_MQBLOCK  - The task blocked on a message queue (full or
+ *                          empty).  arg is the address of the message queue.
+ *   SCHED_TRACE_MQWAKE   - The task was awakened from a message queue wait.
+ *                          arg is the address of the message queue.
+ *
+ * These values are part of the dump format read by tools/tracedecode.py.
+ */
+
+#define SCHED_TRACE_START     0
+#define SCHED_TRACE_STOP      1
+#define SCHED_TRACE_SWITCH    2
+#define SCHED_TRACE_IRQENTER  3
+#define SCHED_TRACE_IRQLEAVE  4
+#define SCHED_TRACE_SEMBLOCK  5
+#define SCHED_TRACE_SEMWAKE   6
+#define SCHED_TRACE_MQBLOCK   7
+#define SCHED_TRACE_MQWAKE    8
+
+/* If tracing is not enabled, then the trace hooks compile to nothing */
+
+#ifndef CONFIG_SCHED_TRACE
+#  define sched_trace_event(t,tcb,a)
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+#ifndef __ASSEMBLY__
+
+/* One event in the trace buffer */
+
+struct sched_trace_s
+{
+  uint32_t time;        /* Time of the event in microseconds */
+  uint8_t  type;        /* Event type.  See SCHED_TRACE_* definitions */
+  uint8_t  priority;    /* Priority of the task at the time of the event */
+  int16_t  pid;         /* ID of the task */
+  uint32_t arg;         /* Event-specific argument */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+#ifdef CONFIG_SCHED_TRACE
+
+struct tcb_s; /* Forward reference */
+
+/****************************************************************************
+ * Name: sched_trace_event
+ *
+ * Description:
+ *   Record one event in the trace buffer.  This is called from the OS
+ *   internally (possibly from interrupt handlers) and should not be called
+ *   by application logic.
+ *
+ * Input Parameters:
+ *   type - The event type (SCHED_TRACE_*)
+ *   tcb  - The TCB of the task that the event applies to
+ *   arg  - The event-specific argument
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_trace_event(uint8_t type, FAR struct tcb_s *tcb, uint32_t arg);
+
+/****************************************************************************
+ * Name: sched_trace_enable
+ *
+ * Description:
+ *   Start or stop recording events.  Recording is enabled at power-up so
+ *   that the trace buffer always holds the most recent events.
+ *
+ * Input Parameters:
+ *   enable - True: start recording; false: stop recording
+ *
+ * Returned Value:
+ *   The previous state:  True if recording was enabled.
+ *
+ ****************************************************************************/
+
+bool sched_trace_enable(bool enable);
+
+/****************************************************************************
+ * Name: sched_trace_clear
+ *
+ * Description:
+ *   Discard all events in the trace buffer and reset the overrun count.
+ *
+ ****************************************************************************/
+
+void sched_trace_clear(void);
+
+/****************************************************************************
+ * Name: sched_trace_read
+ *
+ * Description:
+ *   Remove up to nevents of the oldest events from the trace buffer.
+ *
+ * Input Parameters:
+ *   buffer  - The location to return the events
+ *   nevents - The maximum number of events to return
+ *
+ * Returned Value:
+ *   The number of events returned.  Zero means that the trace buffer is
+ *   empty.
+ *
+ ****************************************************************************/
+
+size_t sched_trace_read(FAR struct sched_trace_s *buffer, size_t nevents);
+
+/****************************************************************************
+ * Name: sched_trace_overruns
+ *
+ * Description:
+ *   Return the number of events that were lost (overwritten by newer
+ *   events) because the trace buffer was full.
+ *
+ ****************************************************************************/
+
+uint32_t sched_trace_overruns(void);
+
+#endif /* CONFIG_SCHED_TRACE */
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ASSEMBLY__ */
+#endif /* __INCLUDE_NUTTX_SCHED_TRACE_H */
@@ -44,6 +44,7 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <signal.h>
 #include <queue.h>
 
@@ -85,6 +86,14 @@
  *  checks for work in units of microseconds.  Default: 50*1000 (50 MS).
  * CONFIG_SCHED_LPWORKSTACKSIZE - The stack size allocated for the lower
  *   priority worker thread.  Default: CONFIG_IDLETHREAD_STACKSIZE.
+ * CONFIG_SCHED_LPNTHREADS - The number of threads in the lower priority
+ *   worker thread pool.  All of the threads share the same work queue so
+ *   that one long-running work item does not stall the others.  Each
+ *   thread gets its own CONFIG_SCHED_LPWORKSTACKSIZE stack.  Default: 1
+ *
+ * CONFIG_SCHED_WORKSTATS - Collect per-queue statistics of the latency
+ *   (from the time that the work became due until it started) and the
+ *   execution time of each work item.  See work_getstats().
  */
 
 /* Is this a kernel build (CONFIG_NUTTX_KERNEL=y) */
@@ -182,6 +191,16 @@
 #    define CONFIG_SCHED_LPWORKSTACKSIZE CONFIG_IDLETHREAD_STACKSIZE
 #  endif
 
+#  ifndef CONFIG_SCHED_LPNTHREADS
+#    define CONFIG_SCHED_LPNTHREADS 1
+#  endif
+
+/* The set of idle worker threads is kept in an 8-bit mask */
+
+#if CONFIG_SCHED_LPNTHREADS < 1 || CONFIG_SCHED_LPNTHREADS > 8
+#  error "CONFIG_SCHED_LPNTHREADS must be in the range 1-8"
+#endif
+
 /* The high priority worker thread should be higher priority than the low
  * priority worker thread.
  */
@@ -264,21 +283,59 @@
 
 #endif /* CONFIG_NUTTX_KERNEL && !__KERNEL__ */
 
+/* The maximum number of threads serving any one work queue.  Only the low
+ * priority, kernel work queue may be served by more than one thread.
+ */
+
+#ifdef CONFIG_SCHED_LPWORK
+#  define WORK_MAXTHREADS CONFIG_SCHED_LPNTHREADS
+#else
+#  define WORK_MAXTHREADS 1
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
 #ifndef __ASSEMBLY__
 
+/* Work queue statistics.  All times are in units of system clock ticks.
+ * The latency of a work item is the time from when the work became due
+ * (i.e., when it was queued plus its delay) until a worker thread started
+ * it.
+ */
+
+#ifdef CONFIG_SCHED_WORKSTATS
+struct work_stats_s
+{
+  uint32_t count;        /* The number of work items performed */
+  uint32_t totlatency;   /* Sum of the latencies of all work items */
+  uint32_t maxlatency;   /* The largest latency of any work item */
+  uint32_t totexec;      /* Sum of the execution times of all work items */
+  uint32_t maxexec;      /* The longest execution time of any work item */
+};
+#endif
+
 /* This structure defines the state on one work queue.  This structure is
  * used internally by the OS and worker queue logic and should not be
  * accessed by application logic.
+ *
+ * Work that is ready to be performed is kept in the FIFO q.  Delayed work
+ * is kept in dq, ordered by the time that it becomes due, so that the
+ * worker threads only ever need to examine the head of dq to know when
+ * the next delayed work must be performed.  When delayed work becomes due,
+ * it is moved to the tail of q.
  */
 
 struct wqueue_s
 {
-  pid_t             pid; /* The task ID of the worker thread */
-  struct dq_queue_s q;   /* The queue of pending work */
+  pid_t             pid[WORK_MAXTHREADS]; /* The task IDs of the worker threads */
+  uint8_t           idle;     /* Set of worker threads waiting for work */
+  struct dq_queue_s q;        /* The queue of work ready to be performed */
+  struct dq_queue_s dq;       /* The queue of delayed work, by due time */
+#ifdef CONFIG_SCHED_WORKSTATS
+  struct work_stats_s stats;  /* Work queue statistics */
+#endif
 };
 
 /* Defines the work callback */
@@ -295,8 +352,8 @@ struct work_s
   struct dq_entry_s dq;  /* Implements a doubly linked list */
   worker_t  worker;      /* Work callback */
   FAR void *arg;         /* Callback argument */
-  uint32_t  qtime;       /* Time work queued */
-  uint32_t  delay;       /* Delay until work performed */
+  uint32_t  qtime;       /* Time work queued (or became due) */
+  uint32_t  delay;       /* Delay until work performed (zero once due) */
 };
 
 /****************************************************************************
@@ -377,6 +434,10 @@ int work_hpthread(int argc, char *argv[]);
 int work_lpthread(int argc, char *argv[]);
 #endif
 
+/* The low priority worker threads are started with their index in the
+ * worker thread pool as argv[1].
+ */
+
 #ifdef CONFIG_SCHED_USRWORK
 int work_usrthread(int argc, char *argv[]);
 #endif
@@ -457,7 +518,10 @@ int work_cancel(int qid, FAR struct work_s *work);
  * Description:
  *   Signal the worker thread to process the work queue now.  This function
  *   is used internally by the work logic but could also be used by the
- *   user to force an immediate re-assessment of pending work.
+ *   user to force an immediate re-assessment of pending work.  If the
+ *   queue is served by more than one thread, only one idle thread is
+ *   awakened; if no thread is idle, nothing is done because busy threads
+ *   always re-assess the work queue before they wait again.
  *
  * Input parameters:
  *   qid    - The work queue ID
@@ -469,6 +533,27 @@ int work_cancel(int qid, FAR struct work_s *work);
 
 int work_signal(int qid);
 
+/****************************************************************************
+ * Name: work_getstats
+ *
+ * Description:
+ *   Return a snapshot of the statistics of one work queue and, optionally,
+ *   reset them.
+ *
+ * Input parameters:
+ *   qid    - The work queue ID
+ *   stats  - The location to return the statistics (may be NULL)
+ *   reset  - True: Reset the statistics after taking the snapshot
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKSTATS
+int work_getstats(int qid, FAR struct work_stats_s *stats, bool reset);
+#endif
+
 /****************************************************************************
  * Name: work_available
  *
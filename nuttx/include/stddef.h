@@ -42,6 +42,18 @@
 
 #include <sys/types.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The byte offset of member m within the structure type t */
+
+#ifdef __GNUC__
+#  define offsetof(t,m) __builtin_offsetof(t,m)
+#else
+#  define offsetof(t,m) ((size_t)&(((FAR t *)0)->m))
+#endif
+
 /****************************************************************************
  * Type Definitions
  ****************************************************************************/
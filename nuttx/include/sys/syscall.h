@@ -258,7 +258,9 @@
 #    define SYS_rmdir                  (__SYS_mountpoint+4)
 #    define SYS_umount                 (__SYS_mountpoint+5)
 #    define SYS_unlink                 (__SYS_mountpoint+6)
-#    define __SYS_pthread              (__SYS_mountpoint+7)
+#    define SYS_ftruncate              (__SYS_mountpoint+7)
+#    define SYS_fallocate              (__SYS_mountpoint+8)
+#    define __SYS_pthread              (__SYS_mountpoint+9)
 #  else
 #    define __SYS_pthread              __SYS_mountpoint
 #  endif
@@ -90,6 +90,17 @@
 #  define CLOCK_ACTIVETIME CLOCK_REALTIME
 #endif
 
+/* CLOCK_THREAD_CPUTIME_ID measures the CPU time consumed by the calling thread.
+ * The clock ID of the CPU time clock of any other thread or task may be
+ * obtained with clock_getcpuclockid().  These clocks are only recognized by
+ * clock_gettime() and clock_getres() and are only available if per-task CPU
+ * time accounting is enabled (CONFIG_SCHED_CPUACCT).
+ */
+
+#ifdef CONFIG_SCHED_CPUACCT
+#  define CLOCK_THREAD_CPUTIME_ID 2
+#endif
+
 /* This is a flag that may be passed to the timer_settime() function */
 
 #define TIMER_ABSTIME      1
@@ -104,7 +115,12 @@
  ********************************************************************************/
 
 typedef uint32_t  time_t;         /* Holds time in seconds */
+#ifdef CONFIG_SCHED_CPUACCT
+typedef int       clockid_t;      /* Identifies one time base source or the
+                                   * CPU time clock of one task (PID) */
+#else
 typedef uint8_t   clockid_t;      /* Identifies one time base source */
+#endif
 typedef FAR void *timer_t;        /* Represents one POSIX timer */
 
 struct timespec
@@ -169,6 +185,9 @@ EXTERN clock_t clock(void);
 EXTERN int clock_settime(clockid_t clockid, const struct timespec *tp);
 EXTERN int clock_gettime(clockid_t clockid, struct timespec *tp);
 EXTERN int clock_getres(clockid_t clockid, struct timespec *res);
+#ifdef CONFIG_SCHED_CPUACCT
+EXTERN int clock_getcpuclockid(pid_t pid, FAR clockid_t *clockid);
+#endif
 
 EXTERN time_t mktime(const struct tm *tp);
 EXTERN FAR struct tm *gmtime(FAR const time_t *timer);
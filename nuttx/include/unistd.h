@@ -142,6 +142,7 @@ EXTERN int     close(int fd);
 EXTERN int     dup(int fd);
 EXTERN int     dup2(int fd1, int fd2);
 EXTERN int     fsync(int fd);
+EXTERN int     ftruncate(int fd, off_t length);
 EXTERN off_t   lseek(int fd, off_t offset, int whence);
 EXTERN ssize_t read(int fd, FAR void *buf, size_t nbytes);
 EXTERN ssize_t write(int fd, FAR const void *buf, size_t nbytes);
@@ -105,16 +105,23 @@ int work_cancel(int qid, FAR struct work_s *work)
   flags = irqsave();
   if (work->worker != NULL)
     {
+      /* Work that has not yet become due is in the list of delayed work;
+       * work that is ready to be performed has a zero delay and is in the
+       * FIFO of ready work.
+       */
+
+      FAR dq_queue_t *q = work->delay ? &wqueue->dq : &wqueue->q;
+
       /* A little test of the integrity of the work queue */
 
-      DEBUGASSERT(work->dq.flink ||(FAR dq_entry_t *)work == wqueue->q.tail);
-      DEBUGASSERT(work->dq.blink ||(FAR dq_entry_t *)work == wqueue->q.head);
+      DEBUGASSERT(work->dq.flink ||(FAR dq_entry_t *)work == q->tail);
+      DEBUGASSERT(work->dq.blink ||(FAR dq_entry_t *)work == q->head);
 
       /* Remove the entry from the work queue and make sure that it is
        * mark as availalbe (i.e., the worker field is nullified).
        */
 
-      dq_rem((FAR dq_entry_t *)work, &wqueue->q);
+      dq_rem((FAR dq_entry_t *)work, q);
       work->worker = NULL;
     }
 
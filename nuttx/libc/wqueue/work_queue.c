@@ -126,8 +126,48 @@ int work_queue(int qid, FAR struct work_s *work, worker_t worker,
   flags        = irqsave();
   work->qtime  = clock_systimer(); /* Time work queued */
 
-  dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
-  kill(wqueue->pid, SIGWORK);      /* Wake up the worker thread */
+  if (delay == 0)
+    {
+      /* The work is ready now.  Just add it to the end of the FIFO of ready
+       * work.
+       */
+
+      dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
+      (void)work_signal(qid);      /* Wake up a worker thread */
+    }
+  else
+    {
+      FAR struct work_s *next;
+      uint32_t due = work->qtime + delay;
+
+      /* Insert the delayed work into the list of delayed work, ordered by
+       * the time that it becomes due.  Work with the same due time is kept
+       * in FIFO order.  The signed comparison allows for timer wrap-around.
+       */
+
+      for (next = (FAR struct work_s *)wqueue->dq.head;
+           next && (int32_t)(next->qtime + next->delay - due) <= 0;
+           next = (FAR struct work_s *)next->dq.flink);
+
+      if (next)
+        {
+          dq_addbefore((FAR dq_entry_t *)next, (FAR dq_entry_t *)work,
+                       &wqueue->dq);
+        }
+      else
+        {
+          dq_addlast((FAR dq_entry_t *)work, &wqueue->dq);
+        }
+
+      /* If this is now the first delayed work to become due, then a worker
+       * thread must re-evaluate how long it waits.
+       */
+
+      if ((FAR dq_entry_t *)work == wqueue->dq.head)
+        {
+          (void)work_signal(qid);
+        }
+    }
 
   irqrestore(flags);
   return OK;
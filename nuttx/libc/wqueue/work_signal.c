@@ -42,6 +42,7 @@
 #include <signal.h>
 #include <assert.h>
 
+#include <nuttx/arch.h>
 #include <nuttx/wqueue.h>
 
 #ifdef CONFIG_SCHED_WORKQUEUE
@@ -75,7 +76,9 @@
  * Description:
  *   Signal the worker thread to process the work queue now.  This function
  *   is used internally by the work logic but could also be used by the
- *   user to force an immediate re-assessment of pending work.
+ *   user to force an immediate re-assessment of pending work.  If the
+ *   queue is served by more than one thread, only one idle thread is
+ *   awakened.
  *
  * Input parameters:
  *   qid    - The work queue ID
@@ -87,8 +90,35 @@
 
 int work_signal(int qid)
 {
+  FAR struct wqueue_s *wqueue = &g_work[qid];
+  irqstate_t flags;
+  int ret = OK;
+  int i;
+
   DEBUGASSERT((unsigned)qid < NWORKERS);
-  return kill(g_work[qid].pid, SIGWORK);
+
+  /* Find an idle worker thread.  If there is none, then all of the worker
+   * threads are busy and each will re-assess the work queue when it
+   * finishes its current work.
+   */
+
+  flags = irqsave();
+  for (i = 0; i < WORK_MAXTHREADS; i++)
+    {
+      if ((wqueue->idle & (1 << i)) != 0)
+        {
+          /* Mark the thread busy now so that the next signal will wake a
+           * different thread, then wake it up.
+           */
+
+          wqueue->idle &= ~(1 << i);
+          ret = kill(wqueue->pid[i], SIGWORK);
+          break;
+        }
+    }
+
+  irqrestore(flags);
+  return ret;
 }
 
 #endif /* CONFIG_SCHED_WORKQUEUE */
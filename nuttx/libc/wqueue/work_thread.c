@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <queue.h>
 #include <assert.h>
@@ -104,97 +105,148 @@ struct wqueue_s g_work[NWORKERS];
  *   This is the logic that performs actions placed on any work list.
  *
  * Input parameters:
- *   wqueue - Describes the work queue to be processed
+ *   qid  - The ID of the work queue to be processed
+ *   wndx - The index of the calling thread in the pool of worker threads
+ *          serving the work queue
  *
  * Returned Value:
  *   None
  *
  ****************************************************************************/
 
-static void work_process(FAR struct wqueue_s *wqueue)
+static void work_process(int qid, int wndx)
 {
-  volatile FAR struct work_s *work;
+  FAR struct wqueue_s *wqueue = &g_work[qid];
+  FAR struct work_s *work;
   worker_t  worker;
   irqstate_t flags;
   FAR void *arg;
+  uint32_t now;
   uint32_t elapsed;
-  uint32_t remaining;
   uint32_t next;
+#ifdef CONFIG_SCHED_WORKSTATS
+  uint32_t latency;
+#endif
 
   /* Then process queued work.  We need to keep interrupts disabled while
    * we process items in the work list.
    */
 
-  next  = CONFIG_SCHED_WORKPERIOD / USEC_PER_TICK;
   flags = irqsave();
-  work  = (FAR struct work_s *)wqueue->q.head;
-  while (work)
+  for (;;)
     {
-      /* Is this work ready?  It is ready if there is no delay or if
-       * the delay has elapsed. qtime is the time that the work was added
-       * to the work queue.  It will always be greater than or equal to
-       * zero.  Therefore a delay of zero will always execute immediately.
+      /* Move any delayed work that has become due to the end of the FIFO of
+       * ready work.  Delayed work is ordered by the time that it becomes
+       * due, so only the head of the list needs to be examined.  qtime is
+       * the time that the work was added to the work queue.  It will always
+       * be greater than or equal to zero.
        */
 
-      elapsed = clock_systimer() - work->qtime;
-      if (elapsed >= work->delay)
+      now = clock_systimer();
+      while ((work = (FAR struct work_s *)wqueue->dq.head) != NULL &&
+             now - work->qtime >= work->delay)
         {
-          /* Remove the ready-to-execute work from the list */
+          (void)dq_remfirst(&wqueue->dq);
 
-          (void)dq_rem((struct dq_entry_s *)work, &wqueue->q);
-
-          /* Extract the work description from the entry (in case the work
-           * instance by the re-used after it has been de-queued).
+          /* From now on, qtime is the time that the work became due and a
+           * zero delay indicates that the work is in the FIFO of ready work.
            */
 
-          worker = work->worker;
-          arg    = work->arg;
+          work->qtime += work->delay;
+          work->delay  = 0;
+          dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
+        }
 
-          /* Mark the work as no longer being queued */
+      /* Take the oldest ready-to-execute work from the list */
 
-          work->worker = NULL;
+      work = (FAR struct work_s *)dq_remfirst(&wqueue->q);
+      if (!work)
+        {
+          break;
+        }
 
-          /* Do the work.  Re-enable interrupts while the work is being
-           * performed... we don't have any idea how long that will take!
-           */
+      /* If there is still more work ready, then let any idle worker thread
+       * start on it while this thread is busy.
+       */
+
+      if (wqueue->q.head && wqueue->idle)
+        {
+          (void)work_signal(qid);
+        }
 
-          irqrestore(flags);
-          worker(arg);
+      /* Extract the work description from the entry (in case the work
+       * instance by the re-used after it has been de-queued).
+       */
 
-          /* Now, unfortunately, since we re-enabled interrupts we don't
-           * know the state of the work list and we will have to start
-           * back at the head of the list.
-           */
+      worker = work->worker;
+      arg    = work->arg;
+#ifdef CONFIG_SCHED_WORKSTATS
+      latency = now - work->qtime;
+#endif
+
+      /* Mark the work as no longer being queued */
 
-          flags = irqsave();
-          work  = (FAR struct work_s *)wqueue->q.head;
+      work->worker = NULL;
+
+      /* Do the work.  Re-enable interrupts while the work is being
+       * performed... we don't have any idea how long that will take!
+       */
+
+      irqrestore(flags);
+      worker(arg);
+
+      /* The work structure may not be accessed again; it may have been
+       * re-queued or even freed by the worker.
+       */
+
+      flags = irqsave();
+
+#ifdef CONFIG_SCHED_WORKSTATS
+      elapsed = clock_systimer() - now;
+
+      wqueue->stats.count++;
+      wqueue->stats.totlatency += latency;
+      wqueue->stats.totexec    += elapsed;
+
+      if (latency > wqueue->stats.maxlatency)
+        {
+          wqueue->stats.maxlatency = latency;
         }
-      else
+
+      if (elapsed > wqueue->stats.maxexec)
         {
-          /* This one is not ready.. will it be ready before the next
-           * scheduled wakeup interval?
-           */
+          wqueue->stats.maxexec = elapsed;
+        }
+#endif
+    }
 
-          /* Here: elapsed < work->delay */
-          remaining = work->delay - elapsed;
-          if (remaining < next)
-            {
-              /* Yes.. Then schedule to wake up when the work is ready */
+  /* There is no more work ready.  Wake up in time to perform the first
+   * delayed work or at the next scheduled wakeup interval, whichever is
+   * first.
+   */
 
-              next = remaining;
-            }
-              
-          /* Then try the next in the list. */
+  next = CONFIG_SCHED_WORKPERIOD / USEC_PER_TICK;
+  work = (FAR struct work_s *)wqueue->dq.head;
+  if (work)
+    {
+      /* Here: now - work->qtime < work->delay */
 
-          work = (FAR struct work_s *)work->dq.flink;
+      elapsed = now - work->qtime;
+      if (work->delay - elapsed < next)
+        {
+          next = work->delay - elapsed;
         }
     }
 
   /* Wait awhile to check the work list.  We will wait here until either
-   * the time elapses or until we are awakened by a signal.
+   * the time elapses or until we are awakened by a signal.  While waiting,
+   * this thread is marked as idle so that work_signal() will wake it up
+   * when more work is queued.
    */
 
+  wqueue->idle |= (1 << wndx);
   usleep(next * USEC_PER_TICK);
+  wqueue->idle &= ~(1 << wndx);
   irqrestore(flags);
 }
 
@@ -214,6 +266,8 @@ static void work_process(FAR struct wqueue_s *wqueue)
  *     thread if CONFIG_SCHED_WORKQUEUE is not defined).
  *
  *     These worker threads are started by the OS during normal bringup.
+ *     There may be a pool of CONFIG_SCHED_LPNTHREADS low priority worker
+ *     threads; each receives its index in the pool as argv[1].
  *
  *   work_usrthread:  This is a user mode work queue.  It must be built into
  *     the applicatino blob during the user phase of a kernel build.  The
@@ -225,7 +279,7 @@ static void work_process(FAR struct wqueue_s *wqueue)
  *   not be accessed by application logic.
  *
  * Input parameters:
- *   argc, argv (not used)
+ *   argc, argv (only used by work_lpthread)
  *
  * Returned Value:
  *   Does not return
@@ -236,6 +290,12 @@ static void work_process(FAR struct wqueue_s *wqueue)
 
 int work_hpthread(int argc, char *argv[])
 {
+  /* Record our task ID before we first wait for work.  This thread may run
+   * before the task ID is returned to the OS bringup logic.
+   */
+
+  g_work[HPWORK].pid[0] = getpid();
+
   /* Loop forever */
 
   for (;;)
@@ -255,7 +315,7 @@ int work_hpthread(int argc, char *argv[])
        * we process items in the work list.
        */
 
-      work_process(&g_work[HPWORK]);
+      work_process(HPWORK, 0);
     }
 
   return OK; /* To keep some compilers happy */
@@ -265,6 +325,23 @@ int work_hpthread(int argc, char *argv[])
 
 int work_lpthread(int argc, char *argv[])
 {
+  int wndx = 0;
+
+#if CONFIG_SCHED_LPNTHREADS > 1
+  /* Which thread of the pool is this?  The index is passed as argv[1]. */
+
+  if (argc > 1)
+    {
+      wndx = atoi(argv[1]);
+    }
+
+  DEBUGASSERT((unsigned)wndx < CONFIG_SCHED_LPNTHREADS);
+#endif
+
+  /* Record our task ID before we first wait for work */
+
+  g_work[LPWORK].pid[wndx] = getpid();
+
   /* Loop forever */
 
   for (;;)
@@ -273,16 +350,20 @@ int work_lpthread(int argc, char *argv[])
        * that were queued because they could not be freed in that execution
        * context (for example, if the memory was freed from an interrupt handler).
        * NOTE: If the work thread is disabled, this clean-up is performed by
-       * the IDLE thread (at a very, very low priority).
+       * the IDLE thread (at a very, very low priority).  Only the first
+       * thread in the pool does this.
        */
 
-      sched_garbagecollection();
+      if (wndx == 0)
+        {
+          sched_garbagecollection();
+        }
 
       /* Then process queued work.  We need to keep interrupts disabled while
        * we process items in the work list.
        */
 
-      work_process(&g_work[LPWORK]);
+      work_process(LPWORK, wndx);
     }
 
   return OK; /* To keep some compilers happy */
@@ -295,6 +376,10 @@ int work_lpthread(int argc, char *argv[])
 
 int work_usrthread(int argc, char *argv[])
 {
+  /* Record our task ID before we first wait for work */
+
+  g_work[USRWORK].pid[0] = getpid();
+
   /* Loop forever */
 
   for (;;)
@@ -303,7 +388,7 @@ int work_usrthread(int argc, char *argv[])
        * we process items in the work list.
        */
 
-      work_process(&g_work[USRWORK]);
+      work_process(USRWORK, 0);
     }
 
   return OK; /* To keep some compilers happy */
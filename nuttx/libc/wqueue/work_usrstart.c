@@ -96,21 +96,21 @@ int work_usrstart(void)
 
   svdbg("Starting user-mode worker thread\n");
 
-  g_usrwork[USRWORK].pid = TASK_CREATE("usrwork",
-                                       CONFIG_SCHED_USRWORKPRIORITY,
-                                       CONFIG_SCHED_USRWORKSTACKSIZE,
-                                       (main_t)work_usrthread,
-                                       (FAR char * const *)NULL);
+  g_usrwork[USRWORK].pid[0] = TASK_CREATE("usrwork",
+                                          CONFIG_SCHED_USRWORKPRIORITY,
+                                          CONFIG_SCHED_USRWORKSTACKSIZE,
+                                          (main_t)work_usrthread,
+                                          (FAR char * const *)NULL);
 
   errcode = errno;
-  ASSERT(g_usrwork[USRWORK].pid > 0);
-  if (g_usrwork[USRWORK].pid < 0)
+  ASSERT(g_usrwork[USRWORK].pid[0] > 0);
+  if (g_usrwork[USRWORK].pid[0] < 0)
     {
       sdbg("task_create failed: %d\n", errcode);
       return -errcode;
     }
 
-  return g_usrwork[USRWORK].pid;
+  return g_usrwork[USRWORK].pid[0];
 }
 
 #endif /* CONFIG_SCHED_WORKQUEUE && CONFIG_SCHED_USRWORK */
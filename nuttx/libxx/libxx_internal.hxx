@@ -58,12 +58,14 @@
 #  define lib_zalloc(s)    kzalloc(s)
 #  define lib_realloc(p,s) krealloc(p,s)
 #  define lib_free(p)      kfree(p)
+#  define lib_hintalloc(h,s) kmalloc_hint(h,s)
 #else
 #  include <cstdlib>
 #  define lib_malloc(s)    malloc(s)
 #  define lib_zalloc(s)    zalloc(s)
 #  define lib_realloc(p,s) realloc(p,s)
 #  define lib_free(p)      free(p)
+#  define lib_hintalloc(h,s) mm_hintalloc(h,s)
 #endif
 
 //***************************************************************************
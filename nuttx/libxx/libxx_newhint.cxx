@@ -0,0 +1,101 @@
+//***************************************************************************
+// libxx/libxx_newhint.cxx
+//
+//   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX nor the names of its contributors may be
+//    used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//***************************************************************************
+
+
+//***************************************************************************
+// Included Files
+//***************************************************************************
+
+#include <nuttx/config.h>
+#include <cstddef>
+#include <debug.h>
+
+#include <nuttx/mm.h>
+
+#include "libxx_internal.hxx"
+
+#ifdef CONFIG_MM_NAMED_HEAPS
+
+//***************************************************************************
+// Operators
+//***************************************************************************
+
+//***************************************************************************
+// Name: new, new[] with a placement hint
+//
+// Description:
+//   Allocate from the named heap selected by the hint (see mm_hintalloc()).
+//   The memory is released with the normal delete operators.  See the NOTE
+//   in libxx_new.cxx about the type of the size argument.
+//
+//***************************************************************************
+
+#ifdef CONFIG_CXX_NEWLONG
+void *operator new(unsigned long nbytes, const mm_placement &where)
+#else
+void *operator new(unsigned int nbytes, const mm_placement &where)
+#endif
+{
+  // We have to allocate something
+
+  if (nbytes < 1)
+    {
+      nbytes = 1;
+    }
+
+  // Perform the allocation
+
+  void *alloc = lib_hintalloc(where.hint, nbytes);
+
+#ifdef CONFIG_DEBUG
+  if (alloc == 0)
+    {
+      dbg("Failed to allocate with hint %02x\n", where.hint);
+    }
+#endif
+
+  return alloc;
+}
+
+#ifdef CONFIG_CXX_NEWLONG
+void *operator new[](unsigned long nbytes, const mm_placement &where)
+#else
+void *operator new[](unsigned int nbytes, const mm_placement &where)
+#endif
+{
+  return operator new(nbytes, where);
+}
+
+#endif // CONFIG_MM_NAMED_HEAPS
@@ -85,7 +85,7 @@ FAR void *mm_calloc(FAR struct mm_heap_s *heap, size_t n, size_t elem_size)
 FAR void *calloc(size_t n, size_t elem_size)
 {
 #ifdef CONFIG_MM_MULTIHEAP
-  return mm_calloc(&g_mmheap, n, elem_size);
+  FAR void *ret = mm_calloc(&g_mmheap, n, elem_size);
 #else
   FAR void *ret = NULL;
 
@@ -93,8 +93,9 @@ FAR void *calloc(size_t n, size_t elem_size)
     {
       ret = zalloc(n * elem_size);
     }
+#endif
 
+  MM_TAGCALLER(ret, n * elem_size);
   return ret;
-#endif
 }
 #endif
@@ -68,8 +68,6 @@ static inline
 void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 {
   FAR struct mm_freenode_s *node;
-  FAR struct mm_freenode_s *prev;
-  FAR struct mm_freenode_s *next;
 
   mvdbg("Freeing %p\n", mem);
 
@@ -80,16 +78,51 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
       return;
     }
 
+  /* Map the memory chunk into a free node */
+
+  node = (FAR struct mm_freenode_s *)((char*)mem - SIZEOF_MM_ALLOCNODE);
+
+#ifdef CONFIG_MM_SLAB
+  /* Small chunks are kept in the cache if there is room.  This does not
+   * require the MM semaphore.
+   */
+
+  if (mm_slab_free(heap, node))
+    {
+      return;
+    }
+#endif
+
   /* We need to hold the MM semaphore while we muck with the
    * nodelist.
    */
 
   mm_takesemaphore(heap);
+  mm_freechunk(heap, node);
+  mm_givesemaphore(heap);
+}
 
-  /* Map the memory chunk into a free node */
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_freechunk
+ *
+ * Description:
+ *   Returns an allocated chunk to the list of free nodes, merging with
+ *   adjacent free chunks if possible.  The caller must hold the mm
+ *   semaphore.
+ *
+ ****************************************************************************/
+
+void mm_freechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+  FAR struct mm_freenode_s *prev;
+  FAR struct mm_freenode_s *next;
 
-  node = (FAR struct mm_freenode_s *)((char*)mem - SIZEOF_MM_ALLOCNODE);
   node->preceding &= ~MM_ALLOC_BIT;
+  MM_SUBUSED(heap, node->size);
 
   /* Check if the following node is free and, if so, merge it */
 
@@ -105,16 +138,9 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 
       andbeyond = (FAR struct mm_allocnode_s*)((char*)next + next->size);
 
-      /* Remove the next node.  There must be a predecessor,
-       * but there may not be a successor node.
-       */
+      /* Remove the next node from the free list */
 
-      DEBUGASSERT(next->blink);
-      next->blink->flink = next->flink;
-      if (next->flink)
-        {
-          next->flink->blink = next->blink;
-        }
+      mm_remfreechunk(heap, next);
 
       /* Then merge the two chunks */
 
@@ -130,16 +156,9 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
   prev = (FAR struct mm_freenode_s *)((char*)node - node->preceding);
   if ((prev->preceding & MM_ALLOC_BIT) == 0)
     {
-      /* Remove the node.  There must be a predecessor, but there may
-       * not be a successor node.
-       */
+      /* Remove the preceding node from the free list */
 
-      DEBUGASSERT(prev->blink);
-      prev->blink->flink = prev->flink;
-      if (prev->flink)
-        {
-          prev->flink->blink = prev->blink;
-        }
+      mm_remfreechunk(heap, prev);
 
       /* Then merge the two chunks */
 
@@ -151,13 +170,8 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
   /* Add the merged node to the nodelist */
 
   mm_addfreechunk(heap, node);
-  mm_givesemaphore(heap);
 }
 
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-
 /****************************************************************************
  * Name: free
  *
@@ -170,6 +184,12 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 #if !defined(CONFIG_NUTTX_KERNEL) || !defined(__KERNEL__)
 void free(FAR void *mem)
 {
+#ifdef CONFIG_MM_NAMED_HEAPS
+  /* The memory may have come from any registered heap */
+
+  mm_free(mm_heapowner(mem), mem);
+#else
   mm_free(&g_mmheap, mem);
+#endif
 }
 #endif
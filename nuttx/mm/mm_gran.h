@@ -59,6 +59,12 @@
 #define SIZEOF_GRAN_S(n) \
   (sizeof(struct gran_s) + sizeof(uint32_t) * (SIZEOF_GAT(n) - 1))
 
+/* Find the first set bit in a (non-zero) GAT entry */
+
+#ifdef __GNUC__
+#  define gran_ctz(w) __builtin_ctz(w)
+#endif
+
 /* Debug */
 
 #ifdef CONFIG_CPP_HAVE_VARARGS
@@ -88,7 +94,8 @@
 struct gran_s
 {
   uint8_t    log2gran;  /* Log base 2 of the size of one granule */
-  uint16_t   ngranules; /* The total number of (aligned) granules in the heap */
+  uint32_t   ngranules; /* The total number of (aligned) granules in the heap */
+  uint32_t   hint;      /* All granules below this granule are allocated */
 #ifdef CONFIG_GRAN_INTR
   irqstate_t irqstate;  /* For exclusive access to the GAT */
 #else
@@ -129,4 +136,51 @@ extern FAR struct gran_s *g_graninfo;
 void gran_enter_critical(FAR struct gran_s *priv);
 void gran_leave_critical(FAR struct gran_s *priv);
 
+/****************************************************************************
+ * Name: gran_ctz
+ *
+ * Description:
+ *   Return the number of trailing zero bits in a non-zero GAT entry, i.e.,
+ *   the bit number of the lowest set bit.
+ *
+ ****************************************************************************/
+
+#ifndef gran_ctz
+static inline int gran_ctz(uint32_t word)
+{
+  int bit = 0;
+
+  if ((word & 0x0000ffff) == 0)
+    {
+      word >>= 16;
+      bit   += 16;
+    }
+
+  if ((word & 0x000000ff) == 0)
+    {
+      word >>= 8;
+      bit   += 8;
+    }
+
+  if ((word & 0x0000000f) == 0)
+    {
+      word >>= 4;
+      bit   += 4;
+    }
+
+  if ((word & 0x00000003) == 0)
+    {
+      word >>= 2;
+      bit   += 2;
+    }
+
+  if ((word & 0x00000001) == 0)
+    {
+      bit   += 1;
+    }
+
+  return bit;
+}
+#endif
+
 #endif /* __MM_MM_GRAN_H */
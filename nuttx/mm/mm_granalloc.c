@@ -52,14 +52,18 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: gran_common_alloc
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: gran_mark_allocated
  *
  * Description:
- *   Allocate memory from the granule heap.
+ *   Mark a range of granules as allocated.
  *
  * Input Parameters:
- *   priv  - The granule heap state structure.
- *   alloc - The adress of the allocation.
+ *   priv      - The granule heap state structure.
+ *   granno    - The granule number of the first granule in the allocation
  *   ngranules - The number of granules allocated
  *
  * Returned Value:
@@ -68,66 +72,156 @@
  ****************************************************************************/
 
 static inline void gran_mark_allocated(FAR struct gran_s *priv,
-                                       uintptr_t alloc,
+                                       unsigned int granno,
                                        unsigned int ngranules)
 {
-  unsigned int granno;
   unsigned int gatidx;
   unsigned int gatbit;
-  unsigned int avail;
+  unsigned int nbits;
   uint32_t     gatmask;
 
-  /* Determine the granule number of the allocation */
-
-  granno = (alloc - priv->heapstart) >> priv->log2gran;
-
   /* Determine the GAT table index associated with the allocation */
 
   gatidx = granno >> 5;
   gatbit = granno & 31;
 
-  /* Mark bits in the GAT entry or entries */
+  /* Mark bits in each GAT entry spanned by the allocation */
 
-  avail = 32 - gatbit;
-  if (ngranules > avail)
+  while (ngranules > 0)
     {
-      /* Mark bits in the first GAT entry */
+      nbits = 32 - gatbit;
+      if (nbits > ngranules)
+        {
+          nbits = ngranules;
+        }
 
-      gatmask =0xffffffff << gatbit;
+      gatmask = (0xffffffff >> (32 - nbits)) << gatbit;
       DEBUGASSERT((priv->gat[gatidx] & gatmask) == 0);
 
       priv->gat[gatidx] |= gatmask;
-      ngranules -= avail;
+      ngranules -= nbits;
+      gatidx++;
+      gatbit = 0;
+    }
+}
 
-      /* Mark bits in the second GAT entry */
+/****************************************************************************
+ * Name: gran_nextfree
+ *
+ * Description:
+ *   Return the granule number of the first free granule at or after
+ *   'granno'.  Whole GAT entries are skipped at a time.
+ *
+ * Returned Value:
+ *   The granule number of the free granule or priv->ngranules if there are
+ *   no free granules at or after 'granno'.
+ *
+ ****************************************************************************/
 
-      gatmask = 0xffffffff >> (32 - ngranules);
-      DEBUGASSERT((priv->gat[gatidx+1] & gatmask) == 0);
+static unsigned int gran_nextfree(FAR struct gran_s *priv, unsigned int granno)
+{
+  unsigned int nentries = SIZEOF_GAT(priv->ngranules);
+  unsigned int gatidx;
+  uint32_t     curr;
 
-      priv->gat[gatidx+1] |= gatmask;
+  if (granno >= priv->ngranules)
+    {
+      return priv->ngranules;
     }
 
-  /* Handle the case where where all of the granules come from one entry */
+  /* Look for a clear bit at or above 'granno' in its GAT entry, then in
+   * each following entry.
+   */
+
+  gatidx = granno >> 5;
+  curr   = ~priv->gat[gatidx] & (0xffffffff << (granno & 31));
 
-  else
+  while (curr == 0)
     {
-      /* Mark bits in a single GAT entry */
+      if (++gatidx >= nentries)
+        {
+          return priv->ngranules;
+        }
 
-      gatmask   = 0xffffffff >> (32 - ngranules);
-      gatmask <<= gatbit;
-      DEBUGASSERT((priv->gat[gatidx] & gatmask) == 0);
+      curr = ~priv->gat[gatidx];
+    }
 
-      priv->gat[gatidx] |= gatmask;
-      return;
+  /* The unused bits at the end of the last entry are clear */
+
+  granno = (gatidx << 5) + gran_ctz(curr);
+  return granno < priv->ngranules ? granno : priv->ngranules;
+}
+
+/****************************************************************************
+ * Name: gran_nextused
+ *
+ * Description:
+ *   Return the granule number of the first allocated granule at or after
+ *   'granno' but before 'limit'.  Whole GAT entries are skipped at a time.
+ *
+ * Returned Value:
+ *   The granule number of the allocated granule or 'limit' if there are no
+ *   allocated granules in the range.
+ *
+ ****************************************************************************/
+
+static unsigned int gran_nextused(FAR struct gran_s *priv, unsigned int granno,
+                                  unsigned int limit)
+{
+  unsigned int gatidx;
+  uint32_t     curr;
+
+  DEBUGASSERT(limit <= priv->ngranules);
+
+  if (granno >= limit)
+    {
+      return limit;
+    }
+
+  gatidx = granno >> 5;
+  curr   = priv->gat[gatidx] & (0xffffffff << (granno & 31));
+
+  while (curr == 0)
+    {
+      if ((++gatidx << 5) >= limit)
+        {
+          return limit;
+        }
+
+      curr = priv->gat[gatidx];
     }
 
+  granno = (gatidx << 5) + gran_ctz(curr);
+  return granno < limit ? granno : limit;
+}
+
+/****************************************************************************
+ * Name: gran_alignup
+ *
+ * Description:
+ *   Return the granule number of the first granule at or after 'granno'
+ *   whose address is aligned to (1 << log2align) bytes.
+ *
+ ****************************************************************************/
+
+static inline unsigned int gran_alignup(FAR struct gran_s *priv,
+                                        unsigned int granno,
+                                        uint8_t log2align)
+{
+  uintptr_t mask = ((uintptr_t)1 << log2align) - 1;
+  uintptr_t addr = priv->heapstart + ((uintptr_t)granno << priv->log2gran);
+
+  addr = (addr + mask) & ~mask;
+  return (addr - priv->heapstart) >> priv->log2gran;
 }
 
 /****************************************************************************
  * Name: gran_common_alloc
  *
  * Description:
- *   Allocate memory from the granule heap.
+ *   Allocate memory from the granule heap.  This is a first fit search:
+ *   The search begins at the hint (all granules below the hint are known to
+ *   be allocated) and proceeds one run of free granules at a time.
  *
  * Input Parameters:
  *   priv - The granule heap state structure.
@@ -141,180 +235,159 @@ static inline void gran_mark_allocated(FAR struct gran_s *priv,
 static inline FAR void *gran_common_alloc(FAR struct gran_s *priv, size_t size)
 {
   unsigned int ngranules;
-  size_t       tmpmask;
-  uintptr_t    alloc;
-  uint32_t     curr;
-  uint32_t     next;
-  uint32_t     mask;
-  int          granidx;
-  int          gatidx;
-  int          bitidx;
-  int          shift;
+  unsigned int granno;
+  unsigned int end;
+  size_t       granmask;
 
-  DEBUGASSERT(priv && size <= 32 * (1 << priv->log2gran));
+  DEBUGASSERT(priv);
 
   if (priv && size > 0)
     {
-      /* Get exclusive access to the GAT */
-
-      gran_enter_critical(priv);
-
       /* How many contiguous granules we we need to find? */
 
-      tmpmask   = (1 << priv->log2gran) - 1;
-      ngranules = (size + tmpmask) >> priv->log2gran;
-
-      /* Then create mask for that number of granules */
-
-      DEBUGASSERT(ngranules <= 32);
-      mask = 0xffffffff >> (32 - ngranules);
+      granmask  = (1 << priv->log2gran) - 1;
+      ngranules = (size + granmask) >> priv->log2gran;
 
-      /* Now search the granule allocation table for that number of contiguous */
-
-      alloc = priv->heapstart;
-
-      for (granidx = 0; granidx < priv->ngranules; granidx += 32)
-        {
-          /* Get the GAT index associated with the granule table entry */
+      /* Get exclusive access to the GAT */
 
-          gatidx = granidx >> 5;
-          curr = priv->gat[gatidx];
+      gran_enter_critical(priv);
 
-          /* Handle the case where there are no free granules in the entry */
+      /* Find the first free granule and tighten the hint */
 
-          if (curr == 0xffffffff)
-            {
-              alloc += (32 << priv->log2gran);
-              continue;
-            }
+      granno     = gran_nextfree(priv, priv->hint);
+      priv->hint = granno;
 
-          /* Get the next entry from the GAT to support a 64 bit shift */
+      /* Check each run of free granules in turn */
 
-          if (granidx < priv->ngranules)
+      while (granno + ngranules <= priv->ngranules)
+        {
+          end = gran_nextused(priv, granno, granno + ngranules);
+          if (end == granno + ngranules)
             {
-              next = priv->gat[gatidx + 1];
-            }
+              /* Found it.. mark these granules allocated */
 
-          /* Use all ones when are at the last entry in the GAT (meaning
-           * nothing can be allocated.
-           */
+              gran_mark_allocated(priv, granno, ngranules);
+              if (granno == priv->hint)
+                {
+                  priv->hint = end;
+                }
 
-          else
-            {
-              next = 0xffffffff;
+              gran_leave_critical(priv);
+              return (FAR void *)(priv->heapstart + (granno << priv->log2gran));
             }
 
-          /* Search through the allocations in the 'curr' GAT entry
-           * to see if we can satisfy the allocation starting in that
-           * entry.
-           *
-           * This loop continues until either all of the bits have been
-           * examined (bitidx >= 32), or until there are insufficient
-           * granules left to satisfy the allocation.
+          /* The run is too short.  Skip to the next free granule after the
+           * allocated granule that ended it.
            */
 
-          for (bitidx = 0;
-               bitidx < 32 && (granidx + bitidx + ngranules) <= priv->ngranules;
-              )
-            {
-              /* Break out if there are no further free bits in 'curr'.
-               * All of the zero bits might have gotten shifted out.
-               */
-
-              if (curr == 0xffffffff)
-                {
-                  break;
-                }
-              
-              /* Check for the first zero bit in the lower or upper 16-bits.
-               * From the test above, we know that at least one of the 32-
-               * bits in 'curr' is zero.
-               */
-
-              else if ((curr & 0x0000ffff) == 0x0000ffff)
-                {
-                  /* Not in the lower 16 bits.  The first free bit must be
-                   * in the upper 16 bits.
-                   */
-
-                  shift = 16;
-                }
+          granno = gran_nextfree(priv, end);
+        }
 
-              /* We know that the first free bit is now within the lower 16
-               * bits of 'curr'.  Is it in the upper or lower byte?
-               */
+      gran_leave_critical(priv);
+    }
 
-              else if ((curr & 0x0000ff) == 0x000000ff)
-                {
-                  /* Not in the lower 8 bits.  The first free bit must be in
-                   * the upper 8 bits.
-                   */
+  return NULL;
+}
 
-                  shift = 8;
-                }
+/****************************************************************************
+ * Name: gran_common_alloc_aligned
+ *
+ * Description:
+ *   Allocate aligned memory from the granule heap.  This is a best fit
+ *   search:  Every run of free granules is examined and the allocation is
+ *   taken from the smallest run that can hold it at the requested
+ *   alignment.  This keeps the large runs intact for later (large) DMA
+ *   buffers, but the search time is always proportional to the size of the
+ *   granule allocation table.
+ *
+ * Input Parameters:
+ *   priv      - The granule heap state structure.
+ *   size      - The size of the memory region to allocate.
+ *   log2align - Log base 2 of the required alignment of the address.
+ *
+ * Returned Value:
+ *   On success, a non-NULL pointer to the allocated memory is returned.
+ *
+ ****************************************************************************/
 
-              /* We know that the first free bit is now within the lower 4
-               * bits of 'curr'.  Is it in the upper or lower nibble?
-               */
+static inline FAR void *gran_common_alloc_aligned(FAR struct gran_s *priv,
+                                                  size_t size,
+                                                  uint8_t log2align)
+{
+  unsigned int ngranules;
+  unsigned int granno;
+  unsigned int start;
+  unsigned int end;
+  unsigned int best;
+  uint32_t     bestlen;
+  size_t       granmask;
+  uintptr_t    gridmask;
 
-              else if ((curr & 0x00000f) == 0x0000000f)
-                {
-                  /* Not in the lower 4 bits.  The first free bit must be in
-                   * the upper 4 bits.
-                   */
+  DEBUGASSERT(priv && log2align < 32);
 
-                  shift = 4;
-                }
+  if (priv && size > 0)
+    {
+      /* The aligned addresses must fall on granule boundaries.  That will
+       * be true if the heap start is aligned to the smaller of the granule
+       * size and the requested alignment.
+       */
+
+      gridmask = ((uintptr_t)1 << (log2align < priv->log2gran ?
+                                   log2align : priv->log2gran)) - 1;
+      if ((priv->heapstart & gridmask) != 0)
+        {
+          return NULL;
+        }
 
-              /* We know that the first free bit is now within the lower 4 bits
-               * of 'curr'.  Is it in the upper or lower pair?
-               */
+      /* How many contiguous granules we we need to find? */
 
-              else if ((curr & 0x000003) == 0x00000003)
-                {
-                  /* Not in the lower 2 bits.  The first free bit must be in
-                   * the upper 2 bits.
-                   */
+      granmask  = (1 << priv->log2gran) - 1;
+      ngranules = (size + granmask) >> priv->log2gran;
 
-                  shift = 2;
-                }
+      /* Get exclusive access to the GAT */
 
-              /* We know that the first free bit is now within the lower 4 bits
-               * of 'curr'.  Check if we have the allocation at this bit position.
-               */
+      gran_enter_critical(priv);
 
-              else if ((curr & mask) == 0)
-                {
-                  /* Yes.. mark these granules allocated */
+      /* Visit each run of free granules [granno, end) */
 
-                  gran_mark_allocated(priv, alloc, ngranules);
+      best    = 0;
+      bestlen = UINT32_MAX;
+      granno  = gran_nextfree(priv, priv->hint);
 
-                  /* And return the allocation address */
+      while (granno < priv->ngranules)
+        {
+          end   = gran_nextused(priv, granno, priv->ngranules);
+          start = gran_alignup(priv, granno, log2align);
 
-                  gran_leave_critical(priv);
-                  return (FAR void *)alloc;
-                }
+          if (start + ngranules <= end && end - granno < bestlen)
+            {
+              best    = start;
+              bestlen = end - granno;
 
-              /* The free allocation does not start at this position */
+              /* Nothing can fit better than an exact fit */
 
-              else
+              if (bestlen == ngranules)
                 {
-                  shift = 1;
+                  break;
                 }
+            }
 
-              /* Set up for the next time through the loop.  Perform a 64
-               * bit shift to move to the next gram position andi ncrement
-               * to the next candidate allocation address.
-               */
+          granno = gran_nextfree(priv, end);
+        }
 
-              alloc  += (shift << priv->log2gran);
-              curr    = (curr >> shift) | (next << (32 - shift));
-              next  >>= shift;
-              bitidx += shift;
+      if (bestlen != UINT32_MAX)
+        {
+          gran_mark_allocated(priv, best, ngranules);
+          if (best == priv->hint)
+            {
+              priv->hint = best + ngranules;
             }
+
+          gran_leave_critical(priv);
+          return (FAR void *)(priv->heapstart + (best << priv->log2gran));
         }
 
-        gran_leave_critical(priv);
+      gran_leave_critical(priv);
     }
 
   return NULL;
@@ -330,10 +403,6 @@ static inline FAR void *gran_common_alloc(FAR struct gran_s *priv, size_t size)
  * Description:
  *   Allocate memory from the granule heap.
  *
- *   NOTE: The current implementation also restricts the maximum allocation
- *   size to 32 granules.  That restriction could be eliminated with some
- *   additional coding effort.
- *
  * Input Parameters:
  *   handle - The handle previously returned by gran_initialize
  *   size   - The size of the memory region to allocate.
@@ -356,4 +425,37 @@ FAR void *gran_alloc(GRAN_HANDLE handle, size_t size)
 }
 #endif
 
+/****************************************************************************
+ * Name: gran_alloc_aligned
+ *
+ * Description:
+ *   Allocate memory from the granule heap with the start address aligned
+ *   to (1 << log2align) bytes.  The allocation is taken from the smallest
+ *   free region that can hold it.
+ *
+ * Input Parameters:
+ *   handle    - The handle previously returned by gran_initialize
+ *   size      - The size of the memory region to allocate.
+ *   log2align - Log base 2 of the required alignment.
+ *
+ * Returned Value:
+ *   On success, a non-NULL pointer to the allocated memory is returned.
+ *   NULL is returned if there is no suitable free region.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_GRAN_SINGLE
+FAR void *gran_alloc_aligned(size_t size, uint8_t log2align)
+{
+  return gran_common_alloc_aligned(g_graninfo, size, log2align);
+}
+#else
+FAR void *gran_alloc_aligned(GRAN_HANDLE handle, size_t size,
+                             uint8_t log2align)
+{
+  return gran_common_alloc_aligned((FAR struct gran_s *)handle, size,
+                                   log2align);
+}
+#endif
+
 #endif /* CONFIG_GRAN */
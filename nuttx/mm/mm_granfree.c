@@ -74,10 +74,10 @@ static inline void gran_common_free(FAR struct gran_s *priv,
   unsigned int gatbit;
   unsigned int granmask;
   unsigned int ngranules;
-  unsigned int avail;
+  unsigned int nbits;
   uint32_t     gatmask;
 
-  DEBUGASSERT(priv && memory && size <= 32 * (1 << priv->log2gran));
+  DEBUGASSERT(priv && memory);
 
   /* Get exclusive access to the GAT */
 
@@ -99,38 +99,32 @@ static inline void gran_common_free(FAR struct gran_s *priv,
   granmask =  (1 << priv->log2gran) - 1;
   ngranules = (size + granmask) >> priv->log2gran;
 
-  /* Clear bits in the GAT entry or entries */
+  DEBUGASSERT(granno + ngranules <= priv->ngranules);
 
-  avail = 32 - gatbit;
-  if (ngranules > avail)
+  /* Clear bits in each GAT entry spanned by the allocation */
+
+  while (ngranules > 0)
     {
-      /* Clear bits in the first GAT entry */
+      nbits = 32 - gatbit;
+      if (nbits > ngranules)
+        {
+          nbits = ngranules;
+        }
 
-      gatmask = (0xffffffff << gatbit);
+      gatmask = (0xffffffff >> (32 - nbits)) << gatbit;
       DEBUGASSERT((priv->gat[gatidx] & gatmask) == gatmask);
 
       priv->gat[gatidx] &= ~gatmask;
-      ngranules -= avail;
-
-      /* Clear bits in the second GAT entry */
-
-      gatmask = 0xffffffff >> (32 - ngranules);
-      DEBUGASSERT((priv->gat[gatidx+1] & gatmask) == gatmask);
-
-      priv->gat[gatidx+1] &= ~gatmask;
+      ngranules -= nbits;
+      gatidx++;
+      gatbit = 0;
     }
 
-  /* Handle the case where where all of the granules came from one entry */
+  /* The search for free granules can now start no later than here */
 
-  else
+  if (granno < priv->hint)
     {
-      /* Clear bits in a single GAT entry */
-
-      gatmask   = 0xffffffff >> (32 - ngranules);
-      gatmask <<= gatbit;
-      DEBUGASSERT((priv->gat[gatidx] & gatmask) == gatmask);
-
-      priv->gat[gatidx] &= ~gatmask;
+      priv->hint = granno;
     }
 
   gran_leave_critical(priv);
@@ -98,7 +98,7 @@ gran_common_initialize(FAR void *heapstart, size_t heapsize, uint8_t log2gran,
   FAR struct gran_s *priv;
   uintptr_t          heapend;
   uintptr_t          alignedstart;
-  unsigned int       mask;
+  uintptr_t          mask;
   unsigned int       alignedsize;
   unsigned int       ngranules;
 
@@ -181,10 +181,6 @@ gran_common_initialize(FAR void *heapstart, size_t heapsize, uint8_t log2gran,
  *   The actual memory allocates will be 64 byte (wasting 17 bytes) and
  *   will be aligned at least to (1 << log2align).
  *
- *   NOTE: The current implementation also restricts the maximum allocation
- *   size to 32 granules.  That restriction could be eliminated with some
- *   additional coding effort.
- *
  * Input Parameters:
  *   heapstart - Start of the granule allocation heap
  *   heapsize  - Size of heap in bytes
@@ -225,4 +221,44 @@ GRAN_HANDLE gran_initialize(FAR void *heapstart, size_t heapsize,
 }
 #endif
 
+/****************************************************************************
+ * Name: gran_release
+ *
+ * Description:
+ *   Uninitialize a granule allocator instance and release the resources
+ *   that it holds.  The memory that it managed is not affected.
+ *
+ * Input Parameters:
+ *   handle - The handle previously returned by gran_initialize
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_GRAN_SINGLE
+void gran_release(void)
+{
+  DEBUGASSERT(g_graninfo);
+
+#ifndef CONFIG_GRAN_INTR
+  sem_destroy(&g_graninfo->exclsem);
+#endif
+  free(g_graninfo);
+  g_graninfo = NULL;
+}
+#else
+void gran_release(GRAN_HANDLE handle)
+{
+  FAR struct gran_s *priv = (FAR struct gran_s *)handle;
+
+  DEBUGASSERT(priv);
+
+#ifndef CONFIG_GRAN_INTR
+  sem_destroy(&priv->exclsem);
+#endif
+  free(priv);
+}
+#endif
+
 #endif /* CONFIG_GRAN */
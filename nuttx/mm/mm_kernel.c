@@ -126,7 +126,9 @@ void kmm_addregion(FAR void *heap_start, size_t heap_size)
 
 FAR void *kmalloc(size_t size)
 {
-  return mm_malloc(&g_kmmheap, size);
+  FAR void *ret = mm_malloc(&g_kmmheap, size);
+  MM_TAGCALLER(ret, size);
+  return ret;
 }
 
 /************************************************************************
@@ -145,7 +147,9 @@ FAR void *kmalloc(size_t size)
 
 FAR void *kzalloc(size_t size)
 {
-  return mm_zalloc(&g_kmmheap, size);
+  FAR void *ret = mm_zalloc(&g_kmmheap, size);
+  MM_TAGCALLER(ret, size);
+  return ret;
 }
 
 /************************************************************************
@@ -165,7 +169,14 @@ FAR void *kzalloc(size_t size)
 
 FAR void *krealloc(FAR void *oldmem, size_t newsize)
 {
-  return mm_realloc(&g_kmmheap, oldmem, newsize);
+#ifdef CONFIG_MM_NAMED_HEAPS
+  FAR void *ret = mm_realloc(oldmem ? mm_heapowner(oldmem) : &g_kmmheap,
+                             oldmem, newsize);
+#else
+  FAR void *ret = mm_realloc(&g_kmmheap, oldmem, newsize);
+#endif
+  MM_TAGCALLER(ret, newsize);
+  return ret;
 }
 
 /************************************************************************
@@ -184,8 +195,17 @@ FAR void *krealloc(FAR void *oldmem, size_t newsize)
 
 void kfree(FAR void *mem)
 {
+#ifdef CONFIG_MM_NAMED_HEAPS
+  /* The memory may have come from any heap registered in the kernel */
+
+  FAR struct mm_heap_s *heap = mm_heapowner(mem);
+
+  DEBUGASSERT(heap != &g_kmmheap || kmm_heapmember(mem));
+  return mm_free(heap, mem);
+#else
   DEBUGASSERT(kmm_heapmember(mem));
   return mm_free(&g_kmmheap, mem);
+#endif
 }
 
 /************************************************************************
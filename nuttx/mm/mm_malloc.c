@@ -70,42 +70,31 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: mm_malloc
+ * Name: mm_allocchunk
  *
  * Description:
- *  Find the smallest chunk that satisfies the request. Take the memory from
- *  that chunk, save the remaining, smaller chunk (if any).
- *
- *  8-byte alignment of the allocated data is assured.
+ *  Find the smallest chunk that satisfies the request, remove it from the
+ *  free list, and return any remaining, smaller chunk to the free list.
+ *  'size' is the full chunk size (including the allocation node header).
+ *  The caller must hold the mm semaphore.
  *
  ****************************************************************************/
 
-#ifndef CONFIG_MM_MULTIHEAP
-static inline
-#endif
-FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+static FAR struct mm_freenode_s *mm_allocchunk(FAR struct mm_heap_s *heap,
+                                               size_t size)
 {
   FAR struct mm_freenode_s *node;
-  void *ret = NULL;
+#ifndef CONFIG_MM_TLSF
   int ndx;
+#endif
 
-  /* Handle bad sizes */
-
-  if (size <= 0)
-    {
-      return NULL;
-    }
-
-  /* Adjust the size to account for (1) the size of the allocated node and
-   * (2) to make sure that it is an even multiple of our granule size.
+#ifdef CONFIG_MM_TLSF
+  /* Find a large enough chunk using the TLSF bitmaps.  This is a constant
+   * time operation.
    */
 
-  size = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
-
-  /* We need to hold the MM semaphore while we muck with the nodelist. */
-
-  mm_takesemaphore(heap);
-
+  node = mm_tlsf_findchunk(heap, size);
+#else
   /* Get the location in the node list to start the search. Special case
    * really big allocations
    */
@@ -129,6 +118,7 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
   for (node = heap->mm_nodelist[ndx].flink;
        node && node->size < size;
        node = node->flink);
+#endif
 
   /* If we found a node with non-zero size, then this is one to use. Since
    * the list is ordered, we know that is must be best fitting chunk
@@ -141,16 +131,9 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       FAR struct mm_freenode_s *next;
       size_t remaining;
 
-      /* Remove the node.  There must be a predecessor, but there may not be
-       * a successor node.
-       */
+      /* Remove the node from the free list */
 
-      DEBUGASSERT(node->blink);
-      node->blink->flink = node->flink;
-      if (node->flink)
-        {
-          node->flink->blink = node->blink;
-        }
+      mm_remfreechunk(heap, node);
 
       /* Check if we have to split the free node into one of the allocated
        * size and another smaller freenode.  In some cases, the remaining
@@ -190,6 +173,103 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       /* Handle the case of an exact size match */
 
       node->preceding |= MM_ALLOC_BIT;
+      MM_ADDUSED(heap, node->size);
+    }
+
+  return node;
+}
+
+/****************************************************************************
+ * Name: mm_malloc
+ *
+ * Description:
+ *  Find the smallest chunk that satisfies the request. Take the memory from
+ *  that chunk, save the remaining, smaller chunk (if any).
+ *
+ *  8-byte alignment of the allocated data is assured.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_MM_MULTIHEAP
+static inline
+#endif
+FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR struct mm_freenode_s *node;
+  void *ret = NULL;
+#ifdef CONFIG_MM_SLAB
+  int i;
+#endif
+
+  /* Handle bad sizes */
+
+  if (size <= 0)
+    {
+      return NULL;
+    }
+
+  /* Adjust the size to account for (1) the size of the allocated node and
+   * (2) to make sure that it is an even multiple of our granule size.
+   */
+
+  size = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
+
+#ifdef CONFIG_MM_SLAB
+  /* Small allocations are taken from the cache of recently freed chunks
+   * if possible.  This does not require the MM semaphore.
+   */
+
+  if (size <= MM_SLAB_MAXCHUNK)
+    {
+      node = mm_slab_alloc(heap, size);
+      if (node)
+        {
+          MM_TAGNODE(node, 0, size - SIZEOF_MM_ALLOCNODE);
+          ret = (void*)((char*)node + SIZEOF_MM_ALLOCNODE);
+          mvdbg("Allocated %p, size %d (cached)\n", ret, size);
+          return ret;
+        }
+    }
+#endif
+
+  /* We need to hold the MM semaphore while we muck with the nodelist. */
+
+  mm_takesemaphore(heap);
+
+  node = mm_allocchunk(heap, size);
+
+#ifdef CONFIG_MM_SLAB
+  if (!node)
+    {
+      /* Memory held in the caches may be all that is needed */
+
+      if (mm_slab_flush(heap))
+        {
+          node = mm_allocchunk(heap, size);
+        }
+    }
+  else if (size <= MM_SLAB_MAXCHUNK)
+    {
+      /* The cache for this size is empty.  Refill it with a batch of
+       * chunks while we hold the semaphore anyway.
+       */
+
+      for (i = 1; i < CONFIG_MM_SLAB_BATCH; i++)
+        {
+          FAR struct mm_freenode_s *extra = mm_allocchunk(heap, size);
+          if (!extra)
+            {
+              break;
+            }
+
+          mm_slab_add(heap, extra);
+        }
+    }
+#endif
+
+  if (node)
+    {
+      MM_TAGNODE(node, 0, size - SIZEOF_MM_ALLOCNODE);
       ret = (void*)((char*)node + SIZEOF_MM_ALLOCNODE);
     }
 
@@ -231,7 +311,9 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 #if !defined(CONFIG_NUTTX_KERNEL) || !defined(__KERNEL__)
 FAR void *malloc(size_t size)
 {
-  return mm_malloc(&g_mmheap, size);
+  FAR void *ret = mm_malloc(&g_mmheap, size);
+  MM_TAGCALLER(ret, size);
+  return ret;
 }
 #endif
 
@@ -170,11 +170,15 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
 
       newnode->size = (size_t)next - (size_t)newnode;
       newnode->preceding = precedingsize | MM_ALLOC_BIT;
+#ifdef CONFIG_MM_CALLERPC
+      MM_TAGNODE(newnode, node->callerpc, node->reqsize);
+#endif
 
       /* Reduce the size of the original chunk and mark it not allocated, */
 
       node->size = precedingsize;
       node->preceding &= ~MM_ALLOC_BIT;
+      MM_SUBUSED(heap, precedingsize);
 
       /* Fix the preceding size of the next node */
 
@@ -234,7 +238,9 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
 
 FAR void *memalign(size_t alignment, size_t size)
 {
-  return mm_memalign(&g_mmheap, alignment, size);
+  FAR void *ret = mm_memalign(&g_mmheap, alignment, size);
+  MM_TAGCALLER(ret, size);
+  return ret;
 }
 
 #endif
@@ -0,0 +1,420 @@
+/****************************************************************************
+ * mm/mm_named.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/mm.h>
+
+#ifdef CONFIG_MM_NAMED_HEAPS
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* This is the heap that hinted allocations fall back to and that owns any
+ * memory that does not lie in a registered heap.  This file is built into
+ * both the kernel and the user blobs of the kernel build, each with its
+ * own registry.
+ */
+
+#if defined(CONFIG_NUTTX_KERNEL) && defined(CONFIG_MM_KERNEL_HEAP) && \
+    defined(__KERNEL__)
+#  define MM_DEFAULT_HEAP (&g_kmmheap)
+#else
+#  define MM_DEFAULT_HEAP (&g_mmheap)
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One entry in the registry of named heaps */
+
+struct mm_named_s
+{
+  FAR struct mm_heap_s *heap;        /* The registered heap */
+  FAR const char *name;              /* Its name (not copied) */
+  uint8_t  flags;                    /* MM_HEAP_* properties */
+  uint32_t nalloc;                   /* Hinted allocations placed here */
+  uint32_t nfallback;                /* ... of which only as a fallback */
+  uint32_t nfail;                    /* Hinted allocations that failed here */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The registry.  Entries are only added (during initialization) and never
+ * removed, so it may be searched without locking.
+ */
+
+static struct mm_named_s g_named[CONFIG_MM_NAMED_NHEAPS];
+static int g_nnamed;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_ismember
+ *
+ * Description:
+ *   Return true if the address lies between the guard nodes of one of the
+ *   regions of the heap.
+ *
+ ****************************************************************************/
+
+static bool mm_ismember(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+#if CONFIG_MM_REGIONS > 1
+  int nregions = heap->mm_nregions;
+#else
+  int nregions = 1;
+#endif
+  int i;
+
+  for (i = 0; i < nregions; i++)
+    {
+      if (mem > (FAR void *)heap->mm_heapstart[i] &&
+          mem < (FAR void *)heap->mm_heapend[i])
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: mm_findnamed
+ *
+ * Description:
+ *   Return the registry entry of a heap or NULL if it is not registered.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_named_s *mm_findnamed(FAR struct mm_heap_s *heap)
+{
+  int i;
+
+  for (i = 0; i < g_nnamed; i++)
+    {
+      if (g_named[i].heap == heap)
+        {
+          return &g_named[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: mm_count
+ *
+ * Description:
+ *   Update the statistics of a registered heap.  The counts are protected
+ *   by the heap semaphore.
+ *
+ ****************************************************************************/
+
+static void mm_count(FAR struct mm_named_s *named, FAR void *mem,
+                     bool fallback)
+{
+  mm_takesemaphore(named->heap);
+  if (mem)
+    {
+      named->nalloc++;
+      if (fallback)
+        {
+          named->nfallback++;
+        }
+    }
+  else
+    {
+      named->nfail++;
+    }
+
+  mm_givesemaphore(named->heap);
+}
+
+/****************************************************************************
+ * Name: mm_place
+ *
+ * Description:
+ *   Allocate from the first registered heap that has all of the properties
+ *   in the hint and, unless MM_HINT_STRICT is set, then from the default
+ *   heap.  A hint with no properties goes directly to the default heap.
+ *
+ ****************************************************************************/
+
+static FAR void *mm_place(uint8_t hint, size_t alignment, size_t size)
+{
+  FAR struct mm_named_s *named;
+  FAR void *mem = NULL;
+  uint8_t props = hint & MM_HEAP_PROPS;
+  int i;
+
+  if (props != 0)
+    {
+      for (i = 0; i < g_nnamed && !mem; i++)
+        {
+          named = &g_named[i];
+          if ((named->flags & props) == props)
+            {
+              mem = alignment ?
+                    mm_memalign(named->heap, alignment, size) :
+                    mm_malloc(named->heap, size);
+              mm_count(named, mem, false);
+            }
+        }
+
+      if (mem || (hint & MM_HINT_STRICT) != 0)
+        {
+          return mem;
+        }
+
+      mvdbg("No heap with properties %02x for %d bytes\n", props, size);
+    }
+
+  /* Fall back to the default heap */
+
+  mem = alignment ?
+        mm_memalign(MM_DEFAULT_HEAP, alignment, size) :
+        mm_malloc(MM_DEFAULT_HEAP, size);
+
+  named = mm_findnamed(MM_DEFAULT_HEAP);
+  if (named)
+    {
+      mm_count(named, mem, props != 0);
+    }
+
+  return mem;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_register
+ *
+ * Description:
+ *   Add a heap to the registry of named heaps.  The heap must already have
+ *   been initialized with mm_initialize() (and, perhaps, extended with
+ *   mm_addregion()).  Heaps are searched in the order of registration so
+ *   the preferred heap for each property should be registered first.  The
+ *   default heap may be registered as well so that it has a name and
+ *   statistics.
+ *
+ *   This is intended to be called during initialization, typically from
+ *   up_addregion() or board initialization logic.  It is not thread-safe.
+ *
+ * Parameters:
+ *   heap  - The heap to register
+ *   name  - The name of the heap.  The string is not copied.
+ *   flags - The properties of the memory in the heap (MM_HEAP_*)
+ *
+ * Return Value:
+ *   OK on success; a negated errno value on failure:  -EEXIST if the heap
+ *   or name is already registered; -ENOMEM if the registry is full.
+ *
+ ****************************************************************************/
+
+int mm_register(FAR struct mm_heap_s *heap, FAR const char *name,
+                uint8_t flags)
+{
+  FAR struct mm_named_s *named;
+
+  DEBUGASSERT(heap && name);
+
+  if (mm_findnamed(heap) || mm_findheap(name))
+    {
+      return -EEXIST;
+    }
+
+  if (g_nnamed >= CONFIG_MM_NAMED_NHEAPS)
+    {
+      return -ENOMEM;
+    }
+
+  named        = &g_named[g_nnamed];
+  named->heap  = heap;
+  named->name  = name;
+  named->flags = flags & MM_HEAP_PROPS;
+  g_nnamed++;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mm_findheap
+ *
+ * Description:
+ *   Return the registered heap with this name (or NULL).  Memory can then
+ *   be allocated from that heap directly with mm_malloc() and friends.
+ *
+ ****************************************************************************/
+
+FAR struct mm_heap_s *mm_findheap(FAR const char *name)
+{
+  int i;
+
+  for (i = 0; i < g_nnamed; i++)
+    {
+      if (strcmp(g_named[i].name, name) == 0)
+        {
+          return g_named[i].heap;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: mm_heapowner
+ *
+ * Description:
+ *   Return the heap that an allocation belongs to:  The registered heap
+ *   that contains the address or, if none does, the default heap.  free()
+ *   and realloc() use this so that memory from any registered heap can be
+ *   freed in the normal way.
+ *
+ ****************************************************************************/
+
+FAR struct mm_heap_s *mm_heapowner(FAR void *mem)
+{
+  int i;
+
+  for (i = 0; i < g_nnamed; i++)
+    {
+      if (g_named[i].heap != MM_DEFAULT_HEAP &&
+          mm_ismember(g_named[i].heap, mem))
+        {
+          return g_named[i].heap;
+        }
+    }
+
+  return MM_DEFAULT_HEAP;
+}
+
+/****************************************************************************
+ * Name: mm_hintalloc, mm_hintzalloc, mm_hintmemalign
+ *
+ * Description:
+ *   Allocate memory with a placement hint:  A combination of MM_HEAP_*
+ *   properties, optionally with MM_HINT_STRICT.  The memory is freed with
+ *   free() (or kfree() in the kernel) as usual.
+ *
+ ****************************************************************************/
+
+FAR void *mm_hintalloc(uint8_t hint, size_t size)
+{
+  FAR void *mem = mm_place(hint, 0, size);
+  MM_TAGCALLER(mem, size);
+  return mem;
+}
+
+FAR void *mm_hintzalloc(uint8_t hint, size_t size)
+{
+  FAR void *mem = mm_place(hint, 0, size);
+  if (mem)
+    {
+      memset(mem, 0, size);
+    }
+
+  MM_TAGCALLER(mem, size);
+  return mem;
+}
+
+FAR void *mm_hintmemalign(uint8_t hint, size_t alignment, size_t size)
+{
+  FAR void *mem = mm_place(hint, alignment, size);
+  MM_TAGCALLER(mem, size);
+  return mem;
+}
+
+/****************************************************************************
+ * Name: mm_heapinfo
+ *
+ * Description:
+ *   Return the name, properties, usage and placement statistics of one
+ *   registered heap.
+ *
+ * Parameters:
+ *   ndx  - The index of the heap in the registry (0, 1, ...)
+ *   info - The location to return the information
+ *
+ * Return Value:
+ *   OK on success; -ENOENT if there is no heap with this index.
+ *
+ ****************************************************************************/
+
+int mm_heapinfo(int ndx, FAR struct mm_heapinfo_s *info)
+{
+  FAR struct mm_named_s *named;
+  struct mallinfo minfo;
+
+  if (ndx < 0 || ndx >= g_nnamed)
+    {
+      return -ENOENT;
+    }
+
+  named = &g_named[ndx];
+  (void)mm_mallinfo(named->heap, &minfo);
+
+  mm_takesemaphore(named->heap);
+  info->name      = named->name;
+  info->flags     = named->flags;
+  info->heapsize  = named->heap->mm_heapsize;
+  info->used      = minfo.uordblks;
+  info->largest   = minfo.mxordblk;
+  info->nalloc    = named->nalloc;
+  info->nfallback = named->nfallback;
+  info->nfail     = named->nfail;
+  mm_givesemaphore(named->heap);
+  return OK;
+}
+
+#endif /* CONFIG_MM_NAMED_HEAPS */
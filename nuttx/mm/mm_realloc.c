@@ -239,20 +239,17 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
         {
           FAR struct mm_allocnode_s *newnode;
 
-          /* Remove the previous node.  There must be a predecessor, but
-           * there may not be a successor node.
-           */
+          /* Remove the previous node from the free list */
 
-          DEBUGASSERT(prev->blink);
-          prev->blink->flink = prev->flink;
-          if (prev->flink)
-            {
-              prev->flink->blink = prev->blink;
-            }
+          mm_remfreechunk(heap, prev);
+          MM_ADDUSED(heap, takeprev);
 
           /* Extend the node into the previous free chunk */
 
           newnode = (FAR struct mm_allocnode_s *)((FAR char*)oldnode - takeprev);
+#ifdef CONFIG_MM_CALLERPC
+          MM_TAGNODE(newnode, oldnode->callerpc, oldnode->reqsize);
+#endif
 
           /* Did we consume the entire preceding chunk? */
 
@@ -284,15 +281,16 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
               next->preceding     = newnode->size | (next->preceding & MM_ALLOC_BIT);
             }
 
-          oldnode = newnode;
-          oldsize = newnode->size;
-
-          /* Now we have to move the user contents 'down' in memory.  memcpy should
-           * should be save for this.
+          /* Now we have to move the user contents 'down' in memory.  The
+           * old and new regions may overlap so memmove must be used and
+           * only the old payload is moved.
            */
 
           newmem = (FAR void*)((FAR char*)newnode + SIZEOF_MM_ALLOCNODE);
-          memcpy(newmem, oldmem, oldsize - SIZEOF_MM_ALLOCNODE);
+          memmove(newmem, oldmem, oldsize - SIZEOF_MM_ALLOCNODE);
+
+          oldnode = newnode;
+          oldsize = newnode->size;
         }
 
       /* Extend into the next free chunk */
@@ -308,16 +306,10 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 
           andbeyond = (FAR struct mm_allocnode_s*)((char*)next + nextsize);
 
-          /* Remove the next node.  There must be a predecessor, but there
-           * may not be a successor node.
-           */
+          /* Remove the next node from the free list */
 
-          DEBUGASSERT(next->blink);
-          next->blink->flink = next->flink;
-          if (next->flink)
-            {
-              next->flink->blink = next->blink;
-            }
+          mm_remfreechunk(heap, next);
+          MM_ADDUSED(heap, takenext);
 
           /* Extend the node into the next chunk */
 
@@ -403,7 +395,16 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 
 FAR void *realloc(FAR void *oldmem, size_t size)
 {
-  return mm_realloc(&g_mmheap, oldmem, size);
+#ifdef CONFIG_MM_NAMED_HEAPS
+  /* Reallocate in the heap that the memory came from */
+
+  FAR void *ret = mm_realloc(oldmem ? mm_heapowner(oldmem) : &g_mmheap,
+                             oldmem, size);
+#else
+  FAR void *ret = mm_realloc(&g_mmheap, oldmem, size);
+#endif
+  MM_TAGCALLER(ret, size);
+  return ret;
 }
 
 #endif
@@ -86,16 +86,9 @@ void  mm_shrinkchunk(FAR struct mm_heap_s *heap,
 
       andbeyond = (FAR struct mm_allocnode_s*)((char*)next + next->size);
 
-      /* Remove the next node.  There must be a predecessor, but there may
-       * not be a successor node.
-       */
+      /* Remove the next node from the free list */
 
-      DEBUGASSERT(next->blink);
-      next->blink->flink = next->flink;
-      if (next->flink)
-        {
-          next->flink->blink = next->blink;
-        }
+      mm_remfreechunk(heap, next);
 
       /* Create a new chunk that will hold both the next chunk and the
        * tailing memory from the aligned chunk.
@@ -105,6 +98,8 @@ void  mm_shrinkchunk(FAR struct mm_heap_s *heap,
 
       /* Set up the size of the new node */
 
+      MM_SUBUSED(heap, node->size - size);
+
       newnode->size        = next->size + node->size - size;
       newnode->preceding   = size;
       node->size           = size;
@@ -131,6 +126,8 @@ void  mm_shrinkchunk(FAR struct mm_heap_s *heap,
 
       /* Set up the size of the new node */
 
+      MM_SUBUSED(heap, node->size - size);
+
       newnode->size        = node->size - size;
       newnode->preceding   = size;
       node->size           = size;
@@ -0,0 +1,289 @@
+/****************************************************************************
+ * mm/mm_slab.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <string.h>
+#include <sched.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <arch/irq.h>
+#include <nuttx/mm.h>
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The caches are protected by briefly disabling interrupts rather than
+ * with the heap semaphore:  The critical sections are only a few
+ * instructions long and are much cheaper than a semaphore.  Interrupts
+ * cannot be disabled from the user-space allocator in the kernel build;
+ * there pre-emption is disabled instead.
+ */
+
+#if defined(CONFIG_NUTTX_KERNEL) && !defined(__KERNEL__)
+#  define mm_slab_lock()    (sched_lock(), 0)
+#  define mm_slab_unlock(s) ((void)(s), sched_unlock())
+#else
+#  define mm_slab_lock()    irqsave()
+#  define mm_slab_unlock(s) irqrestore(s)
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_slab_initialize
+ *
+ * Description:
+ *   Initialize the small object caches of a heap.
+ *
+ ****************************************************************************/
+
+void mm_slab_initialize(FAR struct mm_heap_s *heap)
+{
+  memset(heap->mm_slab, 0, sizeof(heap->mm_slab));
+}
+
+/****************************************************************************
+ * Name: mm_slab_alloc
+ *
+ * Description:
+ *   Take a chunk of the given size from the cache.  The caller need not
+ *   hold the mm semaphore.
+ *
+ * Parameters:
+ *   heap - The selected heap
+ *   size - The chunk size (including the allocation node header).  This
+ *          must be no larger than MM_SLAB_MAXCHUNK.
+ *
+ * Return Value:
+ *   The cached chunk (still marked as allocated) or NULL if the cache for
+ *   this size is empty.
+ *
+ ****************************************************************************/
+
+FAR struct mm_freenode_s *mm_slab_alloc(FAR struct mm_heap_s *heap,
+                                        size_t size)
+{
+  FAR struct mm_slab_s *slab;
+  FAR struct mm_freenode_s *node;
+  irqstate_t flags;
+
+  DEBUGASSERT(size > 0 && size <= MM_SLAB_MAXCHUNK);
+  slab = &heap->mm_slab[MM_SLAB_NDX(size)];
+
+  flags = mm_slab_lock();
+  node  = slab->ms_head;
+  if (node)
+    {
+      slab->ms_head = node->flink;
+      slab->ms_ncached--;
+      slab->ms_nhits++;
+    }
+  else
+    {
+      slab->ms_nmisses++;
+    }
+
+  mm_slab_unlock(flags);
+  return node;
+}
+
+/****************************************************************************
+ * Name: mm_slab_add
+ *
+ * Description:
+ *   Add an allocated chunk to the cache unconditionally.  This is used to
+ *   refill an empty cache in batches.
+ *
+ ****************************************************************************/
+
+void mm_slab_add(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+  FAR struct mm_slab_s *slab;
+  irqstate_t flags;
+
+  DEBUGASSERT(node->size <= MM_SLAB_MAXCHUNK &&
+              (node->preceding & MM_ALLOC_BIT) != 0);
+  slab = &heap->mm_slab[MM_SLAB_NDX(node->size)];
+
+  flags         = mm_slab_lock();
+  node->flink   = slab->ms_head;
+  slab->ms_head = node;
+  slab->ms_ncached++;
+  mm_slab_unlock(flags);
+}
+
+/****************************************************************************
+ * Name: mm_slab_free
+ *
+ * Description:
+ *   Keep a chunk that is being freed in the cache if it is of a cached size
+ *   and there is room in the cache.  The caller need not hold the mm
+ *   semaphore.
+ *
+ * Return Value:
+ *   true if the chunk was cached; false if it must be returned to the heap.
+ *
+ ****************************************************************************/
+
+bool mm_slab_free(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+  FAR struct mm_slab_s *slab;
+  irqstate_t flags;
+  bool cached = false;
+
+  if (node->size > MM_SLAB_MAXCHUNK)
+    {
+      return false;
+    }
+
+  slab  = &heap->mm_slab[MM_SLAB_NDX(node->size)];
+  flags = mm_slab_lock();
+
+  if (slab->ms_ncached < CONFIG_MM_SLAB_NCACHED)
+    {
+      node->flink   = slab->ms_head;
+      slab->ms_head = node;
+      slab->ms_ncached++;
+      slab->ms_nfrees++;
+      cached        = true;
+    }
+  else
+    {
+      slab->ms_nreleased++;
+    }
+
+  mm_slab_unlock(flags);
+  return cached;
+}
+
+/****************************************************************************
+ * Name: mm_slab_flush
+ *
+ * Description:
+ *   Return every cached chunk to the heap.  This is done when an allocation
+ *   fails so that memory held in the caches is never lost to the rest of
+ *   the system.  The caller must hold the mm semaphore.
+ *
+ * Return Value:
+ *   true if any chunks were returned to the heap.
+ *
+ ****************************************************************************/
+
+bool mm_slab_flush(FAR struct mm_heap_s *heap)
+{
+  FAR struct mm_freenode_s *node;
+  FAR struct mm_freenode_s *next;
+  irqstate_t flags;
+  bool flushed = false;
+  int ndx;
+
+  for (ndx = 0; ndx < MM_SLAB_NCLASSES; ndx++)
+    {
+      /* Detach the whole list, then free the chunks at leisure */
+
+      flags = mm_slab_lock();
+      node  = heap->mm_slab[ndx].ms_head;
+      heap->mm_slab[ndx].ms_head    = NULL;
+      heap->mm_slab[ndx].ms_ncached = 0;
+      mm_slab_unlock(flags);
+
+      for (; node; node = next)
+        {
+          next = node->flink;
+          mm_freechunk(heap, node);
+          flushed = true;
+        }
+    }
+
+  return flushed;
+}
+
+/****************************************************************************
+ * Name: mm_slabinfo
+ *
+ * Description:
+ *   Return the statistics of one size class of the small object cache.
+ *
+ * Parameters:
+ *   heap - The selected heap
+ *   ndx  - The size class in the range 0 through MM_SLAB_NCLASSES-1.  The
+ *          chunk size of class ndx is (ndx + 1) * MM_MIN_CHUNK.
+ *   info - The location to return the class statistics
+ *
+ * Return Value:
+ *   OK on success; -EINVAL if ndx is out of range.
+ *
+ ****************************************************************************/
+
+int mm_slabinfo(FAR struct mm_heap_s *heap, int ndx,
+                FAR struct mm_slabinfo_s *info)
+{
+  FAR struct mm_slab_s *slab;
+  irqstate_t flags;
+
+  DEBUGASSERT(info);
+
+  if (ndx < 0 || ndx >= MM_SLAB_NCLASSES)
+    {
+      return -EINVAL;
+    }
+
+  slab  = &heap->mm_slab[ndx];
+  flags = mm_slab_lock();
+
+  info->chunksize = (size_t)(ndx + 1) << MM_MIN_SHIFT;
+  info->ncached   = slab->ms_ncached;
+  info->nhits     = slab->ms_nhits;
+  info->nmisses   = slab->ms_nmisses;
+  info->nfrees    = slab->ms_nfrees;
+  info->nreleased = slab->ms_nreleased;
+
+  mm_slab_unlock(flags);
+  return OK;
+}
+
+#endif /* CONFIG_MM_SLAB */
@@ -0,0 +1,234 @@
+/****************************************************************************
+ * mm/mm_stats.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+#include <assert.h>
+
+#include <nuttx/mm.h>
+
+#ifdef CONFIG_MM_STATS
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_sizeclass
+ *
+ * Description:
+ *   Convert a chunk size to its power-of-two size class.  This is the same
+ *   mapping as mm_size2ndx() but is also available when the TLSF free
+ *   lists are used.
+ *
+ ****************************************************************************/
+
+static int mm_sizeclass(size_t size)
+{
+  int ndx = 0;
+
+  if (size >= MM_MAX_CHUNK)
+    {
+       return MM_NNODES-1;
+    }
+
+  size >>= MM_MIN_SHIFT;
+  while (size > 1)
+    {
+      ndx++;
+      size >>= 1;
+    }
+
+  return ndx;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_stats
+ *
+ * Description:
+ *   Walk the selected heap and return histograms of the allocated and free
+ *   chunks by size class, together with the current and peak number of
+ *   bytes in allocated chunks.  The guard chunks at each end of a region
+ *   are not counted.
+ *
+ * Parameters:
+ *   heap  - The selected heap
+ *   stats - Location to return the heap statistics
+ *
+ * Return Value:
+ *   OK always
+ *
+ ****************************************************************************/
+
+int mm_stats(FAR struct mm_heap_s *heap, FAR struct mm_stats_s *stats)
+{
+  FAR struct mm_allocnode_s *node;
+  int ndx;
+#if CONFIG_MM_REGIONS > 1
+  int region;
+#else
+# define region 0
+#endif
+
+  DEBUGASSERT(stats);
+  memset(stats, 0, sizeof(struct mm_stats_s));
+
+  /* Hold the semaphore for the whole walk so that the histograms and the
+   * usage counts are consistent.
+   */
+
+  mm_takesemaphore(heap);
+
+#if CONFIG_MM_REGIONS > 1
+  for (region = 0; region < heap->mm_nregions; region++)
+#endif
+    {
+      for (node = (FAR struct mm_allocnode_s *)
+                  ((FAR char *)heap->mm_heapstart[region] + SIZEOF_MM_ALLOCNODE);
+           node < heap->mm_heapend[region];
+           node = (FAR struct mm_allocnode_s *)((FAR char *)node + node->size))
+        {
+          ndx = mm_sizeclass(node->size);
+          if (node->preceding & MM_ALLOC_BIT)
+            {
+              stats->nalloc[ndx]++;
+              stats->allocbytes[ndx] += node->size;
+            }
+          else
+            {
+              stats->nfree[ndx]++;
+              stats->freebytes[ndx] += node->size;
+            }
+        }
+    }
+#undef region
+
+  stats->curused = heap->mm_curused;
+  stats->maxused = heap->mm_maxused;
+
+  mm_givesemaphore(heap);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mm_snapshot
+ *
+ * Description:
+ *   Walk the selected heap and return a description of each chunk, in
+ *   address order.  Nothing is allocated during the walk so the caller
+ *   must provide the buffer.  If the buffer is too small, then only the
+ *   first 'nchunks' chunks are described.  The guard chunks at each end of
+ *   a region are not included.
+ *
+ * Parameters:
+ *   heap    - The selected heap
+ *   chunks  - Location to return the chunk descriptions.  May be NULL if
+ *             nchunks is zero.
+ *   nchunks - The number of entries in the chunks[] array
+ *
+ * Return Value:
+ *   The total number of chunks in the heap.  This may be larger than
+ *   nchunks.
+ *
+ ****************************************************************************/
+
+int mm_snapshot(FAR struct mm_heap_s *heap,
+                FAR struct mm_chunkinfo_s *chunks, int nchunks)
+{
+  FAR struct mm_allocnode_s *node;
+  FAR struct mm_chunkinfo_s *info;
+  int total = 0;
+#if CONFIG_MM_REGIONS > 1
+  int region;
+#else
+# define region 0
+#endif
+
+  DEBUGASSERT(chunks || nchunks == 0);
+
+  mm_takesemaphore(heap);
+
+#if CONFIG_MM_REGIONS > 1
+  for (region = 0; region < heap->mm_nregions; region++)
+#endif
+    {
+      for (node = (FAR struct mm_allocnode_s *)
+                  ((FAR char *)heap->mm_heapstart[region] + SIZEOF_MM_ALLOCNODE);
+           node < heap->mm_heapend[region];
+           node = (FAR struct mm_allocnode_s *)((FAR char *)node + node->size))
+        {
+          if (total < nchunks)
+            {
+              info            = &chunks[total];
+              info->addr      = (uintptr_t)node;
+              info->size      = node->size;
+              info->allocated = (node->preceding & MM_ALLOC_BIT) != 0;
+#ifdef CONFIG_MM_CALLERPC
+              if (info->allocated)
+                {
+                  info->callerpc = node->callerpc;
+                  info->reqsize  = node->reqsize;
+                }
+              else
+#endif
+                {
+                  info->callerpc = 0;
+                  info->reqsize  = 0;
+                }
+            }
+
+          total++;
+        }
+    }
+#undef region
+
+  mm_givesemaphore(heap);
+  return total;
+}
+
+#endif /* CONFIG_MM_STATS */
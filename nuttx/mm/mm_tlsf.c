@@ -0,0 +1,372 @@
+/****************************************************************************
+ * mm/mm_tlsf.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+#include <assert.h>
+
+#include <nuttx/mm.h>
+
+#ifdef CONFIG_MM_TLSF
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The last list of the last first level class is unbounded:  In addition to
+ * its own sub-range, it holds every chunk larger than MM_MAX_CHUNK.  It is
+ * the only list that may have to be searched.
+ */
+
+#define MM_TLSF_FLLAST   (MM_TLSF_FLCOUNT - 1)
+#define MM_TLSF_SLLAST   (MM_TLSF_SLCOUNT - 1)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_fls
+ *
+ * Description:
+ *   Return the bit number of the most significant bit that is set in a
+ *   non-zero value.
+ *
+ ****************************************************************************/
+
+static inline int mm_fls(size_t value)
+{
+#if defined(__GNUC__)
+  return (int)(sizeof(unsigned long) * 8 - 1) -
+         __builtin_clzl((unsigned long)value);
+#else
+  int bit = 0;
+
+#if !defined(CONFIG_MM_SMALL) && SIZE_MAX > 0xffffffff
+  if ((value & ~(size_t)0xffffffff) != 0)
+    {
+      value >>= 32;
+      bit    += 32;
+    }
+#endif
+
+  if ((value & 0xffff0000) != 0)
+    {
+      value >>= 16;
+      bit    += 16;
+    }
+
+  if ((value & 0xff00) != 0)
+    {
+      value >>= 8;
+      bit    += 8;
+    }
+
+  if ((value & 0xf0) != 0)
+    {
+      value >>= 4;
+      bit    += 4;
+    }
+
+  if ((value & 0xc) != 0)
+    {
+      value >>= 2;
+      bit    += 2;
+    }
+
+  if ((value & 0x2) != 0)
+    {
+      bit    += 1;
+    }
+
+  return bit;
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_ffs
+ *
+ * Description:
+ *   Return the bit number of the least significant bit that is set in a
+ *   non-zero bitmap.
+ *
+ ****************************************************************************/
+
+static inline int mm_ffs(uint32_t bitmap)
+{
+  return mm_fls(bitmap & -bitmap);
+}
+
+/****************************************************************************
+ * Name: mm_mapping
+ *
+ * Description:
+ *   Map a chunk size to the first and second level index of the free list
+ *   that holds chunks of that size.
+ *
+ ****************************************************************************/
+
+static inline void mm_mapping(size_t size, FAR int *fl, FAR int *sl)
+{
+  int msb;
+
+  if (size < MM_TLSF_SMALL)
+    {
+      /* Small chunks are binned linearly in units of MM_MIN_CHUNK */
+
+      *fl = 0;
+      *sl = (int)(size >> MM_MIN_SHIFT);
+      return;
+    }
+
+  msb = mm_fls(size);
+  if (msb > MM_MAX_SHIFT)
+    {
+      /* Really big chunks all go into the last, unbounded list */
+
+      *fl = MM_TLSF_FLLAST;
+      *sl = MM_TLSF_SLLAST;
+      return;
+    }
+
+  *fl = msb - MM_TLSF_FLSHIFT + 1;
+  *sl = (int)(size >> (msb - MM_TLSF_SLSHIFT)) & MM_TLSF_SLLAST;
+}
+
+/****************************************************************************
+ * Name: mm_takechunk
+ *
+ * Description:
+ *   Return the first node in the list mm_freelist[fl][sl] that is at least
+ *   'size' bytes in size.  Only the last, unbounded list and the list that
+ *   the request size maps to can hold chunks that are too small.
+ *
+ ****************************************************************************/
+
+static inline FAR struct mm_freenode_s *
+mm_takechunk(FAR struct mm_heap_s *heap, int fl, int sl, size_t size)
+{
+  FAR struct mm_freenode_s *node;
+
+  for (node = heap->mm_freelist[fl][sl];
+       node && node->size < size;
+       node = node->flink);
+
+  return node;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_tlsf_initialize
+ *
+ * Description:
+ *   Initialize the segregated free lists of a heap.
+ *
+ ****************************************************************************/
+
+void mm_tlsf_initialize(FAR struct mm_heap_s *heap)
+{
+  heap->mm_flbitmap = 0;
+  memset(heap->mm_slbitmap, 0, sizeof(heap->mm_slbitmap));
+  memset(heap->mm_freelist, 0, sizeof(heap->mm_freelist));
+}
+
+/****************************************************************************
+ * Name: mm_addfreechunk
+ *
+ * Description:
+ *   Add a free chunk to the head of the free list for its size class.  It is
+ *   assumed that the caller holds the mm semaphore
+ *
+ ****************************************************************************/
+
+void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+  FAR struct mm_freenode_s *next;
+  int fl;
+  int sl;
+
+  mm_mapping(node->size, &fl, &sl);
+
+  next        = heap->mm_freelist[fl][sl];
+  node->blink = NULL;
+  node->flink = next;
+
+  if (next)
+    {
+      next->blink = node;
+    }
+
+  heap->mm_freelist[fl][sl] = node;
+  heap->mm_slbitmap[fl]    |= ((uint32_t)1 << sl);
+  heap->mm_flbitmap        |= ((uint32_t)1 << fl);
+}
+
+/****************************************************************************
+ * Name: mm_remfreechunk
+ *
+ * Description:
+ *   Remove a free chunk from the free list for its size class.  It is
+ *   assumed that the caller holds the mm semaphore
+ *
+ ****************************************************************************/
+
+void mm_remfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+  int fl;
+  int sl;
+
+  if (node->flink)
+    {
+      node->flink->blink = node->blink;
+    }
+
+  if (node->blink)
+    {
+      node->blink->flink = node->flink;
+      return;
+    }
+
+  /* The node was at the head of its list */
+
+  mm_mapping(node->size, &fl, &sl);
+  DEBUGASSERT(heap->mm_freelist[fl][sl] == node);
+
+  heap->mm_freelist[fl][sl] = node->flink;
+  if (!node->flink)
+    {
+      /* The list is now empty */
+
+      heap->mm_slbitmap[fl] &= ~((uint32_t)1 << sl);
+      if (heap->mm_slbitmap[fl] == 0)
+        {
+          heap->mm_flbitmap &= ~((uint32_t)1 << fl);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: mm_tlsf_findchunk
+ *
+ * Description:
+ *   Find a free chunk of at least 'size' bytes (including the allocation
+ *   node header).  The request size is rounded up to the next size class
+ *   boundary so that the head of any non-empty list at or above that class
+ *   is guaranteed to be large enough.  The search then consists only of two
+ *   bitmap lookups.
+ *
+ *   If that fails, there could still be a big enough chunk in the list that
+ *   the un-rounded request size maps to.  That list is searched only as a
+ *   last resort before the allocation fails.
+ *
+ *   The returned chunk is not removed from its free list.  It is assumed
+ *   that the caller holds the mm semaphore.
+ *
+ ****************************************************************************/
+
+FAR struct mm_freenode_s *mm_tlsf_findchunk(FAR struct mm_heap_s *heap,
+                                            size_t size)
+{
+  FAR struct mm_freenode_s *node;
+  size_t rounded = size;
+  uint32_t bitmap;
+  int fl;
+  int sl;
+
+  /* Round the size up to the next second level boundary */
+
+  if (size >= MM_TLSF_SMALL)
+    {
+      rounded += (1 << (mm_fls(size) - MM_TLSF_SLSHIFT)) - 1;
+    }
+
+  mm_mapping(rounded, &fl, &sl);
+
+  /* Is there a non-empty list at this first level index with a second level
+   * index that is the same or larger?
+   */
+
+  bitmap = heap->mm_slbitmap[fl] & (~(uint32_t)0 << sl);
+  if (bitmap == 0 && fl < MM_TLSF_FLLAST)
+    {
+      /* No.. is there a non-empty list at a larger first level index? */
+
+      bitmap = heap->mm_flbitmap & (~(uint32_t)0 << (fl + 1));
+      if (bitmap != 0)
+        {
+          fl     = mm_ffs(bitmap);
+          bitmap = heap->mm_slbitmap[fl];
+        }
+    }
+
+  if (bitmap != 0)
+    {
+      sl = mm_ffs(bitmap);
+
+      /* Every chunk in the selected list is big enough except, perhaps, in
+       * the last, unbounded list.
+       */
+
+      if (fl == MM_TLSF_FLLAST && sl == MM_TLSF_SLLAST)
+        {
+          node = mm_takechunk(heap, fl, sl, size);
+        }
+      else
+        {
+          node = heap->mm_freelist[fl][sl];
+        }
+
+      if (node)
+        {
+          DEBUGASSERT(node->size >= size);
+          return node;
+        }
+    }
+
+  /* Nothing found.  Try the list that the un-rounded size maps to */
+
+  mm_mapping(size, &fl, &sl);
+  return mm_takechunk(heap, fl, sl, size);
+}
+
+#endif /* CONFIG_MM_TLSF */
@@ -85,15 +85,16 @@ FAR void *mm_zalloc(FAR struct mm_heap_s *heap, size_t size)
 FAR void *zalloc(size_t size)
 {
 #ifdef CONFIG_MM_MULTIHEAP
-  return mm_zalloc(&g_mmheap, size);
+  FAR void *alloc = mm_zalloc(&g_mmheap, size);
 #else
   FAR void *alloc = malloc(size);
   if (alloc)
     {
        memset(alloc, 0, size);
     }
+#endif
 
+  MM_TAGCALLER(alloc, size);
   return alloc;
-#endif
 }
 #endif
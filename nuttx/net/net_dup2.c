@@ -69,8 +69,10 @@ int net_dup2(int sockfd1, int sockfd2)
 int dup2(int sockfd1, int sockfd2)
 #endif
 {
+  FAR struct socketlist *list;
   FAR struct socket *psock1;
   FAR struct socket *psock2;
+  int ndx;
   int err;
   int ret;
 
@@ -83,11 +85,12 @@ int dup2(int sockfd1, int sockfd2)
   psock1 = sockfd_socket(sockfd1);
   psock2 = sockfd_socket(sockfd2);
 
-  /* Verify that the sockfd1 and sockfd2 both refer to valid socket
-   * descriptors and that sockfd2 corresponds to allocated socket
+  /* Verify that the sockfd1 refers to a valid, allocated socket and that
+   * sockfd2 is a valid socket descriptor.
    */
 
-  if (!psock1 || !psock2 || psock1->s_crefs <= 0)
+  if (!psock1 || psock1->s_crefs <= 0 ||
+      (unsigned int)(sockfd2 - __SOCKFD_OFFSET) >= CONFIG_NSOCKET_DESCRIPTORS)
     {
       err = EBADF;
       goto errout;
@@ -97,16 +100,28 @@ int dup2(int sockfd1, int sockfd2)
    * close it!
    */
 
-  if (psock2->s_crefs > 0)
+  if (psock2 && psock2->s_crefs > 0)
     {
       net_close(sockfd2);
     }
 
+  /* Reserve sockfd2 (allocating memory for it if necessary) */
+
+  list   = sched_getsockets();
+  ndx    = sockfd2 - __SOCKFD_OFFSET;
+  psock2 = list ? net_reserve(list, ndx) : NULL;
+  if (!psock2)
+    {
+      err = ENFILE;
+      goto errout;
+    }
+
   /* Duplicate the socket state */
 
   ret = net_clone(psock1, psock2);
   if (ret < 0)
     {
+      net_unreserve(list, ndx);
       err = -ret;
       goto errout;
     }
@@ -123,6 +123,17 @@ void net_initlist(FAR struct socketlist *list)
   /* Initialize the list access mutex */
 
   (void)sem_init(&list->sl_sem, 0, 1);
+
+  /* And the (empty) table of socket descriptors */
+
+#ifdef CONFIG_FDTABLE_DYNAMIC
+  fdtable_initialize(&list->sl_table, CONFIG_NSOCKET_DESCRIPTORS,
+                     sizeof(struct socket), list->sl_inuse, list->sl_blocks);
+#else
+  fdtable_initialize(&list->sl_table, CONFIG_NSOCKET_DESCRIPTORS,
+                     sizeof(struct socket), list->sl_inuse,
+                     list->sl_sockets);
+#endif
 }
 
 /* Release release resources held by the socket list */
@@ -137,13 +148,17 @@ void net_releaselist(FAR struct socketlist *list)
 
   for (ndx = 0; ndx < CONFIG_NSOCKET_DESCRIPTORS; ndx++)
     {
-      FAR struct socket *psock = &list->sl_sockets[ndx];
-      if (psock->s_crefs > 0)
+      FAR struct socket *psock = net_getsocket(list, ndx);
+      if (psock && psock->s_crefs > 0)
         {
           (void)psock_close(psock);
         }
     }
 
+  /* Free the memory used for the socket descriptors */
+
+  fdtable_release(&list->sl_table);
+
   /* Destroy the semaphore */
 
   (void)sem_destroy(&list->sl_sem);
@@ -152,6 +167,7 @@ void net_releaselist(FAR struct socketlist *list)
 int sockfd_allocate(int minsd)
 {
   FAR struct socketlist *list;
+  FAR struct socket *psock;
   int i;
 
   /* Get the socket list for this task/thread */
@@ -159,28 +175,26 @@ int sockfd_allocate(int minsd)
   list = sched_getsockets();
   if (list)
     {
-      /* Search for a socket structure with no references */
+      /* Take the lowest free socket structure from the table */
 
       _net_semtake(list);
-      for (i = minsd; i < CONFIG_NSOCKET_DESCRIPTORS; i++)
+      i = fdtable_allocate(&list->sl_table, minsd);
+      if (i >= 0)
         {
-          /* Are there references on this socket? */
-
-          if (!list->sl_sockets[i].s_crefs)
-            {
-              /* No take the reference and return the index + an offset
-               * as the socket descriptor.
-               */
+          /* Take the reference and return the index + an offset as the
+           * socket descriptor.
+           */
 
-               memset(&list->sl_sockets[i], 0, sizeof(struct socket));
-               list->sl_sockets[i].s_crefs = 1;
-               _net_semgive(list);
-               return i + __SOCKFD_OFFSET;
-            }
+          psock = net_getsocket(list, i);
+          memset(psock, 0, sizeof(struct socket));
+          psock->s_crefs = 1;
+          _net_semgive(list);
+          return i + __SOCKFD_OFFSET;
         }
+
       _net_semgive(list);
     }
- 
+
   return ERROR;
 }
 
@@ -208,9 +222,17 @@ void sock_release(FAR struct socket *psock)
             }
           else
             {
-              /* The socket will not persist... reset it */
+              /* The socket will not persist... reset it and free its
+               * descriptor (unless it is not in the list at all).
+               */
+
+              int ndx = fdtable_index(&list->sl_table, psock);
 
               memset(psock, 0, sizeof(struct socket));
+              if (ndx >= 0)
+                {
+                  fdtable_free(&list->sl_table, ndx);
+                }
             }
           _net_semgive(list);
         }
@@ -241,11 +263,44 @@ FAR struct socket *sockfd_socket(int sockfd)
       list = sched_getsockets();
       if (list)
         {
-          return &list->sl_sockets[ndx];
+          return net_getsocket(list, ndx);
         }
     }
   return NULL;
 }
 
+/* Reserve a specific socket structure in a list before a socket is cloned
+ * into it.
+ */
+
+FAR struct socket *net_reserve(FAR struct socketlist *list, int ndx)
+{
+  FAR struct socket *psock;
+
+  _net_semtake(list);
+  psock = (FAR struct socket *)fdtable_reserve(&list->sl_table, ndx);
+  _net_semgive(list);
+  return psock;
+}
+
+/* Release a socket structure reserved with net_reserve() if the socket
+ * could not be cloned into it.
+ */
+
+void net_unreserve(FAR struct socketlist *list, int ndx)
+{
+  FAR struct socket *psock;
+
+  _net_semtake(list);
+  psock = net_getsocket(list, ndx);
+  if (psock)
+    {
+      memset(psock, 0, sizeof(struct socket));
+      fdtable_free(&list->sl_table, ndx);
+    }
+
+  _net_semgive(list);
+}
+
 #endif /* CONFIG_NSOCKET_DESCRIPTORS */
 #endif /* CONFIG_NET */
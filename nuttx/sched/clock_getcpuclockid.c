@@ -0,0 +1,135 @@
+/************************************************************************
+ * sched/clock_getcpuclockid.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Included Files
+ ************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/sched.h>
+
+#include "os_internal.h"
+#include "clock_internal.h"
+
+#ifdef CONFIG_SCHED_CPUACCT
+
+/************************************************************************
+ * Public Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name: clock_getcpuclockid
+ *
+ * Description:
+ *   Return the clock ID of the CPU time clock of a task or thread.  This
+ *   differs from POSIX in that the clock measures the CPU time of the
+ *   single task or thread with the given PID, not of all threads in the
+ *   process (NuttX does not otherwise account for threads in the group).
+ *
+ * Parameters:
+ *   pid     - The task or thread ID; zero means the caller
+ *   clockid - The location to return the clock ID
+ *
+ * Return Value:
+ *   Zero (OK) on success; ESRCH if there is no task with this PID.  As
+ *   POSIX requires, the error number is returned, errno is not set.
+ *
+ ************************************************************************/
+
+int clock_getcpuclockid(pid_t pid, FAR clockid_t *clockid)
+{
+  if (pid == 0)
+    {
+      pid = getpid();
+    }
+
+  if (pid < 0 || sched_gettcb(pid) == NULL)
+    {
+      return ESRCH;
+    }
+
+  *clockid = CPUCLOCK_MKID(pid);
+  return OK;
+}
+
+/************************************************************************
+ * Name: clock_cpugettime
+ *
+ * Description:
+ *   Get the time of a CPU time clock.  Called by clock_gettime().
+ *
+ * Parameters:
+ *   clock_id - A CPU time clock ID (CPUCLOCK_ISCPU(clock_id) is true)
+ *   tp       - The location to return the CPU time
+ *
+ * Return Value:
+ *   OK on success; ERROR with errno set to EINVAL if the task no longer
+ *   exists.
+ *
+ ************************************************************************/
+
+int clock_cpugettime(clockid_t clock_id, FAR struct timespec *tp)
+{
+  FAR struct tcb_s *tcb;
+  pid_t pid = CPUCLOCK_PID(clock_id);
+  int ret = OK;
+
+  /* Keep the task from exiting while its TCB is examined */
+
+  sched_lock();
+  tcb = pid < 0 ? sched_self() : sched_gettcb(pid);
+  if (tcb)
+    {
+      sched_cputime(tcb, tp);
+    }
+  else
+    {
+      set_errno(EINVAL);
+      ret = ERROR;
+    }
+
+  sched_unlock();
+  return ret;
+}
+
+#endif /* CONFIG_SCHED_CPUACCT */
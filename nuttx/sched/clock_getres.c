@@ -93,9 +93,13 @@ int clock_getres(clockid_t clock_id, struct timespec *res)
 
   sdbg("clock_id=%d\n", clock_id);
 
-  /* Only CLOCK_REALTIME is supported */
+  /* Only CLOCK_REALTIME and the CPU time clocks are supported */
 
+#ifdef CONFIG_SCHED_CPUACCT
+  if (clock_id != CLOCK_REALTIME && !CPUCLOCK_ISCPU(clock_id))
+#else
   if (clock_id != CLOCK_REALTIME)
+#endif
     {
       sdbg("Returning ERROR\n");
       set_errno(EINVAL);
@@ -103,9 +107,20 @@ int clock_getres(clockid_t clock_id, struct timespec *res)
     }
   else
     {
-      /* Get the clock resolution in nanoseconds */
-
-      time_res = MSEC_PER_TICK * NSEC_PER_MSEC;
+      /* Get the clock resolution in nanoseconds.  CPU time is measured in
+       * microseconds in the tickless mode.
+       */
+
+#if defined(CONFIG_SCHED_CPUACCT) && defined(CONFIG_SCHED_TICKLESS)
+      if (CPUCLOCK_ISCPU(clock_id))
+        {
+          time_res = NSEC_PER_USEC;
+        }
+      else
+#endif
+        {
+          time_res = MSEC_PER_TICK * NSEC_PER_MSEC;
+        }
 
       /* And return this as a timespec. */
 
@@ -47,6 +47,9 @@
 #include <debug.h>
 
 #include <arch/irq.h>
+#ifdef CONFIG_SCHED_TICKLESS
+#  include <nuttx/arch.h>
+#endif
 
 #include "clock_internal.h"
 
@@ -100,12 +103,27 @@ int clock_gettime(clockid_t clock_id, struct timespec *tp)
   uint32_t msecs;
   uint32_t secs;
   uint32_t nsecs;
+#endif
+#ifdef CONFIG_SCHED_TICKLESS
+  struct timespec ts;
+  uint32_t biasns;
 #endif
   int ret = OK;
 
   sdbg("clock_id=%d\n", clock_id);
   DEBUGASSERT(tp != NULL);
 
+#ifdef CONFIG_SCHED_CPUACCT
+  /* CLOCK_THREAD_CPUTIME_ID and the clocks returned by clock_getcpuclockid()
+   * measure the CPU time used by a task.
+   */
+
+  if (CPUCLOCK_ISCPU(clock_id))
+    {
+      return clock_cpugettime(clock_id, tp);
+    }
+#endif
+
   /* CLOCK_REALTIME - POSIX demands this to be present. This is the wall
    * time clock.
    */
@@ -128,6 +146,31 @@ int clock_gettime(clockid_t clock_id, struct timespec *tp)
       else
 #endif
         {
+#ifdef CONFIG_SCHED_TICKLESS
+          /* Get the elapsed time since power up directly from the free-
+           * running counter so that the time has better than one tick
+           * resolution.  Then remove the bias (in milliseconds).
+           */
+
+          (void)up_timer_gettime(&ts);
+
+          msecs  = TICK2MSEC(g_tickbias);
+          secs   = ts.tv_sec - msecs / MSEC_PER_SEC;
+          biasns = (uint32_t)(msecs % MSEC_PER_SEC) * NSEC_PER_MSEC;
+
+          if ((uint32_t)ts.tv_nsec < biasns)
+            {
+              secs--;
+              nsecs = (uint32_t)ts.tv_nsec + NSEC_PER_SEC - biasns;
+            }
+          else
+            {
+              nsecs = (uint32_t)ts.tv_nsec - biasns;
+            }
+
+          sdbg("elapsed=(%d,%d) g_tickbias=%d\n",
+               (int)ts.tv_sec, (int)ts.tv_nsec, (int)g_tickbias);
+#else
           /* Get the elapsed time since power up (in milliseconds) biased
            * as appropriate.
            */
@@ -141,6 +184,7 @@ int clock_gettime(clockid_t clock_id, struct timespec *tp)
 
           secs  = msecs / MSEC_PER_SEC;
           nsecs = (msecs - (secs * MSEC_PER_SEC)) * NSEC_PER_MSEC;
+#endif
 
           sdbg("secs = %d + %d nsecs = %d + %d\n",
                (int)msecs, (int)g_basetime.tv_sec,
@@ -81,10 +81,14 @@
  ****************************************************************************/
 
 #ifdef CONFIG_SYSTEM_TIME64
+#ifndef CONFIG_SCHED_TICKLESS
 volatile uint64_t g_system_timer;
+#endif
 uint64_t          g_tickbias;
 #else
+#ifndef CONFIG_SCHED_TICKLESS
 volatile uint32_t g_system_timer;
+#endif
 uint32_t          g_tickbias;
 #endif
 
@@ -182,8 +186,20 @@ static void clock_inittime(void)
   /* (Re-)initialize the time value to match the RTC */
 
   clock_basetime(&g_basetime);
+#ifdef CONFIG_SCHED_TICKLESS
+  /* There is no system timer to reset; the free-running counter continues
+   * to run.  Bias the time so that it starts at the base time now.
+   */
+
+#ifdef CONFIG_SYSTEM_TIME64
+  g_tickbias     = clock_systimer64();
+#else
+  g_tickbias     = clock_systimer();
+#endif
+#else
   g_system_timer = 0;
   g_tickbias     = 0;
+#endif
 }
 
 /****************************************************************************
@@ -262,9 +278,11 @@ void clock_synchronize(void)
  *
  ****************************************************************************/
 
+#ifndef CONFIG_SCHED_TICKLESS
 void clock_timer(void)
 {
   /* Increment the per-tick system counter */
 
   g_system_timer++;
 }
+#endif
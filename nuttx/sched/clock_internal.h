@@ -59,6 +59,21 @@
 #  undef CONFIG_SYSTEM_TIME64
 #endif
 
+/* CPU time clock IDs.  The two least significant bits of the clock ID hold
+ * CLOCK_THREAD_CPUTIME_ID; the remaining bits hold the PID of the thread plus
+ * one.  So CLOCK_THREAD_CPUTIME_ID by itself (PID field zero) refers to the
+ * calling thread.
+ */
+
+#ifdef CONFIG_SCHED_CPUACCT
+#  define CPUCLOCK_MASK         3
+#  define CPUCLOCK_SHIFT        2
+#  define CPUCLOCK_ISCPU(id)    (((id) & CPUCLOCK_MASK) == CLOCK_THREAD_CPUTIME_ID)
+#  define CPUCLOCK_MKID(pid)    ((((clockid_t)(pid) + 1) << CPUCLOCK_SHIFT) | \
+                                 CLOCK_THREAD_CPUTIME_ID)
+#  define CPUCLOCK_PID(id)      ((pid_t)(((id) >> CPUCLOCK_SHIFT) - 1))
+#endif
+
 /********************************************************************************
  * Public Type Definitions
  ********************************************************************************/
@@ -80,12 +95,17 @@ extern struct timespec g_basetime;
  ********************************************************************************/
 
 void weak_function clock_initialize(void);
+#ifndef CONFIG_SCHED_TICKLESS
 void weak_function clock_timer(void);
+#endif
 
 int    clock_abstime2ticks(clockid_t clockid,
                            FAR const struct timespec *abstime,
                            FAR int *ticks);
 int    clock_time2ticks(FAR const struct timespec *reltime, FAR int *ticks);
 int    clock_ticks2time(int ticks, FAR struct timespec *reltime);
+#ifdef CONFIG_SCHED_CPUACCT
+int    clock_cpugettime(clockid_t clock_id, FAR struct timespec *tp);
+#endif
 
 #endif /* __SCHED_CLOCK_INTERNAL_H */
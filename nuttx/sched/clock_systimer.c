@@ -42,6 +42,10 @@
 #include <stdint.h>
 
 #include <nuttx/clock.h>
+#ifdef CONFIG_SCHED_TICKLESS
+#  include <time.h>
+#  include <nuttx/arch.h>
+#endif
 
 #include "clock_internal.h"
 
@@ -76,7 +80,18 @@
 #if !defined(clock_systimer) /* See nuttx/clock.h */
 uint32_t clock_systimer(void)
 {
-#ifdef CONFIG_SYSTEM_TIME64
+#if defined(CONFIG_SCHED_TICKLESS)
+  struct timespec ts;
+
+  /* Convert the free-running counter to ticks.  The 32-bit result simply
+   * wraps just as the periodic counter would.
+   */
+
+  (void)up_timer_gettime(&ts);
+  return (uint32_t)ts.tv_sec * TICK_PER_SEC +
+         (uint32_t)ts.tv_nsec / NSEC_PER_TICK;
+
+#elif defined(CONFIG_SYSTEM_TIME64)
   return (uint32_t)(g_system_timer & 0x00000000ffffffff);
 #else
   return g_system_timer;
@@ -104,7 +119,15 @@ uint32_t clock_systimer(void)
 #ifdef CONFIG_SYSTEM_TIME64
 uint64_t clock_systimer64(void)
 {
+#ifdef CONFIG_SCHED_TICKLESS
+  struct timespec ts;
+
+  (void)up_timer_gettime(&ts);
+  return (uint64_t)ts.tv_sec * TICK_PER_SEC +
+         (uint64_t)ts.tv_nsec / NSEC_PER_TICK;
+#else
   return g_system_timer;
+#endif
 }
 #endif
 #endif
@@ -46,6 +46,7 @@
 
 #include <nuttx/kmalloc.h>
 
+#include "os_internal.h"
 #include "group_internal.h"
 #include "env_internal.h"
 
@@ -183,7 +184,11 @@ int group_allocate(FAR struct task_tcb_s *tcb)
 
   /* Allocate the group structure and assign it to the TCB */
 
+#ifdef CONFIG_SCHED_TCBCACHE
+  group = (FAR struct task_group_s *)sched_cachealloc(SCHED_CACHE_GROUP);
+#else
   group = (FAR struct task_group_s *)kzalloc(sizeof(struct task_group_s));
+#endif
   if (!group)
     {
       return -ENOMEM;
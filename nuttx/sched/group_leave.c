@@ -48,6 +48,7 @@
 #include <nuttx/net/net.h>
 #include <nuttx/lib.h>
 
+#include "os_internal.h"
 #include "env_internal.h"
 #include "sig_internal.h"
 #include "pthread_internal.h"
@@ -235,7 +236,11 @@ static inline void group_release(FAR struct task_group_s *group)
 
   /* Release the group container itself */
 
+#ifdef CONFIG_SCHED_TCBCACHE
+  sched_cachefree(SCHED_CACHE_GROUP, group);
+#else
   sched_kfree(group);
+#endif
 }
 
 /*****************************************************************************
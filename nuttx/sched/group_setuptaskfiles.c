@@ -90,8 +90,9 @@ static inline void sched_dupfiles(FAR struct task_tcb_s *tcb)
   /* The parent task is the one at the head of the ready-to-run list */
 
   FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
-  FAR struct file *parent;
-  FAR struct file *child;
+  FAR struct filelist *parent;
+  FAR struct filelist *child;
+  FAR struct file *filep;
   int i;
 
   DEBUGASSERT(tcb && tcb->cmn.group && rtcb->group);
@@ -104,8 +105,8 @@ static inline void sched_dupfiles(FAR struct task_tcb_s *tcb)
 
    /* Get pointers to the parent and child task file lists */
 
-  parent = rtcb->group->tg_filelist.fl_files;
-  child  = tcb->cmn.group->tg_filelist.fl_files;
+  parent = &rtcb->group->tg_filelist;
+  child  = &tcb->cmn.group->tg_filelist;
 
   /* Check each file in the parent file list */
 
@@ -116,11 +117,16 @@ static inline void sched_dupfiles(FAR struct task_tcb_s *tcb)
        * i-node structure.
        */
 
-      if (parent[i].f_inode)
+      filep = files_getfile(parent, i);
+      if (filep && filep->f_inode)
         {
-          /* Yes... duplicate it for the child */
+          /* Yes... duplicate it into the same descriptor of the child */
 
-          (void)files_dup(&parent[i], &child[i]);
+          FAR struct file *newp = files_reserve(child, i);
+          if (newp && files_dup(filep, newp) < 0)
+            {
+              files_unreserve(child, i);
+            }
         }
     }
 }
@@ -148,8 +154,9 @@ static inline void sched_dupsockets(FAR struct task_tcb_s *tcb)
   /* The parent task is the one at the head of the ready-to-run list */
 
   FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
-  FAR struct socket *parent;
-  FAR struct socket *child;
+  FAR struct socketlist *parent;
+  FAR struct socketlist *child;
+  FAR struct socket *psock;
   int i;
 
   /* Duplicate the socket descriptors of all sockets opened by the parent
@@ -160,8 +167,8 @@ static inline void sched_dupsockets(FAR struct task_tcb_s *tcb)
 
   /* Get pointers to the parent and child task socket lists */
 
-  parent = rtcb->group->tg_socketlist.sl_sockets;
-  child  = tcb->cmn.group->tg_socketlist.sl_sockets;
+  parent = &rtcb->group->tg_socketlist;
+  child  = &tcb->cmn.group->tg_socketlist;
 
   /* Check each socket in the parent socket list */
 
@@ -172,11 +179,16 @@ static inline void sched_dupsockets(FAR struct task_tcb_s *tcb)
        * reference count.
        */
 
-      if (parent[i].s_crefs > 0)
+      psock = net_getsocket(parent, i);
+      if (psock && psock->s_crefs > 0)
         {
-          /* Yes... duplicate it for the child */
+          /* Yes... duplicate it into the same descriptor of the child */
 
-          (void)net_clone(&parent[i], &child[i]);
+          FAR struct socket *newp = net_reserve(child, i);
+          if (newp && net_clone(psock, newp) < 0)
+            {
+              net_unreserve(child, i);
+            }
         }
     }
 }
@@ -113,6 +113,17 @@ int irq_attach(int irq, xcpt_t isr)
            isr = irq_unexpected_isr;
         }
 
+#ifdef CONFIG_IRQ_THREADED
+      /* If a threaded handler is being replaced, then its thread must
+       * exit.
+       */
+
+      if (isr != irq_thread_dispatch)
+        {
+          irq_thread_detach(irq);
+        }
+#endif
+
       /* Save the new ISR in the table. */
 
       g_irqvector[irq] = isr;
@@ -42,7 +42,9 @@
 #include <debug.h>
 #include <nuttx/arch.h>
 #include <nuttx/irq.h>
+#include <nuttx/sched_trace.h>
 
+#include "os_internal.h"
 #include "irq_internal.h"
 
 /****************************************************************************
@@ -93,6 +95,9 @@ void irq_dispatch(int irq, FAR void *context)
   else
     {
       vector = g_irqvector[irq];
+#ifdef CONFIG_IRQ_STATISTICS
+      g_irqcount[irq]++;
+#endif
     }
 #else
   vector = irq_unexpected_isr;
@@ -100,6 +105,20 @@ void irq_dispatch(int irq, FAR void *context)
 
   /* Then dispatch to the interrupt handler */
 
+#ifdef CONFIG_SCHED_TRACE_IRQ
+  sched_trace_event(SCHED_TRACE_IRQENTER,
+                    (FAR struct tcb_s*)g_readytorun.head, irq);
+#endif
+
+  sched_cpu_irqenter();
   vector(irq, context);
+  sched_cpu_irqleave();
+
+#ifdef CONFIG_SCHED_TRACE_IRQ
+  /* The handler may have made a different task ready-to-run */
+
+  sched_trace_event(SCHED_TRACE_IRQLEAVE,
+                    (FAR struct tcb_s*)g_readytorun.head, irq);
+#endif
 }
 
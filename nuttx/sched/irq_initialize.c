@@ -57,6 +57,10 @@
 
 FAR xcpt_t g_irqvector[NR_IRQS+1];
 
+#ifdef CONFIG_IRQ_STATISTICS
+uint32_t g_irqcount[NR_IRQS];
+#endif
+
 /****************************************************************************
  * Private Variables
  ****************************************************************************/
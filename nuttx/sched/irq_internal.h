@@ -42,6 +42,8 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
+
 #include <nuttx/arch.h>
 #include <nuttx/irq.h>
 #include <nuttx/compiler.h>
@@ -56,6 +58,12 @@
 
 extern FAR xcpt_t g_irqvector[NR_IRQS+1];
 
+/* The number of times that each IRQ has been dispatched */
+
+#ifdef CONFIG_IRQ_STATISTICS
+extern uint32_t g_irqcount[NR_IRQS];
+#endif
+
 /****************************************************************************
  * Public Variables
  ****************************************************************************/
@@ -75,6 +83,15 @@ extern "C"
 void weak_function irq_initialize(void);
 int irq_unexpected_isr(int irq, FAR void *context);
 
+#ifdef CONFIG_IRQ_THREADED
+int irq_thread_dispatch(int irq, FAR void *context);
+void irq_thread_detach(int irq);
+void irq_thread_start(void);
+#ifdef CONFIG_IRQ_STATISTICS
+void irq_thread_info(int irq, FAR struct irq_info_s *info);
+#endif
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -0,0 +1,541 @@
+/****************************************************************************
+ * sched/irq_thread.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <time.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+#include <nuttx/clock.h>
+
+#include "os_internal.h"
+#include "irq_internal.h"
+
+#ifdef CONFIG_IRQ_THREADED
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_IRQ_NTHREADS
+#  define CONFIG_IRQ_NTHREADS 4
+#endif
+
+#ifndef CONFIG_IRQ_THREAD_STACKSIZE
+#  define CONFIG_IRQ_THREAD_STACKSIZE 1024
+#endif
+
+/* The default top half can only be used if IRQs can be disabled
+ * individually.
+ */
+
+#if !defined(CONFIG_ARCH_NOINTC) && !defined(CONFIG_ARCH_VECNOTIRQ)
+#  define HAVE_DEFAULT_ISR 1
+#endif
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/* This describes one threaded interrupt handler */
+
+struct irq_thread_s
+{
+  bool          inuse;       /* The entry is in use */
+  volatile bool pending;     /* The bottom half has been woken */
+  int16_t       irq;         /* The IRQ number */
+  uint8_t       priority;    /* Priority of the bottom half thread */
+  pid_t         pid;         /* The bottom half thread (0 if not started) */
+  int           stacksize;   /* Stack size of the bottom half thread */
+  xcpt_t        isr;         /* The top half (NULL: default top half) */
+  irqthread_t   handler;     /* The bottom half (NULL: being detached) */
+  FAR void     *arg;         /* Argument passed to the bottom half */
+  sem_t         sem;         /* Posted to wake the bottom half */
+#ifdef CONFIG_IRQ_STATISTICS
+  uint32_t      wakeup;      /* Time when the bottom half was woken */
+  uint32_t      nruns;       /* Number of runs of the bottom half */
+  uint32_t      latsum;      /* Total wake-up latency */
+  uint32_t      latmax;      /* Maximum wake-up latency */
+  uint32_t      runmax;      /* Longest run of the bottom half */
+#endif
+};
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+static struct irq_thread_s g_irqthread[CONFIG_IRQ_NTHREADS];
+
+/* True after os_bringup() has started the bottom half threads.  Threads for
+ * handlers attached after that are started immediately.
+ */
+
+static bool g_irqthread_started;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: irq_now
+ *
+ * Description:
+ *   Return the current time in microseconds.  In the tickless mode, this
+ *   has the resolution of the platform's free-running counter; otherwise,
+ *   it has the resolution of the system timer tick.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IRQ_STATISTICS
+static inline uint32_t irq_now(void)
+{
+#ifdef CONFIG_SCHED_TICKLESS
+  struct timespec ts;
+
+  (void)up_timer_gettime(&ts);
+  return (uint32_t)ts.tv_sec * USEC_PER_SEC + ts.tv_nsec / NSEC_PER_USEC;
+#else
+  return clock_systimer() * USEC_PER_TICK;
+#endif
+}
+#endif
+
+/****************************************************************************
+ * Name: irq_thread_find
+ *
+ * Description:
+ *   Return the threaded handler attached to an IRQ (or NULL).  Entries
+ *   that are being detached are ignored.
+ *
+ ****************************************************************************/
+
+static FAR struct irq_thread_s *irq_thread_find(int irq)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_IRQ_NTHREADS; i++)
+    {
+      if (g_irqthread[i].inuse && g_irqthread[i].handler &&
+          g_irqthread[i].irq == irq)
+        {
+          return &g_irqthread[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: irq_thread_main
+ *
+ * Description:
+ *   The bottom half thread.  The index of its entry in g_irqthread[] is
+ *   passed as argv[1].
+ *
+ ****************************************************************************/
+
+static int irq_thread_main(int argc, FAR char *argv[])
+{
+  FAR struct irq_thread_s *entry = &g_irqthread[atoi(argv[1])];
+  irqthread_t handler;
+  FAR void *arg;
+  irqstate_t flags;
+#ifdef CONFIG_IRQ_STATISTICS
+  uint32_t wakeup;
+  uint32_t start;
+  uint32_t elapsed;
+#endif
+
+  for (;;)
+    {
+      /* Wait for the top half */
+
+      while (sem_wait(&entry->sem) < 0)
+        {
+          /* The only case that an error should occur here is if the wait
+           * was awakened by a signal.
+           */
+
+          DEBUGASSERT(get_errno() == EINTR);
+        }
+
+      flags = irqsave();
+      if (!entry->handler)
+        {
+          /* The handler has been detached.  Free the entry and exit */
+
+          sem_destroy(&entry->sem);
+          entry->pid   = 0;
+          entry->inuse = false;
+          irqrestore(flags);
+          return OK;
+        }
+
+      /* From here on, another interrupt will wake the bottom half again */
+
+      entry->pending = false;
+      handler        = entry->handler;
+      arg            = entry->arg;
+#ifdef CONFIG_IRQ_STATISTICS
+      wakeup = entry->wakeup;
+#endif
+      irqrestore(flags);
+
+      /* Run the bottom half */
+
+#ifdef CONFIG_IRQ_STATISTICS
+      start = irq_now();
+#endif
+
+      handler(entry->irq, arg);
+
+#ifdef CONFIG_IRQ_STATISTICS
+      elapsed = irq_now() - start;
+      start  -= wakeup;
+
+      flags = irqsave();
+      entry->nruns++;
+      entry->latsum += start;
+      if (start > entry->latmax)
+        {
+          entry->latmax = start;
+        }
+
+      if (elapsed > entry->runmax)
+        {
+          entry->runmax = elapsed;
+        }
+
+      irqrestore(flags);
+#endif
+
+      /* The default top half disabled the IRQ */
+
+#ifdef HAVE_DEFAULT_ISR
+      if (!entry->isr)
+        {
+          up_enable_irq(entry->irq);
+        }
+#endif
+    }
+
+  return OK; /* To keep some compilers happy */
+}
+
+/****************************************************************************
+ * Name: irq_thread_create
+ *
+ * Description:
+ *   Start the bottom half thread of an entry.
+ *
+ ****************************************************************************/
+
+static int irq_thread_create(FAR struct irq_thread_s *entry)
+{
+  FAR char *argv[2];
+  char name[8];
+  char arg[4];
+  int pid;
+
+  snprintf(name, sizeof(name), "irq%d", entry->irq);
+  (void)itoa(entry - g_irqthread, arg, 10);
+  argv[0] = arg;
+  argv[1] = NULL;
+
+  pid = KERNEL_THREAD(name, entry->priority, entry->stacksize,
+                      (main_t)irq_thread_main, (FAR char * const *)argv);
+  if (pid < 0)
+    {
+      sdbg("Failed to start the thread for IRQ %d: %d\n",
+           entry->irq, get_errno());
+      return -ENOMEM;
+    }
+
+  entry->pid = pid;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: irq_thread_dispatch
+ *
+ * Description:
+ *   This is attached to every IRQ with a threaded handler.  It runs the top
+ *   half and wakes the bottom half if necessary.
+ *
+ ****************************************************************************/
+
+int irq_thread_dispatch(int irq, FAR void *context)
+{
+  FAR struct irq_thread_s *entry = irq_thread_find(irq);
+
+  if (!entry)
+    {
+      return irq_unexpected_isr(irq, context);
+    }
+
+  if (entry->isr)
+    {
+      if (entry->isr(irq, context) != IRQ_WAKE_THREAD)
+        {
+          return OK;
+        }
+    }
+#ifdef HAVE_DEFAULT_ISR
+  else
+    {
+      /* Keep the interrupt from firing again until the bottom half has
+       * run.
+       */
+
+      up_disable_irq(irq);
+    }
+#endif
+
+  /* Wake the bottom half unless that has already been done */
+
+  if (!entry->pending)
+    {
+      entry->pending = true;
+#ifdef CONFIG_IRQ_STATISTICS
+      entry->wakeup  = irq_now();
+#endif
+      sem_post(&entry->sem);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: irq_attach_thread
+ *
+ * Description:
+ *   Attach a threaded interrupt handler to IRQ number 'irq'.  See
+ *   include/nuttx/irq.h.
+ *
+ ****************************************************************************/
+
+int irq_attach_thread(int irq, xcpt_t isr, irqthread_t handler,
+                      FAR void *arg, int priority, int stacksize)
+{
+  FAR struct irq_thread_s *entry = NULL;
+  int ret;
+  int i;
+
+  if ((unsigned)irq >= NR_IRQS || !handler ||
+      priority < SCHED_PRIORITY_MIN || priority > SCHED_PRIORITY_MAX)
+    {
+      return -EINVAL;
+    }
+
+#ifndef HAVE_DEFAULT_ISR
+  if (!isr)
+    {
+      return -EINVAL;
+    }
+#endif
+
+  /* Find a free entry.  The scheduler is locked so that no other thread can
+   * take it or attach to the same IRQ.
+   */
+
+  sched_lock();
+  if (irq_thread_find(irq))
+    {
+      ret = -EBUSY;
+      goto errout;
+    }
+
+  for (i = 0; i < CONFIG_IRQ_NTHREADS && !entry; i++)
+    {
+      if (!g_irqthread[i].inuse)
+        {
+          entry = &g_irqthread[i];
+        }
+    }
+
+  if (!entry)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  memset(entry, 0, sizeof(struct irq_thread_s));
+  entry->irq       = irq;
+  entry->priority  = priority;
+  entry->stacksize = stacksize > 0 ? stacksize : CONFIG_IRQ_THREAD_STACKSIZE;
+  entry->isr       = isr;
+  entry->handler   = handler;
+  entry->arg       = arg;
+  sem_init(&entry->sem, 0, 0);
+  entry->inuse     = true;
+
+  /* Start the bottom half now unless the OS is still being initialized */
+
+  if (g_irqthread_started)
+    {
+      ret = irq_thread_create(entry);
+      if (ret < 0)
+        {
+          sem_destroy(&entry->sem);
+          entry->inuse = false;
+          goto errout;
+        }
+    }
+
+  /* Then route the interrupt to the top half */
+
+  ret = irq_attach(irq, irq_thread_dispatch);
+
+errout:
+  sched_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: irq_thread_detach
+ *
+ * Description:
+ *   Called by irq_attach() when another handler (or none) is attached to an
+ *   IRQ.  If the IRQ had a threaded handler, then its thread is told to
+ *   exit.  The entry is freed when it does.  Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void irq_thread_detach(int irq)
+{
+  FAR struct irq_thread_s *entry = irq_thread_find(irq);
+
+  if (entry)
+    {
+      entry->handler = NULL;
+      if (entry->pid > 0)
+        {
+          sem_post(&entry->sem);
+        }
+      else
+        {
+          /* The thread was never started */
+
+          sem_destroy(&entry->sem);
+          entry->inuse = false;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: irq_thread_start
+ *
+ * Description:
+ *   Called by os_bringup() to start the bottom half threads of the handlers
+ *   that were attached while the OS was being initialized.
+ *
+ ****************************************************************************/
+
+void irq_thread_start(void)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_IRQ_NTHREADS; i++)
+    {
+      if (g_irqthread[i].inuse && g_irqthread[i].handler &&
+          g_irqthread[i].pid == 0)
+        {
+          (void)irq_thread_create(&g_irqthread[i]);
+        }
+    }
+
+  g_irqthread_started = true;
+}
+
+/****************************************************************************
+ * Name: irq_thread_info
+ *
+ * Description:
+ *   Add the statistics of the threaded handler of an IRQ (if any) to the
+ *   information returned by irq_info().
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IRQ_STATISTICS
+void irq_thread_info(int irq, FAR struct irq_info_s *info)
+{
+  FAR struct irq_thread_s *entry;
+  irqstate_t flags;
+
+  flags = irqsave();
+  entry = irq_thread_find(irq);
+  if (entry)
+    {
+      info->pid      = entry->pid;
+      info->priority = entry->priority;
+      info->nruns    = entry->nruns;
+      info->latsum   = entry->latsum;
+      info->latmax   = entry->latmax;
+      info->runmax   = entry->runmax;
+    }
+  else
+    {
+      info->pid      = 0;
+      info->priority = 0;
+      info->nruns    = 0;
+      info->latsum   = 0;
+      info->latmax   = 0;
+      info->runmax   = 0;
+    }
+
+  irqrestore(flags);
+}
+#endif
+
+#endif /* CONFIG_IRQ_THREADED */
@@ -44,6 +44,7 @@
 #include <nuttx/compiler.h>
 
 #include <sys/types.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <limits.h>
@@ -75,6 +76,26 @@
 
 #define NUM_INTERRUPT_MSGS   8
 
+/* The size of the message header and the size of a message in the pool of
+ * a zero-copy message queue (with n bytes of data, rounded up so that
+ * every message in the pool is aligned).
+ */
+
+#define SIZEOF_MQ_MSGHDR  offsetof(mqmsg_t, mail)
+#define SIZEOF_MQ_MSG(n) \
+  ((SIZEOF_MQ_MSGHDR + (n) + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1))
+
+/* A message queue is full when the maximum number of messages is queued.
+ * For a zero-copy message queue, messages that are loaned out also count.
+ */
+
+#ifdef CONFIG_MQ_ZEROCOPY
+#  define MQ_ISFULL(q) \
+  ((q)->msgpool ? sq_empty(&(q)->msgfree) : (q)->nmsgs >= (q)->maxmsgs)
+#else
+#  define MQ_ISFULL(q) ((q)->nmsgs >= (q)->maxmsgs)
+#endif
+
 /****************************************************************************
  * Global Type Declarations
  ****************************************************************************/
@@ -83,7 +104,8 @@ enum mqalloc_e
 {
   MQ_ALLOC_FIXED = 0,  /* pre-allocated; never freed */
   MQ_ALLOC_DYN,        /* dynamically allocated; free when unused */
-  MQ_ALLOC_IRQ         /* Preallocated, reserved for interrupt handling */
+  MQ_ALLOC_IRQ,        /* Preallocated, reserved for interrupt handling */
+  MQ_ALLOC_QUEUE       /* Part of the pool of a zero-copy message queue */
 };
 
 typedef enum mqalloc_e mqalloc_t;
@@ -163,15 +185,24 @@ void mq_waitirq(FAR struct tcb_s *wtcb, int errcode);
 int mq_verifyreceive(mqd_t mqdes, void *msg, size_t msglen);
 FAR mqmsg_t *mq_waitreceive(mqd_t mqdes);
 ssize_t mq_doreceive(mqd_t mqdes, mqmsg_t *mqmsg, void *ubuffer, int *prio);
+void mq_notfull(FAR msgq_t *msgq);
 
 /* mq_sndinternal.c ********************************************************/
 
 int mq_verifysend(mqd_t mqdes, const void *msg, size_t msglen, int prio);
-FAR mqmsg_t *mq_msgalloc(void);
+FAR mqmsg_t *mq_msgalloc(FAR msgq_t *msgq);
 int mq_waitsend(mqd_t mqdes);
 int mq_dosend(mqd_t mqdes, FAR mqmsg_t *mqmsg, const void *msg,
               size_t msglen, int prio);
 
+/* mq_msgpool.c ************************************************************/
+
+#ifdef CONFIG_MQ_ZEROCOPY
+int mq_poolcreate(FAR msgq_t *msgq);
+FAR mqmsg_t *mq_poolmsg(FAR msgq_t *msgq, FAR void *buf);
+void mq_poolfree(FAR msgq_t *msgq, FAR mqmsg_t *mqmsg);
+#endif
+
 /* mq_release.c ************************************************************/
 
 struct task_group_s; /* Forward reference */
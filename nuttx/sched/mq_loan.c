@@ -0,0 +1,219 @@
+/****************************************************************************
+ * sched/mq_loan.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <errno.h>
+#include <sched.h>
+
+#include <nuttx/arch.h>
+
+#include "os_internal.h"
+#include "mq_internal.h"
+
+#ifdef CONFIG_MQ_ZEROCOPY
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/****************************************************************************
+ * Global Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_loan
+ *
+ * Description:
+ *   Borrow an empty message buffer from the pool of a zero-copy message
+ *   queue (one created with the MQ_ZEROCOPY flag).  The caller fills in
+ *   the buffer, then queues it with mq_sendloan() or gives it back with
+ *   mq_return().  The buffer can hold the mq_msgsize attribute of the
+ *   message queue.
+ *
+ *   Loaned buffers count against the mq_maxmsg attribute of the message
+ *   queue.  If all of the buffers are queued or loaned out and O_NONBLOCK
+ *   is not set in the message queue, then mq_loan() will block until one
+ *   is returned.  All loaned buffers must be given back before the message
+ *   queue is closed.
+ *
+ * Parameters:
+ *   mqdes - Message queue descriptor
+ *
+ * Return Value:
+ *   The message buffer.  On failure, NULL is returned and the errno is set
+ *   appropriately:
+ *
+ *   EINVAL   mqdes is invalid or is not a zero-copy message queue.
+ *   EPERM    Message queue opened not opened for writing.
+ *   EAGAIN   No buffer is available and O_NONBLOCK is set (or mq_loan()
+ *            was called from an interrupt handler).
+ *   EINTR    The call was interrupted by a signal handler.
+ *
+ * Assumptions/restrictions:
+ *
+ ****************************************************************************/
+
+FAR void *mq_loan(mqd_t mqdes)
+{
+  FAR msgq_t  *msgq;
+  FAR mqmsg_t *mqmsg = NULL;
+  irqstate_t   saved_state;
+
+  if (!mqdes || !mqdes->msgq->msgpool)
+    {
+      set_errno(EINVAL);
+      return NULL;
+    }
+
+  if ((mqdes->oflags & O_WROK) == 0)
+    {
+      set_errno(EPERM);
+      return NULL;
+    }
+
+  /* Take a buffer from the pool if one is available */
+
+  msgq = mqdes->msgq;
+
+  saved_state = irqsave();
+  mqmsg = (FAR mqmsg_t*)sq_remfirst(&msgq->msgfree);
+  irqrestore(saved_state);
+
+  if (!mqmsg)
+    {
+      /* No.. wait for one.  This is the same logic that mq_send() uses to
+       * allocate a message.
+       */
+
+      sched_lock();
+      saved_state = irqsave();
+      if (up_interrupt_context())
+        {
+          set_errno(EAGAIN);
+        }
+      else if (mq_waitsend(mqdes) == OK)
+        {
+          mqmsg = (FAR mqmsg_t*)sq_remfirst(&msgq->msgfree);
+        }
+
+      irqrestore(saved_state);
+      sched_unlock();
+    }
+
+  return mqmsg ? (FAR void *)mqmsg->mail : NULL;
+}
+
+/****************************************************************************
+ * Name: mq_return
+ *
+ * Description:
+ *   Give a message buffer back to the pool of its zero-copy message queue.
+ *   The buffer may have been obtained with mq_receiveloan() (the message
+ *   has been consumed) or with mq_loan() (the buffer was not sent after
+ *   all).  If a task is waiting for the message queue to become not full,
+ *   it is awakened.
+ *
+ * Parameters:
+ *   mqdes - Message queue descriptor
+ *   buf   - The message buffer
+ *
+ * Return Value:
+ *   On success, 0 (OK) is returned.  On failure, -1 (ERROR) is returned
+ *   and the errno is set to EINVAL:  mqdes is invalid or buf is not a
+ *   message buffer of the message queue.
+ *
+ * Assumptions/restrictions:
+ *
+ ****************************************************************************/
+
+int mq_return(mqd_t mqdes, FAR void *buf)
+{
+  FAR msgq_t  *msgq;
+  FAR mqmsg_t *mqmsg;
+
+  if (!mqdes)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  msgq  = mqdes->msgq;
+  mqmsg = mq_poolmsg(msgq, buf);
+  if (!mqmsg)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  mq_poolfree(msgq, mqmsg);
+
+  /* Wake up a task that is waiting for a buffer (if there is one) */
+
+  if (msgq->nwaitnotfull > 0)
+    {
+      sched_lock();
+      mq_notfull(msgq);
+      sched_unlock();
+    }
+
+  return OK;
+}
+
+#endif /* CONFIG_MQ_ZEROCOPY */
@@ -0,0 +1,197 @@
+/****************************************************************************
+ * sched/mq_msgpool.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <queue.h>
+#include <assert.h>
+
+#include <nuttx/kmalloc.h>
+#include <arch/irq.h>
+
+#include "os_internal.h"
+#include "mq_internal.h"
+
+#ifdef CONFIG_MQ_ZEROCOPY
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/****************************************************************************
+ * Global Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_poolcreate
+ *
+ * Description:
+ *   Allocate the pool of messages of a zero-copy message queue.  The pool
+ *   holds maxmsgs messages, each with room for maxmsgsize bytes of data.
+ *   Messages sent to the queue are taken only from this pool.
+ *
+ * Parameters:
+ *   msgq - The new message queue (maxmsgs and maxmsgsize must be set)
+ *
+ * Return Value:
+ *   OK on success; ERROR if the pool could not be allocated.
+ *
+ ****************************************************************************/
+
+int mq_poolcreate(FAR msgq_t *msgq)
+{
+  FAR uint8_t *pool;
+  FAR mqmsg_t *mqmsg;
+  int msgsize;
+  int i;
+
+  if (msgq->maxmsgs <= 0)
+    {
+      return ERROR;
+    }
+
+  msgsize = SIZEOF_MQ_MSG(msgq->maxmsgsize);
+  pool    = (FAR uint8_t*)kmalloc(msgq->maxmsgs * msgsize);
+  if (!pool)
+    {
+      return ERROR;
+    }
+
+  sq_init(&msgq->msgfree);
+  for (i = 0; i < msgq->maxmsgs; i++)
+    {
+      mqmsg       = (FAR mqmsg_t*)&pool[i * msgsize];
+      mqmsg->type = MQ_ALLOC_QUEUE;
+      sq_addlast((FAR sq_entry_t*)mqmsg, &msgq->msgfree);
+    }
+
+  msgq->msgpool = pool;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mq_poolmsg
+ *
+ * Description:
+ *   Convert a message buffer that was loaned out by mq_loan() or
+ *   mq_receiveloan() back to its message structure.
+ *
+ * Parameters:
+ *   msgq - The message queue
+ *   buf  - The message buffer
+ *
+ * Return Value:
+ *   The message structure or NULL if buf is not a message buffer in the
+ *   pool of the message queue.
+ *
+ ****************************************************************************/
+
+FAR mqmsg_t *mq_poolmsg(FAR msgq_t *msgq, FAR void *buf)
+{
+  FAR mqmsg_t *mqmsg;
+  uintptr_t offset;
+  int msgsize;
+
+  if (msgq->msgpool && buf)
+    {
+      msgsize = SIZEOF_MQ_MSG(msgq->maxmsgsize);
+      offset  = (uintptr_t)buf - (uintptr_t)msgq->msgpool - SIZEOF_MQ_MSGHDR;
+
+      /* Checking that the buffer is at a message boundary would take a
+       * division, so that is done only if debug is enabled.
+       */
+
+      if (offset < (uintptr_t)(msgq->maxmsgs * msgsize))
+        {
+          mqmsg = (FAR mqmsg_t*)((FAR uint8_t*)msgq->msgpool + offset);
+          DEBUGASSERT(offset % msgsize == 0 && mqmsg->type == MQ_ALLOC_QUEUE);
+          return mqmsg;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: mq_poolfree
+ *
+ * Description:
+ *   Return a message to the pool of its zero-copy message queue.  The
+ *   message is put at the head of the free list so that the next message
+ *   sent reuses the buffer that is most likely to be in the cache.
+ *
+ * Parameters:
+ *   msgq  - The message queue
+ *   mqmsg - The message to free
+ *
+ * Return Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mq_poolfree(FAR msgq_t *msgq, FAR mqmsg_t *mqmsg)
+{
+  irqstate_t saved_state;
+
+  /* Messages may be allocated by interrupt handlers */
+
+  saved_state = irqsave();
+  sq_addfirst((FAR sq_entry_t*)mqmsg, &msgq->msgfree);
+  irqrestore(saved_state);
+}
+
+#endif /* CONFIG_MQ_ZEROCOPY */
@@ -90,16 +90,27 @@ void mq_msgqfree(FAR msgq_t *msgq)
   FAR mqmsg_t *curr;
   FAR mqmsg_t *next;
 
-  /* Deallocate any stranded messages in the message queue. */
+#ifdef CONFIG_MQ_ZEROCOPY
+  /* All of the messages of a zero-copy queue are in its own pool */
 
-  curr = (FAR mqmsg_t*)msgq->msglist.head;
-  while (curr)
+  if (msgq->msgpool)
     {
-      /* Deallocate the message structure. */
+      sched_kfree(msgq->msgpool);
+    }
+  else
+#endif
+    {
+      /* Deallocate any stranded messages in the message queue. */
+
+      curr = (FAR mqmsg_t*)msgq->msglist.head;
+      while (curr)
+        {
+          /* Deallocate the message structure. */
 
-      next = curr->next;
-      mq_msgfree(curr);
-      curr = next;
+          next = curr->next;
+          mq_msgfree(curr);
+          curr = next;
+        }
     }
 
   /* Then deallocate the message queue itself */
@@ -99,6 +99,9 @@
  *        is used at the time that the message queue is
  *        created to determine the maximum number of
  *        messages that may be placed in the message queue.
+ *        If CONFIG_MQ_ZEROCOPY is selected, the non-standard
+ *        MQ_ZEROCOPY flag in mq_flags gives the new queue
+ *        its own pool of mq_maxmsg messages.
  *
  * Return Value:
  *   A message queue descriptor or -1 (ERROR)
@@ -151,6 +154,15 @@ mqd_t mq_open(const char *mq_name, int oflags, ...)
 
           else if ((oflags & O_CREAT) != 0)
             {
+              /* Set up to get the optional arguments needed to create
+               * a message queue.
+               */
+
+              va_start(arg, oflags);
+              (void)va_arg(arg, mode_t); /* MQ creation mode parameter (ignored) */
+              attr = va_arg(arg, struct mq_attr*);
+              va_end(arg);
+
               /* Allocate memory for the new message queue.  The size to
                * allocate is the size of the msgq_t header plus the size
                * of the message queue name+1.
@@ -159,63 +171,66 @@ mqd_t mq_open(const char *mq_name, int oflags, ...)
               msgq = (FAR msgq_t*)kzalloc(SIZEOF_MQ_HEADER + namelen + 1);
               if (msgq)
                 {
-                  /* Create a message queue descriptor for the TCB */
+                  /* Initialize the new named message queue */
 
-                  mqdes = mq_descreate(rtcb, msgq, oflags);
-                  if (mqdes)
+                  sq_init(&msgq->msglist);
+                  if (attr)
                     {
-                      /* Set up to get the optional arguments needed to create
-                       * a message queue.
-                       */
-
-                      va_start(arg, oflags);
-                      (void)va_arg(arg, mode_t); /* MQ creation mode parameter (ignored) */
-                      attr = va_arg(arg, struct mq_attr*);
-
-                      /* Initialize the new named message queue */
-
-                      sq_init(&msgq->msglist);
-                      if (attr)
+                      msgq->maxmsgs = (int16_t)attr->mq_maxmsg;
+                      if (attr->mq_msgsize <= MQ_MAX_BYTES)
                         {
-                          msgq->maxmsgs = (int16_t)attr->mq_maxmsg;
-                          if (attr->mq_msgsize <= MQ_MAX_BYTES)
-                            {
-                              msgq->maxmsgsize = (int16_t)attr->mq_msgsize;
-                            }
-                          else
-                            {
-                              msgq->maxmsgsize = MQ_MAX_BYTES;
-                            }
+                          msgq->maxmsgsize = (int16_t)attr->mq_msgsize;
                         }
                       else
                         {
-                          msgq->maxmsgs = MQ_MAX_MSGS;
                           msgq->maxmsgsize = MQ_MAX_BYTES;
                         }
+                    }
+                  else
+                    {
+                      msgq->maxmsgs = MQ_MAX_MSGS;
+                      msgq->maxmsgsize = MQ_MAX_BYTES;
+                    }
 
-                      msgq->nconnect = 1;
+                  msgq->nconnect = 1;
 #ifndef CONFIG_DISABLE_SIGNALS
-                      msgq->ntpid    = INVALID_PROCESS_ID;
+                  msgq->ntpid    = INVALID_PROCESS_ID;
 #endif
-                      strcpy(msgq->name, mq_name);
+                  strcpy(msgq->name, mq_name);
 
+#ifdef CONFIG_MQ_ZEROCOPY
+                  /* Give the message queue its own pool of messages if
+                   * the zero-copy interfaces were requested.
+                   */
+
+                  if (attr && (attr->mq_flags & MQ_ZEROCOPY) != 0 &&
+                      mq_poolcreate(msgq) != OK)
+                    {
+                      set_errno(ENOMEM);
+                    }
+                  else
+#endif
+                    {
+                      /* Create a message queue descriptor for the TCB */
+
+                      mqdes = mq_descreate(rtcb, msgq, oflags);
+                    }
+
+                  if (mqdes)
+                    {
                       /* Add the new message queue to the list of
                        * message queues
                        */
 
                       sq_addlast((FAR sq_entry_t*)msgq, &g_msgqueues);
-
-                      /* Clean-up variable argument stuff */
-
-                      va_end(arg);
                     }
                   else
                     {
-                      /* Deallocate the msgq structure.  Since it is
-                       * uninitialized, mq_deallocate() is not used.
+                      /* Deallocate the msgq structure (and its pool of
+                       * messages, if any).
                        */
 
-                      sched_kfree(msgq);
+                      mq_msgqfree(msgq);
                     }
                 }
             }
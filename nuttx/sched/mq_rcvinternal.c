@@ -49,6 +49,7 @@
 #include <debug.h>
 
 #include <nuttx/arch.h>
+#include <nuttx/sched_trace.h>
 
 #include "os_internal.h"
 #include "mq_internal.h"
@@ -181,6 +182,8 @@ FAR mqmsg_t *mq_waitreceive(mqd_t mqdes)
           msgq->nwaitnotempty++;
 
           set_errno(OK);
+          sched_trace_event(SCHED_TRACE_MQBLOCK, rtcb,
+                            (uint32_t)(uintptr_t)msgq);
           up_block_task(rtcb, TSTATE_WAIT_MQNOTEMPTY);
 
           /* When we resume at this point, either (1) the message queue
@@ -247,9 +250,7 @@ FAR mqmsg_t *mq_waitreceive(mqd_t mqdes)
 
 ssize_t mq_doreceive(mqd_t mqdes, mqmsg_t *mqmsg, void *ubuffer, int *prio)
 {
-  FAR struct tcb_s *btcb;
-  irqstate_t saved_state;
-  FAR msgq_t *msgq;
+  FAR msgq_t *msgq = mqdes->msgq;
   ssize_t rcvmsglen;
 
   /* Get the length of the message (also the return value) */
@@ -269,11 +270,52 @@ ssize_t mq_doreceive(mqd_t mqdes, mqmsg_t *mqmsg, void *ubuffer, int *prio)
 
   /* We are done with the message.  Deallocate it now. */
 
-  mq_msgfree(mqmsg);
+#ifdef CONFIG_MQ_ZEROCOPY
+  if (mqmsg->type == MQ_ALLOC_QUEUE)
+    {
+      mq_poolfree(msgq, mqmsg);
+    }
+  else
+#endif
+    {
+      mq_msgfree(mqmsg);
+    }
 
   /* Check if any tasks are waiting for the MQ not full event. */
 
-  msgq = mqdes->msgq;
+  mq_notfull(msgq);
+
+  /* Return the length of the message transferred to the user buffer */
+
+  return rcvmsglen;
+}
+
+/****************************************************************************
+ * Name: mq_notfull
+ *
+ * Description:
+ *   This is internal, common logic shared by mq_doreceive() and mq_return().
+ *   A message has been removed from the message queue (or a message buffer
+ *   has been returned to the pool of a zero-copy queue).  Wake up the
+ *   highest priority task that is waiting for the queue to become not full,
+ *   if there is one.
+ *
+ * Parameters:
+ *   msgq - The message queue
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ * - Pre-emption should be disabled throughout this call.
+ *
+ ****************************************************************************/
+
+void mq_notfull(FAR msgq_t *msgq)
+{
+  FAR struct tcb_s *btcb;
+  irqstate_t saved_state;
+
   if (msgq->nwaitnotfull > 0)
     {
       /* Find the highest priority task that is waiting for
@@ -296,12 +338,9 @@ ssize_t mq_doreceive(mqd_t mqdes, mqmsg_t *mqmsg, void *ubuffer, int *prio)
 
        btcb->msgwaitq = NULL;
        msgq->nwaitnotfull--;
+       sched_trace_event(SCHED_TRACE_MQWAKE, btcb, (uint32_t)(uintptr_t)msgq);
        up_unblock_task(btcb);
 
       irqrestore(saved_state);
     }
-
-  /* Return the length of the message transferred to the user buffer */
-
-  return rcvmsglen;
 }
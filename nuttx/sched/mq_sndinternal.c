@@ -50,6 +50,7 @@
 
 #include  <nuttx/kmalloc.h>
 #include  <nuttx/arch.h>
+#include  <nuttx/sched_trace.h>
 
 #include  "os_internal.h"
 #ifndef CONFIG_DISABLE_SIGNALS
@@ -139,7 +140,7 @@ int mq_verifysend(mqd_t mqdes, const void *msg, size_t msglen, int prio)
  * Description:
  *   The mq_msgalloc function will get a free message for use by the
  *   operating system.  The message will be allocated from the g_msgfree
- *   list.
+ *   list (or from the queue's own pool if it is a zero-copy queue).
  *
  *   If the list is empty AND the message is NOT being allocated from the
  *   interrupt level, then the message will be allocated.  If a message
@@ -152,19 +153,32 @@ int mq_verifysend(mqd_t mqdes, const void *msg, size_t msglen, int prio)
  *   handler will be notified.
  *
  * Inputs:
- *   None
+ *   msgq - The message queue that the message will be sent to
  *
  * Return Value:
  *   A reference to the allocated msg structure.  On a failure to allocate,
- *   this function PANICs.
+ *   this function PANICs.  The pool of a zero-copy queue may be empty; in
+ *   that case NULL is returned.
  *
  ****************************************************************************/
 
-FAR mqmsg_t *mq_msgalloc(void)
+FAR mqmsg_t *mq_msgalloc(FAR msgq_t *msgq)
 {
   FAR mqmsg_t *mqmsg;
   irqstate_t   saved_state;
 
+#ifdef CONFIG_MQ_ZEROCOPY
+  /* A zero-copy queue uses only the messages in its own pool */
+
+  if (msgq->msgpool)
+    {
+      saved_state = irqsave();
+      mqmsg = (FAR mqmsg_t*)sq_remfirst(&msgq->msgfree);
+      irqrestore(saved_state);
+      return mqmsg;
+    }
+#endif
+
   /* If we were called from an interrupt handler, then try to get the message
    * from generally available list of messages. If this fails, then try the
    * list of messages reserved for interrupt handlers
@@ -248,7 +262,7 @@ int mq_waitsend(mqd_t mqdes)
 
   /* Verify that the queue is indeed full as the caller thinks */
 
-  if (msgq->nmsgs >= msgq->maxmsgs)
+  if (MQ_ISFULL(msgq))
     {
       /* Should we block until there is sufficient space in the
        * message queue?
@@ -272,7 +286,7 @@ int mq_waitsend(mqd_t mqdes)
            * receiving message queue
            */
 
-          while (msgq->nmsgs >= msgq->maxmsgs)
+          while (MQ_ISFULL(msgq))
             {
               /* Block until the message queue is no longer full.
                * When we are unblocked, we will try again
@@ -283,6 +297,8 @@ int mq_waitsend(mqd_t mqdes)
               msgq->nwaitnotfull++;
 
               set_errno(OK);
+              sched_trace_event(SCHED_TRACE_MQBLOCK, rtcb,
+                                (uint32_t)(uintptr_t)msgq);
               up_block_task(rtcb, TSTATE_WAIT_MQNOTFULL);
 
               /* When we resume at this point, either (1) the message queue
@@ -313,7 +329,8 @@ int mq_waitsend(mqd_t mqdes)
  * 
  * Parameters:
  *   mqdes - Message queue descriptor
- *   msg - Message to send
+ *   mqmsg - The message structure to send
+ *   msg - Message to send (NULL if the data is already in mqmsg)
  *   msglen - The length of the message in bytes
  *   prio - The priority of the message
  *
@@ -342,9 +359,12 @@ int mq_dosend(mqd_t mqdes, FAR mqmsg_t *mqmsg, const void *msg, size_t msglen, i
   mqmsg->priority = prio;
   mqmsg->msglen   = msglen;
 
-  /* Copy the message data into the message */
+  /* Copy the message data into the message (unless it was loaned) */
 
-  memcpy((void*)mqmsg->mail, (const void*)msg, msglen);
+  if (msg)
+    {
+      memcpy((void*)mqmsg->mail, (const void*)msg, msglen);
+    }
 
   /* Insert the new message in the message queue */
 
@@ -430,6 +450,7 @@ int mq_dosend(mqd_t mqdes, FAR mqmsg_t *mqmsg, const void *msg, size_t msglen, i
 
       btcb->msgwaitq = NULL;
       msgq->nwaitnotempty--;
+      sched_trace_event(SCHED_TRACE_MQWAKE, btcb, (uint32_t)(uintptr_t)msgq);
       up_unblock_task(btcb);
     }
 
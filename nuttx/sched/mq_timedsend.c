@@ -229,12 +229,12 @@ int mq_timedsend(mqd_t mqdes, const char *msg, size_t msglen, int prio,
   sched_lock();
   saved_state = irqsave();
   if (up_interrupt_context()      || /* In an interrupt handler */
-      msgq->nmsgs < msgq->maxmsgs)   /* OR Message queue not full */
+      !MQ_ISFULL(msgq))              /* OR Message queue not full */
     {
       /* Allocate the message */
 
       irqrestore(saved_state);
-      mqmsg = mq_msgalloc();
+      mqmsg = mq_msgalloc(msgq);
     }
   else
     {
@@ -296,7 +296,7 @@ int mq_timedsend(mqd_t mqdes, const char *msg, size_t msglen, int prio,
 
       if (ret == OK)
         {
-          mqmsg = mq_msgalloc();
+          mqmsg = mq_msgalloc(msgq);
         }
     }
 
@@ -44,6 +44,7 @@
 
 #include <nuttx/arch.h>
 #include <nuttx/mqueue.h>
+#include <nuttx/sched_trace.h>
 
 #include "os_internal.h"
 
@@ -136,6 +137,7 @@ void mq_waitirq(FAR struct tcb_s *wtcb, int errcode)
 
       /* Restart the task. */
 
+      sched_trace_event(SCHED_TRACE_MQWAKE, wtcb, (uint32_t)(uintptr_t)msgq);
       up_unblock_task(wtcb);
     }
 
@@ -53,6 +53,9 @@
 #include <nuttx/userspace.h>
 
 #include "os_internal.h"
+#ifdef CONFIG_IRQ_THREADED
+# include "irq_internal.h"
+#endif
 #ifdef CONFIG_PAGING
 # include "pg_internal.h"
 #endif
@@ -115,6 +118,9 @@
  *
  *   - pg_worker:   The page-fault worker thread (only if CONFIG_PAGING is
  *                  defined.
+ *   - irq_thread:  The threads of the threaded interrupt handlers attached
+ *                  during initialization (only if CONFIG_IRQ_THREADED is
+ *                  defined).
  *   - work_thread: The work thread.  This general thread can be used to
  *                  perform most any kind of queued work.  Its primary
  *                  function is to serve as the "bottom half" of device
@@ -130,6 +136,9 @@
 int os_bringup(void)
 {
   int taskid;
+#if defined(CONFIG_SCHED_LPWORK) && CONFIG_SCHED_LPNTHREADS > 1
+  int i;
+#endif
 
   /* Setup up the initial environment for the idle task.  At present, this
    * may consist of only the initial PATH variable.  The PATH variable is
@@ -156,6 +165,13 @@ int os_bringup(void)
   DEBUGASSERT(g_pgworker > 0);
 #endif
 
+  /* Start the "bottom half" threads of the threaded interrupt handlers */
+
+#ifdef CONFIG_IRQ_THREADED
+  svdbg("Starting threaded interrupt handlers\n");
+  irq_thread_start();
+#endif
+
   /* Start the worker thread that will serve as the device driver "bottom-
    * half" and will perform misc garbage clean-up.
    */
@@ -169,10 +185,10 @@ int os_bringup(void)
   svdbg("Starting kernel worker thread\n");
 #endif
 
-  g_work[HPWORK].pid = KERNEL_THREAD(HPWORKNAME, CONFIG_SCHED_WORKPRIORITY,
-                                     CONFIG_SCHED_WORKSTACKSIZE,
-                                     (main_t)work_hpthread, (FAR char * const *)NULL);
-  DEBUGASSERT(g_work[HPWORK].pid > 0);
+  g_work[HPWORK].pid[0] = KERNEL_THREAD(HPWORKNAME, CONFIG_SCHED_WORKPRIORITY,
+                                        CONFIG_SCHED_WORKSTACKSIZE,
+                                        (main_t)work_hpthread, (FAR char * const *)NULL);
+  DEBUGASSERT(g_work[HPWORK].pid[0] > 0);
 
   /* Start a lower priority worker thread for other, non-critical continuation
    * tasks
@@ -180,12 +196,36 @@ int os_bringup(void)
 
 #ifdef CONFIG_SCHED_LPWORK
 
+#if CONFIG_SCHED_LPNTHREADS > 1
+  svdbg("Starting %d low-priority kernel worker threads\n",
+        CONFIG_SCHED_LPNTHREADS);
+
+  /* All of the threads in the pool serve the same work queue.  Each is
+   * passed its index in the pool.
+   */
+
+  for (i = 0; i < CONFIG_SCHED_LPNTHREADS; i++)
+    {
+      char arg[4];
+      FAR char *argv[2];
+
+      (void)itoa(i, arg, 10);
+      argv[0] = arg;
+      argv[1] = NULL;
+
+      g_work[LPWORK].pid[i] = KERNEL_THREAD(LPWORKNAME, CONFIG_SCHED_LPWORKPRIORITY,
+                                            CONFIG_SCHED_LPWORKSTACKSIZE,
+                                            (main_t)work_lpthread, (FAR char * const *)argv);
+      DEBUGASSERT(g_work[LPWORK].pid[i] > 0);
+    }
+#else
   svdbg("Starting low-priority kernel worker thread\n");
 
-  g_work[LPWORK].pid = KERNEL_THREAD(LPWORKNAME, CONFIG_SCHED_LPWORKPRIORITY,
-                                     CONFIG_SCHED_LPWORKSTACKSIZE,
-                                     (main_t)work_lpthread, (FAR char * const *)NULL);
-  DEBUGASSERT(g_work[LPWORK].pid > 0);
+  g_work[LPWORK].pid[0] = KERNEL_THREAD(LPWORKNAME, CONFIG_SCHED_LPWORKPRIORITY,
+                                        CONFIG_SCHED_LPWORKSTACKSIZE,
+                                        (main_t)work_lpthread, (FAR char * const *)NULL);
+  DEBUGASSERT(g_work[LPWORK].pid[0] > 0);
+#endif
 
 #endif /* CONFIG_SCHED_LPWORK */
 #endif /* CONFIG_SCHED_HPWORK */
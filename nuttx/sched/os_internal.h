@@ -250,6 +250,10 @@ bool sched_addreadytorun(FAR struct tcb_s *rtrtcb);
 bool sched_removereadytorun(FAR struct tcb_s *rtrtcb);
 bool sched_addprioritized(FAR struct tcb_s *newTcb, DSEG dq_queue_t *list);
 bool sched_mergepending(void);
+#ifdef CONFIG_SCHED_RTRBITMAP
+bool sched_rtrinsert(FAR struct tcb_s *tcb);
+void sched_rtrremove(FAR struct tcb_s *tcb);
+#endif
 void sched_addblocked(FAR struct tcb_s *btcb, tstate_t task_state);
 void sched_removeblocked(FAR struct tcb_s *btcb);
 int  sched_setpriority(FAR struct tcb_s *tcb, int sched_priority);
@@ -260,7 +264,39 @@ int  sched_reprioritize(FAR struct tcb_s *tcb, int sched_priority);
 #endif
 FAR struct tcb_s *sched_gettcb(pid_t pid);
 bool sched_verifytcb(FAR struct tcb_s *tcb);
+#ifdef CONFIG_SCHED_TICKLESS
+int  sched_timer_elapsed(void);
+void sched_timer_reassess(void);
+#if CONFIG_RR_INTERVAL > 0
+void sched_timer_switch(FAR struct tcb_s *otcb);
+#endif
+#endif
+
+#if defined(CONFIG_SCHED_CPUACCT) && !defined(CONFIG_SCHED_TICKLESS)
+void sched_cpu_tick(void);
+#endif
+#if defined(CONFIG_SCHED_CPUACCT) && defined(CONFIG_SCHED_TICKLESS)
+void sched_cpu_switch(FAR struct tcb_s *from);
+void sched_cpu_irqenter(void);
+void sched_cpu_irqleave(void);
+#else
+#  define sched_cpu_switch(f)
+#  define sched_cpu_irqenter()
+#  define sched_cpu_irqleave()
+#endif
 
 int  sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype);
 
+#ifdef CONFIG_SCHED_TCBCACHE
+FAR void *sched_cachealloc(int cache);
+void sched_cachefree(int cache, FAR void *mem);
+#ifndef CONFIG_CUSTOM_STACK
+int  sched_createstack(FAR struct tcb_s *tcb, size_t stack_size, uint8_t ttype);
+void sched_releasestack(FAR struct tcb_s *tcb, uint8_t ttype);
+#endif
+#else
+#  define sched_createstack(t,s,y) up_create_stack(t,s,y)
+#  define sched_releasestack(t,y)  up_release_stack(t,y)
+#endif
+
 #endif /* __SCHED_OS_INTERNAL_H */
@@ -247,7 +247,11 @@ int pthread_create(FAR pthread_t *thread, FAR pthread_attr_t *attr,
 
   /* Allocate a TCB for the new task. */
 
+#ifdef CONFIG_SCHED_TCBCACHE
+  ptcb = (FAR struct pthread_tcb_s *)sched_cachealloc(SCHED_CACHE_PTHREAD);
+#else
   ptcb = (FAR struct pthread_tcb_s *)kzalloc(sizeof(struct pthread_tcb_s));
+#endif
   if (!ptcb)
     {
       sdbg("ERROR: Failed to allocate TCB\n");
@@ -294,8 +298,8 @@ int pthread_create(FAR pthread_t *thread, FAR pthread_attr_t *attr,
 
   /* Allocate the stack for the TCB */
 
-  ret = up_create_stack((FAR struct tcb_s *)ptcb, attr->stacksize,
-                        TCB_FLAG_TTYPE_PTHREAD);
+  ret = sched_createstack((FAR struct tcb_s *)ptcb, attr->stacksize,
+                          TCB_FLAG_TTYPE_PTHREAD);
   if (ret != OK)
     {
       errcode = ENOMEM;
@@ -46,6 +46,7 @@
 #include <debug.h>
 
 #include "pthread_internal.h"
+#include "sem_internal.h"
 
 /****************************************************************************
  * Definitions
@@ -127,6 +128,21 @@ int pthread_mutex_lock(FAR pthread_mutex_t *mutex)
     {
       ret = EINVAL;
     }
+
+#ifdef CONFIG_SEM_FASTPATH
+  /* If the mutex is not locked, take it with one atomic operation.  If it
+   * is locked (possibly by this thread) use the logic below.
+   */
+
+  else if (sem_fastwait((sem_t*)&mutex->sem))
+    {
+      mutex->pid    = mypid;
+#ifdef CONFIG_MUTEX_TYPES
+      mutex->nlocks = 1;
+#endif
+    }
+#endif
+
   else
     {
       /* Make sure the semaphore is stable while we make the following
@@ -47,6 +47,7 @@
 #include <debug.h>
 
 #include "pthread_internal.h"
+#include "sem_internal.h"
 
 /****************************************************************************
  * Definitions
@@ -106,6 +107,19 @@ int pthread_mutex_trylock(FAR pthread_mutex_t *mutex)
     {
       ret = EINVAL;
     }
+
+#ifdef CONFIG_SEM_FASTPATH
+  /* sem_fastwait() fails only if no count is available */
+
+  else if (sem_fastwait((sem_t*)&mutex->sem))
+    {
+      mutex->pid = (int)getpid();
+    }
+  else
+    {
+      ret = EBUSY;
+    }
+#else
   else
     {
       /* Make sure the semaphore is stable while we make the following
@@ -138,6 +152,7 @@ int pthread_mutex_trylock(FAR pthread_mutex_t *mutex)
 
       sched_unlock();
     }
+#endif
 
   sdbg("Returning %d\n", ret);
   return ret;
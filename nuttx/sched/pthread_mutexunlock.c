@@ -46,6 +46,7 @@
 #include <debug.h>
 
 #include "pthread_internal.h"
+#include "sem_internal.h"
 
 /****************************************************************************
  * Definitions
@@ -108,6 +109,32 @@ int pthread_mutex_unlock(FAR pthread_mutex_t *mutex)
     {
       ret = EINVAL;
     }
+
+#ifdef CONFIG_SEM_FASTPATH
+  /* If the caller holds the only lock on the mutex, release it without
+   * locking the scheduler.  Only the owner modifies mutex->pid while the
+   * mutex is locked so the check is stable.  The pid must be nullified
+   * before the count is posted.  The semaphore is posted the normal way
+   * only if some thread is waiting for it.
+   */
+
+  else if (mutex->pid == (int)getpid()
+#ifdef CONFIG_MUTEX_TYPES
+           && (mutex->type != PTHREAD_MUTEX_RECURSIVE || mutex->nlocks <= 1)
+#endif
+          )
+    {
+      mutex->pid    = 0;
+#ifdef CONFIG_MUTEX_TYPES
+      mutex->nlocks = 0;
+#endif
+      if (!sem_fastpost((sem_t*)&mutex->sem))
+        {
+          ret = pthread_givesemaphore((sem_t*)&mutex->sem);
+        }
+    }
+#endif
+
   else
     {
       /* Make sure the semaphore is stable while we make the following
@@ -43,6 +43,8 @@
 #include <queue.h>
 #include <assert.h>
 
+#include <nuttx/sched_trace.h>
+
 #include "os_internal.h"
 
 /****************************************************************************
@@ -121,11 +123,17 @@ bool sched_addreadytorun(FAR struct tcb_s *btcb)
 
   /* Otherwise, add the new task to the g_readytorun task list */
 
+#ifdef CONFIG_SCHED_RTRBITMAP
+  else if (sched_rtrinsert(btcb))
+#else
   else if (sched_addprioritized(btcb, (FAR dq_queue_t*)&g_readytorun))
+#endif
     {
       /* Inform the instrumentation logic that we are switching tasks */
 
       sched_note_switch(rtcb, btcb);
+      sched_cpu_switch(rtcb);
+      sched_trace_event(SCHED_TRACE_SWITCH, btcb, rtcb->pid);
 
       /* The new btcb was added at the head of the g_readytorun list.  It
        * is now to new active task!
@@ -136,6 +144,14 @@ bool sched_addreadytorun(FAR struct tcb_s *btcb)
       btcb->task_state = TSTATE_TASK_RUNNING;
       btcb->flink->task_state = TSTATE_TASK_READYTORUN;
       ret = true;
+
+#if defined(CONFIG_SCHED_TICKLESS) && CONFIG_RR_INTERVAL > 0
+      /* Charge the time that rtcb ran against its timeslice and start
+       * timing the timeslice of btcb.
+       */
+
+      sched_timer_switch(rtcb);
+#endif
     }
   else
     {
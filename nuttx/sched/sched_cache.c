@@ -0,0 +1,435 @@
+/****************************************************************************
+ * sched/sched_cache.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <queue.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/sched.h>
+
+#include "os_internal.h"
+
+#ifdef CONFIG_SCHED_TCBCACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_SCHED_TCBCACHE_NTCBS
+#  define CONFIG_SCHED_TCBCACHE_NTCBS 4
+#endif
+
+#ifndef CONFIG_SCHED_TCBCACHE_NSTACKS
+#  define CONFIG_SCHED_TCBCACHE_NSTACKS 4
+#endif
+
+#ifndef CONFIG_SCHED_TCBCACHE_MAXSTACK
+#  define CONFIG_SCHED_TCBCACHE_MAXSTACK 4096
+#endif
+
+/* Stacks of kernel threads come from the kernel heap in the kernel build
+ * and are not cached.
+ */
+
+#if defined(CONFIG_NUTTX_KERNEL) && defined(CONFIG_MM_KERNEL_HEAP)
+#  define STACK_CACHEABLE(t) ((t) != TCB_FLAG_TTYPE_KERNEL)
+#else
+#  define STACK_CACHEABLE(t) true
+#endif
+
+/* A cached stack may be up to STACK_SLACK bytes smaller than the requested
+ * size, because up_create_stack() may also lose that much to alignment.  It
+ * may be at most 25% larger, so that small stacks do not take up the large
+ * ones.
+ */
+
+#define STACK_SLACK         8
+#define STACK_MAXWASTE(s)   ((s) >> 2)
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/* One cache.  Cached memory is linked into the list through its first
+ * word.
+ */
+
+struct sched_cache_s
+{
+  sq_queue_t list;
+  struct sched_cachestats_s stats;
+};
+
+/* The header that is kept at the bottom of each cached stack */
+
+struct stack_entry_s
+{
+  FAR struct stack_entry_s *flink;       /* Must be first (see sq_entry_t) */
+  size_t size;                           /* Usable size of the stack */
+};
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+static struct sched_cache_s g_sched_cache[SCHED_NCACHES];
+
+/* The size of the objects in each cache (except the stack cache) */
+
+static const uint16_t g_sched_cachesize[SCHED_CACHE_STACK] =
+{
+  sizeof(struct task_tcb_s),
+#ifndef CONFIG_DISABLE_PTHREAD
+  sizeof(struct pthread_tcb_s),
+#else
+  0,
+#endif
+#ifdef HAVE_TASK_GROUP
+  sizeof(struct task_group_s)
+#else
+  0
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_flushstacks
+ *
+ * Description:
+ *   Return all cached stacks to the heap.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_CUSTOM_STACK
+static bool sched_flushstacks(void)
+{
+  FAR struct sched_cache_s *cache = &g_sched_cache[SCHED_CACHE_STACK];
+  FAR sq_entry_t *entry;
+  irqstate_t flags;
+  bool flushed = false;
+
+  for (;;)
+    {
+      flags = irqsave();
+      entry = sq_remfirst(&cache->list);
+      if (entry)
+        {
+          cache->stats.ncached--;
+        }
+
+      irqrestore(flags);
+
+      if (!entry)
+        {
+          return flushed;
+        }
+
+      sched_ufree(entry);
+      flushed = true;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_cachealloc
+ *
+ * Description:
+ *   Allocate a zeroed TCB or task group, re-using the memory of one that was
+ *   released earlier if possible.  This replaces kzalloc().
+ *
+ * Input Parameters:
+ *   cache - SCHED_CACHE_TASK, SCHED_CACHE_PTHREAD or SCHED_CACHE_GROUP
+ *
+ * Returned Value:
+ *   The allocated memory or NULL if the heap is exhausted.
+ *
+ ****************************************************************************/
+
+FAR void *sched_cachealloc(int cache)
+{
+  FAR struct sched_cache_s *cp = &g_sched_cache[cache];
+  FAR void *mem;
+  irqstate_t flags;
+
+  DEBUGASSERT(cache >= 0 && cache < SCHED_CACHE_STACK);
+
+  flags = irqsave();
+  mem = sq_remfirst(&cp->list);
+  if (mem)
+    {
+      cp->stats.ncached--;
+      cp->stats.hits++;
+    }
+  else
+    {
+      cp->stats.misses++;
+    }
+
+  irqrestore(flags);
+
+  if (mem)
+    {
+      memset(mem, 0, g_sched_cachesize[cache]);
+      return mem;
+    }
+
+  return kzalloc(g_sched_cachesize[cache]);
+}
+
+/****************************************************************************
+ * Name: sched_cachefree
+ *
+ * Description:
+ *   Release a TCB or task group allocated with sched_cachealloc() (or with
+ *   kzalloc()).  The memory is kept for re-use unless the cache is full.
+ *   This replaces sched_kfree() and, like it, may be called with interrupts
+ *   disabled.
+ *
+ * Input Parameters:
+ *   cache - SCHED_CACHE_TASK, SCHED_CACHE_PTHREAD or SCHED_CACHE_GROUP
+ *   mem   - The memory to release
+ *
+ ****************************************************************************/
+
+void sched_cachefree(int cache, FAR void *mem)
+{
+  FAR struct sched_cache_s *cp = &g_sched_cache[cache];
+  irqstate_t flags;
+
+  DEBUGASSERT(cache >= 0 && cache < SCHED_CACHE_STACK && mem);
+
+  flags = irqsave();
+  if (cp->stats.ncached < CONFIG_SCHED_TCBCACHE_NTCBS)
+    {
+      sq_addfirst((FAR sq_entry_t *)mem, &cp->list);
+      cp->stats.ncached++;
+      irqrestore(flags);
+      return;
+    }
+
+  cp->stats.discards++;
+  irqrestore(flags);
+
+  sched_kfree(mem);
+}
+
+/****************************************************************************
+ * Name: sched_createstack
+ *
+ * Description:
+ *   Allocate a stack for a new task or thread.  A cached stack of about
+ *   the right size is used if there is one; otherwise this is the same as
+ *   up_create_stack().
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_CUSTOM_STACK
+int sched_createstack(FAR struct tcb_s *tcb, size_t stack_size, uint8_t ttype)
+{
+  FAR struct sched_cache_s *cache = &g_sched_cache[SCHED_CACHE_STACK];
+  FAR struct stack_entry_s *best = NULL;
+  FAR struct stack_entry_s *bestprev = NULL;
+  FAR struct stack_entry_s *prev;
+  FAR struct stack_entry_s *curr;
+  irqstate_t flags;
+  int ret;
+
+  if (STACK_CACHEABLE(ttype) && stack_size <= CONFIG_SCHED_TCBCACHE_MAXSTACK)
+    {
+      /* Look for the smallest cached stack that is big enough */
+
+      flags = irqsave();
+      for (prev = NULL, curr = (FAR struct stack_entry_s *)cache->list.head;
+           curr;
+           prev = curr, curr = curr->flink)
+        {
+          if (curr->size + STACK_SLACK >= stack_size &&
+              curr->size <= stack_size + STACK_MAXWASTE(stack_size) &&
+              (!best || curr->size < best->size))
+            {
+              best     = curr;
+              bestprev = prev;
+            }
+        }
+
+      if (best)
+        {
+          if (bestprev)
+            {
+              (void)sq_remafter((FAR sq_entry_t *)bestprev, &cache->list);
+            }
+          else
+            {
+              (void)sq_remfirst(&cache->list);
+            }
+
+          cache->stats.ncached--;
+          cache->stats.hits++;
+        }
+      else
+        {
+          cache->stats.misses++;
+        }
+
+      irqrestore(flags);
+
+      /* up_use_stack() also re-colors the stack if CONFIG_STACK_COLORATION
+       * is enabled so the high water mark starts over for the new thread.
+       */
+
+      if (best)
+        {
+          return up_use_stack(tcb, best, best->size);
+        }
+    }
+
+  /* Allocate a new stack.  If the heap is exhausted, retry after giving the
+   * cached stacks back to the heap.
+   */
+
+  ret = up_create_stack(tcb, stack_size, ttype);
+  if (ret < 0 && sched_flushstacks())
+    {
+      ret = up_create_stack(tcb, stack_size, ttype);
+    }
+
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: sched_releasestack
+ *
+ * Description:
+ *   Release the stack of a task or thread.  The stack is kept for re-use
+ *   unless it is too large or the cache is full.  This may be called by the
+ *   exiting task itself, with interrupts disabled: The header of the cached
+ *   stack is written at the bottom of the stack, far from the part that is
+ *   still in use.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_CUSTOM_STACK
+void sched_releasestack(FAR struct tcb_s *tcb, uint8_t ttype)
+{
+  FAR struct sched_cache_s *cache = &g_sched_cache[SCHED_CACHE_STACK];
+  FAR struct stack_entry_s *entry;
+  irqstate_t flags;
+
+  if (tcb->stack_alloc_ptr && STACK_CACHEABLE(ttype) &&
+      tcb->adj_stack_size <= CONFIG_SCHED_TCBCACHE_MAXSTACK)
+    {
+      flags = irqsave();
+      if (cache->stats.ncached < CONFIG_SCHED_TCBCACHE_NSTACKS)
+        {
+          entry       = (FAR struct stack_entry_s *)tcb->stack_alloc_ptr;
+          entry->size = tcb->adj_stack_size;
+
+          sq_addfirst((FAR sq_entry_t *)entry, &cache->list);
+          cache->stats.ncached++;
+          irqrestore(flags);
+
+          tcb->stack_alloc_ptr = NULL;
+          tcb->adj_stack_size  = 0;
+          return;
+        }
+
+      cache->stats.discards++;
+      irqrestore(flags);
+    }
+
+  up_release_stack(tcb, ttype);
+}
+#endif
+
+/****************************************************************************
+ * Name: sched_cachestats
+ *
+ * Description:
+ *   Return the statistics of one cache and optionally reset the counts.
+ *
+ * Input Parameters:
+ *   cache - One of SCHED_CACHE_*
+ *   stats - The location to return the statistics (may be NULL)
+ *   reset - True: Clear the counts
+ *
+ ****************************************************************************/
+
+void sched_cachestats(int cache, FAR struct sched_cachestats_s *stats,
+                      bool reset)
+{
+  FAR struct sched_cache_s *cp;
+  irqstate_t flags;
+
+  DEBUGASSERT(cache >= 0 && cache < SCHED_NCACHES);
+  cp = &g_sched_cache[cache];
+
+  flags = irqsave();
+  if (stats)
+    {
+      *stats = cp->stats;
+    }
+
+  if (reset)
+    {
+      cp->stats.hits     = 0;
+      cp->stats.misses   = 0;
+      cp->stats.discards = 0;
+    }
+
+  irqrestore(flags);
+}
+
+#endif /* CONFIG_SCHED_TCBCACHE */
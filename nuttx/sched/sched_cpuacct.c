@@ -0,0 +1,293 @@
+/****************************************************************************
+ * sched/sched_cpuacct.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <time.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/sched.h>
+
+#include "os_internal.h"
+
+#ifdef CONFIG_SCHED_CPUACCT
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+/* In the tickless mode, CPU time is measured with the free-running timer.
+ * g_cpulast is the time (in microseconds) of the last context switch or
+ * interrupt entry/exit; the time since then has not yet been charged to
+ * anyone.  g_cpuirqdepth is the interrupt nesting level and g_cpuirqticks
+ * and g_cpuirqusec hold the total time spent in interrupt handlers.
+ */
+
+static uint32_t g_cpulast;
+static uint32_t g_cpuirqticks;
+static uint32_t g_cpuirqusec;
+static uint8_t  g_cpuirqdepth;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: cpu_now
+ *
+ * Description:
+ *   Return the value of the free-running timer in microseconds.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+static inline uint32_t cpu_now(void)
+{
+  struct timespec ts;
+
+  (void)up_timer_gettime(&ts);
+  return (uint32_t)ts.tv_sec * USEC_PER_SEC + ts.tv_nsec / NSEC_PER_USEC;
+}
+#endif
+
+/****************************************************************************
+ * Name: cpu_charge
+ *
+ * Description:
+ *   Add an elapsed time in microseconds to a tick count and its sub-tick
+ *   remainder.  The elapsed time is normally less than one tick.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+static void cpu_charge(FAR uint32_t *ticks, FAR uint32_t *usec,
+                       uint32_t elapsed)
+{
+  elapsed += *usec;
+  if (elapsed >= USEC_PER_TICK)
+    {
+      *ticks += elapsed / USEC_PER_TICK;
+      elapsed = elapsed % USEC_PER_TICK;
+    }
+
+  *usec = elapsed;
+}
+#endif
+
+/****************************************************************************
+ * Name: cpu_totimespec
+ *
+ * Description:
+ *   Convert a tick count and a microsecond remainder to a timespec.
+ *
+ ****************************************************************************/
+
+static void cpu_totimespec(uint32_t ticks, uint32_t usec,
+                           FAR struct timespec *ts)
+{
+  ticks      += usec / USEC_PER_TICK;
+  usec        = usec % USEC_PER_TICK;
+
+  ts->tv_sec  = ticks / TICK_PER_SEC;
+  ts->tv_nsec = (ticks % TICK_PER_SEC) * NSEC_PER_TICK +
+                usec * NSEC_PER_USEC;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_cpu_tick
+ *
+ * Description:
+ *   Charge one system timer tick to the task that was running when the
+ *   tick occurred.  This is called from sched_process_timer() when the
+ *   periodic system timer is used.  This statistical sampling is cheap but
+ *   tasks that run for less than a tick at a time may not be seen at all.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_SCHED_TICKLESS
+void sched_cpu_tick(void)
+{
+  FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
+  rtcb->cputicks++;
+}
+#endif
+
+/****************************************************************************
+ * Name: sched_cpu_switch
+ *
+ * Description:
+ *   Charge the time since the last context switch to the task that is
+ *   being suspended.  This is called by the scheduler, with interrupts
+ *   disabled, whenever the task at the head of the g_readytorun list
+ *   changes.
+ *
+ * Input Parameters:
+ *   from - The TCB of the task that is being suspended
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+void sched_cpu_switch(FAR struct tcb_s *from)
+{
+  uint32_t now;
+
+  /* Inside an interrupt handler, the outgoing task was already charged when
+   * the interrupt was entered.  The time until the interrupt returns belongs
+   * to the interrupt.
+   */
+
+  if (g_cpuirqdepth == 0)
+    {
+      now = cpu_now();
+      cpu_charge(&from->cputicks, &from->cpuusec, now - g_cpulast);
+      g_cpulast = now;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: sched_cpu_irqenter and sched_cpu_irqleave
+ *
+ * Description:
+ *   Called from irq_dispatch() on the entry to and exit from each interrupt
+ *   handler.  The time up to the interrupt is charged to the interrupted
+ *   task; the time spent in the handler is charged to the interrupt time.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+void sched_cpu_irqenter(void)
+{
+  FAR struct tcb_s *rtcb;
+  uint32_t now;
+
+  if (g_cpuirqdepth++ == 0)
+    {
+      rtcb = (FAR struct tcb_s*)g_readytorun.head;
+      now  = cpu_now();
+      cpu_charge(&rtcb->cputicks, &rtcb->cpuusec, now - g_cpulast);
+      g_cpulast = now;
+    }
+}
+
+void sched_cpu_irqleave(void)
+{
+  uint32_t now;
+
+  DEBUGASSERT(g_cpuirqdepth > 0);
+  if (--g_cpuirqdepth == 0)
+    {
+      now = cpu_now();
+      cpu_charge(&g_cpuirqticks, &g_cpuirqusec, now - g_cpulast);
+      g_cpulast = now;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: sched_cputime
+ *
+ * Description:
+ *   Return the CPU time consumed by a task or thread.  For the task that is
+ *   currently running, this includes the time since it was last charged.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the task or thread.  If NULL, the time spent in
+ *         interrupt handlers is returned instead (always zero if the
+ *         periodic system timer is used).
+ *   ts  - The location to return the CPU time
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_cputime(FAR struct tcb_s *tcb, FAR struct timespec *ts)
+{
+  irqstate_t flags;
+  uint32_t ticks;
+  uint32_t usec;
+
+  DEBUGASSERT(ts);
+
+  flags = irqsave();
+#ifdef CONFIG_SCHED_TICKLESS
+  if (tcb == NULL)
+    {
+      ticks = g_cpuirqticks;
+      usec  = g_cpuirqusec;
+    }
+  else
+    {
+      ticks = tcb->cputicks;
+      usec  = tcb->cpuusec;
+
+      if (tcb == (FAR struct tcb_s*)g_readytorun.head && g_cpuirqdepth == 0)
+        {
+          usec += cpu_now() - g_cpulast;
+        }
+    }
+#else
+  ticks = tcb ? tcb->cputicks : 0;
+  usec  = 0;
+#endif
+  irqrestore(flags);
+
+  cpu_totimespec(ticks, usec, ts);
+}
+
+#endif /* CONFIG_SCHED_CPUACCT */
@@ -44,6 +44,8 @@
 #include <queue.h>
 #include <assert.h>
 
+#include <nuttx/sched_trace.h>
+
 #include "os_internal.h"
 
 /************************************************************************
@@ -97,9 +99,44 @@ bool sched_mergepending(void)
   FAR struct tcb_s *pndtcb;
   FAR struct tcb_s *pndnext;
   FAR struct tcb_s *rtrtcb;
+#ifndef CONFIG_SCHED_RTRBITMAP
   FAR struct tcb_s *rtrprev;
+#endif
+#if defined(CONFIG_SCHED_TICKLESS) && CONFIG_RR_INTERVAL > 0
+  FAR struct tcb_s *otcb = (FAR struct tcb_s*)g_readytorun.head;
+#endif
   bool ret = false;
 
+#ifdef CONFIG_SCHED_RTRBITMAP
+  /* Process every TCB in the g_pendingtasks list.  The location of each
+   * TCB in the g_readytorun list is found from the priority bitmap.
+   */
+
+  for (pndtcb = (FAR struct tcb_s*)g_pendingtasks.head; pndtcb; pndtcb = pndnext)
+    {
+      pndnext = pndtcb->flink;
+      rtrtcb  = (FAR struct tcb_s*)g_readytorun.head;
+
+      if (sched_rtrinsert(pndtcb))
+        {
+          /* pndtcb was inserted at the head of the list.  Inform the
+           * instrumentation layer that we are switching tasks.
+           */
+
+          sched_note_switch(rtrtcb, pndtcb);
+          sched_cpu_switch(rtrtcb);
+          sched_trace_event(SCHED_TRACE_SWITCH, pndtcb, rtrtcb->pid);
+
+          rtrtcb->task_state = TSTATE_TASK_READYTORUN;
+          pndtcb->task_state = TSTATE_TASK_RUNNING;
+          ret                = true;
+        }
+      else
+        {
+          pndtcb->task_state = TSTATE_TASK_READYTORUN;
+        }
+    }
+#else
   /* Initialize the inner search loop */
 
   rtrtcb = (FAR struct tcb_s*)g_readytorun.head;
@@ -136,6 +173,8 @@ bool sched_mergepending(void)
           /* Inform the instrumentation layer that we are switching tasks */
 
           sched_note_switch(rtrtcb, pndtcb);
+          sched_cpu_switch(rtrtcb);
+          sched_trace_event(SCHED_TRACE_SWITCH, pndtcb, rtrtcb->pid);
 
           /* Then insert at the head of the list */
 
@@ -162,11 +201,23 @@ bool sched_mergepending(void)
 
       rtrtcb = pndtcb;
     }
+#endif
 
   /* Mark the input list empty */
 
   g_pendingtasks.head = NULL;
   g_pendingtasks.tail = NULL;
 
+#if defined(CONFIG_SCHED_TICKLESS) && CONFIG_RR_INTERVAL > 0
+  /* Charge the time that otcb ran against its timeslice and start timing
+   * the timeslice of the new active task.
+   */
+
+  if (ret)
+    {
+      sched_timer_switch(otcb);
+    }
+#endif
+
   return ret;
 }
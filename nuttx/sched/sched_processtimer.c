@@ -182,6 +182,12 @@ void sched_process_timer(void)
       wd_timer();
     }
 
+  /* Charge this tick to the currently executing task */
+
+#ifdef CONFIG_SCHED_CPUACCT
+  sched_cpu_tick();
+#endif
+
   /* Check if the currently executing task has exceeded its
    * timeslice.
    */
@@ -0,0 +1,236 @@
+/****************************************************************************
+ * sched/sched_profile.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/sched_profile.h>
+
+#include "os_internal.h"
+
+#ifdef CONFIG_SCHED_PROFILE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* One slot of the buffer is always empty so that a full buffer can be told
+ * from an empty one.
+ */
+
+#define PROFILE_NSLOTS (CONFIG_SCHED_PROFILE_NSAMPLES + 1)
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* The sample buffer.  g_profhead is the index of the next sample to be
+ * written and is only changed by sched_profile_sample(); g_proftail is the
+ * index of the oldest sample and is only changed by the reader.  No lock
+ * is needed, which matters in the simulation where the samples are taken
+ * from a host signal handler that irqsave() does not hold off.
+ */
+
+static volatile struct sched_profile_s g_profbuffer[PROFILE_NSLOTS];
+static volatile uint16_t g_profhead;
+static volatile uint16_t g_proftail;
+static uint32_t g_profoverruns;
+static uint16_t g_profticks;
+static volatile bool g_profenabled;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_profile_sample
+ *
+ * Description:
+ *   Called by the architecture-specific logic on every system timer tick
+ *   (from the timer interrupt handler) with the program counter of the
+ *   code that was interrupted.  A sample is recorded every
+ *   CONFIG_SCHED_PROFILE_INTERVAL ticks while profiling is enabled.
+ *
+ * Input Parameters:
+ *   pc - The interrupted program counter
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_profile_sample(uintptr_t pc)
+{
+  FAR struct tcb_s *rtcb;
+  uint16_t next;
+
+  if (!g_profenabled || ++g_profticks < CONFIG_SCHED_PROFILE_INTERVAL)
+    {
+      return;
+    }
+
+  g_profticks = 0;
+
+  next = g_profhead + 1;
+  if (next >= PROFILE_NSLOTS)
+    {
+      next = 0;
+    }
+
+  if (next == g_proftail)
+    {
+      /* The buffer is full */
+
+      g_profoverruns++;
+      return;
+    }
+
+  /* Record the sample, then publish it */
+
+  rtcb = (FAR struct tcb_s*)g_readytorun.head;
+  g_profbuffer[g_profhead].pc  = pc;
+  g_profbuffer[g_profhead].pid = rtcb->pid;
+  g_profhead = next;
+}
+
+/****************************************************************************
+ * Name: sched_profile_enable
+ *
+ * Description:
+ *   Start or stop sampling.  Sampling is disabled at power-up.
+ *
+ * Input Parameters:
+ *   enable - True: start sampling; false: stop sampling
+ *
+ * Returned Value:
+ *   The previous state:  True if sampling was enabled.
+ *
+ ****************************************************************************/
+
+bool sched_profile_enable(bool enable)
+{
+  bool ret = g_profenabled;
+
+  if (enable != ret)
+    {
+      g_profenabled = enable;
+      up_profile_enable(enable);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: sched_profile_clear
+ *
+ * Description:
+ *   Discard all samples in the buffer and reset the overrun count.
+ *
+ ****************************************************************************/
+
+void sched_profile_clear(void)
+{
+  g_proftail     = g_profhead;
+  g_profoverruns = 0;
+}
+
+/****************************************************************************
+ * Name: sched_profile_read
+ *
+ * Description:
+ *   Remove up to nsamples of the oldest samples from the buffer.
+ *
+ * Input Parameters:
+ *   buffer   - The location to return the samples
+ *   nsamples - The maximum number of samples to return
+ *
+ * Returned Value:
+ *   The number of samples returned.  Zero means that the buffer is empty.
+ *
+ ****************************************************************************/
+
+size_t sched_profile_read(FAR struct sched_profile_s *buffer,
+                          size_t nsamples)
+{
+  uint16_t tail = g_proftail;
+  size_t ret;
+
+  for (ret = 0; ret < nsamples && tail != g_profhead; ret++)
+    {
+      buffer[ret].pc  = g_profbuffer[tail].pc;
+      buffer[ret].pid = g_profbuffer[tail].pid;
+
+      if (++tail >= PROFILE_NSLOTS)
+        {
+          tail = 0;
+        }
+    }
+
+  /* Release the slots that were read */
+
+  g_proftail = tail;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: sched_profile_overruns
+ *
+ * Description:
+ *   Return the number of samples that were dropped because the buffer was
+ *   full.
+ *
+ ****************************************************************************/
+
+uint32_t sched_profile_overruns(void)
+{
+  return g_profoverruns;
+}
+
+#endif /* CONFIG_SCHED_PROFILE */
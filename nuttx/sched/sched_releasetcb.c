@@ -138,7 +138,7 @@ int sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype)
 #ifndef CONFIG_CUSTOM_STACK
       if (tcb->stack_alloc_ptr)
         {
-          up_release_stack(tcb, ttype);
+          sched_releasestack(tcb, ttype);
         }
 #endif
 
@@ -193,7 +193,12 @@ int sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype)
 #endif
       /* And, finally, release the TCB itself */
 
+#ifdef CONFIG_SCHED_TCBCACHE
+      sched_cachefree(ttype == TCB_FLAG_TTYPE_PTHREAD ?
+                      SCHED_CACHE_PTHREAD : SCHED_CACHE_TASK, tcb);
+#else
       sched_kfree(tcb);
+#endif
     }
 
   return ret;
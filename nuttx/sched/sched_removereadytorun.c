@@ -43,6 +43,8 @@
 #include <queue.h>
 #include <assert.h>
 
+#include <nuttx/sched_trace.h>
+
 #include "os_internal.h"
 
 /****************************************************************************
@@ -107,6 +109,8 @@ bool sched_removereadytorun(FAR struct tcb_s *rtcb)
       /* Inform the instrumentation layer that we are switching tasks */
 
       sched_note_switch(rtcb, rtcb->flink);
+      sched_cpu_switch(rtcb);
+      sched_trace_event(SCHED_TRACE_SWITCH, rtcb->flink, rtcb->pid);
 
       rtcb->flink->task_state = TSTATE_TASK_RUNNING;
       ret = true;
@@ -114,7 +118,22 @@ bool sched_removereadytorun(FAR struct tcb_s *rtcb)
 
   /* Remove the TCB from the ready-to-run list */
 
+#ifdef CONFIG_SCHED_RTRBITMAP
+  sched_rtrremove(rtcb);
+#else
   dq_rem((FAR dq_entry_t*)rtcb, (dq_queue_t*)&g_readytorun);
+#endif
+
+#if defined(CONFIG_SCHED_TICKLESS) && CONFIG_RR_INTERVAL > 0
+  /* Charge the time that rtcb ran against its timeslice and start timing
+   * the timeslice of the new active task.
+   */
+
+  if (ret)
+    {
+      sched_timer_switch(rtcb);
+    }
+#endif
 
   rtcb->task_state = TSTATE_TASK_INVALID;
   return ret;
@@ -0,0 +1,247 @@
+/****************************************************************************
+ * sched/sched_rtrbitmap.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+#include <assert.h>
+
+#include "os_internal.h"
+
+#ifdef CONFIG_SCHED_RTRBITMAP
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define RTR_NPRIORITIES  256
+#define RTR_NWORDS       (RTR_NPRIORITIES / 32)
+
+/* Find the first set bit in a (non-zero) bitmap word */
+
+#ifdef __GNUC__
+#  define rtr_ctz(w) __builtin_ctz(w)
+#endif
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* The g_readytorun list is still a single list in priority order, so that
+ * the head of the list is always the running task and all of the existing
+ * users of the list are unaffected.  g_rtrtail[] and the bitmaps index
+ * that list:  g_rtrtail[n] is the last task in the list with priority n
+ * and bit n of g_rtrbitmap[] is set if there is any such task.  Bit w of
+ * g_rtrsummary is set if g_rtrbitmap[w] is non-zero.
+ */
+
+static FAR struct tcb_s *g_rtrtail[RTR_NPRIORITIES];
+static uint32_t g_rtrbitmap[RTR_NWORDS];
+static uint8_t g_rtrsummary;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: rtr_ctz
+ *
+ * Description:
+ *   Return the number of the least significant set bit of a non-zero
+ *   word (for compilers without a count-trailing-zeroes built-in).
+ *
+ ****************************************************************************/
+
+#ifndef rtr_ctz
+static inline int rtr_ctz(uint32_t word)
+{
+  int bit = 0;
+
+  while ((word & 1) == 0)
+    {
+      word >>= 1;
+      bit++;
+    }
+
+  return bit;
+}
+#endif
+
+/****************************************************************************
+ * Name: rtr_lowest
+ *
+ * Description:
+ *   Return the lowest priority, greater than or equal to priority, that
+ *   has tasks in the g_readytorun list, or -1 if there is none.
+ *
+ ****************************************************************************/
+
+static inline int rtr_lowest(int priority)
+{
+  uint32_t word;
+  int ndx = priority >> 5;
+
+  /* Check the remainder of the word that holds priority */
+
+  word = g_rtrbitmap[ndx] & (0xffffffff << (priority & 31));
+  if (word == 0)
+    {
+      /* Then the first non-empty word above it */
+
+      word = (uint32_t)g_rtrsummary & (0xfffffffe << ndx);
+      if (word == 0)
+        {
+          return -1;
+        }
+
+      ndx  = rtr_ctz(word);
+      word = g_rtrbitmap[ndx];
+    }
+
+  return (ndx << 5) + rtr_ctz(word);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_rtrinsert
+ *
+ * Description:
+ *   Insert a TCB into the g_readytorun list after all tasks of the same or
+ *   higher priority.  This is equivalent to
+ *   sched_addprioritized(tcb, &g_readytorun) but does not search the list.
+ *
+ * Inputs:
+ *   tcb - The TCB to insert
+ *
+ * Return Value:
+ *   true if the TCB was inserted at the head of the list.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+bool sched_rtrinsert(FAR struct tcb_s *tcb)
+{
+  int priority = tcb->sched_priority;
+  FAR struct tcb_s *prev;
+  int lowest;
+  bool ret = false;
+
+  /* Insert after the last task with the lowest priority that is greater
+   * than or equal to the priority of the new task.
+   */
+
+  lowest = rtr_lowest(priority);
+  if (lowest < 0)
+    {
+      dq_addfirst((FAR dq_entry_t*)tcb, (FAR dq_queue_t*)&g_readytorun);
+      ret = true;
+    }
+  else
+    {
+      prev = g_rtrtail[lowest];
+      dq_addafter((FAR dq_entry_t*)prev, (FAR dq_entry_t*)tcb,
+                  (FAR dq_queue_t*)&g_readytorun);
+    }
+
+  /* The new task is now the last task at its priority */
+
+  g_rtrtail[priority] = tcb;
+  g_rtrbitmap[priority >> 5] |= (uint32_t)1 << (priority & 31);
+  g_rtrsummary |= 1 << (priority >> 5);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: sched_rtrremove
+ *
+ * Description:
+ *   Remove a TCB from the g_readytorun list.  The TCB must still have the
+ *   priority that it had when it was inserted.
+ *
+ * Inputs:
+ *   tcb - The TCB to remove
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void sched_rtrremove(FAR struct tcb_s *tcb)
+{
+  int priority = tcb->sched_priority;
+  FAR struct tcb_s *prev;
+
+  DEBUGASSERT(g_rtrtail[priority] != NULL);
+
+  if (g_rtrtail[priority] == tcb)
+    {
+      prev = tcb->blink;
+      if (prev && prev->sched_priority == priority)
+        {
+          g_rtrtail[priority] = prev;
+        }
+      else
+        {
+          g_rtrtail[priority] = NULL;
+          g_rtrbitmap[priority >> 5] &= ~((uint32_t)1 << (priority & 31));
+          if (g_rtrbitmap[priority >> 5] == 0)
+            {
+              g_rtrsummary &= ~(1 << (priority >> 5));
+            }
+        }
+    }
+
+  dq_rem((FAR dq_entry_t*)tcb, (FAR dq_queue_t*)&g_readytorun);
+}
+
+#endif /* CONFIG_SCHED_RTRBITMAP */
@@ -151,7 +151,18 @@ int sched_setpriority(FAR struct tcb_s *tcb, int sched_priority)
           {
             /* Change the task priority */
 
+#ifdef CONFIG_SCHED_RTRBITMAP
+            /* The priority bitmap indexes the ready-to-run list by
+             * priority so the task must be removed and re-inserted.  It
+             * will still be at the head of the list.
+             */
+
+            sched_rtrremove(tcb);
+            tcb->sched_priority = (uint8_t)sched_priority;
+            (void)sched_rtrinsert(tcb);
+#else
             tcb->sched_priority = (uint8_t)sched_priority;
+#endif
           }
         break;
 
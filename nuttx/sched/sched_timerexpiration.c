@@ -0,0 +1,451 @@
+/****************************************************************************
+ * sched/sched_timerexpiration.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <nuttx/compiler.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sched.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+
+#include "os_internal.h"
+#include "wd_internal.h"
+#include "clock_internal.h"
+
+#ifdef CONFIG_SCHED_TICKLESS
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Tick boundaries are aligned with whole seconds of the free-running
+ * counter.  That requires that a tick evenly divides one second.
+ */
+
+#if (MSEC_PER_SEC % MSEC_PER_TICK) != 0
+#  error "MSEC_PER_TICK must evenly divide one second with CONFIG_SCHED_TICKLESS"
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The value of the system timer when the elapsed time was last accounted
+ * for.  The delays of the active watchdogs and the remaining
+ * timeslice of the running task are relative to this time.
+ */
+
+static uint32_t g_timer_tick;
+
+/* True while sched_timer_expiration() is processing the elapsed time.
+ * Requests to re-program the one-shot timer are ignored while busy because
+ * the timer will be re-programmed when the processing completes.
+ */
+
+static bool g_timer_busy;
+
+/* The value of the system timer when the timeslice of the running task was
+ * last charged.  This is reset whenever a different task becomes the
+ * running task so that a round-robin task is only charged for the time
+ * that it actually runs.
+ */
+
+#if CONFIG_RR_INTERVAL > 0
+static uint32_t g_timeslice_tick;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_process_timeslice
+ *
+ * Description:
+ *   Charge the elapsed time against the timeslice of the currently
+ *   executing task (if it is a round-robin task).
+ *
+ * Inputs:
+ *   ticks - The number of ticks that have elapsed
+ *
+ * Return Value:
+ *   true if the timeslice has expired and the task must relinquish the CPU
+ *   to the next task at the same priority.
+ *
+ ****************************************************************************/
+
+#if CONFIG_RR_INTERVAL > 0
+static bool sched_process_timeslice(int ticks)
+{
+  FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
+
+  /* Check if the currently executing task uses round robin scheduling. */
+
+  if ((rtcb->flags & TCB_FLAG_ROUND_ROBIN) != 0)
+    {
+      /* Yes, check if the elapsed time would cause the timeslice to
+       * expire.
+       */
+
+      if (rtcb->timeslice <= ticks)
+        {
+          /* Yes, Now check if the task has pre-emption disabled.  If so,
+           * then we will hold the timeslice at one tick so that it is
+           * checked again on the next tick after pre-emption has been
+           * enabled.
+           */
+
+          if (rtcb->lockcount)
+            {
+              rtcb->timeslice = 1;
+            }
+          else
+            {
+              /* Reset the timeslice in any case.  Then give the next task
+               * a shot if it has the same priority.
+               */
+
+              rtcb->timeslice = CONFIG_RR_INTERVAL / MSEC_PER_TICK;
+              return (rtcb->flink &&
+                      rtcb->flink->sched_priority >= rtcb->sched_priority);
+            }
+        }
+      else
+        {
+          /* Decrement the timeslice counter */
+
+          rtcb->timeslice -= ticks;
+        }
+    }
+
+  return false;
+}
+#endif
+
+/****************************************************************************
+ * Name: sched_timer_start
+ *
+ * Description:
+ *   Program the one-shot timer for the next watchdog or timeslice
+ *   expiration.  If there is nothing to wait for, then the timer is
+ *   cancelled and the system may remain idle indefinitely.
+ *
+ * Inputs:
+ *   None
+ *
+ * Return Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void sched_timer_start(void)
+{
+#if CONFIG_RR_INTERVAL > 0
+  FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
+  uint32_t rrexpire;
+#endif
+  struct timespec ts;
+  uint32_t expire;
+  uint32_t frac;
+  uint32_t now;
+  bool armed;
+  int ticks;
+
+  /* Get the delay until the next watchdog expiration, relative to
+   * g_timer_tick (zero if there are no active watchdogs).
+   */
+
+  ticks  = wd_nextdelay();
+  expire = g_timer_tick + ticks;
+  armed  = (ticks != 0);
+
+#if CONFIG_RR_INTERVAL > 0
+  /* The timeslice of a round-robin task is relative to the time that it
+   * was last charged, not to g_timer_tick.
+   */
+
+  if ((rtcb->flags & TCB_FLAG_ROUND_ROBIN) != 0)
+    {
+      rrexpire = g_timeslice_tick +
+                 (rtcb->timeslice > 0 ? rtcb->timeslice : 1);
+
+      if (!armed || (int32_t)(rrexpire - expire) < 0)
+        {
+          expire = rrexpire;
+          armed  = true;
+        }
+    }
+#endif
+
+  if (!armed)
+    {
+      (void)up_timer_cancel();
+      return;
+    }
+
+  /* Convert the expiration to an interval from the current time.  The
+   * timer expires on the tick boundary so that the timing is exactly the
+   * same as it would be with the periodic timer (only without all of the
+   * intervening interrupts).
+   */
+
+  (void)up_timer_gettime(&ts);
+  now   = (uint32_t)ts.tv_sec * TICK_PER_SEC +
+          (uint32_t)ts.tv_nsec / NSEC_PER_TICK;
+  frac  = (uint32_t)ts.tv_nsec % NSEC_PER_TICK;
+  ticks = (int)(expire - now);
+
+  if (ticks <= 0)
+    {
+      /* The expiration time has already passed */
+
+      ts.tv_sec  = 0;
+      ts.tv_nsec = 0;
+    }
+  else
+    {
+      ts.tv_sec  = ticks / TICK_PER_SEC;
+      ts.tv_nsec = (ticks % TICK_PER_SEC) * NSEC_PER_TICK;
+
+      if ((uint32_t)ts.tv_nsec < frac)
+        {
+          ts.tv_sec--;
+          ts.tv_nsec += NSEC_PER_SEC;
+        }
+
+      ts.tv_nsec -= frac;
+    }
+
+  (void)up_timer_start(&ts);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_timer_elapsed
+ *
+ * Description:
+ *   Return the number of ticks that have elapsed since the elapsed time
+ *   was last accounted for.  Watchdog lags are relative to that time so
+ *   wd_start() must add this to the delay of a new watchdog.
+ *
+ *   If there are no active watchdogs, then nothing depends on the old time
+ *   and it is simply advanced to the current time.  This keeps the value
+ *   small after the system has been idle for a long time.
+ *
+ * Inputs:
+ *   None
+ *
+ * Return Value:
+ *   The number of elapsed ticks.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+int sched_timer_elapsed(void)
+{
+  uint32_t now = clock_systimer();
+
+  if (!g_timer_busy && wd_nextdelay() == 0)
+    {
+      g_timer_tick = now;
+    }
+
+  return (int)(now - g_timer_tick);
+}
+
+/****************************************************************************
+ * Name: sched_timer_reassess
+ *
+ * Description:
+ *   The next expiration may have changed (a watchdog was started or
+ *   cancelled at the head of the timer queue, or a round-robin task became
+ *   the running task).  Re-program the one-shot timer.
+ *
+ * Inputs:
+ *   None
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void sched_timer_reassess(void)
+{
+  if (!g_timer_busy)
+    {
+      sched_timer_start();
+    }
+}
+
+/****************************************************************************
+ * Name: sched_timer_switch
+ *
+ * Description:
+ *   A different task has become the running task.  Charge the time that
+ *   the previous task ran against its timeslice (if it is a round-robin
+ *   task) and start timing the timeslice of the new running task from now.
+ *   If the new running task is a round-robin task, then the one-shot timer
+ *   is re-programmed for the end of its timeslice.
+ *
+ * Inputs:
+ *   otcb - The TCB of the task that was running.  It must still be valid.
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   Interrupts are disabled.  g_readytorun.head is the new running task.
+ *
+ ****************************************************************************/
+
+#if CONFIG_RR_INTERVAL > 0
+void sched_timer_switch(FAR struct tcb_s *otcb)
+{
+  FAR struct tcb_s *ntcb = (FAR struct tcb_s*)g_readytorun.head;
+  uint32_t now = clock_systimer();
+  int ticks = (int)(now - g_timeslice_tick);
+
+  if ((otcb->flags & TCB_FLAG_ROUND_ROBIN) != 0 && ticks > 0)
+    {
+      /* Keep at least one tick so that the task is not rotated the moment
+       * that it runs again; an expired timeslice is then handled at the
+       * next tick, just as when pre-emption was disabled.
+       */
+
+      otcb->timeslice = otcb->timeslice > ticks ?
+                        otcb->timeslice - ticks : 1;
+    }
+
+  g_timeslice_tick = now;
+
+  if ((ntcb->flags & TCB_FLAG_ROUND_ROBIN) != 0)
+    {
+      sched_timer_reassess();
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: sched_timer_expiration
+ *
+ * Description:
+ *   This function replaces sched_process_timer() when CONFIG_SCHED_TICKLESS
+ *   is selected.  The platform-specific logic calls this function when the
+ *   one-shot timer expires.  The elapsed time is computed from the
+ *   free-running counter and any number of ticks may have elapsed since the
+ *   last call.
+ *
+ * Inputs:
+ *   None
+ *
+ * Return Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_timer_expiration(void)
+{
+  uint32_t now;
+  int elapsed;
+#if CONFIG_RR_INTERVAL > 0
+  bool rotate;
+#endif
+
+  g_timer_busy = true;
+
+  /* Account for all of the time that has elapsed */
+
+  now          = clock_systimer();
+  elapsed      = (int)(now - g_timer_tick);
+  g_timer_tick = now;
+
+  /* Process watchdogs (if in the link) */
+
+  if (elapsed > 0)
+    {
+#ifdef CONFIG_HAVE_WEAKFUNCTIONS
+      if (wd_timer != NULL)
+#endif
+        {
+          wd_timer(elapsed);
+        }
+    }
+
+  /* Check if the currently executing task has exceeded its timeslice.  It
+   * is charged only for the time since it was last charged, which may be
+   * later than g_timer_tick if it became the running task since then.
+   */
+
+#if CONFIG_RR_INTERVAL > 0
+  rotate           = sched_process_timeslice((int)(now - g_timeslice_tick));
+  g_timeslice_tick = now;
+#endif
+
+  /* Then set up the next expiration */
+
+  g_timer_busy = false;
+  sched_timer_start();
+
+  /* Finally, let the next task at the same priority run.  Just resetting
+   * the task priority to its current value will cause the task to be
+   * rescheduled behind any other tasks at the same priority.
+   */
+
+#if CONFIG_RR_INTERVAL > 0
+  if (rotate)
+    {
+      FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
+      up_reprioritize_rtr(rtcb, rtcb->sched_priority);
+    }
+#endif
+}
+
+#endif /* CONFIG_SCHED_TICKLESS */
@@ -0,0 +1,267 @@
+/****************************************************************************
+ * sched/sched_trace.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/sched_trace.h>
+
+#include "os_internal.h"
+
+#ifdef CONFIG_SCHED_TRACE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* The trace buffer.  g_tracehead is the index of the next event to be
+ * written and g_tracecount is the number of valid events that precede it
+ * (circularly).  When the buffer is full, new events overwrite the oldest
+ * and g_traceoverruns is incremented.
+ */
+
+static struct sched_trace_s g_tracebuffer[CONFIG_SCHED_TRACE_NEVENTS];
+static uint16_t g_tracehead;
+static uint16_t g_tracecount;
+static uint32_t g_traceoverruns;
+static bool     g_traceenabled = true;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: trace_timestamp
+ *
+ * Description:
+ *   Return the current time in microseconds.  In the tickless mode, this
+ *   has the resolution of the platform's free-running counter; otherwise,
+ *   it has the resolution of the system timer tick.
+ *
+ ****************************************************************************/
+
+static inline uint32_t trace_timestamp(void)
+{
+#ifdef CONFIG_SCHED_TICKLESS
+  struct timespec ts;
+
+  (void)up_timer_gettime(&ts);
+  return (uint32_t)ts.tv_sec * USEC_PER_SEC + ts.tv_nsec / NSEC_PER_USEC;
+#else
+  return clock_systimer() * USEC_PER_TICK;
+#endif
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_trace_event
+ *
+ * Description:
+ *   Record one event in the trace buffer.  This is called from the OS
+ *   internally (possibly from interrupt handlers) and should not be called
+ *   by application logic.
+ *
+ * Input Parameters:
+ *   type - The event type (SCHED_TRACE_*)
+ *   tcb  - The TCB of the task that the event applies to
+ *   arg  - The event-specific argument
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_trace_event(uint8_t type, FAR struct tcb_s *tcb, uint32_t arg)
+{
+  FAR struct sched_trace_s *event;
+  irqstate_t flags;
+
+  /* Most callers already have interrupts disabled */
+
+  flags = irqsave();
+  if (g_traceenabled)
+    {
+      event           = &g_tracebuffer[g_tracehead];
+      event->time     = trace_timestamp();
+      event->type     = type;
+      event->priority = tcb->sched_priority;
+      event->pid      = tcb->pid;
+      event->arg      = arg;
+
+      if (++g_tracehead >= CONFIG_SCHED_TRACE_NEVENTS)
+        {
+          g_tracehead = 0;
+        }
+
+      if (g_tracecount < CONFIG_SCHED_TRACE_NEVENTS)
+        {
+          g_tracecount++;
+        }
+      else
+        {
+          g_traceoverruns++;
+        }
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: sched_trace_enable
+ *
+ * Description:
+ *   Start or stop recording events.  Recording is enabled at power-up so
+ *   that the trace buffer always holds the most recent events.
+ *
+ * Input Parameters:
+ *   enable - True: start recording; false: stop recording
+ *
+ * Returned Value:
+ *   The previous state:  True if recording was enabled.
+ *
+ ****************************************************************************/
+
+bool sched_trace_enable(bool enable)
+{
+  bool ret = g_traceenabled;
+
+  g_traceenabled = enable;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: sched_trace_clear
+ *
+ * Description:
+ *   Discard all events in the trace buffer and reset the overrun count.
+ *
+ ****************************************************************************/
+
+void sched_trace_clear(void)
+{
+  irqstate_t flags;
+
+  flags           = irqsave();
+  g_tracehead     = 0;
+  g_tracecount    = 0;
+  g_traceoverruns = 0;
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: sched_trace_read
+ *
+ * Description:
+ *   Remove up to nevents of the oldest events from the trace buffer.
+ *
+ * Input Parameters:
+ *   buffer  - The location to return the events
+ *   nevents - The maximum number of events to return
+ *
+ * Returned Value:
+ *   The number of events returned.  Zero means that the trace buffer is
+ *   empty.
+ *
+ ****************************************************************************/
+
+size_t sched_trace_read(FAR struct sched_trace_s *buffer, size_t nevents)
+{
+  irqstate_t flags;
+  size_t ret;
+  int tail;
+
+  flags = irqsave();
+  if (nevents > g_tracecount)
+    {
+      nevents = g_tracecount;
+    }
+
+  /* The oldest event is g_tracecount events before the head */
+
+  tail = (int)g_tracehead - (int)g_tracecount;
+  if (tail < 0)
+    {
+      tail += CONFIG_SCHED_TRACE_NEVENTS;
+    }
+
+  for (ret = 0; ret < nevents; ret++)
+    {
+      buffer[ret] = g_tracebuffer[tail];
+      if (++tail >= CONFIG_SCHED_TRACE_NEVENTS)
+        {
+          tail = 0;
+        }
+    }
+
+  g_tracecount -= nevents;
+  irqrestore(flags);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: sched_trace_overruns
+ *
+ * Description:
+ *   Return the number of events that were lost (overwritten by newer
+ *   events) because the trace buffer was full.
+ *
+ ****************************************************************************/
+
+uint32_t sched_trace_overruns(void)
+{
+  return g_traceoverruns;
+}
+
+#endif /* CONFIG_SCHED_TRACE */
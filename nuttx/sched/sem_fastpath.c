@@ -0,0 +1,195 @@
+/****************************************************************************
+ * sched/sem_fastpath.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <semaphore.h>
+
+#include <arch/irq.h>
+
+#include "sem_internal.h"
+
+#ifdef CONFIG_SEM_FASTPATH
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* With priority inheritance, the holder list must change atomically with
+ * the count so a compare-and-swap on the count alone is not enough.
+ */
+
+#if defined(CONFIG_ARCH_HAVE_CMPXCHG) && !defined(CONFIG_PRIORITY_INHERITANCE)
+#  define SEM_HAVE_CMPXCHG 1
+#  define sem_cmpxchg(p,o,n) __sync_bool_compare_and_swap(p,o,n)
+#endif
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sem_fastwait
+ *
+ * Description:
+ *   Take one count from the semaphore if one is available.  This is the
+ *   uncontended case of sem_wait():  It never blocks, never modifies the
+ *   errno value and does not lock the scheduler.
+ *
+ * Parameters:
+ *   sem - Semaphore descriptor (must not be NULL)
+ *
+ * Return Value:
+ *   true if a count was taken; false if the caller must use the normal
+ *   sem_wait() logic (and perhaps block).
+ *
+ * Assumptions:
+ *   Called from task context.
+ *
+ ****************************************************************************/
+
+bool sem_fastwait(FAR sem_t *sem)
+{
+#ifdef SEM_HAVE_CMPXCHG
+  int16_t count;
+
+  do
+    {
+      count = sem->semcount;
+      if (count <= 0)
+        {
+          return false;
+        }
+    }
+  while (!sem_cmpxchg(&sem->semcount, count, count - 1));
+
+  return true;
+#else
+  irqstate_t saved_state;
+  bool ret = false;
+
+  saved_state = irqsave();
+  if (sem->semcount > 0)
+    {
+      sem->semcount--;
+      sem_addholder(sem);
+      ret = true;
+    }
+
+  irqrestore(saved_state);
+  return ret;
+#endif
+}
+
+/****************************************************************************
+ * Name: sem_fastpost
+ *
+ * Description:
+ *   Return one count to the semaphore if no task is waiting for it.  This
+ *   is the uncontended case of sem_post():  No task needs to be awakened
+ *   and no priority needs to be restored.
+ *
+ * Parameters:
+ *   sem - Semaphore descriptor (must not be NULL)
+ *
+ * Return Value:
+ *   true if the count was posted; false if the caller must use the normal
+ *   sem_post() logic.
+ *
+ * Assumptions:
+ *   May be called from an interrupt handler.
+ *
+ ****************************************************************************/
+
+bool sem_fastpost(FAR sem_t *sem)
+{
+#ifdef SEM_HAVE_CMPXCHG
+  int16_t count;
+
+  do
+    {
+      count = sem->semcount;
+      if (count < 0 || count >= SEM_VALUE_MAX)
+        {
+          return false;
+        }
+    }
+  while (!sem_cmpxchg(&sem->semcount, count, count + 1));
+
+  return true;
+#else
+  irqstate_t saved_state;
+  bool ret = false;
+
+  saved_state = irqsave();
+  if (sem->semcount >= 0 && sem->semcount < SEM_VALUE_MAX)
+    {
+      /* This is the same sequence that sem_post() performs when there are
+       * no waiters.  No thread was given a count, so sem_restorebaseprio()
+       * only discards our holder entry if we no longer hold any counts.
+       */
+
+      sem_releaseholder(sem);
+      sem->semcount++;
+      sem_restorebaseprio(NULL, sem);
+      ret = true;
+    }
+
+  irqrestore(saved_state);
+  return ret;
+#endif
+}
+
+#endif /* CONFIG_SEM_FASTPATH */
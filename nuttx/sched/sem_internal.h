@@ -97,6 +97,13 @@ void weak_function sem_initialize(void);
 void sem_waitirq(FAR struct tcb_s *wtcb, int errcode);
 FAR nsem_t *sem_findnamed(const char *name);
 
+/* Uncontended fast path used by the semaphore and mutex interfaces */
+
+#ifdef CONFIG_SEM_FASTPATH
+bool sem_fastwait(FAR sem_t *sem);
+bool sem_fastpost(FAR sem_t *sem);
+#endif
+
 /* Special logic needed only by priority inheritance to manage collections of
  * holders of semaphores.
  */
@@ -43,6 +43,7 @@
 #include <semaphore.h>
 #include <sched.h>
 #include <nuttx/arch.h>
+#include <nuttx/sched_trace.h>
 
 #include "os_internal.h"
 #include "sem_internal.h"
@@ -106,6 +107,15 @@ int sem_post(FAR sem_t *sem)
   irqstate_t saved_state;
   int ret = ERROR;
 
+#ifdef CONFIG_SEM_FASTPATH
+  /* If no task is waiting for the semaphore, just return the count */
+
+  if (sem && sem_fastpost(sem))
+    {
+      return OK;
+    }
+#endif
+
   /* Make sure we were supplied with a valid semaphore. */
 
   if (sem)
@@ -158,6 +168,8 @@ int sem_post(FAR sem_t *sem)
 
               /* Restart the waiting task. */
 
+              sched_trace_event(SCHED_TRACE_SEMWAKE, stcb,
+                                (uint32_t)(uintptr_t)sem);
               up_unblock_task(stcb);
             }
         }
@@ -44,6 +44,7 @@
 #include <errno.h>
 #include <assert.h>
 #include <nuttx/arch.h>
+#include <nuttx/sched_trace.h>
 
 #include "os_internal.h"
 #include "sem_internal.h"
@@ -104,6 +105,17 @@ int sem_wait(FAR sem_t *sem)
 
   DEBUGASSERT(up_interrupt_context() == false)
 
+#ifdef CONFIG_SEM_FASTPATH
+  /* If a count is available, just take it.  The errno value is not
+   * modified on success so there is nothing else to do.
+   */
+
+  if (sem && sem_fastwait(sem))
+    {
+      return OK;
+    }
+#endif
+
   /* Assume any errors reported are due to invalid arguments. */
 
   errno = EINVAL;
@@ -169,6 +181,8 @@ int sem_wait(FAR sem_t *sem)
           /* Add the TCB to the prioritized semaphore wait queue */
 
           errno = 0;
+          sched_trace_event(SCHED_TRACE_SEMBLOCK, rtcb,
+                            (uint32_t)(uintptr_t)sem);
           up_block_task(rtcb, TSTATE_WAIT_SEM);
 
           /* When we resume at this point, either (1) the semaphore has been
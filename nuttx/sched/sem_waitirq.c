@@ -42,6 +42,7 @@
 #include <sched.h>
 #include <errno.h>
 #include <nuttx/arch.h>
+#include <nuttx/sched_trace.h>
 
 #include "sem_internal.h"
 
@@ -135,6 +136,7 @@ void sem_waitirq(FAR struct tcb_s *wtcb, int errcode)
 
       /* Restart the task. */
 
+      sched_trace_event(SCHED_TRACE_SEMWAKE, wtcb, (uint32_t)(uintptr_t)sem);
       up_unblock_task(wtcb);
     }
 
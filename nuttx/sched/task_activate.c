@@ -43,6 +43,7 @@
 #include <debug.h>
 
 #include <nuttx/arch.h>
+#include <nuttx/sched_trace.h>
 
 /****************************************************************************
  * Definitions
@@ -111,6 +112,8 @@ int task_activate(FAR struct tcb_s *tcb)
   sched_note_start(tcb);
 #endif
 
+  sched_trace_event(SCHED_TRACE_START, tcb, 0);
+
   up_unblock_task(tcb);
   irqrestore(flags);
   return OK;
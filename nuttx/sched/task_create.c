@@ -113,7 +113,11 @@ static int thread_create(FAR const char *name, uint8_t ttype, int priority,
 
   /* Allocate a TCB for the new task. */
 
+#ifdef CONFIG_SCHED_TCBCACHE
+  tcb = (FAR struct task_tcb_s *)sched_cachealloc(SCHED_CACHE_TASK);
+#else
   tcb = (FAR struct task_tcb_s *)kzalloc(sizeof(struct task_tcb_s));
+#endif
   if (!tcb)
     {
       sdbg("ERROR: Failed to allocate TCB\n");
@@ -146,7 +150,7 @@ static int thread_create(FAR const char *name, uint8_t ttype, int priority,
   /* Allocate the stack for the TCB */
 
 #ifndef CONFIG_CUSTOM_STACK
-  ret = up_create_stack((FAR struct tcb_s *)tcb, stack_size, ttype);
+  ret = sched_createstack((FAR struct tcb_s *)tcb, stack_size, ttype);
   if (ret < OK)
     {
       errcode = -ret;
@@ -43,7 +43,9 @@
 #include <assert.h>
 #include <queue.h>
 
+#include <nuttx/arch.h>
 #include <nuttx/sched.h>
+#include <nuttx/sched_trace.h>
 #include <arch/irq.h>
 
 #include "os_internal.h"
@@ -167,7 +169,18 @@ int task_terminate(pid_t pid, bool nonblocking)
   /* Remove the task from the OS's tasks lists. */
 
   saved_state = irqsave();
-  dq_rem((FAR dq_entry_t*)dtcb, (dq_queue_t*)g_tasklisttable[dtcb->task_state].list);
+#ifdef CONFIG_SCHED_RTRBITMAP
+  if (dtcb->task_state == TSTATE_TASK_READYTORUN)
+    {
+      sched_rtrremove(dtcb);
+    }
+  else
+#endif
+    {
+      dq_rem((FAR dq_entry_t*)dtcb,
+             (dq_queue_t*)g_tasklisttable[dtcb->task_state].list);
+    }
+
   dtcb->task_state = TSTATE_TASK_INVALID;
   irqrestore(saved_state);
 
@@ -181,6 +194,11 @@ int task_terminate(pid_t pid, bool nonblocking)
    */
 
   sched_note_stop(dtcb);
+#ifdef CONFIG_STACK_COLORATION
+  sched_trace_event(SCHED_TRACE_STOP, dtcb, up_check_tcbstack(dtcb));
+#else
+  sched_trace_event(SCHED_TRACE_STOP, dtcb, 0);
+#endif
 
   /* Deallocate its TCB */
 
@@ -135,7 +135,11 @@ FAR struct task_tcb_s *task_vforksetup(start_t retaddr)
 
   /* Allocate a TCB for the child task. */
 
+#ifdef CONFIG_SCHED_TCBCACHE
+  child = (FAR struct task_tcb_s *)sched_cachealloc(SCHED_CACHE_TASK);
+#else
   child = (FAR struct task_tcb_s *)kzalloc(sizeof(struct task_tcb_s));
+#endif
   if (!child)
     {
       sdbg("ERROR: Failed to allocate TCB\n");
@@ -90,9 +90,14 @@
 
 int wd_cancel (WDOG_ID wdid)
 {
+#ifndef CONFIG_WDOG_WHEEL
   wdog_t    *curr;
   wdog_t    *prev;
+#endif
   irqstate_t saved_state;
+#ifdef CONFIG_SCHED_TICKLESS
+  bool       reassess;
+#endif
   int        ret = ERROR;
 
   /* Prohibit timer interactions with the timer queue until the
@@ -105,6 +110,16 @@ int wd_cancel (WDOG_ID wdid)
 
   if (wdid && wdid->active)
     {
+#ifdef CONFIG_WDOG_WHEEL
+      /* Unhash the watchdog from its timer wheel slot.  This is O(1),
+       * independent of the number of active watchdogs.
+       */
+
+      wd_wheel_remove(wdid);
+#ifdef CONFIG_SCHED_TICKLESS
+      reassess = true;
+#endif
+#else
       /* Search the g_wdactivelist for the target FCB.  We can't use sq_rem
        * to do this because there are additional operations that need to be
        * done.
@@ -134,6 +149,14 @@ int wd_cancel (WDOG_ID wdid)
           curr->next->lag += curr->lag;
         }
 
+#ifdef CONFIG_SCHED_TICKLESS
+      /* If the watchdog was the next to expire, then the one-shot timer
+       * must be re-programmed (after it has been removed from the list).
+       */
+
+      reassess = (prev == NULL);
+#endif
+
       /* Now, remove the watchdog from the timer queue */
 
       if (prev)
@@ -146,6 +169,7 @@ int wd_cancel (WDOG_ID wdid)
         }
 
       wdid->next = NULL;
+#endif /* CONFIG_WDOG_WHEEL */
 
       /* Return success */
 
@@ -154,6 +178,13 @@ int wd_cancel (WDOG_ID wdid)
       /* Mark the watchdog inactive */
 
       wdid->active = false;
+
+#ifdef CONFIG_SCHED_TICKLESS
+      if (reassess)
+        {
+          sched_timer_reassess();
+        }
+#endif
     }
 
   irqrestore(saved_state);
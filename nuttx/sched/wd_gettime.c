@@ -95,6 +95,24 @@ int wd_gettime(WDOG_ID wdog)
   flags = irqsave();
   if (wdog && wdog->active)
     {
+#ifdef CONFIG_WDOG_WHEEL
+      /* The expiration time is kept in the watchdog.  The +1 matches the
+       * lag that would have been accumulated from the list.
+       */
+
+      int delay = (int)(wdog->expire - g_wdnext) + 1;
+
+#ifdef CONFIG_SCHED_TICKLESS
+      delay -= sched_timer_elapsed();
+      if (delay <= 0)
+        {
+          delay = 1;
+        }
+#endif
+
+      irqrestore(flags);
+      return delay;
+#else
       /* Traverse the watchdog list accumulating lag times until we find the wdog
        * that we are looking for
        */
@@ -107,10 +125,22 @@ int wd_gettime(WDOG_ID wdog)
           delay += curr->lag;
           if (curr == wdog)
             {
+#ifdef CONFIG_SCHED_TICKLESS
+              /* The lags are relative to the time that the elapsed time
+               * was last accounted for.  Remove the time elapsed since then.
+               */
+
+              delay -= sched_timer_elapsed();
+              if (delay <= 0)
+                {
+                  delay = 1;
+                }
+#endif
               irqrestore(flags);
               return delay;
             }
         }
+#endif
     }
 
   irqrestore(flags);
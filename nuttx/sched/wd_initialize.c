@@ -69,12 +69,14 @@ sq_queue_t g_wdfreelist;
 
 FAR wdog_t *g_wdpool;
 
+#ifndef CONFIG_WDOG_WHEEL
 /* The g_wdactivelist data structure is a singly linked list ordered by
  * watchdog expiration time. When watchdog timers expire,the functions on
  * this linked list are removed and the function is called.
  */
 
 sq_queue_t g_wdactivelist;
+#endif
 
 /************************************************************************
  * Private Variables
@@ -129,7 +131,11 @@ void wd_initialize(void)
         }
     }
 
-  /* The g_wdactivelist queue must be reset at initialization time. */
+  /* The active watchdog queue must be reset at initialization time. */
 
+#ifdef CONFIG_WDOG_WHEEL
+  wd_wheel_initialize();
+#else
   sq_init(&g_wdactivelist);
+#endif
 }
@@ -44,6 +44,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <queue.h>
 #include <wdog.h>
 
 #include <nuttx/compiler.h>
@@ -52,6 +53,20 @@
  * Pre-processor Definitions
  ************************************************************************/
 
+/* Timer wheel geometry.  Each level of the wheel has WHEEL_SLOTS slots.
+ * A slot at level n holds the watchdogs that expire within the same
+ * WHEEL_SLOTS**n ticks.  WHEEL_LEVELS levels cover the full 32-bit range
+ * of the system timer.
+ */
+
+#ifdef CONFIG_WDOG_WHEEL
+#  define WHEEL_BITS      4
+#  define WHEEL_SLOTS     (1 << WHEEL_BITS)
+#  define WHEEL_MASK      (WHEEL_SLOTS - 1)
+#  define WHEEL_LEVELS    (32 / WHEEL_BITS)
+#  define WHEEL_SHIFT(l)  ((l) * WHEEL_BITS)
+#endif
+
 /************************************************************************
  * Public Type Declarations
  ************************************************************************/
@@ -63,11 +78,19 @@
 struct wdog_s
 {
   FAR struct wdog_s *next;       /* Support for singly linked lists. */
+#ifdef CONFIG_WDOG_WHEEL
+  FAR struct wdog_s *prev;       /* Support for doubly linked lists. */
+#endif
   wdentry_t          func;       /* Function to execute when delay expires */
 #ifdef CONFIG_PIC
   FAR void          *picbase;    /* PIC base address */
 #endif
+#ifdef CONFIG_WDOG_WHEEL
+  uint32_t           expire;     /* Tick at which the watchdog expires */
+  uint8_t            slot;       /* Timer wheel slot holding the watchdog */
+#else
   int                lag;        /* Timer associated with the delay */
+#endif
   bool               active;     /* true if the watchdog is actively timing */
   uint8_t            argc;       /* The number of parameters to pass */
   uint32_t           parm[CONFIG_MAX_WDOGPARMS];
@@ -90,12 +113,21 @@ extern sq_queue_t g_wdfreelist;
 
 extern FAR wdog_t *g_wdpool;
 
+#ifdef CONFIG_WDOG_WHEEL
+/* g_wdnext is the next tick that the timer wheel will process.  The
+ * expiration times of the watchdogs in the timer wheel are relative to
+ * this time.
+ */
+
+extern uint32_t g_wdnext;
+#else
 /* The g_wdactivelist data structure is a singly linked list ordered by
  * watchdog expiration time. When watchdog timers expire,the functions on
  * this linked list are removed and the function is called.
  */
 
 extern sq_queue_t g_wdactivelist;
+#endif
 
 /************************************************************************
  * Public Function Prototypes
@@ -109,7 +141,19 @@ extern "C" {
 #endif
 
 EXTERN void weak_function wd_initialize(void);
+#ifdef CONFIG_SCHED_TICKLESS
+EXTERN void weak_function wd_timer(int ticks);
+EXTERN int  wd_nextdelay(void);
+#else
 EXTERN void weak_function wd_timer(void);
+#endif
+EXTERN void wd_expiration(FAR wdog_t *wdog);
+
+#ifdef CONFIG_WDOG_WHEEL
+EXTERN void wd_wheel_initialize(void);
+EXTERN void wd_wheel_add(FAR wdog_t *wdog, int delay);
+EXTERN void wd_wheel_remove(FAR wdog_t *wdog);
+#endif
 
 #undef EXTERN
 #ifdef __cplusplus
@@ -42,6 +42,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <limits.h>
 #include <wdog.h>
 #include <unistd.h>
 #include <sched.h>
@@ -128,10 +129,14 @@ typedef void (*wdentry4_t)(int argc, uint32_t arg1, uint32_t arg2,
 int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
 {
   va_list    ap;
+#ifndef CONFIG_WDOG_WHEEL
   FAR wdog_t *curr;
   FAR wdog_t *prev;
   FAR wdog_t *next;
+#endif
+#if !defined(CONFIG_WDOG_WHEEL) || defined(CONFIG_SCHED_TICKLESS)
   int32_t    now;
+#endif
   irqstate_t saved_state;
   int        i;
 
@@ -185,6 +190,34 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
       delay--;
     }
 
+#ifdef CONFIG_SCHED_TICKLESS
+  /* In the tickless mode, the lags in the timer queue are relative to the
+   * time that the elapsed time was last accounted for, not to the current
+   * time.  Add the ticks that have elapsed since then to the delay.
+   */
+
+  now = sched_timer_elapsed();
+  if (delay <= INT_MAX - now)
+    {
+      delay += now;
+    }
+#endif
+
+#ifdef CONFIG_WDOG_WHEEL
+  /* Hash the watchdog into the timer wheel.  This is O(1), independent
+   * of the number of active watchdogs.
+   */
+
+  wd_wheel_add(wdog, delay);
+  wdog->active = true;
+
+#ifdef CONFIG_SCHED_TICKLESS
+  /* The new watchdog may be the next to expire */
+
+  sched_timer_reassess();
+#endif
+
+#else
   /* Do the easy case first -- when the watchdog timer queue is empty. */
 
   if (g_wdactivelist.head == NULL)
@@ -268,10 +301,117 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
   wdog->lag = delay;
   wdog->active = true;
 
+#ifdef CONFIG_SCHED_TICKLESS
+  /* If the new watchdog is now the next to expire, then the one-shot timer
+   * must be re-programmed.
+   */
+
+  if ((FAR wdog_t*)g_wdactivelist.head == wdog)
+    {
+      sched_timer_reassess();
+    }
+#endif
+#endif /* CONFIG_WDOG_WHEEL */
+
   irqrestore(saved_state);
   return OK;
 }
 
+/****************************************************************************
+ * Name: wd_expiration
+ *
+ * Description:
+ *   Execute the function of a watchdog that has expired.  The watchdog has
+ *   already been removed from the timer queue and marked inactive by the
+ *   caller.
+ *
+ * Parameters:
+ *   wdog - The expired watchdog
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from the timer interrupt handler with interrupts disabled.
+ *
+ ****************************************************************************/
+
+void wd_expiration(FAR wdog_t *wdog)
+{
+  /* Execute the watchdog function */
+
+  up_setpicbase(wdog->picbase);
+  switch (wdog->argc)
+    {
+      default:
+#ifdef CONFIG_DEBUG
+        PANIC();
+#endif
+      case 0:
+        (*((wdentry0_t)(wdog->func)))(0);
+        break;
+
+#if CONFIG_MAX_WDOGPARMS > 0
+      case 1:
+        (*((wdentry1_t)(wdog->func)))(1, wdog->parm[0]);
+        break;
+#endif
+#if CONFIG_MAX_WDOGPARMS > 1
+      case 2:
+        (*((wdentry2_t)(wdog->func)))(2,
+                        wdog->parm[0], wdog->parm[1]);
+        break;
+#endif
+#if CONFIG_MAX_WDOGPARMS > 2
+      case 3:
+        (*((wdentry3_t)(wdog->func)))(3,
+                        wdog->parm[0], wdog->parm[1],
+                        wdog->parm[2]);
+        break;
+#endif
+#if CONFIG_MAX_WDOGPARMS > 3
+      case 4:
+        (*((wdentry4_t)(wdog->func)))(4,
+                        wdog->parm[0], wdog->parm[1],
+                        wdog->parm[2] ,wdog->parm[3]);
+        break;
+#endif
+    }
+}
+
+/****************************************************************************
+ * Name: wd_nextdelay
+ *
+ * Description:
+ *   Return the number of ticks, relative to the time when the elapsed time
+ *   was last accounted for, until the next watchdog expires.  This is used
+ *   to program the one-shot timer in the tickless mode.
+ *
+ * Parameters:
+ *   None
+ *
+ * Return Value:
+ *   The delay in ticks (>= 1) or zero if there are no active watchdogs.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_SCHED_TICKLESS) && !defined(CONFIG_WDOG_WHEEL)
+int wd_nextdelay(void)
+{
+  FAR wdog_t *wdog = (FAR wdog_t*)g_wdactivelist.head;
+
+  if (wdog == NULL)
+    {
+      return 0;
+    }
+
+  return wdog->lag > 0 ? wdog->lag : 1;
+}
+#endif
+
 /****************************************************************************
  * Name: wd_timer
  *
@@ -280,8 +420,13 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
  *   if it is time to execute a watchdog function.  If so, the watchdog
  *   function will be executed in the context of the timer interrupt handler.
  *
+ *   If CONFIG_WDOG_WHEEL is selected, wd_timer() is provided by wd_wheel.c
+ *   instead.
+ *
  * Parameters:
- *   None
+ *   ticks - If CONFIG_SCHED_TICKLESS is selected, this is the number of
+ *     ticks that have elapsed since the last call.  Otherwise, exactly one
+ *     tick has elapsed and there is no parameter.
  *
  * Return Value:
  *   None
@@ -290,7 +435,12 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
  *
  ****************************************************************************/
 
+#ifndef CONFIG_WDOG_WHEEL
+#ifdef CONFIG_SCHED_TICKLESS
+void wd_timer(int ticks)
+#else
 void wd_timer(void)
+#endif
 {
   FAR wdog_t *wdog;
 
@@ -298,9 +448,17 @@ void wd_timer(void)
 
   if (g_wdactivelist.head)
     {
-      /* There are.  Decrement the lag counter */
+      /* There are.  Decrement the lag counter.  In the tickless mode, more
+       * than one tick may have elapsed; any excess is carried into the
+       * lag of the following watchdogs as each expired watchdog is removed
+       * below.
+       */
 
+#ifdef CONFIG_SCHED_TICKLESS
+      ((FAR wdog_t*)g_wdactivelist.head)->lag -= ticks;
+#else
       --(((FAR wdog_t*)g_wdactivelist.head)->lag);
+#endif
 
       /* Check if the watchdog at the head of the list is ready to run */
 
@@ -326,50 +484,14 @@ void wd_timer(void)
                   ((FAR wdog_t*)g_wdactivelist.head)->lag += wdog->lag;
                 }
 
-              /* Indicate that the watchdog is no longer active. */
+              /* Indicate that the watchdog is no longer active and execute
+               * the watchdog function.
+               */
 
               wdog->active = false;
-
-              /* Execute the watchdog function */
-
-              up_setpicbase(wdog->picbase);
-              switch (wdog->argc)
-                {
-                  default:
-#ifdef CONFIG_DEBUG
-                    PANIC();
-#endif
-                  case 0:
-                    (*((wdentry0_t)(wdog->func)))(0);
-                    break;
-
-#if CONFIG_MAX_WDOGPARMS > 0
-                  case 1:
-                    (*((wdentry1_t)(wdog->func)))(1, wdog->parm[0]);
-                    break;
-#endif
-#if CONFIG_MAX_WDOGPARMS > 1
-                  case 2:
-                    (*((wdentry2_t)(wdog->func)))(2,
-                                    wdog->parm[0], wdog->parm[1]);
-                    break;
-#endif
-#if CONFIG_MAX_WDOGPARMS > 2
-                  case 3:
-                    (*((wdentry3_t)(wdog->func)))(3,
-                                    wdog->parm[0], wdog->parm[1],
-                                    wdog->parm[2]);
-                    break;
-#endif
-#if CONFIG_MAX_WDOGPARMS > 3
-                  case 4:
-                    (*((wdentry4_t)(wdog->func)))(4,
-                                    wdog->parm[0], wdog->parm[1],
-                                    wdog->parm[2] ,wdog->parm[3]);
-                    break;
-#endif
-                }
+              wd_expiration(wdog);
             }
         }
     }
 }
+#endif /* !CONFIG_WDOG_WHEEL */
@@ -0,0 +1,478 @@
+/****************************************************************************
+ * sched/wd_wheel.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+#include <wdog.h>
+
+#include "os_internal.h"
+#include "wd_internal.h"
+
+#ifdef CONFIG_WDOG_WHEEL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Find the first set bit in a (non-zero) slot bitmap */
+
+#ifdef __GNUC__
+#  define wd_ctz(b) __builtin_ctz(b)
+#endif
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/****************************************************************************
+ * Global Variables
+ ****************************************************************************/
+
+/* g_wdnext is the next tick that the timer wheel will process.  The
+ * expiration times of the watchdogs in the timer wheel are relative to
+ * this time.
+ */
+
+uint32_t g_wdnext;
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* The timer wheel.  Level n of the wheel is g_wdwheel[n * WHEEL_SLOTS]
+ * through g_wdwheel[(n + 1) * WHEEL_SLOTS - 1].  Each slot holds an
+ * unordered, doubly linked list of watchdogs so that a watchdog can be
+ * removed without searching for it.
+ */
+
+static dq_queue_t g_wdwheel[WHEEL_LEVELS * WHEEL_SLOTS];
+
+/* One bit for each non-empty slot at each level of the wheel */
+
+static uint16_t g_wdbitmap[WHEEL_LEVELS];
+
+/* In the tickless mode, the delays passed to wd_start() from a watchdog
+ * function are relative to the end of the interval being processed by
+ * wd_timer(), not to the tick being processed.  This is the difference.
+ */
+
+#ifdef CONFIG_SCHED_TICKLESS
+static uint32_t g_wdbias;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_ctz
+ *
+ * Description:
+ *   Return the number of the least significant set bit of a non-zero
+ *   bitmap (for compilers without a count-trailing-zeroes built-in).
+ *
+ ****************************************************************************/
+
+#ifndef wd_ctz
+static inline int wd_ctz(uint32_t bitmap)
+{
+  int bit = 0;
+
+  while ((bitmap & 1) == 0)
+    {
+      bitmap >>= 1;
+      bit++;
+    }
+
+  return bit;
+}
+#endif
+
+/****************************************************************************
+ * Name: wd_wheel_insert
+ *
+ * Description:
+ *   Hash a watchdog into the slot of the timer wheel that corresponds to
+ *   its expiration time.  The level is selected so that the slot will be
+ *   reached within one revolution of that level: a slot at level n is
+ *   cascaded into the lower levels when the low 4*n bits of the time are
+ *   zero.
+ *
+ ****************************************************************************/
+
+static void wd_wheel_insert(FAR wdog_t *wdog)
+{
+  uint32_t delta = wdog->expire - g_wdnext;
+  int level;
+  int idx;
+
+  /* Watchdogs that are already due expire on the next tick processed */
+
+  if ((int32_t)delta < 0)
+    {
+      wdog->expire = g_wdnext;
+      delta = 0;
+    }
+
+  for (level = 0; level < WHEEL_LEVELS - 1; level++)
+    {
+      if ((delta >> WHEEL_SHIFT(level + 1)) == 0)
+        {
+          break;
+        }
+    }
+
+  idx = (wdog->expire >> WHEEL_SHIFT(level)) & WHEEL_MASK;
+
+  wdog->slot = level * WHEEL_SLOTS + idx;
+  dq_addlast((FAR dq_entry_t*)wdog, &g_wdwheel[wdog->slot]);
+  g_wdbitmap[level] |= (1 << idx);
+}
+
+/****************************************************************************
+ * Name: wd_wheel_cascade
+ *
+ * Description:
+ *   Move all of the watchdogs in one slot of a higher level of the wheel
+ *   into the lower levels.
+ *
+ ****************************************************************************/
+
+static void wd_wheel_cascade(int slot)
+{
+  FAR wdog_t *wdog = (FAR wdog_t*)g_wdwheel[slot].head;
+  FAR wdog_t *next;
+
+  dq_init(&g_wdwheel[slot]);
+  g_wdbitmap[slot / WHEEL_SLOTS] &= ~(1 << (slot & WHEEL_MASK));
+
+  for (; wdog; wdog = next)
+    {
+      next = wdog->next;
+      wd_wheel_insert(wdog);
+    }
+}
+
+/****************************************************************************
+ * Name: wd_wheel_tick
+ *
+ * Description:
+ *   Process the tick g_wdnext:  Cascade the higher levels of the wheel as
+ *   necessary, then expire all of the watchdogs in the level 0 slot.
+ *
+ ****************************************************************************/
+
+static void wd_wheel_tick(void)
+{
+  uint32_t now = g_wdnext;
+  FAR dq_queue_t *queue;
+  FAR wdog_t *wdog;
+  int level;
+  int idx;
+
+  /* Level n is cascaded each time that level n-1 wraps around to slot 0 */
+
+  for (level = 1; level < WHEEL_LEVELS; level++)
+    {
+      if (((now >> WHEEL_SHIFT(level - 1)) & WHEEL_MASK) != 0)
+        {
+          break;
+        }
+
+      wd_wheel_cascade(level * WHEEL_SLOTS +
+                       ((now >> WHEEL_SHIFT(level)) & WHEEL_MASK));
+    }
+
+  /* Advance the time before running the watchdog functions so that any
+   * watchdogs that they start are relative to the next tick.
+   */
+
+  g_wdnext = now + 1;
+
+  /* Every watchdog in the level 0 slot expires now.  Watchdogs started by
+   * the watchdog functions may be added to the end of the same slot but
+   * those will not expire until a later revolution.  A watchdog function
+   * may also cancel any of the others so they are removed one at a time.
+   */
+
+  idx   = now & WHEEL_MASK;
+  queue = &g_wdwheel[idx];
+
+  while ((wdog = (FAR wdog_t*)queue->head) != NULL && wdog->expire == now)
+    {
+      (void)dq_remfirst(queue);
+      if (queue->head == NULL)
+        {
+          g_wdbitmap[0] &= ~(1 << idx);
+        }
+
+      /* Indicate that the watchdog is no longer active and execute the
+       * watchdog function.
+       */
+
+      wdog->active = false;
+      wd_expiration(wdog);
+    }
+}
+
+/****************************************************************************
+ * Name: wd_wheel_nextevent
+ *
+ * Description:
+ *   Return the number of ticks from g_wdnext until the next tick when
+ *   the wheel has work to do:  Either a level 0 slot with watchdogs that
+ *   expire or a higher level slot that must be cascaded.
+ *
+ * Return Value:
+ *   true if the wheel is not empty; the delay is returned in *delta.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+static bool wd_wheel_nextevent(FAR uint32_t *delta)
+{
+  uint32_t now = g_wdnext;
+  uint32_t bitmap;
+  uint32_t first;
+  uint32_t event;
+  bool found = false;
+  int shift;
+  int level;
+  int idx;
+
+  for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+      bitmap = g_wdbitmap[level];
+      if (bitmap == 0)
+        {
+          continue;
+        }
+
+      /* The first time, at or after now, that level visits a slot.  Then
+       * rotate the bitmap so that bit 0 corresponds to that slot and find
+       * the first non-empty slot from there.
+       */
+
+      shift = WHEEL_SHIFT(level);
+      first = level == 0 ? now : ((now - 1) >> shift) + 1;
+      idx   = first & WHEEL_MASK;
+
+      bitmap = ((bitmap >> idx) | (bitmap << (WHEEL_SLOTS - idx))) &
+               ((1 << WHEEL_SLOTS) - 1);
+
+      event = ((first + wd_ctz(bitmap)) << shift) - now;
+      if (!found || event < *delta)
+        {
+          *delta = event;
+          found  = true;
+        }
+    }
+
+  return found;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_wheel_initialize
+ *
+ * Description:
+ *   Initialize the timer wheel.  Called from wd_initialize().
+ *
+ ****************************************************************************/
+
+void wd_wheel_initialize(void)
+{
+  int i;
+
+  for (i = 0; i < WHEEL_LEVELS * WHEEL_SLOTS; i++)
+    {
+      dq_init(&g_wdwheel[i]);
+    }
+
+  for (i = 0; i < WHEEL_LEVELS; i++)
+    {
+      g_wdbitmap[i] = 0;
+    }
+
+  g_wdnext = 0;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_add
+ *
+ * Description:
+ *   Add a watchdog to the timer wheel.
+ *
+ * Parameters:
+ *   wdog  - The watchdog to add
+ *   delay - The delay in ticks, plus one (the same as the lag of the first
+ *           watchdog of the timer queue when the list is used)
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void wd_wheel_add(FAR wdog_t *wdog, int delay)
+{
+#ifdef CONFIG_SCHED_TICKLESS
+  wdog->expire = g_wdnext + g_wdbias + (uint32_t)delay - 1;
+#else
+  wdog->expire = g_wdnext + (uint32_t)delay - 1;
+#endif
+  wd_wheel_insert(wdog);
+}
+
+/****************************************************************************
+ * Name: wd_wheel_remove
+ *
+ * Description:
+ *   Remove an active watchdog from the timer wheel.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void wd_wheel_remove(FAR wdog_t *wdog)
+{
+  FAR dq_queue_t *queue = &g_wdwheel[wdog->slot];
+
+  dq_rem((FAR dq_entry_t*)wdog, queue);
+  if (queue->head == NULL)
+    {
+      g_wdbitmap[wdog->slot / WHEEL_SLOTS] &=
+        ~(1 << (wdog->slot & WHEEL_MASK));
+    }
+
+  wdog->next = NULL;
+  wdog->prev = NULL;
+}
+
+/****************************************************************************
+ * Name: wd_nextdelay
+ *
+ * Description:
+ *   Return the number of ticks, relative to the time when the elapsed time
+ *   was last accounted for, until the timer wheel next has work to do.
+ *   This is used to program the one-shot timer in the tickless mode.
+ *
+ *   NOTE:  This may be a tick on which a slot of a higher level of the
+ *   wheel is only cascaded into the lower levels.  That costs a wakeup
+ *   without any watchdog expiring, at most one per level of the wheel for
+ *   each watchdog.
+ *
+ * Return Value:
+ *   The delay in ticks (>= 1) or zero if there are no active watchdogs.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+int wd_nextdelay(void)
+{
+  uint32_t delta;
+
+  if (!wd_wheel_nextevent(&delta))
+    {
+      return 0;
+    }
+
+  return delta < INT32_MAX ? (int)delta + 1 : INT32_MAX;
+}
+#endif
+
+/****************************************************************************
+ * Name: wd_timer
+ *
+ * Description:
+ *   This function is called from the timer interrupt handler to determine
+ *   if it is time to execute a watchdog function.  If so, the watchdog
+ *   function will be executed in the context of the timer interrupt handler.
+ *
+ * Parameters:
+ *   ticks - If CONFIG_SCHED_TICKLESS is selected, this is the number of
+ *     ticks that have elapsed since the last call.  Otherwise, exactly one
+ *     tick has elapsed and there is no parameter.
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from the timer interrupt handler with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+void wd_timer(int ticks)
+{
+  uint32_t end = g_wdnext + (uint32_t)ticks;
+  uint32_t delta;
+
+  /* Skip directly to each tick in the elapsed interval when the wheel has
+   * work to do.
+   */
+
+  while (wd_wheel_nextevent(&delta) && delta < end - g_wdnext)
+    {
+      g_wdnext += delta;
+      g_wdbias  = end - g_wdnext - 1;
+      wd_wheel_tick();
+    }
+
+  g_wdnext = end;
+  g_wdbias = 0;
+}
+#else
+void wd_timer(void)
+{
+  wd_wheel_tick();
+}
+#endif
+
+#endif /* CONFIG_WDOG_WHEEL */
@@ -192,6 +192,8 @@ SYSCALL_LOOKUP(up_assert,                 2, STUB_up_assert)
   SYSCALL_LOOKUP(rmdir,                   1, STUB_rmdir)
   SYSCALL_LOOKUP(umount,                  1, STUB_umount)
   SYSCALL_LOOKUP(unlink,                  1, STUB_unlink)
+  SYSCALL_LOOKUP(ftruncate,               2, STUB_ftruncate)
+  SYSCALL_LOOKUP(fallocate,               4, STUB_fallocate)
 #  endif
 #endif
 
@@ -207,6 +207,9 @@ uintptr_t STUB_rename(int nbr, uintptr_t parm1, uintptr_t parm2);
 uintptr_t STUB_rmdir(int nbr, uintptr_t parm1);
 uintptr_t STUB_umount(int nbr, uintptr_t parm1);
 uintptr_t STUB_unlink(int nbr, uintptr_t parm1);
+uintptr_t STUB_ftruncate(int nbr, uintptr_t parm1, uintptr_t parm2);
+uintptr_t STUB_fallocate(int nbr, uintptr_t parm1, uintptr_t parm2,
+            uintptr_t parm3, uintptr_t parm4);
 
 /* The following are defined if pthreads are enabled */
 
@@ -0,0 +1,270 @@
+#!/usr/bin/env python
+############################################################################
+# tools/mmdump.py
+#
+#   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+#   Author: Gregory Nutt <gnutt@nuttx.org>
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in
+#    the documentation and/or other materials provided with the
+#    distribution.
+# 3. Neither the name NuttX nor the names of its contributors may be
+#    used to endorse or promote products derived from this software
+#    without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+# AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+############################################################################
+
+# Decode and compare the binary heap dumps written by the NSH command
+# 'heapinfo -d <dump-file>' (see apps/nshlib/nsh_mmcmds.c for the format).
+#
+#   mmdump.py [options] <dump-file>
+#       Show the heap usage, the size class histograms and the callers that
+#       hold the most memory.
+#
+#   mmdump.py [options] <old-dump-file> <new-dump-file>
+#       Show how the heap changed between two dumps:  The change in each
+#       size class and the callers whose allocations grew the most.
+
+import argparse
+import struct
+import subprocess
+import sys
+
+HEAPINFO_MAGIC = 0x4e584d4d
+HEAPINFO_VERSION = 1
+
+HEAPINFO_FLAG_CALLERPC = 1 << 0
+HEAPINFO_FLAG_TRUNCATED = 1 << 1
+
+HEAPINFO_CHUNK_ALLOC = 1 << 0
+
+HEADER_WORDS = 10
+CLASS_WORDS = 4
+CHUNK_WORDS = 5
+
+class HeapDump(object):
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            data = f.read()
+
+        if len(data) < 4 * HEADER_WORDS:
+            raise ValueError('%s: file is too short' % path)
+
+        # The dump is in the byte order of the target.  Use the magic
+        # number to find out which that is.
+
+        for order in ('<', '>'):
+            if struct.unpack(order + 'I', data[0:4])[0] == HEAPINFO_MAGIC:
+                break
+        else:
+            raise ValueError('%s: not a heap dump' % path)
+
+        def words(offset, count):
+            return struct.unpack(order + '%dI' % count,
+                                 data[offset:offset + 4 * count])
+
+        hdr = words(0, HEADER_WORDS)
+        if hdr[1] != HEAPINFO_VERSION:
+            raise ValueError('%s: unsupported version %d' % (path, hdr[1]))
+
+        self.path = path
+        self.flags = hdr[2]
+        self.minshift = hdr[3]
+        self.nnodes = hdr[4]
+        self.heapsize = hdr[5]
+        self.used = hdr[6]
+        self.peak = hdr[7]
+        nchunks = hdr[8]
+        self.timestamp = hdr[9]
+
+        expected = 4 * (HEADER_WORDS + CLASS_WORDS * self.nnodes +
+                        CHUNK_WORDS * nchunks)
+        if len(data) < expected:
+            raise ValueError('%s: file is truncated' % path)
+
+        offset = 4 * HEADER_WORDS
+        self.classes = []
+        for i in range(self.nnodes):
+            self.classes.append(words(offset, CLASS_WORDS))
+            offset += 4 * CLASS_WORDS
+
+        self.chunks = []
+        for i in range(nchunks):
+            addr, size, flags, pc, reqsize = words(offset, CHUNK_WORDS)
+            self.chunks.append((addr, size, (flags & HEAPINFO_CHUNK_ALLOC) != 0,
+                                pc, reqsize))
+            offset += 4 * CHUNK_WORDS
+
+    def has_callers(self):
+        return (self.flags & HEAPINFO_FLAG_CALLERPC) != 0
+
+    def classsize(self, ndx):
+        return 1 << (self.minshift + ndx)
+
+    def freestats(self):
+        free = [c[1] for c in self.chunks if not c[2]]
+        return sum(free), max(free) if free else 0
+
+    def callers(self):
+        """Return {callerpc: [count, bytes, requested bytes]} for all
+        allocated chunks."""
+
+        result = {}
+        for addr, size, allocated, pc, reqsize in self.chunks:
+            if allocated:
+                entry = result.setdefault(pc, [0, 0, 0])
+                entry[0] += 1
+                entry[1] += size
+                entry[2] += reqsize
+        return result
+
+class Symbolizer(object):
+    def __init__(self, elf, addr2line):
+        self.elf = elf
+        self.addr2line = addr2line
+        self.cache = {0: '(untagged)'}
+
+    def lookup(self, addrs):
+        addrs = [a for a in addrs if a not in self.cache]
+        if not addrs:
+            return
+        if not self.elf:
+            for a in addrs:
+                self.cache[a] = '0x%08x' % a
+            return
+
+        # The return address is the instruction after the call; look up the
+        # call itself.
+
+        args = [self.addr2line, '-f', '-e', self.elf]
+        args += ['0x%x' % (a - 1) for a in addrs]
+        output = subprocess.check_output(args).decode().splitlines()
+        for i, a in enumerate(addrs):
+            func = output[2 * i].strip()
+            line = output[2 * i + 1].strip().split('/')[-1]
+            self.cache[a] = '0x%08x %s (%s)' % (a, func, line)
+
+    def name(self, addr):
+        return self.cache[addr]
+
+def show_header(dump):
+    total, largest = dump.freestats()
+    print('%s:' % dump.path)
+    print('  Heap size: %10d' % dump.heapsize)
+    print('  Used:      %10d' % dump.used)
+    print('  Peak:      %10d' % dump.peak)
+    print('  Free:      %10d  (largest %d)' % (total, largest))
+    if total > 0:
+        print('  Fragmentation: %d%%' % (100 - (100 * largest) // total))
+    if dump.flags & HEAPINFO_FLAG_TRUNCATED:
+        print('  WARNING: Not all chunks were saved')
+
+def show_dump(dump, symbols, count):
+    show_header(dump)
+
+    print('')
+    print('     size     allocs      bytes      frees      bytes')
+    for ndx, (nalloc, abytes, nfree, fbytes) in enumerate(dump.classes):
+        if nalloc or nfree:
+            print('%9d%11d%11d%11d%11d' %
+                  (dump.classsize(ndx), nalloc, abytes, nfree, fbytes))
+
+    if not dump.has_callers():
+        return
+
+    callers = sorted(dump.callers().items(), key=lambda e: -e[1][1])
+    callers = callers[:count]
+    symbols.lookup([pc for pc, _ in callers])
+
+    print('')
+    print('   allocs      bytes  requested  caller')
+    for pc, (n, size, reqsize) in callers:
+        print('%9d%11d%11d  %s' % (n, size, reqsize, symbols.name(pc)))
+
+def show_diff(old, new, symbols, count):
+    show_header(old)
+    show_header(new)
+    if new.timestamp >= old.timestamp:
+        print('  %d seconds later' % (new.timestamp - old.timestamp))
+
+    print('')
+    print('     size     allocs      bytes      frees      bytes')
+    for ndx in range(min(old.nnodes, new.nnodes)):
+        delta = [n - o for o, n in zip(old.classes[ndx], new.classes[ndx])]
+        if any(delta):
+            print('%9d%+11d%+11d%+11d%+11d' %
+                  tuple([new.classsize(ndx)] + delta))
+
+    if not (old.has_callers() and new.has_callers()):
+        return
+
+    oldcallers = old.callers()
+    newcallers = new.callers()
+    changes = []
+    for pc in set(oldcallers) | set(newcallers):
+        o = oldcallers.get(pc, [0, 0, 0])
+        n = newcallers.get(pc, [0, 0, 0])
+        if o != n:
+            changes.append((pc, n[0] - o[0], n[1] - o[1]))
+
+    changes.sort(key=lambda e: -e[2])
+    changes = changes[:count]
+    symbols.lookup([pc for pc, _, _ in changes])
+
+    print('')
+    print('   allocs      bytes  caller')
+    for pc, n, size in changes:
+        print('%+9d%+11d  %s' % (n, size, symbols.name(pc)))
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Decode or compare NuttX heap dumps')
+    parser.add_argument('-e', '--elf',
+                        help='ELF file used to convert caller addresses '
+                             'to function names')
+    parser.add_argument('-a', '--addr2line', default='addr2line',
+                        help='addr2line program for the target '
+                             '(default: addr2line)')
+    parser.add_argument('-n', '--count', type=int, default=20,
+                        help='number of callers to show (default: 20)')
+    parser.add_argument('dumps', nargs='+', metavar='dump-file')
+    args = parser.parse_args()
+
+    if len(args.dumps) > 2:
+        parser.error('at most two dump files may be given')
+
+    try:
+        dumps = [HeapDump(path) for path in args.dumps]
+    except (IOError, ValueError) as e:
+        sys.stderr.write('mmdump.py: %s\n' % e)
+        return 1
+
+    symbols = Symbolizer(args.elf, args.addr2line)
+    if len(dumps) == 1:
+        show_dump(dumps[0], symbols, args.count)
+    else:
+        show_diff(dumps[0], dumps[1], symbols, args.count)
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
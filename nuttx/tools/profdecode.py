@@ -0,0 +1,195 @@
+#!/usr/bin/env python
+############################################################################
+# tools/profdecode.py
+#
+#   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+#   Author: Gregory Nutt <gnutt@nuttx.org>
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in
+#    the documentation and/or other materials provided with the
+#    distribution.
+# 3. Neither the name NuttX nor the names of its contributors may be
+#    used to endorse or promote products derived from this software
+#    without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+# AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+
+# Convert the sampling profiler dumps printed by the NSH command 'prof dump'
+# (see apps/nshlib/nsh_proccmds.c and include/nuttx/sched_profile.h for the
+# format) into a flat profile.  Capture the console output of the command
+# to a file on the host; any other lines in the capture are ignored.
+#
+#   profdecode.py -e nuttx [options] [<capture-file>]
+#       Show the share of the samples that hit each function and each
+#       task.  Without -e, the raw program counters are counted instead.
+
+import argparse
+import bisect
+import subprocess
+import sys
+
+class Profile(object):
+    """One 'prof dump' parsed from a console capture."""
+
+    def __init__(self, lines):
+        self.usecpersample = None
+        self.overruns = 0
+        self.anchor = 0
+        self.names = {}
+        self.samples = []
+
+        for line in lines:
+            fields = line.strip().split(None, 3)
+            if not fields:
+                continue
+            try:
+                if fields[0] == 'PROFILE' and len(fields) == 4:
+                    self.usecpersample = int(fields[1])
+                    self.overruns = int(fields[2])
+                    self.anchor = int(fields[3], 16)
+                elif fields[0] == 'T' and len(fields) >= 3:
+                    name = fields[3] if len(fields) > 3 else ''
+                    self.names[int(fields[1])] = name
+                elif fields[0] == 'S' and len(fields) == 3:
+                    self.samples.append((int(fields[1], 16),
+                                         int(fields[2])))
+            except ValueError:
+                continue
+
+        if self.usecpersample is None:
+            raise ValueError('no profile dump found')
+
+    def name(self, pid):
+        return '%s(%d)' % (self.names.get(pid, '?'), pid)
+
+class Symbolizer(object):
+    """Map program counters to function names using the symbol table of the
+    ELF file."""
+
+    # The dump gives the run-time address of this function so that the
+    # samples of a position-independent (simulation) build can be relocated
+
+    ANCHOR = 'sched_profile_sample'
+
+    def __init__(self, elf, nm, anchor):
+        self.addrs = []
+        self.syms = []
+        self.bias = 0
+
+        args = [nm, '-n', '-S', '--defined-only', elf]
+        output = subprocess.check_output(args).decode().splitlines()
+        for line in output:
+            fields = line.split()
+            if len(fields) == 4:
+                addr, size, stype, name = fields
+                size = int(size, 16)
+            elif len(fields) == 3:
+                addr, stype, name = fields
+                size = None
+            else:
+                continue
+            if stype not in 'TtWw':
+                continue
+            addr = int(addr, 16)
+            self.addrs.append(addr)
+            self.syms.append((addr, size, name))
+            if name == self.ANCHOR:
+                self.bias = (anchor & ~1) - (addr & ~1)
+
+    def name(self, pc):
+        pc -= self.bias
+        i = bisect.bisect_right(self.addrs, pc) - 1
+        if i < 0:
+            return '(outside ELF)'
+        addr, size, name = self.syms[i]
+        if size is not None and pc >= addr + size:
+            return '(outside ELF)'
+        return name
+
+def show_table(title, counts, total, count):
+    print('  samples      %%   cum%%  %s' % title)
+    cum = 0
+    for key, n in sorted(counts.items(), key=lambda x: (-x[1], x[0]))[:count]:
+        cum += n
+        print('%9d %6.2f %6.2f  %s' % (n, 100.0 * n / total,
+                                       100.0 * cum / total, key))
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Convert a NuttX profiler dump into a flat profile')
+    parser.add_argument('-e', '--elf',
+                        help='ELF file used to convert program counters '
+                             'to function names')
+    parser.add_argument('--nm', default='nm',
+                        help='nm program for the target (default: nm)')
+    parser.add_argument('-n', '--count', type=int, default=30,
+                        help='number of functions to show (default: 30)')
+    parser.add_argument('-p', '--pid', type=int,
+                        help='only count the samples of this task')
+    parser.add_argument('capture', nargs='?', metavar='capture-file',
+                        help='console capture of "prof dump" '
+                             '(default: standard input)')
+    args = parser.parse_args()
+
+    try:
+        if args.capture:
+            with open(args.capture) as f:
+                profile = Profile(f)
+        else:
+            profile = Profile(sys.stdin)
+        symbols = None
+        if args.elf:
+            symbols = Symbolizer(args.elf, args.nm, profile.anchor)
+    except (IOError, OSError, ValueError, subprocess.CalledProcessError) as e:
+        sys.stderr.write('profdecode.py: %s\n' % e)
+        return 1
+
+    samples = profile.samples
+    if args.pid is not None:
+        samples = [s for s in samples if s[1] == args.pid]
+    if not samples:
+        print('The profile is empty')
+        return 0
+
+    total = len(samples)
+    print('%d samples, one every %d usec, %d overruns' %
+          (total, profile.usecpersample, profile.overruns))
+    if profile.overruns:
+        print('NOTE: The buffer was full; the newest samples were lost')
+    print('')
+
+    tasks = {}
+    funcs = {}
+    for pc, pid in samples:
+        name = profile.name(pid)
+        tasks[name] = tasks.get(name, 0) + 1
+        func = symbols.name(pc) if symbols else '0x%08x' % pc
+        funcs[func] = funcs.get(func, 0) + 1
+
+    if args.pid is None:
+        show_table('task', tasks, total, len(tasks))
+        print('')
+    show_table('function' if symbols else 'pc', funcs, total, args.count)
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
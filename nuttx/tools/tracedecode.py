@@ -0,0 +1,294 @@
+#!/usr/bin/env python
+############################################################################
+# tools/tracedecode.py
+#
+#   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+#   Author: Gregory Nutt <gnutt@nuttx.org>
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in
+#    the documentation and/or other materials provided with the
+#    distribution.
+# 3. Neither the name NuttX nor the names of its contributors may be
+#    used to endorse or promote products derived from this software
+#    without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+# AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+############################################################################
+
+# Decode the scheduler trace dumps printed by the NSH command 'trace dump'
+# (see apps/nshlib/nsh_proccmds.c and include/nuttx/sched_trace.h for the
+# format).  Capture the console output of the command to a file on the
+# host; any other lines in the capture are ignored.
+#
+#   tracedecode.py [options] [<capture-file>]
+#       Show the CPU utilisation of each task and of interrupt handlers
+#       over the traced interval and, with -t, a timeline of all events.
+
+import argparse
+import sys
+
+# Event types (SCHED_TRACE_* in include/nuttx/sched_trace.h)
+
+TRACE_START = 0
+TRACE_STOP = 1
+TRACE_SWITCH = 2
+TRACE_IRQENTER = 3
+TRACE_IRQLEAVE = 4
+TRACE_SEMBLOCK = 5
+TRACE_SEMWAKE = 6
+TRACE_MQBLOCK = 7
+TRACE_MQWAKE = 8
+
+class Event(object):
+    def __init__(self, time, etype, pid, priority, arg):
+        self.time = time
+        self.type = etype
+        self.pid = pid
+        self.priority = priority
+        self.arg = arg
+
+class Task(object):
+    def __init__(self, pid, name):
+        self.pid = pid
+        self.name = name
+        self.runtime = 0      # Time running, excluding interrupts
+        self.maxslice = 0     # Longest time running without a switch
+        self.switches = 0     # Number of times switched in
+        self.semblocks = 0
+        self.mqblocks = 0
+
+class Trace(object):
+    """One 'trace dump' parsed from a console capture."""
+
+    def __init__(self, lines):
+        self.usecpertick = None
+        self.overruns = 0
+        self.names = {}
+        self.events = []
+
+        wrap = 0
+        last = None
+        for line in lines:
+            fields = line.strip().split(None, 3)
+            if not fields:
+                continue
+            try:
+                if fields[0] == 'TRACE' and len(fields) == 3:
+                    self.usecpertick = int(fields[1])
+                    self.overruns = int(fields[2])
+                elif fields[0] == 'T' and len(fields) >= 3:
+                    name = fields[3] if len(fields) > 3 else ''
+                    self.names[int(fields[1])] = name
+                elif fields[0] == 'E':
+                    fields = line.split()
+                    if len(fields) != 6:
+                        continue
+
+                    # The 32-bit microsecond time stamps wrap around after
+                    # about 71 minutes
+
+                    time = int(fields[1])
+                    if last is not None and time < last:
+                        wrap += 1 << 32
+                    last = time
+                    self.events.append(Event(time + wrap, int(fields[2]),
+                                             int(fields[3]), int(fields[4]),
+                                             int(fields[5], 16)))
+            except ValueError:
+                continue
+
+        if self.usecpertick is None:
+            raise ValueError('no trace dump found')
+
+    def name(self, pid):
+        return '%s(%d)' % (self.names.get(pid, '?'), pid)
+
+def fmt_usec(usec):
+    return '%d.%03d' % (usec // 1000, usec % 1000)
+
+def show_timeline(trace):
+    start = trace.events[0].time
+    running = None
+    since = start
+
+    print('    msec  event')
+    for e in trace.events:
+        t = fmt_usec(e.time - start)
+        if e.type == TRACE_SWITCH:
+            ran = ''
+            if running is not None:
+                ran = '  (%s ran %s msec)' % (trace.name(running),
+                                             fmt_usec(e.time - since))
+            print('%10s  %s -> %s prio %d%s' %
+                  (t, trace.name(e.arg), trace.name(e.pid), e.priority, ran))
+            running = e.pid
+            since = e.time
+        elif e.type == TRACE_START:
+            print('%10s  %s started, prio %d' % (t, trace.name(e.pid),
+                                                 e.priority))
+        elif e.type == TRACE_STOP:
+            stack = ''
+            if e.arg:
+                stack = ', %d bytes of stack used' % e.arg
+            print('%10s  %s stopped%s' % (t, trace.name(e.pid), stack))
+        elif e.type == TRACE_IRQENTER:
+            print('%10s  irq %d enter (%s)' % (t, e.arg, trace.name(e.pid)))
+        elif e.type == TRACE_IRQLEAVE:
+            print('%10s  irq %d leave (%s)' % (t, e.arg, trace.name(e.pid)))
+        elif e.type == TRACE_SEMBLOCK:
+            print('%10s  %s blocks on sem %08x' % (t, trace.name(e.pid),
+                                                   e.arg))
+        elif e.type == TRACE_SEMWAKE:
+            print('%10s  %s wakes from sem %08x' % (t, trace.name(e.pid),
+                                                    e.arg))
+        elif e.type == TRACE_MQBLOCK:
+            print('%10s  %s blocks on mq %08x' % (t, trace.name(e.pid),
+                                                  e.arg))
+        elif e.type == TRACE_MQWAKE:
+            print('%10s  %s wakes from mq %08x' % (t, trace.name(e.pid),
+                                                   e.arg))
+        else:
+            print('%10s  unknown event %d' % (t, e.type))
+    print('')
+
+def show_utilisation(trace):
+    start = trace.events[0].time
+    end = trace.events[-1].time
+    total = end - start
+
+    tasks = {}
+    def task(pid):
+        if pid not in tasks:
+            tasks[pid] = Task(pid, trace.name(pid))
+        return tasks[pid]
+
+    # The task running before the first switch is the one switched away
+    # from by that switch
+
+    running = None
+    for e in trace.events:
+        if e.type == TRACE_SWITCH:
+            running = e.arg
+            break
+
+    since = start       # Start of the current slice of the running task
+    slicetime = 0       # Time run so far in the current slice
+    irqdepth = 0
+    irqstart = 0
+    irqtime = 0
+    irqcount = 0
+
+    for e in trace.events:
+        if e.type == TRACE_IRQENTER:
+            if irqdepth == 0:
+                if running is not None:
+                    slicetime += e.time - since
+                irqstart = e.time
+            irqdepth += 1
+            irqcount += 1
+        elif e.type == TRACE_IRQLEAVE and irqdepth > 0:
+            irqdepth -= 1
+            if irqdepth == 0:
+                irqtime += e.time - irqstart
+                since = e.time
+        elif e.type == TRACE_SWITCH:
+            if irqdepth == 0 and running is not None:
+                slicetime += e.time - since
+            if running is not None:
+                t = task(running)
+                t.runtime += slicetime
+                t.maxslice = max(t.maxslice, slicetime)
+            running = e.pid
+            task(running).switches += 1
+            since = e.time
+            slicetime = 0
+        elif e.type == TRACE_SEMBLOCK:
+            task(e.pid).semblocks += 1
+        elif e.type == TRACE_MQBLOCK:
+            task(e.pid).mqblocks += 1
+
+    if running is not None:
+        if irqdepth == 0:
+            slicetime += end - since
+        t = task(running)
+        t.runtime += slicetime
+        t.maxslice = max(t.maxslice, slicetime)
+
+    print('%d events over %s msec, %d overruns (%d usec per tick)' %
+          (len(trace.events), fmt_usec(total), trace.overruns,
+           trace.usecpertick))
+    if trace.overruns:
+        print('NOTE: The oldest events were lost; the trace begins with '
+              'the oldest remaining event')
+    print('')
+    print('   CPU%        msec   max slice  switches  semblk   mqblk  task')
+    for t in sorted(tasks.values(), key=lambda t: -t.runtime):
+        pct = 100.0 * t.runtime / total if total else 0.0
+        print('%6.2f%% %11s %11s %9d %7d %7d  %s' %
+              (pct, fmt_usec(t.runtime), fmt_usec(t.maxslice), t.switches,
+               t.semblocks, t.mqblocks, t.name))
+    if irqcount:
+        pct = 100.0 * irqtime / total if total else 0.0
+        print('%6.2f%% %11s %11s %9d %7s %7s  %s' %
+              (pct, fmt_usec(irqtime), '', irqcount, '', '', '<interrupts>'))
+
+    # With CONFIG_STACK_COLORATION, stop events carry the stack high water
+    # mark of the exiting task
+
+    stops = [e for e in trace.events if e.type == TRACE_STOP and e.arg]
+    if stops:
+        print('')
+        print('  stack  exited task')
+        for e in stops:
+            print('%7d  %s' % (e.arg, trace.name(e.pid)))
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Decode a NuttX scheduler trace dump')
+    parser.add_argument('-t', '--timeline', action='store_true',
+                        help='show a timeline of all events')
+    parser.add_argument('capture', nargs='?', metavar='capture-file',
+                        help='console capture of "trace dump" '
+                             '(default: standard input)')
+    args = parser.parse_args()
+
+    try:
+        if args.capture:
+            with open(args.capture) as f:
+                trace = Trace(f)
+        else:
+            trace = Trace(sys.stdin)
+    except (IOError, ValueError) as e:
+        sys.stderr.write('tracedecode.py: %s\n' % e)
+        return 1
+
+    if not trace.events:
+        print('The trace is empty')
+        return 0
+
+    if args.timeline:
+        show_timeline(trace)
+    show_utilisation(trace)
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())